@@ -44,6 +44,7 @@
 #include <QMessageBox>
 #include <QObject>
 #include <QString>
+#include <QThreadPool>
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
@@ -54,6 +55,7 @@
 #include "BtSplashScreen.h"
 #include "config.h"
 #include "database/Database.h"
+#include "database/ObjectStore.h"
 #include "Localization.h"
 #include "MainWindow.h"
 #include "measurement/ColorMethods.h"
@@ -71,6 +73,7 @@
 #include "model/Water.h"
 #include "model/Yeast.h"
 #include "PersistentSettings.h"
+#include "serialization/json/JsonSchema.h"
 
 // Needed for kill(2)
 #if defined(Q_OS_UNIX)
@@ -458,6 +461,8 @@ void Application::cleanup() {
    // Should I do qApp->removeTranslator() first?
    MainWindow::DeleteMainWindow();
 
+   // Make sure any property changes still in the write-behind queue get to the DB before we close it
+   ObjectStore::flush();
    Database::instance().unload();
    return;
 }
@@ -490,6 +495,17 @@ int Application::run() {
    splashScreen.finish(&mainWindow);
 
    initiateCheckForNewVersion(&mainWindow);
+
+   //
+   // Building the BeerJSON schema takes a noticeable amount of time, and valijson has no way for us to save the result
+   // to disk for next time.  So, instead, we build it in the background now, so that it's ready if and when the user
+   // imports a BeerJSON file.  (See comments in serialization/json/JsonSchema.cpp for why this is thread-safe.)
+   //
+   QThreadPool::globalInstance()->start([]() {
+      JsonSchema::instance(JsonSchema::Id::BEER_JSON_2_1);
+      return;
+   });
+
    do {
       ret = qApp->exec();
    } while (ret == 1000);
@@ -520,6 +536,14 @@ void Application::readSystemOptions() {
    //=======================Language & Date format===================
    Localization::loadSettings();
 
+   //=======================Database write-behind===================
+   // Batching up property changes to the DB is opt-in for now, via a setting that is not (yet) exposed in the UI.
+   // See ObjectStore::setWriteBehind() for more details.
+   int const writeBehindDelay_ms = PersistentSettings::value(PersistentSettings::Names::writeBehindDelay_ms, 0).toInt();
+   if (writeBehindDelay_ms > 0) {
+      ObjectStore::setWriteBehind(true, writeBehindDelay_ms);
+   }
+
    return;
 
 }
@@ -18,12 +18,20 @@
  =====================================================================================================================*/
 #include "Logging.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <sstream>      // For std::ostringstream
+#include <thread>
 
 #include <boost/stacktrace.hpp>
 
 #include <QApplication>
 #include <QDebug>
+#include <QLoggingCategory>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QObject>
@@ -47,7 +55,8 @@
 //
 namespace {
 
-   Logging::Level currentLoggingLevel = Logging::LogLevel_INFO;
+   // This is read on every logging call, potentially from several threads, hence atomic
+   std::atomic<Logging::Level> currentLoggingLevel{Logging::LogLevel_INFO};
 
    // We decompose the log filename into its body and suffix for log rotation
    // The _current_ log file is always "[applicaiton name].log"
@@ -61,6 +70,7 @@ namespace {
    QString const timeFormat{"hh:mm:ss.zzz"};
 
    QFile logFile;
+   // Protects logFile and stream.  NB: Logging calls do not take this mutex -- see LogWriter below.
    QMutex mutex;
 
    // This global flag controls whether, in general, we are logging to stderr or not.  Usually it's turned off for at
@@ -68,7 +78,7 @@ namespace {
    bool isLoggingToStderr{true};
 
    QTextStream errStream{stderr};
-   QTextStream * stream;
+   QTextStream * stream = nullptr;
 
    //
    // It's useful to include the thread ID in log messages.  We don't care what the actual ID is, we just need to be
@@ -121,21 +131,388 @@ namespace {
       }
    }
 
-   //
-   // This is what actually outputs a message to the log file and/or std::cerr
-   //
-   void doLog(const Logging::Level level, const QString message) {
-      QString logEntry = QString{"[%1] (%2) %3 : %4"}.arg(QTime::currentTime().toString(timeFormat))
-                                                     .arg(threadId)
-                                                     .arg(Logging::getStringFromLogLevel(level))
-                                                     .arg(message);
+   /**
+    * \brief A log message as captured on the thread that logged it.  We defer the work of formatting it into a log line
+    *        (timestamp, thread ID, level name, source file) to the writer thread.
+    */
+   struct LogEntry {
+      QTime          time;
+      QString        threadId;
+      Logging::Level level;
+      QString        message;
+      //! Full path of the source file.  We take a copy because \c QMessageLogContext::file is only guaranteed to be
+      //  valid for the duration of the call to the message handler.
+      QString        file;
+      int            line;
+      bool           toStderr;
+   };
+
+   /**
+    * \brief Turn a \c LogEntry into the line we write to the log file and/or stderr
+    */
+   QString formatLogEntry(LogEntry const & entry) {
+      // We don't use Logging::getStringFromLogLevel() here because this can get called from LogWriter's destructor,
+      // by which time Logging::levelDetails might already have been destroyed.
+      char const * levelName = "ERROR";
+      switch (entry.level) {
+         case Logging::LogLevel_DEBUG  : levelName = "DEBUG"  ; break;
+         case Logging::LogLevel_INFO   : levelName = "INFO"   ; break;
+         case Logging::LogLevel_WARNING: levelName = "WARNING"; break;
+         case Logging::LogLevel_ERROR  : levelName = "ERROR"  ; break;
+      }
+
+      //
+      // QMessageLogContext members are a bit hard to find in Qt documentation so noted here:
+      //    category : const char *
+      //    file : const char *      -- full path of the source file
+      //    function : const char *  -- same as what gets written out by Q_FUNC_INFO
+      //    line : int
+      //    version : int
+      //
+      // We don't want to log the full path of the source file, because that might contain private info about the
+      // directory structure on the machine on which the build was done.  We could just show the filename with:
+      //    QString sourceFile = QFileInfo(context.file).fileName();
+      // But we'd like to show the relative path under the src directory (eg database/Database.cpp rather than just
+      // Database.cpp).  (The code here assumes there will not be any subdirectory of src that is also called src,
+      // which seems pretty reasonable.)
+      QString const sourceFile = entry.file.split("/src/").last();
+      return QString{"[%1] (%2) %3 : %4  [%5:%6]"}.arg(entry.time.toString(timeFormat))
+                                                   .arg(entry.threadId)
+                                                   .arg(levelName)
+                                                   .arg(entry.message)
+                                                   .arg(sourceFile)
+                                                   .arg(entry.line);
+   }
+
+   /**
+    * \brief Bounded, lock-free, multi-producer, single-consumer queue of log messages.
+    *
+    *        This is the well-known bounded queue algorithm by Dmitry Vyukov.  Each cell has a sequence number that
+    *        tells producers when the cell is free to write to, and the consumer when it is ready to read.  Producers
+    *        only ever contend on one atomic (the enqueue position), and never wait for the consumer, unless the buffer
+    *        is full.
+    */
+   class LogRingBuffer {
+   public:
+      static constexpr std::size_t capacity = 8192;
+      static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
+      LogRingBuffer() : m_cells{}, m_enqueuePosition{0}, m_dequeuePosition{0} {
+         for (std::size_t ii = 0; ii < capacity; ++ii) {
+            this->m_cells[ii].sequence.store(ii, std::memory_order_relaxed);
+         }
+         return;
+      }
+
+      /**
+       * \brief Called from any thread.  \c entry is only moved from if we succeed.
+       *
+       * \return \c false if the buffer is full
+       */
+      bool tryPush(LogEntry && entry) {
+         std::size_t position = this->m_enqueuePosition.load(std::memory_order_relaxed);
+         Cell * cell;
+         for (;;) {
+            cell = &this->m_cells[position & (capacity - 1)];
+            std::size_t const sequence = cell->sequence.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (diff == 0) {
+               // Cell is free.  Try to claim it.  (On failure, position gets updated to the current enqueue position.)
+               if (this->m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                  break;
+               }
+            } else if (diff < 0) {
+               // Cell still holds an entry from one lap ago that the consumer hasn't read yet
+               return false;
+            } else {
+               // Another producer got here first
+               position = this->m_enqueuePosition.load(std::memory_order_relaxed);
+            }
+         }
+         cell->entry = std::move(entry);
+         cell->sequence.store(position + 1, std::memory_order_release);
+         return true;
+      }
+
+      /**
+       * \brief Only called from the writer thread.
+       *
+       * \return \c false if the buffer is empty
+       */
+      bool tryPop(LogEntry & entry) {
+         Cell & cell = this->m_cells[this->m_dequeuePosition & (capacity - 1)];
+         if (cell.sequence.load(std::memory_order_acquire) != this->m_dequeuePosition + 1) {
+            return false;
+         }
+         entry = std::move(cell.entry);
+         cell.sequence.store(this->m_dequeuePosition + capacity, std::memory_order_release);
+         ++this->m_dequeuePosition;
+         return true;
+      }
+
+   private:
+      struct Cell {
+         std::atomic<std::size_t> sequence;
+         LogEntry entry;
+      };
+      std::array<Cell, capacity> m_cells;
+      // Keep producer and consumer positions on different cache lines
+      alignas(64) std::atomic<std::size_t> m_enqueuePosition;
+      alignas(64) std::size_t m_dequeuePosition;
+   };
+
+   void writeLogEntries(QString const & fileText, QString const & stderrText);
+   bool logFileWouldExceedMaxSize(qsizetype const extraChars);
+   void rotateLogFiles();
+
+   /**
+    * \brief Asynchronous log sink.  Logging calls put messages in a \c LogRingBuffer and return.  A background thread
+    *        takes them out in batches, formats them, writes them to the log file and/or stderr, and rotates the log
+    *        file when needed.  So none of the formatting, file I/O or log rotation happens on the thread doing the
+    *        logging.
+    */
+   class LogWriter {
+   public:
+      LogWriter() :
+         m_ringBuffer    {},
+         m_thread        {},
+         m_running       {false},
+         m_accepting     {false},
+         m_numPushing    {0},
+         m_stopRequested {false},
+         m_flushRequested{false},
+         m_numQueued     {0},
+         m_numWritten    {0},
+         m_wakeMutex     {},
+         m_wakeCondition {},
+         m_flushMutex    {},
+         m_flushCondition{} {
+         return;
+      }
+
+      ~LogWriter() {
+         this->stop();
+         return;
+      }
+
+      void start() {
+         if (!this->isRunning()) {
+            this->m_stopRequested = false;
+            this->m_thread = std::thread{&LogWriter::run, this};
+            this->m_running.store(true, std::memory_order_release);
+            this->m_accepting.store(true);
+         }
+         return;
+      }
+
+      //! Write out everything queued so far and stop the writer thread.  After this, we log synchronously.
+      void stop() {
+         if (this->isRunning()) {
+            //
+            // First we stop taking new messages, and wait for any producer that got in before that to finish queueing
+            // its message.  (The writer thread is still running at this point, so a producer waiting for room in a full
+            // buffer will get it.)  Then we know that nothing else can get into the buffer once the writer thread has
+            // done its final write below.
+            //
+            this->m_accepting.store(false);
+            while (this->m_numPushing.load() > 0) {
+               this->m_wakeCondition.notify_one();
+               std::this_thread::yield();
+            }
+            {
+               std::lock_guard<std::mutex> lock{this->m_wakeMutex};
+               this->m_stopRequested = true;
+            }
+            this->m_wakeCondition.notify_one();
+            this->m_thread.join();
+            this->m_running.store(false, std::memory_order_release);
+            // The writer thread should have emptied the buffer before it finished, but it does no harm to make sure
+            this->writeBatch();
+         }
+         return;
+      }
+
+      bool isRunning() const {
+         return this->m_running.load(std::memory_order_acquire);
+      }
+
+      /**
+       * \brief Queue a message for the writer thread.
+       *
+       * \return \c false if the message could not be queued -- ie if we are stopping, or if the buffer is full and we
+       *         are the writer thread (eg logging about log file rotation) -- in which case the caller needs to write
+       *         the message itself.
+       */
+      bool push(LogEntry && entry) {
+         // We say we're pushing before we check whether we can, so that stop() can't miss us.  (Both of these use
+         // sequentially-consistent ordering, as do the corresponding operations in stop().)
+         this->m_numPushing.fetch_add(1);
+         if (!this->m_accepting.load()) {
+            this->m_numPushing.fetch_sub(1);
+            return false;
+         }
+         bool const queued = this->pushWhileAccepting(std::move(entry));
+         this->m_numPushing.fetch_sub(1);
+         return queued;
+      }
+
+      //! Block until everything queued before the call has been written
+      void flush() {
+         if (!this->isRunning() || std::this_thread::get_id() == this->m_thread.get_id()) {
+            return;
+         }
+         std::uint64_t const target = this->m_numQueued.load(std::memory_order_relaxed);
+         {
+            std::lock_guard<std::mutex> lock{this->m_wakeMutex};
+            this->m_flushRequested = true;
+         }
+         this->m_wakeCondition.notify_one();
+         std::unique_lock<std::mutex> lock{this->m_flushMutex};
+         this->m_flushCondition.wait(
+            lock, [&]() { return this->m_numWritten.load(std::memory_order_acquire) >= target; }
+         );
+         return;
+      }
+
+   private:
+      //! Longest we leave messages sitting in the buffer before writing them out
+      static constexpr std::chrono::milliseconds maxSleep{100};
+      //! Number of queued messages at which we wake the writer thread rather than waiting for maxSleep to elapse
+      static constexpr std::int64_t wakeThreshold = LogRingBuffer::capacity / 4;
+
+      /**
+       * \brief Approximate number of messages waiting to be written.  (Because a producer increments m_numQueued
+       *        before pushing its message, this can briefly include messages that are not yet in the buffer.)
+       */
+      std::int64_t numPending() const {
+         return static_cast<std::int64_t>(this->m_numQueued.load(std::memory_order_relaxed) -
+                                          this->m_numWritten.load(std::memory_order_relaxed));
+      }
+
+      //! Does the work for push()
+      bool pushWhileAccepting(LogEntry && entry) {
+         // We count the message before it goes in the buffer, so that the writer can never have written more messages
+         // than have been counted.  Otherwise, flush() could see another thread's uncounted message being written and
+         // return before ours had been.
+         this->m_numQueued.fetch_add(1, std::memory_order_relaxed);
+         while (!this->m_ringBuffer.tryPush(std::move(entry))) {
+            if (std::this_thread::get_id() == this->m_thread.get_id()) {
+               this->m_numQueued.fetch_sub(1, std::memory_order_relaxed);
+               return false;
+            }
+            // Buffer is full, so give the writer thread a chance to catch up.  We don't want to drop messages.
+            this->m_wakeCondition.notify_one();
+            std::this_thread::yield();
+         }
+         // The writer will pick up the message within maxSleep anyway, so we only bother to wake it if enough has built
+         // up to be worth writing.
+         if (this->numPending() >= wakeThreshold) {
+            this->m_wakeCondition.notify_one();
+         }
+         return true;
+      }
+
+      void run() {
+         for (;;) {
+            bool stopRequested;
+            {
+               std::unique_lock<std::mutex> lock{this->m_wakeMutex};
+               this->m_wakeCondition.wait_for(lock, maxSleep, [&]() {
+                  return this->m_stopRequested || this->m_flushRequested || this->numPending() >= wakeThreshold;
+               });
+               stopRequested = this->m_stopRequested;
+               this->m_flushRequested = false;
+            }
+            this->writeBatch();
+            if (stopRequested) {
+               // stop() has already made sure nothing else can be queued, so the batch we just wrote was the last one
+               return;
+            }
+         }
+      }
+
+      //! Write out everything in the buffer
+      void writeBatch() {
+         QString fileText;
+         QString stderrText;
+         std::uint64_t numWritten = this->m_numWritten.load(std::memory_order_relaxed);
+         LogEntry entry;
+         while (this->m_ringBuffer.tryPop(entry)) {
+            QString const line = formatLogEntry(entry) + '\n';
+            if (entry.toStderr) {
+               stderrText += line;
+            }
+            //
+            // Rotate the log file if this line would take it over the size limit.  We check this per line (rather than
+            // per batch) so that batching doesn't make log files bigger than they should be.
+            //
+            if (!fileText.isEmpty() && logFileWouldExceedMaxSize(fileText.size() + line.size())) {
+               writeLogEntries(fileText, QString{});
+               fileText.clear();
+               rotateLogFiles();
+            }
+            fileText += line;
+            ++numWritten;
+         }
+         if (!fileText.isEmpty() || !stderrText.isEmpty()) {
+            writeLogEntries(fileText, stderrText);
+            if (logFileWouldExceedMaxSize(0)) {
+               rotateLogFiles();
+            }
+         }
+         {
+            std::lock_guard<std::mutex> lock{this->m_flushMutex};
+            this->m_numWritten.store(numWritten, std::memory_order_release);
+         }
+         this->m_flushCondition.notify_all();
+         return;
+      }
+
+      LogRingBuffer m_ringBuffer;
+      std::thread m_thread;
+      std::atomic<bool> m_running;
+      //! Whether push() will take new messages.  Cleared at the start of stop().
+      std::atomic<bool> m_accepting;
+      //! Number of threads currently in push() (including ones that are about to find they can't push)
+      std::atomic<int> m_numPushing;
+      // These two are protected by m_wakeMutex
+      bool m_stopRequested;
+      bool m_flushRequested;
+      std::atomic<std::uint64_t> m_numQueued;
+      std::atomic<std::uint64_t> m_numWritten;
+      std::mutex m_wakeMutex;
+      std::condition_variable m_wakeCondition;
+      std::mutex m_flushMutex;
+      std::condition_variable m_flushCondition;
+   };
+
+   /**
+    * \brief Write (already formatted) log lines to the log file and/or stderr.  Called from the writer thread, or
+    *        directly from the logging thread when the writer thread is not running.
+    */
+   void writeLogEntries(QString const & fileText, QString const & stderrText) {
       QMutexLocker locker(&mutex);
-      if (isLoggingToStderr ||
-          forceStderrLogging) { errStream << logEntry << END_OF_LINE; }
-      if (stream)             {   *stream << logEntry << END_OF_LINE; }
+      if (!stderrText.isEmpty()) {
+         errStream << stderrText;
+         errStream.flush();
+      }
+      if (stream && !fileText.isEmpty()) {
+         *stream << fileText;
+         stream->flush();
+      }
       return;
    }
 
+   /**
+    * \brief Returns \c true if writing \c extraChars more characters to the log file would take it over
+    *        \c Logging::logFileSize.  (We count characters rather than bytes, which is near enough.)  Always returns
+    *        \c false if there is no log file open.
+    */
+   bool logFileWouldExceedMaxSize(qsizetype const extraChars) {
+      QMutexLocker locker(&mutex);
+      return stream && logFile.size() + extraChars > Logging::logFileSize;
+   }
+
    /**
     * \brief Generates a log file name
     */
@@ -193,7 +570,7 @@ namespace {
       // First check if it's time to rotate the log file
       if (logFile.size() > Logging::logFileSize) {
          // Acquire lock due to the file mangling below.  NB: This means we do not want to use Qt logging in this
-         // block, as we'd end up attempting to acquire the same mutex in the doLog() function above!  So, any errors
+         // block, as we'd end up attempting to acquire the same mutex in writeLogEntries() above!  So, any errors
          // between here and the closing brace need to go to stderr
          QMutexLocker locker(&mutex);
          // Double check that the stream is not initiated, if so, kill it.
@@ -209,7 +586,11 @@ namespace {
       // Test default location
       logFile.setFileName(logDirectory.filePath(logFileFullName()));
       if (logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
-         stream = new QTextStream(&logFile);
+         {
+            // The writer thread could be writing to the stream, so we need the mutex to set it
+            QMutexLocker locker(&mutex);
+            stream = new QTextStream(&logFile);
+         }
          qInfo() << Q_FUNC_INFO << "Logging to file" << QFileInfo(logFile).canonicalFilePath();
          return true;
       }
@@ -222,7 +603,10 @@ namespace {
       logFile.setFileName(QDir::temp().filePath(logFileFullName()));
       if (logFile.open(QFile::WriteOnly | QFile::Truncate)) {
          logFile.setPermissions(QFileDevice::WriteUser | QFileDevice::ReadUser | QFileDevice::ExeUser);
-         stream = new QTextStream(&logFile);
+         {
+            QMutexLocker locker(&mutex);
+            stream = new QTextStream(&logFile);
+         }
          qWarning() <<
             Q_FUNC_INFO << "Log file is in a temporary directory: " << QFileInfo(logFile).canonicalFilePath();
          return true;
@@ -260,55 +644,88 @@ namespace {
       return;
    }
 
+   /**
+    * \brief Prune old log files and start a new one.  Called (from the writer thread) when the log file gets too big.
+    */
+   void rotateLogFiles() {
+      pruneLogFiles();
+      openLogFile();
+      return;
+   }
+
+   // Needs to be declared after everything it uses, so that it is destroyed (which stops the writer thread) before them
+   LogWriter logWriter;
+
    /**
     * \brief Handles all log messages, which should be logged using the standard Qt functions, eg:
     *        qDebug() << "message" << some_variable; //for a debug message!
+    *
+    *        We do as little as possible here, as this is called on the thread doing the logging.
     */
    void logMessageHandler(QtMsgType qtMsgType, QMessageLogContext const & context, QString const & message) {
       Logging::Level logLevelOfMessage = levelFromQtMsgType(qtMsgType);
-      //
-      // First things first!  What logging level has the user chosen.
-      // then, if the file-stream is open and the log file size is to big, we need to prune the old logs and initiate a new logfile.
-      // after that we're all set, Log away!
-      //
 
       // Check that we're set to log this level, this is set by the user options.
-      if (logLevelOfMessage < currentLoggingLevel) {
+      if (logLevelOfMessage < currentLoggingLevel.load(std::memory_order_relaxed)) {
          return;
       }
 
-      // Check if there is a file actually set yet.  In a rare case if the logfile was not created at initialization,
-      // then we won't be logging to a file, the location may not yet have been loaded from the settings, thus only logging to the stderr.
-      // In this case we cannot do any of the pruning or filename generation.
-      if (stream) {
-         if (logFile.size() >= Logging::logFileSize) {
-            pruneLogFiles();
-            openLogFile();
-         }
+      LogEntry entry{QTime::currentTime(),
+                     threadId,
+                     logLevelOfMessage,
+                     message,
+                     QString{context.file},
+                     context.line,
+                     isLoggingToStderr || forceStderrLogging};
+      if (!logWriter.isRunning() || !logWriter.push(std::move(entry))) {
+         // Writer thread not running or stopping (eg we are shutting down), or this is the writer thread itself
+         // logging (eg about log rotation) and the buffer is full.  Either way, we write the message ourselves.
+         QString const line = formatLogEntry(entry) + '\n';
+         writeLogEntries(line, entry.toStderr ? line : QString{});
+         return;
       }
 
-      // Writing the actual log
-      //
-      // QMessageLogContext members are a bit hard to find in Qt documentation so noted here:
-      //    category : const char *
-      //    file : const char *      -- full path of the source file
-      //    function : const char *  -- same as what gets written out by Q_FUNC_INFO
-      //    line : int
-      //    version : int
-      //
-      // We don't want to log the full path of the source file, because that might contain private info about the
-      // directory structure on the machine on which the build was done.  We could just show the filename with:
-      //    QString sourceFile = QFileInfo(context.file).fileName();
-      // But we'd like to show the relative path under the src directory (eg database/Database.cpp rather than just
-      // Database.cpp).  (The code here assumes there will not be any subdirectory of src that is also called src,
-      // which seems pretty reasonable.)
-      QString sourceFile = QString{context.file}.split("/src/").last();
-      doLog(logLevelOfMessage, QString("%1  [%2:%3]").arg(message).arg(sourceFile).arg(context.line));
+      // If something's gone badly wrong, we don't want its log messages stuck in the buffer if the program then
+      // crashes.  (Errors should be rare enough that waiting for them to be written doesn't slow anything down.)
+      if (logLevelOfMessage >= Logging::LogLevel_ERROR) {
+         logWriter.flush();
+      }
+      return;
+   }
+
+   //! Whatever category filter was installed before ours -- normally Qt's own, which applies QT_LOGGING_RULES etc
+   QLoggingCategory::CategoryFilter qtCategoryFilter = nullptr;
+
+   /**
+    * \brief Tell Qt which message types we want in each logging category, so that messages below the current logging
+    *        level are discarded as early as possible.  (For qCDebug() etc, this means before the message is built.)
+    *        Qt calls this for every category when it is created, and for all existing ones when we (re)install it.
+    */
+   void categoryFilter(QLoggingCategory * category) {
+      if (qtCategoryFilter) {
+         qtCategoryFilter(category);
+      }
+      Logging::Level const level = currentLoggingLevel.load(std::memory_order_relaxed);
+      category->setEnabled(QtDebugMsg  , category->isDebugEnabled  () && level <= Logging::LogLevel_DEBUG  );
+      category->setEnabled(QtInfoMsg   , category->isInfoEnabled   () && level <= Logging::LogLevel_INFO   );
+      category->setEnabled(QtWarningMsg, category->isWarningEnabled() && level <= Logging::LogLevel_WARNING);
+      return;
+   }
+
+   //! Apply the current logging level to all logging categories
+   void setQtCategoryLevels() {
+      QLoggingCategory::CategoryFilter const previousFilter = QLoggingCategory::installFilter(categoryFilter);
+      if (previousFilter != categoryFilter) {
+         qtCategoryFilter = previousFilter;
+      }
       return;
    }
 
 }
 
+namespace Logging {
+   Q_LOGGING_CATEGORY(calcs, "brewken.calcs")
+}
 
 QVector<Logging::LevelDetail> const Logging::levelDetails{
    { Logging::LogLevel_DEBUG,   "DEBUG",   QObject::tr("Detailed (for debugging)")},
@@ -338,12 +755,17 @@ Logging::Level Logging::getLogLevelFromString(QString const name) {
 }
 
 Logging::Level Logging::getLogLevel() {
-   return currentLoggingLevel;
+   return currentLoggingLevel.load(std::memory_order_relaxed);
+}
+
+bool Logging::isLogging(Level const level) {
+   return level >= currentLoggingLevel.load(std::memory_order_relaxed);
 }
 
 void Logging::setLogLevel(Level newLevel) {
    currentLoggingLevel = newLevel;
-   PersistentSettings::insert(PersistentSettings::Names::LoggingLevel, Logging::getStringFromLogLevel(currentLoggingLevel));
+   setQtCategoryLevels();
+   PersistentSettings::insert(PersistentSettings::Names::LoggingLevel, Logging::getStringFromLogLevel(newLevel));
    return;
 }
 
@@ -366,11 +788,13 @@ bool Logging::initializeLogging() {
    TemporarilyForceStderrLogging temporarilyForceStderrLogging;
 
    currentLoggingLevel = Logging::getLogLevelFromString(PersistentSettings::value(PersistentSettings::Names::LoggingLevel, "INFO").toString());
+   setQtCategoryLevels();
    Logging::setDirectory(
       PersistentSettings::contains(PersistentSettings::Names::LogDirectory) ?
          std::optional<QDir>(PersistentSettings::value(PersistentSettings::Names::LogDirectory).toString()) : std::optional<QDir>(std::nullopt)
    );
 
+   logWriter.start();
    qInstallMessageHandler(logMessageHandler);
    qDebug() << Q_FUNC_INFO << "Logging initialized.  Logs will be written to" << logDirectory.absolutePath();
 
@@ -517,7 +941,14 @@ QFileInfoList Logging::getLogFileList() {
 }
 
 
+void Logging::flush() {
+   logWriter.flush();
+   return;
+}
+
 void Logging::terminateLogging() {
+   // Write out anything still queued before we close the file
+   logWriter.stop();
    QMutexLocker locker(&mutex);
    closeLogFile();
    return;
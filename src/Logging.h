@@ -23,6 +23,7 @@
 
 #include <QDir>
 #include <QFileInfoList>
+#include <QLoggingCategory>
 #include <QString>
 #include <QVector>
 
@@ -86,6 +87,20 @@ namespace Logging {
     */
    extern void setLogLevel(Level newLevel);
 
+   /**
+    * \brief Returns \c true if messages of the supplied level are currently being logged.  Use this to avoid the cost
+    *        of building debug messages in code that gets called a lot.  (Qt assembles the text of a message before we
+    *        get a chance to discard it.)
+    */
+   extern bool isLogging(Level const level);
+
+   /**
+    * \brief Category for debug logging in calculations that get done a lot (eg \c Recipe recalculations and IBUs).
+    *        Log with \c qCDebug(Logging::calcs) rather than \c qDebug(), and, unless debug logging is on, none of the
+    *        message gets built.  (Like all other categories, it follows the current logging level.)
+    */
+   Q_DECLARE_LOGGING_CATEGORY(calcs)
+
    /**
     * \return \b true if we are logging in the config dir (the default), \b false if we are logging in a directory
     *         configured via \c Logging::setDirectory()
@@ -157,6 +172,12 @@ namespace Logging {
     */
    extern QFileInfoList getLogFileList();
 
+   /**
+    * \brief Log messages are written to the log file (and stderr) by a background thread.  This blocks until all
+    *        messages logged (by any thread) before the call have been written.
+    */
+   extern void flush();
+
    /**
     * \brief Terminate logging
     */
@@ -86,6 +86,7 @@ AddSettingName(treeView_yeast_headerState)       // MainWindow section
 AddSettingName(UserDataDirectory)
 AddSettingName(versioning)
 AddSettingName(windowState)
+AddSettingName(writeBehindDelay_ms)
 #undef AddSettingName
 //=========================================== End of setting NAME constants ============================================
 //======================================================================================================================
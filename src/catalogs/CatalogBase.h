@@ -119,7 +119,6 @@ public:
       m_tableWidget->setSortingEnabled(true);
       m_tableWidget->sortByColumn(static_cast<int>(NeTableModel::ColumnIndex::Name), Qt::AscendingOrder);
       m_neTableProxy->setDynamicSortFilter(true);
-      m_neTableProxy->setFilterKeyColumn(1);
 
       m_qLineEdit_searchBox->setMaxLength(30);
       m_qLineEdit_searchBox->setPlaceholderText("Enter filter");
@@ -354,11 +353,11 @@ public:
    }
 
    /**
-    * \brief Subclass should call this from its \c filterItems slot
+    * \brief Subclass should call this from its \c filterItems slot.  See \c FilterQuery for what \c searchExpression
+    *        can contain.
     */
    void filter(QString searchExpression) {
-      m_neTableProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
-      m_neTableProxy->setFilterFixedString(searchExpression);
+      m_neTableProxy->setFilterQuery(searchExpression);
       return;
    }
 
@@ -38,6 +38,7 @@
 
 #include <filesystem>
 #include <iostream> // For writing to std::cerr in destructor
+#include <map>
 #include <mutex>    // For std::once_flag etc
 
 #include <QDateTime>
@@ -235,7 +236,9 @@ public:
                                    loaded{false},
                                    loadWasSuccessful{false},
                                    mutex{},
-                                   userDatabaseDidNotExist{false} {
+                                   userDatabaseDidNotExist{false},
+                                   preparedQueriesMutex{},
+                                   preparedQueries{} {
       return;
    }
 
@@ -605,6 +608,17 @@ public:
    QString dbSchema;
    QString dbUsername;
    QString dbPassword;
+
+   //
+   // Pool of prepared queries not currently in use, keyed by connection name and SQL -- see Database::preparedQuery().
+   // We never keep more than one query per key.  We use std::map rather than QHash because the latter cannot hold
+   // move-only values.
+   //
+   // This has its own mutex because the pool is accessed far more often than, and independently of, the things the
+   // main mutex protects.
+   //
+   QMutex preparedQueriesMutex;
+   std::map<QString, std::unique_ptr<BtSqlQuery>> preparedQueries;
 };
 
 
@@ -628,6 +642,86 @@ Database::~Database() {
    return;
 }
 
+namespace {
+   /**
+    * \brief Key for Database::impl::preparedQueries.  Connection names can't contain newlines (or at least ours don't),
+    *        so this is unambiguous.
+    */
+   QString preparedQueryPoolKey(QSqlDatabase const & connection, QString const & sql) {
+      return connection.connectionName() + '\n' + sql;
+   }
+}
+
+Database::PreparedQuery::PreparedQuery(Database const & database,
+                                       QString const & poolKey,
+                                       std::unique_ptr<BtSqlQuery> query) :
+   m_database{database},
+   m_poolKey{poolKey},
+   m_query{std::move(query)} {
+   return;
+}
+
+Database::PreparedQuery::PreparedQuery(PreparedQuery && other) :
+   m_database{other.m_database},
+   m_poolKey{other.m_poolKey},
+   m_query{std::move(other.m_query)} {
+   return;
+}
+
+Database::PreparedQuery::~PreparedQuery() {
+   if (!this->m_query) {
+      // We were moved from, so nothing to give back
+      return;
+   }
+   // Release any results (and, on SQLite, any locks held by the statement) but keep the statement prepared
+   this->m_query->finish();
+   QMutexLocker locker(&this->m_database.pimpl->preparedQueriesMutex);
+   // If someone else put back a query for the same SQL while we were using this one (ie there was a nested call), we
+   // only need to keep one of them, and try_emplace does nothing if the key is already present.
+   this->m_database.pimpl->preparedQueries.try_emplace(this->m_poolKey, std::move(this->m_query));
+   return;
+}
+
+BtSqlQuery & Database::PreparedQuery::operator*() const {
+   return *this->m_query;
+}
+
+BtSqlQuery * Database::PreparedQuery::operator->() const {
+   return this->m_query.get();
+}
+
+Database::PreparedQuery Database::preparedQuery(QSqlDatabase const & connection, QString const & sql) const {
+   QString const poolKey = preparedQueryPoolKey(connection, sql);
+   {
+      QMutexLocker locker(&this->pimpl->preparedQueriesMutex);
+      auto pooled = this->pimpl->preparedQueries.find(poolKey);
+      if (pooled != this->pimpl->preparedQueries.end()) {
+         auto query = std::move(pooled->second);
+         this->pimpl->preparedQueries.erase(pooled);
+         return PreparedQuery{*this, poolKey, std::move(query)};
+      }
+   }
+
+   // Nothing in the pool, so make a new one.  As noted in BtSqlQuery, the statement only actually gets prepared on the
+   // DB when the first value is bound to it, and stays prepared after that.
+   auto query = std::make_unique<BtSqlQuery>(connection);
+   query->prepare(sql);
+   return PreparedQuery{*this, poolKey, std::move(query)};
+}
+
+void Database::releasePreparedQueries(QSqlDatabase const & connection) const {
+   QString const prefix = connection.connectionName() + '\n';
+   QMutexLocker locker(&this->pimpl->preparedQueriesMutex);
+   for (auto ii = this->pimpl->preparedQueries.begin(); ii != this->pimpl->preparedQueries.end(); ) {
+      if (ii->first.startsWith(prefix)) {
+         ii = this->pimpl->preparedQueries.erase(ii);
+      } else {
+         ++ii;
+      }
+   }
+   return;
+}
+
 QSqlDatabase Database::sqlDatabase() const {
    // Need a unique database connection for each thread.
    //http://www.linuxjournal.com/article/9602
@@ -693,7 +787,8 @@ QSqlDatabase Database::sqlDatabase() const {
       }
       qCritical() << Q_FUNC_INFO << errorMessage;
 
-      if (Application::isInteractive()) {
+      // We can only show a message box on the main thread.  On other threads, the exception below will have to do.
+      if (Application::isInteractive() && QThread::currentThread() == QCoreApplication::instance()->thread()) {
          QMessageBox::critical(nullptr,
                                QObject::tr("Database Failure"),
                                errorMessage);
@@ -706,6 +801,29 @@ QSqlDatabase Database::sqlDatabase() const {
    return connection;
 }
 
+void Database::closeConnectionForThisThread() const {
+   Q_ASSERT(!QCoreApplication::instance() || QThread::currentThread() != QCoreApplication::instance()->thread());
+   QString const connectionName = dbConnectionNamesForThisThread.value(this->pimpl->dbType);
+   if (!QSqlDatabase::contains(connectionName)) {
+      return;
+   }
+
+   qDebug() << Q_FUNC_INFO << "Closing connection " << connectionName;
+   {
+      //
+      // Extra braces here are to ensure that this QSqlDatabase object is out of scope before the call to
+      // QSqlDatabase::removeDatabase() below
+      //
+      QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+      this->releasePreparedQueries(connection);
+      if (connection.isOpen()) {
+         connection.close();
+      }
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+   return;
+}
+
 bool Database::load() {
    this->pimpl->createFromScratch = false;
    this->pimpl->schemaUpdated = false;
@@ -849,6 +967,15 @@ void Database::unload() {
    // This RAII wrapper does all the hard work on mutex.lock() and mutex.unlock() in an exception-safe way
    QMutexLocker locker(&this->pimpl->mutex);
 
+   //
+   // Any pooled queries have to be destroyed before the connections they use are removed (see comment in header file
+   // for Database::sqlDatabase()).
+   //
+   {
+      QMutexLocker preparedQueriesLocker(&this->pimpl->preparedQueriesMutex);
+      this->pimpl->preparedQueries.clear();
+   }
+
    // We only want to close connections that relate to this instance of Database
    QString ourConnectionPrefix = QString{"%1-"}.arg(getDbNativeName(displayableDbType, this->pimpl->dbType));
 
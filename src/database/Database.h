@@ -39,6 +39,7 @@
 #include "config.h"
 #include "utils/NoCopy.h"
 
+class BtSqlQuery;
 class BtStringConst;
 
 /*!
@@ -103,6 +104,64 @@ public:
     */
    QSqlDatabase sqlDatabase() const;
 
+   /**
+    * \brief RAII handle to a prepared query borrowed from the pool in \c Database -- see \c preparedQuery().  When the
+    *        handle goes out of scope, the query is finished (ie any result set is released, but the statement stays
+    *        prepared on the database side) and returned to the pool for the next caller who wants the same SQL on the
+    *        same connection.
+    */
+   class PreparedQuery {
+   public:
+      PreparedQuery(Database const & database, QString const & poolKey, std::unique_ptr<BtSqlQuery> query);
+      PreparedQuery(PreparedQuery && other);
+      ~PreparedQuery();
+
+      BtSqlQuery & operator*() const;
+      BtSqlQuery * operator->() const;
+
+   private:
+      Database const & m_database;
+      QString const m_poolKey;
+      std::unique_ptr<BtSqlQuery> m_query;
+
+      PreparedQuery(PreparedQuery const &) = delete;
+      PreparedQuery & operator=(PreparedQuery const &) = delete;
+      PreparedQuery & operator=(PreparedQuery &&) = delete;
+   };
+
+   /**
+    * \brief Get a query object for the supplied SQL on the supplied connection.  If we have previously prepared the
+    *        same SQL on the same connection, and that query object isn't currently in use, we return it rather than
+    *        create a new one, which saves the database from recompiling the statement.  Callers just need to call
+    *        \c bindValue() and \c exec() on the returned handle -- ie NOT \c prepare(), as that has been done for them.
+    *
+    *        This is intended for the SQL that \c ObjectStore runs over and over again (INSERT, UPDATE and DELETE on a
+    *        given table).  There's not much benefit to using it for one-off queries.
+    *
+    *        Since connections are per-thread (see \c sqlDatabase()), so, in effect, is the pool.  If the same SQL is
+    *        requested again while the pooled query is still in use (eg because of a nested call), the second caller
+    *        just gets a new query object, so callers don't need to worry about re-entrancy.
+    *
+    *        All pooled queries are destroyed in \c unload(), before the underlying connections are removed.
+    */
+   PreparedQuery preparedQuery(QSqlDatabase const & connection, QString const & sql) const;
+
+   /**
+    * \brief Destroy any pooled queries for the supplied connection.  Callers only need to do this for connections that
+    *        they are going to remove themselves (ie not ones we gave out from \c sqlDatabase()).
+    */
+   void releasePreparedQueries(QSqlDatabase const & connection) const;
+
+   /**
+    * \brief Close and remove the connection (if any) that \c sqlDatabase() created for the current thread, along with
+    *        any pooled queries on it.  This is for worker threads that are done with the DB, eg those used by
+    *        \c InitialiseAllObjectStores().  (Thread IDs can be reused, so we don't want to leave connections for
+    *        finished threads lying around.)  It should not be called on the main thread.
+    *
+    *        Callers must not be holding any \c QSqlDatabase objects for the connection when they call this.
+    */
+   void closeConnectionForThisThread() const;
+
    //! \brief Should be called when we are about to close down.
    void unload();
 
@@ -16,11 +16,27 @@
 #include "database/DbTransaction.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QSqlError>
+#include <QSqlQuery>
 
 #include "database/Database.h"
 #include "Logging.h"
 
+namespace {
+   //
+   // How many DbTransaction objects are open on each connection, keyed by connection name.  Connections are per-thread
+   // (see Database::sqlDatabase()), so this can be too.
+   //
+   thread_local QHash<QString, int> transactionDepths;
+
+   //! \return Name for the savepoint if we are about to start a nested transaction on \c connection, empty otherwise
+   QString nextSavepointName(QSqlDatabase const & connection) {
+      int const depth = transactionDepths.value(connection.connectionName(), 0);
+      return depth > 0 ? QString{"nested_transaction_%1"}.arg(depth) : QString{};
+   }
+}
+
 DbTransaction::DbTransaction(Database & database,
                              QSqlDatabase & connection,
                              QString const nameForLogging,
@@ -28,8 +44,21 @@ DbTransaction::DbTransaction(Database & database,
    database{database},
    connection{connection},
    nameForLogging{nameForLogging},
+   savepointName{nextSavepointName(connection)},
    committed{false},
    specialBehaviours{specialBehaviours} {
+   ++transactionDepths[this->connection.connectionName()];
+
+   if (!this->savepointName.isEmpty()) {
+      // It's a coding error to try to turn off foreign keys inside a transaction -- see comment below
+      Q_ASSERT(!(this->specialBehaviours & DISABLE_FOREIGN_KEYS));
+      bool succeeded = this->execSavepointCommand("SAVEPOINT " + this->savepointName);
+      qDebug() <<
+         Q_FUNC_INFO << "Nested database transaction" << this->nameForLogging << "(" << this->savepointName <<
+         ") begin: " << (succeeded ? "succeeded" : "failed");
+      return;
+   }
+
    // Note that, on SQLite at least, turning foreign keys on and off has to happen outside a transaction, so we have to
    // be careful about the order in which we do things.
    if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
@@ -49,6 +78,23 @@ DbTransaction::DbTransaction(Database & database,
 
 DbTransaction::~DbTransaction() {
    qDebug() << Q_FUNC_INFO;
+   QString const connectionName = this->connection.connectionName();
+   if (--transactionDepths[connectionName] <= 0) {
+      transactionDepths.remove(connectionName);
+   }
+
+   if (!this->savepointName.isEmpty()) {
+      if (!committed) {
+         // Rolling back to a savepoint doesn't remove it, so we need to release it as well
+         bool succeeded = this->execSavepointCommand("ROLLBACK TO SAVEPOINT " + this->savepointName) &&
+                          this->execSavepointCommand("RELEASE SAVEPOINT " + this->savepointName);
+         qDebug() <<
+            Q_FUNC_INFO << "Nested database transaction" << this->nameForLogging << "rollback: " <<
+            (succeeded ? "succeeded" : "failed");
+      }
+      return;
+   }
+
    if (!committed) {
       bool succeeded = this->connection.rollback();
       qDebug() <<
@@ -67,6 +113,14 @@ DbTransaction::~DbTransaction() {
 }
 
 bool DbTransaction::commit() {
+   if (!this->savepointName.isEmpty()) {
+      this->committed = this->execSavepointCommand("RELEASE SAVEPOINT " + this->savepointName);
+      qDebug() <<
+         Q_FUNC_INFO << "Nested database transaction" << this->nameForLogging << "commit: " <<
+         (this->committed ? "succeeded" : "failed");
+      return this->committed;
+   }
+
    this->committed = connection.commit();
    qDebug() <<
       Q_FUNC_INFO << "Database transaction" << this->nameForLogging << "commit: " << (this->committed ? "succeeded" : "failed");
@@ -76,3 +130,14 @@ bool DbTransaction::commit() {
    }
    return this->committed;
 }
+
+bool DbTransaction::execSavepointCommand(QString const & command) {
+   QSqlQuery query{this->connection};
+   if (!query.exec(command)) {
+      qCritical() <<
+         Q_FUNC_INFO << "Error executing" << command << "for database transaction" << this->nameForLogging << ":" <<
+         query.lastError().text();
+      return false;
+   }
+   return true;
+}
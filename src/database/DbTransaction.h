@@ -23,6 +23,11 @@ class Database;
 
 /**
  * \brief RAII wrapper for transaction(), commit(), rollback() member functions of QSqlDatabase
+ *
+ *        Transactions can be nested: if there is already a \c DbTransaction open on the connection, we use a savepoint
+ *        (which both SQLite and PostgreSQL support) instead of starting a new transaction.  This means that, eg, a bulk
+ *        import can wrap all its inserts in one transaction (which is a lot quicker on SQLite than committing each
+ *        one separately), whilst each insert still gets rolled back on its own if it fails.
  */
 class DbTransaction {
 public:
@@ -32,7 +37,10 @@ public:
    };
 
    /**
-    * \brief Constructing a \c DbTransaction will start a DB transaction
+    * \brief Constructing a \c DbTransaction will start a DB transaction (or, if nested, a savepoint)
+    *
+    *        NB: \c DISABLE_FOREIGN_KEYS cannot be used for a nested transaction, as, on SQLite at least, foreign keys
+    *        can only be turned on and off outside a transaction.
     */
    DbTransaction(Database & database,
                  QSqlDatabase & connection,
@@ -59,9 +67,16 @@ private:
    // This is useful for diagnosing problems such as
    // 'Unable to start database transaction: "cannot start a transaction within a transaction Unable to begin transaction"'
    QString const nameForLogging;
+   //! Empty if this is not a nested transaction
+   QString const savepointName;
    bool committed;
    int specialBehaviours;
 
+   /**
+    * \brief Run a SAVEPOINT, RELEASE SAVEPOINT or ROLLBACK TO SAVEPOINT command for a nested transaction
+    */
+   bool execSavepointCommand(QString const & command);
+
    // RAII class shouldn't be getting copied or moved
    DbTransaction(DbTransaction const &) = delete;
    DbTransaction & operator=(DbTransaction const &) = delete;
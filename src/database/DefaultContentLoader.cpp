@@ -136,7 +136,7 @@ DefaultContentLoader::UpdateResult DefaultContentLoader::updateContentIfNecessar
          QList<Recipe *> allRecipesBeforeImport = ObjectStoreWrapper::getAllRaw<Recipe>();
          qDebug() << Q_FUNC_INFO << allRecipesBeforeImport.size() << "Recipes before import";
 
-         succeeded = ImportExport::importFromFiles(inputFiles);
+         succeeded = ImportExport::importDefaultContent(inputFiles);
 
          if (succeeded) {
             //
@@ -174,8 +174,8 @@ DefaultContentLoader::UpdateResult DefaultContentLoader::updateContentIfNecessar
       }
 
       //
-      // ImportExport::importFromFiles will already have shown success/failure pop-ups, so we don't need to interact
-      // further with the user here.
+      // ImportExport::importDefaultContent will already have shown a success/failure pop-up, so we don't need to
+      // interact further with the user here.
       //
       return succeeded ? DefaultContentLoader::UpdateResult::Succeeded : DefaultContentLoader::UpdateResult::Failed;
    }
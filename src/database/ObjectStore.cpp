@@ -17,17 +17,29 @@
 
 #include <cstring>
 #include <iostream> // For start-up errors!
+#include <mutex>    // For std::once_flag etc
+#include <optional>
 #include <tuple>
 
+#include <QCoreApplication>
 #include <QDebug>
 #include <QHash>
 #include <QMap>
+#include <QMessageBox>
+#include <QMetaProperty>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QSet>
 #include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlField>
 #include <QSqlRecord>
+#include <QThread>
+#include <QTimer>
 #include <QVector>
 
+#include "Application.h"
 #include "database/BtSqlQuery.h"
 #include "database/Database.h"
 #include "database/DbTransaction.h"
@@ -296,20 +308,62 @@ namespace {
       return junctionTable.tableFields.size() > 3 ? junctionTable.tableFields[3].columnName : BtString::NULL_STR;
    }
 
+   /**
+    * \brief Construct the SQL for inserting one row into a junction table.  See comment in
+    *        \c insertIntoJunctionTableDefinition for why we only ever insert one row at a time.
+    *
+    *        Note that orderByColumn column is only used if specified, and that, if it is, we assume it's an integer
+    *        type and that we create the values ourselves.
+    */
+   QString junctionTableInsertSql(ObjectStore::JunctionTableDefinition const & junctionTable) {
+      QString queryString{"INSERT INTO "};
+      QTextStream queryStringAsStream{&queryString};
+      queryStringAsStream << junctionTable.tableName << " (" <<
+         GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << ", " <<
+         GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
+      if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
+         queryStringAsStream << ", " << GetJunctionTableDefinitionOrderByColumn(junctionTable);
+      }
+      queryStringAsStream <<
+         ") VALUES (:" << GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << ", :" <<
+         GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
+      if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
+         queryStringAsStream << ", :" << GetJunctionTableDefinitionOrderByColumn(junctionTable);
+      }
+      queryStringAsStream << ");";
+      return queryString;
+   }
+
+   /**
+    * \brief Construct the SQL for deleting all the rows relating to a particular object from a junction table
+    */
+   QString junctionTableDeleteSql(ObjectStore::JunctionTableDefinition const & junctionTable) {
+      QString queryString{"DELETE FROM "};
+      QTextStream queryStringAsStream{&queryString};
+      queryStringAsStream <<
+         junctionTable.tableName << " WHERE " << GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) <<
+         " = :" << GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << ";";
+      return queryString;
+   }
+
    /**
     * \brief Insert data from an object property to a junction table
     *
     * \param junctionTable
+    * \param queryString  SQL from \c junctionTableInsertSql() for \c junctionTable
     * \param object
     * \param primaryKey  Note that this must be supplied separately as, for a new object, we may not (yet) have set its
     *                    primary key (ie we cannot just read primary key from object)
+    * \param database
     * \param connection
     *
     * \return \c true if succeeded, \c false otherwise
     */
    bool insertIntoJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                          QString const & queryString,
                                           QObject const & object,
                                           QVariant const & primaryKey,
+                                          Database const & database,
                                           QSqlDatabase & connection) {
       qDebug() <<
          Q_FUNC_INFO << "Writing" << object.metaObject()->className() << "property" <<
@@ -345,36 +399,14 @@ namespace {
       // parameters.)  And there's likely no noticeable performance benefit given that we're typically inserting only
       // a handful of rows at a time (eg all the Hops in a Recipe).
       //
-      // So instead, we just do individual inserts.  Note that orderByColumn column is only used if specified, and
-      // that, if it is, we assume it's an integer type and that we create the values ourselves.
+      // So instead, we just do individual inserts, reusing the same prepared statement for each row.  (The SQL itself is
+      // constructed once per junction table by ObjectStore::impl -- see junctionTableInsertSql() above.)
       //
-      QString queryString{"INSERT INTO "};
-      QTextStream queryStringAsStream{&queryString};
-      queryStringAsStream << junctionTable.tableName << " (" <<
-         GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << ", " <<
-         GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
-      if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
-         queryStringAsStream << ", " << GetJunctionTableDefinitionOrderByColumn(junctionTable);
-      }
       QString const thisPrimaryKeyBindName  = QString{":"} + *GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable);
       QString const otherPrimaryKeyBindName = QString{":"} + *GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
       QString const orderByBindName         = QString{":"} + *GetJunctionTableDefinitionOrderByColumn(junctionTable);
-      queryStringAsStream << ") VALUES (" << thisPrimaryKeyBindName << ", " << otherPrimaryKeyBindName;
-      if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
-         queryStringAsStream << ", " << orderByBindName;
-      }
-      queryStringAsStream << ");";
       qDebug() << Q_FUNC_INFO << "Using query string" << queryString;
 
-      //
-      // Note that, when we are using bind values, we do NOT want to call the
-      // BtSqlQuery::BtSqlQuery(const QString &, QSqlDatabase db) version of the BtSqlQuery constructor because that
-      // would result in the supplied query being executed immediately (ie before we've had a chance to bind
-      // parameters).
-      //
-      BtSqlQuery sqlQuery{connection};
-      sqlQuery.prepare(queryString);
-
       // Get the list of data to bind to it
       QVariant propertyValuesWrapper = object.property(*GetJunctionTableDefinitionPropertyName(junctionTable));
       if (!propertyValuesWrapper.isValid()) {
@@ -428,26 +460,37 @@ namespace {
          propertyValues = propertyValuesWrapper.value< QVector<int> >();
       }
 
-      // Now loop through and bind/run the insert query once for each item in the list
+      // Nothing to insert means we don't even need to get the query
+      if (propertyValues.isEmpty()) {
+         return true;
+      }
+
+      //
+      // Now loop through and bind/run the insert query once for each item in the list.
+      //
+      // Note that we get the query from the pool (see Database::preparedQuery) only after we've finished reading the
+      // property, as that is the point we know we're going to use it.
+      //
+      Database::PreparedQuery sqlQuery = database.preparedQuery(connection, queryString);
       int itemNumber = 1;
       qDebug() <<
          Q_FUNC_INFO << propertyValues.size() << "value(s) (in" << propertyValuesWrapper.typeName() <<
          ") for property" << GetJunctionTableDefinitionPropertyName(junctionTable) << "of" <<
          object.metaObject()->className() << "#" << primaryKey.toInt();
       for (int curValue : propertyValues) {
-         sqlQuery.bindValue(thisPrimaryKeyBindName, primaryKey);
-         sqlQuery.bindValue(otherPrimaryKeyBindName, curValue);
+         sqlQuery->bindValue(thisPrimaryKeyBindName, primaryKey);
+         sqlQuery->bindValue(otherPrimaryKeyBindName, curValue);
          if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
-            sqlQuery.bindValue(orderByBindName, itemNumber);
+            sqlQuery->bindValue(orderByBindName, itemNumber);
          }
          qDebug() <<
             Q_FUNC_INFO <<
             GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << " #" << primaryKey.toInt() << ":" <<
             GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable) << "N°" << itemNumber << " is #" << curValue;
 
-         if (!sqlQuery.exec()) {
+         if (!sqlQuery->exec()) {
             qCritical() <<
-               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery->lastError().text();
             return false;
          }
          ++itemNumber;
@@ -460,13 +503,17 @@ namespace {
     * \brief Delete rows relating to a particular object from a junction table
     *
     * \param junctionTable
+    * \param queryString  SQL from \c junctionTableDeleteSql() for \c junctionTable
     * \param primaryKey
+    * \param database
     * \param connection
     *
     * \return \c true if succeeded, \c false otherwise
     */
    bool deleteFromJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                          QString const & queryString,
                                           QVariant const & primaryKey,
+                                          Database const & database,
                                           QSqlDatabase & connection) {
 
       qDebug() <<
@@ -476,24 +523,16 @@ namespace {
       QString const thisPrimaryKeyBindName =
          QString{":"} + *GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable);
 
-      // Construct the DELETE query
-      QString queryString{"DELETE FROM "};
-      QTextStream queryStringAsStream{&queryString};
-      queryStringAsStream <<
-         junctionTable.tableName << " WHERE " << GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) <<
-         " = " << thisPrimaryKeyBindName << ";";
-
-      BtSqlQuery sqlQuery{connection};
-      sqlQuery.prepare(queryString);
+      Database::PreparedQuery sqlQuery = database.preparedQuery(connection, queryString);
 
       // Bind the primary key value
-      sqlQuery.bindValue(thisPrimaryKeyBindName, primaryKey);
-      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+      sqlQuery->bindValue(thisPrimaryKeyBindName, primaryKey);
+      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(*sqlQuery);
 
       // Run the query
-      if (!sqlQuery.exec()) {
+      if (!sqlQuery->exec()) {
          qCritical() <<
-            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery->lastError().text();
          return false;
       }
 
@@ -613,6 +652,41 @@ ObjectStore::TableDefinition::TableDefinition(char const * const tableName,
    return;
 }
 
+namespace {
+   /**
+    * \brief Property changes waiting to be written to the DB -- see \c ObjectStore::setWriteBehind().  There is one
+    *        queue for all object stores so that flushing it needs only one DB transaction.
+    *
+    *        Changes are only queued on the main thread (as the timer needs its event loop), but the queue can be
+    *        flushed from any thread -- eg a worker thread writing straight through to the DB has to flush first so it
+    *        doesn't overtake changes queued earlier.  Hence the mutex, which is held for the whole of a flush so that
+    *        two flushes can't interleave their writes.
+    */
+   struct WriteBehindQueue {
+      QMutex mutex;
+
+      struct PendingWrite {
+         ObjectStore * objectStore;
+         //! We hold the object so it can't go away before it's written (eg if it is soft-deleted in the meantime)
+         std::shared_ptr<QObject> object;
+         //! In the order they were first changed, without duplicates
+         QVector<BtStringConst const *> propertyNames;
+      };
+
+      bool enabled = false;
+      int flushDelay_ms = 500;
+      //! Created on first use, and owned by the application object -- hence QPointer
+      QPointer<QTimer> timer = nullptr;
+      //! In the order they were first queued
+      QVector<PendingWrite> pendingWrites;
+      //! (Object store, object ID) -> index in pendingWrites, so we can coalesce multiple changes to the same object
+      QHash<std::pair<ObjectStore const *, int>, qsizetype> pendingWriteIndexes;
+      //! So we only tell the user once when flushes start failing, rather than every time we retry
+      bool lastFlushFailed = false;
+   };
+   WriteBehindQueue writeBehindQueue;
+}
+
 // This private implementation class holds all private non-virtual members of ObjectStore
 class ObjectStore::impl {
 public:
@@ -620,16 +694,42 @@ public:
    /**
     * Constructor
     */
-   impl(char const *             const   className,
-        TypeLookup               const & typeLookup,
-        TableDefinition          const & primaryTable,
-        JunctionTableDefinitions const & junctionTables) : m_className{className},
-                                                           m_state{ObjectStore::State::NotYetInitialised},
-                                                           typeLookup{typeLookup},
-                                                           primaryTable{primaryTable},
-                                                           junctionTables{junctionTables},
-                                                           allObjects{},
-                                                           database{nullptr} {
+   impl(char const *              const   className,
+        TypeLookup                const & typeLookup,
+        TableDefinition           const & primaryTable,
+        JunctionTableDefinitions  const & junctionTables,
+        SecondaryIndexDefinitions const & secondaryIndexDefinitions) : m_className{className},
+                                                                       m_state{ObjectStore::State::NotYetInitialised},
+                                                                       typeLookup{typeLookup},
+                                                                       primaryTable{primaryTable},
+                                                                       junctionTables{junctionTables},
+                                                                       allObjects{},
+                                                                       secondaryIndexes{},
+                                                                       hasNameIndex{false},
+                                                                       nameIndex{},
+                                                                       database{nullptr} {
+      for (BtStringConst const * propertyName : secondaryIndexDefinitions) {
+         // It's a coding error if we're asked to index something that isn't an int field in the primary table
+         auto fieldDefn = std::find_if(
+            this->primaryTable.tableFields.begin(),
+            this->primaryTable.tableFields.end(),
+            [propertyName](TableField const & fd) {return fd.propertyName == *propertyName;}
+         );
+         if (fieldDefn == this->primaryTable.tableFields.end() || fieldDefn->fieldType != ObjectStore::FieldType::Int) {
+            qCritical() <<
+               Q_FUNC_INFO << "Cannot index" << *propertyName << "as it is not an int field in" <<
+               this->primaryTable.tableName;
+            Q_ASSERT(false);
+            continue;
+         }
+         this->secondaryIndexes.append(SecondaryIndex{propertyName, {}, {}});
+      }
+
+      this->hasNameIndex = std::any_of(
+         this->primaryTable.tableFields.begin(),
+         this->primaryTable.tableFields.end(),
+         [](TableField const & fd) {return fd.propertyName == PropertyNames::NamedEntity::name;}
+      );
       return;
    }
 
@@ -1036,23 +1136,16 @@ public:
 
       if (matchingFieldDefn != this->primaryTable.tableFields.end()) {
          //
-         // We're updating a simple property
-         //
-         // Construct the SQL, which will be of the form
-         //
-         //    UPDATE tablename
-         //    SET columnName = :columnName
-         //    WHERE primaryKeyColumn = :primaryKeyColumn;
+         // We're updating a simple property, so we just need the relevant cached UPDATE statement -- see
+         // constructSql().
          //
-         QString queryString{"UPDATE "};
-         QTextStream queryStringAsStream{&queryString};
-         queryStringAsStream << this->primaryTable.tableName << " SET ";
+         auto const & fieldDefn = matchingFieldDefn;
+         QString const & queryString{
+            this->sql().updateColumn[std::distance(this->primaryTable.tableFields.begin(), matchingFieldDefn)]
+         };
 
          BtStringConst const & columnToUpdateInDb = matchingFieldDefn->columnName;
 
-         queryStringAsStream << " " << columnToUpdateInDb << " = :" << columnToUpdateInDb;
-         queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
-
          qDebug() <<
             Q_FUNC_INFO << "Updating" << object.metaObject()->className() << "property" << propertyName <<
             "with database query" << queryString;
@@ -1060,17 +1153,7 @@ public:
          //
          // Bind the values
          //
-         BtSqlQuery sqlQuery{connection};
-         sqlQuery.prepare(queryString);
          QVariant propertyBindValue{object.property(*propertyName)};
-         auto fieldDefn = std::find_if(
-            this->primaryTable.tableFields.begin(),
-            this->primaryTable.tableFields.end(),
-            [propertyName](TableField const & fd){return propertyName == fd.propertyName;}
-         );
-
-         // It's a coding error if we're trying to update a property that's not in the field definitions
-         Q_ASSERT(fieldDefn != this->primaryTable.tableFields.end());
 
          // Fix-up the QVariant if needed, including converting enums to strings
          this->unwrapAndMapAsNeeded(this->primaryTable, *fieldDefn, propertyBindValue);
@@ -1091,16 +1174,17 @@ public:
                propertyBindValue = QVariant{QMetaType{QMetaType::Int}};
             }
          }
-         sqlQuery.bindValue(QString{":%1"}.arg(*columnToUpdateInDb), propertyBindValue);
-         sqlQuery.bindValue(QString{":%1"}.arg(*primaryKeyColumn), primaryKey);
-         qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+         Database::PreparedQuery sqlQuery = this->database->preparedQuery(connection, queryString);
+         sqlQuery->bindValue(QString{":%1"}.arg(*columnToUpdateInDb), propertyBindValue);
+         sqlQuery->bindValue(QString{":%1"}.arg(*primaryKeyColumn), primaryKey);
+         qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(*sqlQuery);
 
          //
          // Run the query
          //
-         if (!sqlQuery.exec()) {
+         if (!sqlQuery->exec()) {
             qCritical() <<
-               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery->lastError().text();
             return false;
          }
       } else {
@@ -1123,19 +1207,15 @@ public:
                propertyName << "in either" << this->primaryTable.tableName << "or any associated table";
             qCritical().noquote() << Q_FUNC_INFO << Logging::getStackTrace();
             Q_ASSERT(false);
+            return false;
          }
 
-         //
-         // As elsewhere, the simplest way to update a junction table is to blat any rows relating to the current object
-         // and then write out data based on the current property values.
-         //
          qDebug() <<
             Q_FUNC_INFO << "Updating" << object.metaObject()->className() << "property" << propertyName <<
             "in junction table" << matchingJunctionTableDefinitionDefn->tableName;
-         if (!deleteFromJunctionTableDefinition(*matchingJunctionTableDefinitionDefn, primaryKey, connection)) {
-            return false;
-         }
-         if (!insertIntoJunctionTableDefinition(*matchingJunctionTableDefinitionDefn, object, primaryKey, connection)) {
+         if (!this->rewriteJunctionTable(
+            std::distance(this->junctionTables.begin(), matchingJunctionTableDefinitionDefn), object, primaryKey, connection
+         )) {
             return false;
          }
       }
@@ -1149,6 +1229,7 @@ public:
     *
     *        NB: Caller is responsible for handling transactions
     *
+    * \param database Normally \c this->database, but different if we are writing existing objects to a new database
     * \param connection
     * \param object
     * \param writePrimaryKey Normally this is \c false, meaning we are going to let the DB assign a primary key to the
@@ -1162,23 +1243,16 @@ public:
     *         \c writePrimaryKey is \c false (ie we are inserting a new object), it is the \b caller's responsibility to
     *         update the object with its new primary key.
     */
-   int insertObjectInDb(QSqlDatabase & connection, QObject const & object, bool writePrimaryKey) {
-      //
-      // Construct the SQL, which will be of the form
+   int insertObjectInDb(Database const & database,
+                        QSqlDatabase & connection,
+                        QObject const & object,
+                        bool writePrimaryKey) {
       //
-      //    INSERT INTO tablename (firstColumn, secondColumn, ...)
-      //    VALUES (:firstColumn, :secondColumn, ...);
+      // Unless we're writing to a new DB, we omit the primary key column because we can't know its value in advance.
+      // We'll find out what value the DB assigned to it after the query was run -- see below.
       //
-      // We omit the primary key column because we can't know its value in advance.  We'll find out what value the DB
-      // assigned to it after the query was run -- see below.
-      //
-      QString queryString{"INSERT INTO "};
-      QTextStream queryStringAsStream{&queryString};
-      queryStringAsStream << this->primaryTable.tableName << " (";
-      this->appendColumNames(queryStringAsStream, writePrimaryKey, false);
-      queryStringAsStream << ") VALUES (";
-      this->appendColumNames(queryStringAsStream, writePrimaryKey, true);
-      queryStringAsStream << ");";
+      CachedSql const & cachedSql = this->sql();
+      QString const & queryString{writePrimaryKey ? cachedSql.insertWithPrimaryKey : cachedSql.insert};
 
       qDebug() <<
          Q_FUNC_INFO << "Inserting" << object.metaObject()->className() << "main table row with database query " <<
@@ -1189,8 +1263,7 @@ public:
       //
       // Bind the values
       //
-      BtSqlQuery sqlQuery{connection};
-      sqlQuery.prepare(queryString);
+      Database::PreparedQuery sqlQuery = database.preparedQuery(connection, queryString);
       for (int ii = (writePrimaryKey ? 0 : 1); ii < this->primaryTable.tableFields.size(); ++ii) {
          auto const & fieldDefn = this->primaryTable.tableFields[ii];
 
@@ -1206,17 +1279,17 @@ public:
             bindValue = QVariant();
          }
 
-         sqlQuery.bindValue(QString{":"} + *fieldDefn.columnName, bindValue);
+         sqlQuery->bindValue(QString{":"} + *fieldDefn.columnName, bindValue);
       }
 
-      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(*sqlQuery);
 
       //
       // Run the query
       //
-      if (!sqlQuery.exec()) {
+      if (!sqlQuery->exec()) {
          qCritical() <<
-            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery->lastError().text();
          return -1;
       }
 
@@ -1247,8 +1320,8 @@ public:
          // Note too that we have to explicitly put the primary key into an int, because, by default it might come back
          // as long long int rather than int (ie 64-bits rather than 32-bits in the C++ implementations we care about).
          //
-         Q_ASSERT(sqlQuery.driver()->hasFeature(QSqlDriver::LastInsertId));
-         QVariant rawPrimaryKey = sqlQuery.lastInsertId();
+         Q_ASSERT(sqlQuery->driver()->hasFeature(QSqlDriver::LastInsertId));
+         QVariant rawPrimaryKey = sqlQuery->lastInsertId();
          Q_ASSERT(rawPrimaryKey.canConvert<int>());
          primaryKeyInDb = rawPrimaryKey.toInt();
 
@@ -1276,8 +1349,13 @@ public:
       //
       // Now save data to the junction tables
       //
-      for (auto const & junctionTable : this->junctionTables) {
-         if (!insertIntoJunctionTableDefinition(junctionTable, object, primaryKeyInDb, connection)) {
+      for (qsizetype ii = 0; ii < this->junctionTables.size(); ++ii) {
+         if (!insertIntoJunctionTableDefinition(this->junctionTables[ii],
+                                                cachedSql.junctionInsert[ii],
+                                                object,
+                                                primaryKeyInDb,
+                                                database,
+                                                connection)) {
             qCritical() <<
                Q_FUNC_INFO << "Error writing to junction tables:" << connection.lastError().text();
             return -1;
@@ -1287,125 +1365,532 @@ public:
       return primaryKeyInDb;
    }
 
-   char const * const m_className;
-   ObjectStore::State m_state;
-   TypeLookup const & typeLookup;
-   TableDefinition const & primaryTable;
-   JunctionTableDefinitions const & junctionTables;
-   QHash<int, std::shared_ptr<QObject> > allObjects;
-   Database * database;
-};
+   /**
+    * \brief In-memory secondary index on one (integer) property -- see \c ObjectStore::SecondaryIndexDefinitions
+    */
+   struct SecondaryIndex {
+      BtStringConst const * propertyName;
+      //! Property value -> IDs of all the objects with that value
+      QHash<int, QSet<int> > valueToIds;
+      //! Object ID -> property value under which we indexed it, so we can find the old entry when the value changes
+      QHash<int, int> idToValue;
+   };
 
-QString ObjectStore::getDisplayName(ObjectStore::FieldType const fieldType) {
-   switch (fieldType) {
-      case ObjectStore::FieldType::Bool  : return "ObjectStore::FieldType::Bool"  ;
-      case ObjectStore::FieldType::Int   : return "ObjectStore::FieldType::Int"   ;
-      case ObjectStore::FieldType::UInt  : return "ObjectStore::FieldType::UInt"  ;
-      case ObjectStore::FieldType::Double: return "ObjectStore::FieldType::Double";
-      case ObjectStore::FieldType::String: return "ObjectStore::FieldType::String";
-      case ObjectStore::FieldType::Date  : return "ObjectStore::FieldType::Date"  ;
-      case ObjectStore::FieldType::Enum  : return "ObjectStore::FieldType::Enum"  ;
-      case ObjectStore::FieldType::Unit  : return "ObjectStore::FieldType::Unit"  ;
-      // In C++23, we'd add:
-      // default: std::unreachable();
+   /**
+    * \return The secondary index for the specified property, or \c nullptr if there isn't one
+    */
+   SecondaryIndex const * findSecondaryIndex(BtStringConst const & propertyName) const {
+      for (auto const & index : this->secondaryIndexes) {
+         if (*index.propertyName == propertyName) {
+            return &index;
+         }
+      }
+      return nullptr;
    }
-   // In C++23, we'd add:
-   // std::unreachable()
-   // It's a coding error if we get here
-   Q_ASSERT(false);
-}
 
-ObjectStore::ObjectStore(char const *             const   className,
-                         TypeLookup               const & typeLookup,
-                         TableDefinition          const & primaryTable,
-                         JunctionTableDefinitions const & junctionTables) :
-   pimpl{ std::make_unique<impl>(className, typeLookup, primaryTable, junctionTables) } {
-   qDebug() << Q_FUNC_INFO << "Construct of object store for primary table" << this->pimpl->primaryTable.tableName;
-   // We have seen a circumstance where primaryTable.tableName is null, which shouldn't be possible.  This is some
-   // diagnostic to try to find out why.
-   if (this->pimpl->primaryTable.tableName.isNull()) {
-      qCritical().noquote() << Q_FUNC_INFO << "Primary table without name.  Call stack is:" << Logging::getStackTrace();
+   /**
+    * \brief Remove the entry (if any) for the object with the specified ID from one secondary index
+    */
+   static void removeIndexEntry(SecondaryIndex & index, int const id) {
+      auto oldValue = index.idToValue.find(id);
+      if (oldValue == index.idToValue.end()) {
+         return;
+      }
+      auto ids = index.valueToIds.find(*oldValue);
+      if (ids != index.valueToIds.end()) {
+         ids->remove(id);
+         if (ids->isEmpty()) {
+            index.valueToIds.erase(ids);
+         }
+      }
+      index.idToValue.erase(oldValue);
+      return;
    }
-   return;
-}
 
-// See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
-// header file)
-ObjectStore::~ObjectStore() {
-   // Normally we try to avoid logging things here, as it's possible that the objects used in Logging.cpp have already
-   // been destroyed, but it can be useful to turn this on when debugging ObjectStore problems.
-   //qDebug() <<
-   //   Q_FUNC_INFO << "Destruct of object store for primary table" << this->pimpl->primaryTable.tableName <<
-   //   "(containing" << this->pimpl->allObjects.size() << "objects)";
-   return;
-}
+   /**
+    * \brief Add or update the entry for the supplied object in one secondary index
+    */
+   static void setIndexEntry(SecondaryIndex & index, int const id, QObject const & object) {
+      int const value = object.property(**index.propertyName).toInt();
+      auto oldValue = index.idToValue.constFind(id);
+      if (oldValue != index.idToValue.cend()) {
+         if (*oldValue == value) {
+            // Nothing has changed, so nothing to do
+            return;
+         }
+         removeIndexEntry(index, id);
+      }
+      index.valueToIds[value].insert(id);
+      index.idToValue.insert(id, value);
+      return;
+   }
 
-ObjectStore::State ObjectStore::state() const {
-   return this->pimpl->m_state;
-}
+   /**
+    * \brief Add or update the entries for the supplied object in all secondary indexes.  Called whenever an object is
+    *        added to \c allObjects or (potentially) has several of its properties changed at once.
+    */
+   void indexObject(int const id, QObject const & object) {
+      for (auto & index : this->secondaryIndexes) {
+         setIndexEntry(index, id, object);
+      }
+      this->setNameIndexEntry(id, object);
+      return;
+   }
 
-void ObjectStore::logDiagnostics() const {
-   for (int key : this->pimpl->allObjects.keys()) {
-      std::shared_ptr<QObject> object = this->pimpl->allObjects.value(key);
-      qDebug() <<
-         Q_FUNC_INFO << "Object @" << static_cast<void *>(object.get()) << "stored as #" << key << "has key" <<
-         this->pimpl->getPrimaryKey(*object) << "and shared pointer use count" << object.use_count();
+   /**
+    * \brief Update the entry for the supplied object in the secondary index for \c propertyName, if there is one.
+    *        Called whenever a single property of a stored object changes.
+    */
+   void reindexProperty(int const id, QObject const & object, BtStringConst const & propertyName) {
+      for (auto & index : this->secondaryIndexes) {
+         if (*index.propertyName == propertyName) {
+            setIndexEntry(index, id, object);
+         }
+      }
+      if (propertyName == PropertyNames::NamedEntity::name) {
+         this->setNameIndexEntry(id, object);
+      }
+      return;
    }
-   return;
-}
 
-// Note that we have to pass Database in as a parameter because, ultimately, we're being called from Database::load()
-// which is called from Database::getInstance(), so we don't want to get in an endless loop.
-bool ObjectStore::createTables(Database & database, QSqlDatabase & connection) const {
-   //
-   // Note that we are not putting in foreign key constraints here, as we don't want to have to care about the order in
-   // which tables are created.  The constraints are added subsequently by calls to addTableConstraints();
-   //
-   // Note too, that we don't care about default values as we assume we will always provide values for all columns when
-   // we do an insert.  (Suitable default values for object fields are set in the object's constructor.)
-   //
-   if (!createTableWithoutForeignKeys(database, connection, this->pimpl->primaryTable)) {
-      return false;
+   /**
+    * \brief Remove the object with the specified ID from all secondary indexes.  Called whenever an object is removed
+    *        from \c allObjects.
+    */
+   void unindexObject(int const id) {
+      for (auto & index : this->secondaryIndexes) {
+         removeIndexEntry(index, id);
+      }
+      this->removeNameIndexEntry(id);
+      return;
    }
 
    //
-   // Now create the junction tables
+   // For stores whose primary table has a name column (which is pretty much all of them), we also index objects by
+   // name, so that, when we are importing from BeerJSON or BeerXML, we can check for duplicates and name clashes
+   // without comparing every record read in against every object in the store.  See findAllByName() and
+   // findAllPossibleDuplicates().
    //
-   for (auto const & junctionTable : this->pimpl->junctionTables) {
-      if (!createTableWithoutForeignKeys(database, connection, junctionTable)) {
-         return false;
+   // We keep two indexes: one on the exact name and one on the name with any duplicate number (eg the " (1)" in
+   // "Tettnang (1)") stripped off -- because NamedEntity::operator== ignores such numbers, the latter is what we
+   // need to find candidate duplicates.  (We can't usefully hash the rest of an object's contents as
+   // NamedEntity::isEqualTo() does approximate comparison of floating point values, so checking the candidates
+   // still requires a call to operator==.)
+   //
+   struct NameIndex {
+      //! Name -> IDs of all objects with that name
+      QHash<QString, QSet<int> > nameToIds;
+      //! Name with duplicate number stripped -> IDs of all objects with that stripped name
+      QHash<QString, QSet<int> > baseNameToIds;
+      //! Object ID -> name under which we indexed it, so we can find the old entries when the name changes
+      QHash<int, QString> idToName;
+   };
+
+   static void removeIdFromNameBucket(QHash<QString, QSet<int> > & nameToIds, QString const & name, int const id) {
+      auto ids = nameToIds.find(name);
+      if (ids != nameToIds.end()) {
+         ids->remove(id);
+         if (ids->isEmpty()) {
+            nameToIds.erase(ids);
+         }
       }
+      return;
    }
 
-   return true;
-}
-
-// Note that we have to pass Database in as a parameter because, ultimately, we're being called from Database::load()
-// which is called from Database::getInstance(), so we don't want to get in an endless loop.
-bool ObjectStore::addTableConstraints(Database & database, QSqlDatabase & connection) const {
-   // This is all pretty much the same structure as createTables(), so I won't repeat all the comments here
-
-   if (!addForeignKeysToTable(database, connection, this->pimpl->primaryTable)) {
-      return false;
+   void removeNameIndexEntry(int const id) {
+      if (!this->hasNameIndex) {
+         return;
+      }
+      auto oldName = this->nameIndex.idToName.find(id);
+      if (oldName == this->nameIndex.idToName.end()) {
+         return;
+      }
+      removeIdFromNameBucket(this->nameIndex.nameToIds, *oldName, id);
+      removeIdFromNameBucket(this->nameIndex.baseNameToIds, NamedEntity::nameWithoutDuplicateNumber(*oldName), id);
+      this->nameIndex.idToName.erase(oldName);
+      return;
    }
 
-   for (auto const & junctionTable : this->pimpl->junctionTables) {
-      if (!addForeignKeysToTable(database, connection, junctionTable)) {
-         return false;
+   void setNameIndexEntry(int const id, QObject const & object) {
+      if (!this->hasNameIndex) {
+         return;
+      }
+      QString const name = object.property(*PropertyNames::NamedEntity::name).toString();
+      auto oldName = this->nameIndex.idToName.constFind(id);
+      if (oldName != this->nameIndex.idToName.cend()) {
+         if (*oldName == name) {
+            return;
+         }
+         this->removeNameIndexEntry(id);
       }
+      this->nameIndex.nameToIds[name].insert(id);
+      this->nameIndex.baseNameToIds[NamedEntity::nameWithoutDuplicateNumber(name)].insert(id);
+      this->nameIndex.idToName.insert(id, name);
+      return;
    }
 
-   return true;
-}
+   /**
+    * \brief Look up the supplied key in one of the name indexes, or, if we don't have name indexes, fall back to a
+    *        linear search using \c nameMatches.
+    */
+   QList<std::shared_ptr<QObject> > findAllInNameIndex(QHash<QString, QSet<int> > const & nameToIds,
+                                                       QString const & key,
+                                                       std::function<bool(QString const &)> const & nameMatches) const {
+      QList<std::shared_ptr<QObject> > results;
+      if (!this->hasNameIndex) {
+         for (auto const & object : this->allObjects) {
+            if (nameMatches(object->property(*PropertyNames::NamedEntity::name).toString())) {
+               results.append(object);
+            }
+         }
+         return results;
+      }
 
-void ObjectStore::loadAll(Database * database) {
-   // Assume we failed until we succeed!  (This saves us having to remember to set the error state in every error
-   // branch.  Instead, we just have to set the all OK state at the end of this function.)
-   this->pimpl->m_state = ObjectStore::State::ErrorInitialising;
+      auto ids = nameToIds.constFind(key);
+      if (ids != nameToIds.cend()) {
+         results.reserve(ids->size());
+         for (int const id : *ids) {
+            // It's a coding error if the index has got out of step with the cache
+            Q_ASSERT(this->allObjects.contains(id));
+            results.append(this->allObjects.value(id));
+         }
+      }
+      return results;
+   }
 
-   if (database) {
-      this->pimpl->database = database;
-   } else {
+   char const * const m_className;
+   ObjectStore::State m_state;
+   TypeLookup const & typeLookup;
+   TableDefinition const & primaryTable;
+   JunctionTableDefinitions const & junctionTables;
+   QHash<int, std::shared_ptr<QObject> > allObjects;
+   QVector<SecondaryIndex> secondaryIndexes;
+   bool hasNameIndex;
+   NameIndex nameIndex;
+   Database * database;
+
+   /**
+    * \brief What \c ObjectStore::fetchAll() read from the DB, for \c ObjectStore::loadAll() to turn into objects
+    */
+   struct FetchedData {
+      //! Primary key and constructor parameters for each row of the primary table
+      QVector<std::pair<int, NamedParameterBundle>> rows;
+      //! For each junction table (in the same order as junctionTables), each "this" key with its list of "other" keys
+      QVector<QVector<std::pair<int, QVector<int>>>> junctionRows;
+   };
+   std::optional<FetchedData> fetchedData;
+
+   /**
+    * \brief If write-behind is enabled and we are on the main thread, add the supplied property change to the
+    *        write-behind queue (see \c ObjectStore::setWriteBehind()).
+    *
+    * \return \c true if the change was queued, \c false if the caller needs to write it to the DB now
+    */
+   bool queueWriteBehind(ObjectStore & objectStore, int const id, BtStringConst const & propertyName) {
+      auto const * application = QCoreApplication::instance();
+      if (!application || QThread::currentThread() != application->thread()) {
+         return false;
+      }
+
+      QMutexLocker locker(&writeBehindQueue.mutex);
+      if (!writeBehindQueue.enabled) {
+         return false;
+      }
+
+      // We need the shared pointer to the object to hold in the queue.  If, for whatever reason, it's not in our
+      // cache, then just write it now.
+      auto object = this->allObjects.value(id);
+      if (!object) {
+         return false;
+      }
+
+      auto const key = std::make_pair(static_cast<ObjectStore const *>(&objectStore), id);
+      if (!writeBehindQueue.pendingWriteIndexes.contains(key)) {
+         writeBehindQueue.pendingWriteIndexes.insert(key, writeBehindQueue.pendingWrites.size());
+         writeBehindQueue.pendingWrites.append(WriteBehindQueue::PendingWrite{&objectStore, object, {}});
+      }
+      auto & propertyNames = writeBehindQueue.pendingWrites[writeBehindQueue.pendingWriteIndexes.value(key)].propertyNames;
+      if (std::none_of(propertyNames.cbegin(),
+                       propertyNames.cend(),
+                       [&propertyName](BtStringConst const * pn) { return *pn == propertyName; })) {
+         propertyNames.append(&propertyName);
+      }
+
+      if (!writeBehindQueue.timer) {
+         QTimer * timer = new QTimer(QCoreApplication::instance());
+         timer->setSingleShot(true);
+         QObject::connect(timer, &QTimer::timeout, timer, []() {
+            ObjectStore::flush();
+            return;
+         });
+         writeBehindQueue.timer = timer;
+      }
+      // We don't restart the timer if it's already running, so changes are never queued for much longer than the
+      // flush delay, however many there are.
+      if (!writeBehindQueue.timer->isActive()) {
+         writeBehindQueue.timer->start(writeBehindQueue.flushDelay_ms);
+      }
+      return true;
+   }
+
+   //
+   // The SQL for the INSERT, UPDATE and DELETE statements we run over and over again only depends on the table
+   // definitions, so we construct it once, the first time it's needed -- see sql().  (We don't do it in the constructor
+   // as we have seen circumstances, at least at start-up, where the table definitions are not yet fully initialised at
+   // that point.)  The prepared statements themselves are pooled by Database -- see Database::preparedQuery().
+   //
+   struct CachedSql {
+      //! INSERT of all columns except the primary key
+      QString insert;
+      //! INSERT of all columns including the primary key -- used when writing to a new DB
+      QString insertWithPrimaryKey;
+      //! UPDATE of all columns
+      QString update;
+      //! DELETE of one row by primary key
+      QString hardDelete;
+      //! UPDATE of one column, in the same order as primaryTable.tableFields
+      QVector<QString> updateColumn;
+      //! Insert of one row into a junction table, in the same order as junctionTables
+      QVector<QString> junctionInsert;
+      //! Delete of all rows for one object from a junction table, in the same order as junctionTables
+      QVector<QString> junctionDelete;
+   };
+   std::once_flag cachedSqlInitOnceFlag;
+   CachedSql cachedSql;
+
+   /**
+    * \brief Construct all the SQL in \c cachedSql.  Should only be called (once) from \c sql().
+    */
+   void constructSql() {
+      {
+         //
+         //    INSERT INTO tablename (firstColumn, secondColumn, ...)
+         //    VALUES (:firstColumn, :secondColumn, ...);
+         //
+         for (bool const writePrimaryKey : {false, true}) {
+            QString queryString{"INSERT INTO "};
+            QTextStream queryStringAsStream{&queryString};
+            queryStringAsStream << this->primaryTable.tableName << " (";
+            this->appendColumNames(queryStringAsStream, writePrimaryKey, false);
+            queryStringAsStream << ") VALUES (";
+            this->appendColumNames(queryStringAsStream, writePrimaryKey, true);
+            queryStringAsStream << ");";
+            (writePrimaryKey ? this->cachedSql.insertWithPrimaryKey : this->cachedSql.insert) = queryString;
+         }
+      }
+
+      BtStringConst const & primaryKeyColumn {this->getPrimaryKeyColumn()};
+      {
+         //
+         //    UPDATE tablename
+         //    SET firstColumn = :firstColumn, secondColumn = :secondColumn, ...
+         //    WHERE primaryKeyColumn = :primaryKeyColumn;
+         //
+         QString queryString{"UPDATE "};
+         QTextStream queryStringAsStream{&queryString};
+         queryStringAsStream << this->primaryTable.tableName << " SET ";
+         bool skippedPrimaryKey = false;
+         bool firstFieldOutput = false;
+         for (auto const & fieldDefn: this->primaryTable.tableFields) {
+            if (!skippedPrimaryKey) {
+               skippedPrimaryKey = true;
+            } else {
+               if (!firstFieldOutput) {
+                  firstFieldOutput = true;
+               } else {
+                  queryStringAsStream << ", ";
+               }
+               queryStringAsStream << " " << fieldDefn.columnName << " = :" << fieldDefn.columnName;
+            }
+         }
+         queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+         this->cachedSql.update = queryString;
+      }
+
+      {
+         //
+         //    DELETE FROM tablename
+         //    WHERE primaryKeyColumn = :primaryKeyColumn;
+         //
+         QString queryString{"DELETE FROM "};
+         QTextStream queryStringAsStream{&queryString};
+         queryStringAsStream <<
+            this->primaryTable.tableName << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+         this->cachedSql.hardDelete = queryString;
+      }
+
+      //
+      //    UPDATE tablename
+      //    SET columnName = :columnName
+      //    WHERE primaryKeyColumn = :primaryKeyColumn;
+      //
+      this->cachedSql.updateColumn.reserve(this->primaryTable.tableFields.size());
+      for (auto const & fieldDefn: this->primaryTable.tableFields) {
+         QString queryString{"UPDATE "};
+         QTextStream queryStringAsStream{&queryString};
+         queryStringAsStream <<
+            this->primaryTable.tableName << " SET " << fieldDefn.columnName << " = :" << fieldDefn.columnName <<
+            " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+         this->cachedSql.updateColumn.append(queryString);
+      }
+
+      this->cachedSql.junctionInsert.reserve(this->junctionTables.size());
+      this->cachedSql.junctionDelete.reserve(this->junctionTables.size());
+      for (auto const & junctionTable : this->junctionTables) {
+         this->cachedSql.junctionInsert.append(junctionTableInsertSql(junctionTable));
+         this->cachedSql.junctionDelete.append(junctionTableDeleteSql(junctionTable));
+      }
+      return;
+   }
+
+   /**
+    * \brief Get the cached SQL, constructing it if necessary.  Thread-safe.
+    */
+   CachedSql const & sql() {
+      std::call_once(this->cachedSqlInitOnceFlag, &ObjectStore::impl::constructSql, this);
+      return this->cachedSql;
+   }
+
+   /**
+    * \brief Write the data for all junction-table properties of an object, replacing any previously stored
+    *
+    *        As elsewhere, the simplest way to update a junction table is to blat any rows relating to the current
+    *        object and then write out data based on the current property values.  This may often mean we're deleting
+    *        rows and rewriting them but, for the small quantity of data we're talking about, it doesn't seem worth the
+    *        complexity of optimising (eg read what's in the DB, compare with what's in the object property, work out
+    *        what deletes, inserts and updates are needed to sync them, etc.
+    *
+    * \param junctionTableIndex index in \c junctionTables
+    */
+   bool rewriteJunctionTable(qsizetype const junctionTableIndex,
+                             QObject const & object,
+                             QVariant const & primaryKey,
+                             QSqlDatabase & connection) {
+      auto const & junctionTable = this->junctionTables[junctionTableIndex];
+      CachedSql const & cachedSql = this->sql();
+      if (!deleteFromJunctionTableDefinition(junctionTable,
+                                             cachedSql.junctionDelete[junctionTableIndex],
+                                             primaryKey,
+                                             *this->database,
+                                             connection)) {
+         return false;
+      }
+      return insertIntoJunctionTableDefinition(junctionTable,
+                                               cachedSql.junctionInsert[junctionTableIndex],
+                                               object,
+                                               primaryKey,
+                                               *this->database,
+                                               connection);
+   }
+};
+
+QString ObjectStore::getDisplayName(ObjectStore::FieldType const fieldType) {
+   switch (fieldType) {
+      case ObjectStore::FieldType::Bool  : return "ObjectStore::FieldType::Bool"  ;
+      case ObjectStore::FieldType::Int   : return "ObjectStore::FieldType::Int"   ;
+      case ObjectStore::FieldType::UInt  : return "ObjectStore::FieldType::UInt"  ;
+      case ObjectStore::FieldType::Double: return "ObjectStore::FieldType::Double";
+      case ObjectStore::FieldType::String: return "ObjectStore::FieldType::String";
+      case ObjectStore::FieldType::Date  : return "ObjectStore::FieldType::Date"  ;
+      case ObjectStore::FieldType::Enum  : return "ObjectStore::FieldType::Enum"  ;
+      case ObjectStore::FieldType::Unit  : return "ObjectStore::FieldType::Unit"  ;
+      // In C++23, we'd add:
+      // default: std::unreachable();
+   }
+   // In C++23, we'd add:
+   // std::unreachable()
+   // It's a coding error if we get here
+   Q_ASSERT(false);
+}
+
+ObjectStore::ObjectStore(char const *              const   className,
+                         TypeLookup                const & typeLookup,
+                         TableDefinition           const & primaryTable,
+                         JunctionTableDefinitions  const & junctionTables,
+                         SecondaryIndexDefinitions const & secondaryIndexes) :
+   pimpl{ std::make_unique<impl>(className, typeLookup, primaryTable, junctionTables, secondaryIndexes) } {
+   qDebug() << Q_FUNC_INFO << "Construct of object store for primary table" << this->pimpl->primaryTable.tableName;
+   // We have seen a circumstance where primaryTable.tableName is null, which shouldn't be possible.  This is some
+   // diagnostic to try to find out why.
+   if (this->pimpl->primaryTable.tableName.isNull()) {
+      qCritical().noquote() << Q_FUNC_INFO << "Primary table without name.  Call stack is:" << Logging::getStackTrace();
+   }
+   return;
+}
+
+// See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
+// header file)
+ObjectStore::~ObjectStore() {
+   // Normally we try to avoid logging things here, as it's possible that the objects used in Logging.cpp have already
+   // been destroyed, but it can be useful to turn this on when debugging ObjectStore problems.
+   //qDebug() <<
+   //   Q_FUNC_INFO << "Destruct of object store for primary table" << this->pimpl->primaryTable.tableName <<
+   //   "(containing" << this->pimpl->allObjects.size() << "objects)";
+   return;
+}
+
+ObjectStore::State ObjectStore::state() const {
+   return this->pimpl->m_state;
+}
+
+void ObjectStore::logDiagnostics() const {
+   for (int key : this->pimpl->allObjects.keys()) {
+      std::shared_ptr<QObject> object = this->pimpl->allObjects.value(key);
+      qDebug() <<
+         Q_FUNC_INFO << "Object @" << static_cast<void *>(object.get()) << "stored as #" << key << "has key" <<
+         this->pimpl->getPrimaryKey(*object) << "and shared pointer use count" << object.use_count();
+   }
+   return;
+}
+
+// Note that we have to pass Database in as a parameter because, ultimately, we're being called from Database::load()
+// which is called from Database::getInstance(), so we don't want to get in an endless loop.
+bool ObjectStore::createTables(Database & database, QSqlDatabase & connection) const {
+   //
+   // Note that we are not putting in foreign key constraints here, as we don't want to have to care about the order in
+   // which tables are created.  The constraints are added subsequently by calls to addTableConstraints();
+   //
+   // Note too, that we don't care about default values as we assume we will always provide values for all columns when
+   // we do an insert.  (Suitable default values for object fields are set in the object's constructor.)
+   //
+   if (!createTableWithoutForeignKeys(database, connection, this->pimpl->primaryTable)) {
+      return false;
+   }
+
+   //
+   // Now create the junction tables
+   //
+   for (auto const & junctionTable : this->pimpl->junctionTables) {
+      if (!createTableWithoutForeignKeys(database, connection, junctionTable)) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+// Note that we have to pass Database in as a parameter because, ultimately, we're being called from Database::load()
+// which is called from Database::getInstance(), so we don't want to get in an endless loop.
+bool ObjectStore::addTableConstraints(Database & database, QSqlDatabase & connection) const {
+   // This is all pretty much the same structure as createTables(), so I won't repeat all the comments here
+
+   if (!addForeignKeysToTable(database, connection, this->pimpl->primaryTable)) {
+      return false;
+   }
+
+   for (auto const & junctionTable : this->pimpl->junctionTables) {
+      if (!addForeignKeysToTable(database, connection, junctionTable)) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool ObjectStore::fetchAll(Database * database) {
+   if (database) {
+      this->pimpl->database = database;
+   } else {
       this->pimpl->database = &Database::instance();
    }
 
@@ -1433,17 +1918,26 @@ void ObjectStore::loadAll(Database * database) {
    this->pimpl->appendColumNames(queryStringAsStream, true, false);
    queryStringAsStream << "\n FROM " << this->pimpl->primaryTable.tableName << ";";
    BtSqlQuery sqlQuery{connection};
+   // We only ever step forward through the results, so we can tell the driver not to cache them all
+   sqlQuery.setForwardOnly(true);
    sqlQuery.prepare(queryString);
    if (!sqlQuery.exec()) {
       qCritical() <<
          Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-      return;
+      return false;
    }
 
    qDebug() <<
       Q_FUNC_INFO << "Reading main table rows from" << this->pimpl->primaryTable.tableName <<
       "database table using query " << queryString;
 
+   // Not all drivers can tell us the number of rows in advance (eg SQLite can't), but, if we know, we can save some
+   // reallocating
+   impl::FetchedData fetchedData;
+   if (sqlQuery.size() > 0) {
+      fetchedData.rows.reserve(sqlQuery.size());
+   }
+
    while (sqlQuery.next()) {
       //
       // We want to pull all the fields for the current row from the database and use them to construct a new
@@ -1476,7 +1970,7 @@ void ObjectStore::loadAll(Database * database) {
       // object class to enforce mandatory construction parameters with this approach.
       //
       // Method (ii) is therefore our preferred approach.  We use NamedParameterBundle, which is a simple extension of
-      // QHash.
+      // QHash.  Here we just build the bundle; loadAll() does the constructing.
       //
       NamedParameterBundle namedParameterBundle;
       int primaryKey = -1;
@@ -1488,9 +1982,12 @@ void ObjectStore::loadAll(Database * database) {
       // NB: For now we're assuming that the primary key is always an integer, but it would not be enormous work to
       //     allow a wider range of types.
       //
+      // Since we listed the columns in the SELECT in the same order as tableFields, we can read them by index, which
+      // saves a name lookup for every field of every row.
       bool readPrimaryKey = false;
+      int columnIndex = 0;
       for (auto const & fieldDefn : this->pimpl->primaryTable.tableFields) {
-         QVariant fieldValue = sqlQuery.value(*fieldDefn.columnName);
+         QVariant fieldValue = sqlQuery.value(columnIndex++);
          //qDebug() <<
          //   Q_FUNC_INFO << "Reading col" << fieldDefn.columnName << "(=" << fieldValue << ") into property" <<
          //   fieldDefn.propertyName;
@@ -1519,34 +2016,33 @@ void ObjectStore::loadAll(Database * database) {
          }
       }
 
-      // Get a new object...
-      auto object = this->createNewObject(namedParameterBundle);
-
-      // ...and store it
-      // It's a coding error if we have two objects with the same primary key
-      Q_ASSERT(!this->pimpl->allObjects.contains(primaryKey));
-      this->pimpl->allObjects.insert(primaryKey, object);
-      // Normally leave this debug output commented, as it generates a lot of logging at start-up, but can be useful to
-      // enable for debugging.
-//      qDebug() <<
-//         Q_FUNC_INFO << "Cached" << object->metaObject()->className() << "#" << primaryKey << "in" <<
-//         this->metaObject()->className();
+      fetchedData.rows.append(std::make_pair(primaryKey, std::move(namedParameterBundle)));
    }
 
    qDebug() <<
-      Q_FUNC_INFO << "Read" << this->pimpl->allObjects.size() << "entries from primary table" <<
+      Q_FUNC_INFO << "Read" << fetchedData.rows.size() << "rows from primary table" <<
       this->pimpl->primaryTable.tableName;
 
    //
-   // Now we load the data from the junction tables.  This, pretty much by definition, isn't needed for the object's
+   // Now we read the data from the junction tables.  This, pretty much by definition, isn't needed for the object's
    // constructor, so we're OK to pull it out separately.  Otherwise we'd have to do a LEFT JOIN for each junction
    // table in the query above.  Since we're caching everything in memory, and we're not overly worried about
    // optimising every single SQL query (because the amount of data in the DB is not enormous), we prefer the
    // simplicity of separate queries.
    //
+   // Each junction table query is ordered by the ID of "this" object, so all the rows for one object come together,
+   // and we can gather each object's list of "other" IDs in one pass through the rows.
+   //
    for (auto const & junctionTable : this->pimpl->junctionTables) {
+      fetchedData.junctionRows.append(QVector<std::pair<int, QVector<int>>>{});
+
+      // If there are no objects then there's nothing to set.  (And any rows in the junction table would be orphans.)
+      if (fetchedData.rows.isEmpty()) {
+         continue;
+      }
+
       qDebug() <<
-         Q_FUNC_INFO << "Reading junction table " << junctionTable.tableName << " into " <<
+         Q_FUNC_INFO << "Reading junction table " << junctionTable.tableName << " for " <<
          GetJunctionTableDefinitionPropertyName(junctionTable);
 
       //
@@ -1566,112 +2062,126 @@ void ObjectStore::loadAll(Database * database) {
       }
       queryStringAsStream << ";";
 
-///      sqlQuery = BtSqlQuery{connection};
       sqlQuery.prepare(queryString);
       if (!sqlQuery.exec()) {
          qCritical() <<
             Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-         return;
+         return false;
       }
 
       qDebug() << Q_FUNC_INFO << "Reading junction table rows from database query " << queryString;
 
-      //
-      // The simplest way to process the data is first to build the ID-to-ordered-list-of-IDs map in memory, then loop
-      // through this to pass the data to the relevant objects.
-      //
-      int previousPrimaryKey = -1;
-      QMap< int, QVector<int> > thisToOtherKeys;
+      auto & junctionRows = fetchedData.junctionRows.last();
       while (sqlQuery.next()) {
-         int thisPrimaryKey = sqlQuery.value(*GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable)).toInt();
-         int otherPrimaryKey = sqlQuery.value(*GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable)).toInt();
-         // Usually keep the next line commented out otherwise it generates a lot of lines in the logs
-//         qDebug() << Q_FUNC_INFO << "Interim store of" << thisPrimaryKey << "<->" << otherPrimaryKey;
-
-         if (thisPrimaryKey != previousPrimaryKey) {
-            thisToOtherKeys.insert(thisPrimaryKey, QVector<int>{});
-            previousPrimaryKey = thisPrimaryKey;
+         int const thisPrimaryKey  = sqlQuery.value(0).toInt();
+         int const otherPrimaryKey = sqlQuery.value(1).toInt();
+         if (junctionRows.isEmpty() || junctionRows.last().first != thisPrimaryKey) {
+            junctionRows.append(std::make_pair(thisPrimaryKey, QVector<int>{}));
          }
-         Q_ASSERT(thisToOtherKeys.contains(thisPrimaryKey));
-         thisToOtherKeys[thisPrimaryKey].append(otherPrimaryKey);
+         junctionRows.last().second.append(otherPrimaryKey);
+      }
+   }
+
+   dbTransaction.commit();
+
+   this->pimpl->fetchedData = std::move(fetchedData);
+   return true;
+}
+
+void ObjectStore::loadAll(Database * database) {
+   // Assume we failed until we succeed!  (This saves us having to remember to set the error state in every error
+   // branch.  Instead, we just have to set the all OK state at the end of this function.)
+   this->pimpl->m_state = ObjectStore::State::ErrorInitialising;
+
+   if (!this->pimpl->fetchedData && !this->fetchAll(database)) {
+      return;
+   }
+   impl::FetchedData const fetchedData = std::move(*this->pimpl->fetchedData);
+   this->pimpl->fetchedData.reset();
+
+   this->pimpl->allObjects.reserve(fetchedData.rows.size());
+   for (auto const & [primaryKey, namedParameterBundle] : fetchedData.rows) {
+      // Get a new object...
+      auto object = this->createNewObject(namedParameterBundle);
+
+      // ...and store it
+      // It's a coding error if we have two objects with the same primary key
+      Q_ASSERT(!this->pimpl->allObjects.contains(primaryKey));
+      this->pimpl->allObjects.insert(primaryKey, object);
+      this->pimpl->indexObject(primaryKey, *object);
+      // Normally leave this debug output commented, as it generates a lot of logging at start-up, but can be useful to
+      // enable for debugging.
+//      qDebug() <<
+//         Q_FUNC_INFO << "Cached" << object->metaObject()->className() << "#" << primaryKey << "in" <<
+//         this->metaObject()->className();
+   }
+
+   for (qsizetype ii = 0; ii < this->pimpl->junctionTables.size(); ++ii) {
+      // If there are no objects then there's nothing to set
+      if (this->pimpl->allObjects.isEmpty()) {
+         break;
+      }
+
+      auto const & junctionTable = this->pimpl->junctionTables.at(ii);
+
+      //
+      // All objects in the store are the same class, so we only need to look up the property we're setting once.
+      // (Calling QObject::setProperty() would look it up by name for every object.)
+      //
+      QMetaObject const * metaObject = this->pimpl->allObjects.cbegin().value()->metaObject();
+      QMetaProperty const metaProperty =
+         metaObject->property(metaObject->indexOfProperty(*GetJunctionTableDefinitionPropertyName(junctionTable)));
+      if (!metaProperty.isWritable()) {
+         // This is a coding error - eg the property doesn't exist or doesn't have a WRITE member function
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to set property" << GetJunctionTableDefinitionPropertyName(junctionTable) <<
+            "on" << metaObject->className();
+         Q_ASSERT(false); // Stop here on a debug build
+         return;          // Continue but leave the store in error state on a non-debug build
       }
 
-      for (auto currentMapping = thisToOtherKeys.cbegin();
-           currentMapping != thisToOtherKeys.cend();
-           ++currentMapping) {
+      //
+      // Normally we'd pass a list of all the "other" keys for each "this" object, but if we've been told to assume
+      // there is at most one "other" per "this", then we'll pass just the first one we got back for each "this".
+      //
+      // Note that we can't just shove a QList<QVariant> inside a QVariant, because passing this to the property
+      // setter will cause Qt to attempt (and fail) to access a setter that takes QList<QVariant>.  We need a
+      // QVector<int> (ie what the setter expects) wrapped in a QVariant.  And, despite QVariant having a huge number of
+      // constructors, none of them will accept QVector<int>, so, instead, we have to use QVariant::fromValue.
+      //
+      for (auto const & [thisPrimaryKey, otherKeys] : fetchedData.junctionRows.at(ii)) {
          //
          // It's probably a coding error somewhere if there's an associative entry for an object that doesn't exist,
          // but we can recover by ignoring the associative entry
          //
-         if (!this->contains(currentMapping.key())) {
+         auto currentObject = this->pimpl->allObjects.value(thisPrimaryKey);
+         if (!currentObject) {
             qCritical() <<
                Q_FUNC_INFO << "Ignoring record in table " << junctionTable.tableName <<
-               " for non-existent object with primary key " << currentMapping.key();
+               " for non-existent object with primary key " << thisPrimaryKey;
             continue;
          }
 
-         auto currentObject = this->getById(currentMapping.key());
-
-         // We assert that we could not have created a mapping without at least one entry
-         Q_ASSERT(currentMapping.value().size() > 0);
+         // We assert that we could not have got here without at least one entry
+         Q_ASSERT(otherKeys.size() > 0);
 
-         //
-         // Normally we'd pass a list of all the "other" keys for each "this" object, but if we've been told to assume
-         // there is at most one "other" per "this", then we'll pass just the first one we get back for each "this".
-         //
-         bool success = false;
-         if (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) {
-            qDebug() <<
-               Q_FUNC_INFO << currentObject->metaObject()->className() << " #" << currentMapping.key() << ", " <<
-               GetJunctionTableDefinitionPropertyName(junctionTable) << "=" << currentMapping.value().first();
-            success = currentObject->setProperty(*GetJunctionTableDefinitionPropertyName(junctionTable),
-                                                 currentMapping.value().first());
-         } else {
-            //
-            // The setProperty function always takes a QVariant, so we need to create one from the QList<QVariant> we
-            // have.  However, we need to be careful here.  There are several ways to get the call to setProperty wrong
-            // at runtime, which gives you a "false" return code but no diagnostics or log of why the call failed.
-            //
-            // In particular, we can't just shove a QList<QVariant> (ie otherKeys) inside a QVariant, because passing
-            // this to setProperty() (or equivalent calls via the metaObject) will cause Qt to attempt (and fail) to
-            // access a setter that takes QList<QVariant>.  We need a QVector<int> (ie what the setter expects) wrapped
-            // in a QVariant.
-            //
-            // To add to the challenge, despite QVariant having a huge number of constructors, none of them will accept
-            // QVector<int>, so, instead, you have to use the static function QVariant::fromValue to create a QVariant
-            // wrapper around QVector<int>.
-            //
-            QVariant wrappedConvertedOtherKeys = QVariant::fromValue(currentMapping.value());
-            qDebug() <<
-               Q_FUNC_INFO << currentObject->metaObject()->className() << " #" << currentMapping.key() << ", " <<
-               GetJunctionTableDefinitionPropertyName(junctionTable) << "=" << currentMapping.value() << "(" <<
-               wrappedConvertedOtherKeys << ")";
-            success = currentObject->setProperty(*GetJunctionTableDefinitionPropertyName(junctionTable),
-                                                 wrappedConvertedOtherKeys);
-         }
-         if (!success) {
-            // This is a coding error - eg the property doesn't have a WRITE member function or it doesn't take the
-            // type of argument we supplied inside a QVariant.
+         QVariant const wrappedOtherKeys = (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) ?
+            QVariant{otherKeys.first()} : QVariant::fromValue(otherKeys);
+         // Usually keep the next line commented out otherwise it generates a lot of lines in the logs
+//         qDebug() <<
+//            Q_FUNC_INFO << currentObject->metaObject()->className() << " #" << thisPrimaryKey << ", " <<
+//            GetJunctionTableDefinitionPropertyName(junctionTable) << "=" << wrappedOtherKeys;
+         if (!metaProperty.write(currentObject.get(), wrappedOtherKeys)) {
+            // This is a coding error - eg the setter doesn't take the type of argument we supplied inside a QVariant.
             qCritical() <<
                Q_FUNC_INFO << "Unable to set property" << GetJunctionTableDefinitionPropertyName(junctionTable) <<
                "on" << currentObject->metaObject()->className();
             Q_ASSERT(false); // Stop here on a debug build
-            return;          // Continue but abort the transaction on a non-debug build
+            return;          // Continue but leave the store in error state on a non-debug build
          }
-
-         // This is useful for debugging but I usually leave it commented out as it generates a lot of logging at
-         // start-up
-//         qDebug() <<
-//            Q_FUNC_INFO << "Set" <<
-//            (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY ? 1 : otherKeys.size()) <<
-//            GetJunctionTableDefinitionPropertyName(junctionTable).c_str() << "property for" <<
-//            currentObject->metaObject()->className() << "#" << currentKey;
-
       }
    }
 
-   dbTransaction.commit();
-
    qInfo() << Q_FUNC_INFO << "Read" << this->size() << "objects from DB table" << this->pimpl->primaryTable.tableName;
 
    // If we made it this far, everything must have loaded in OK (otherwise we'd have bailed out above).
@@ -1714,6 +2224,9 @@ QList<std::shared_ptr<QObject> > ObjectStore::getByIds(QVector<int> const & list
 }
 
 int ObjectStore::insert(std::shared_ptr<QObject> object) {
+   // Make sure any queued property changes get to the DB before this insert does
+   ObjectStore::flush();
+
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
@@ -1721,7 +2234,7 @@ int ObjectStore::insert(std::shared_ptr<QObject> object) {
                                connection,
                                QString("Insert %1").arg(*this->pimpl->primaryTable.tableName)};
 
-   int primaryKey = this->pimpl->insertObjectInDb(connection, *object, false);
+   int primaryKey = this->pimpl->insertObjectInDb(*this->pimpl->database, connection, *object, false);
 
    //
    // Add the object to our list of all objects of this type (asserting that it should be impossible for an object with
@@ -1747,6 +2260,9 @@ int ObjectStore::insert(std::shared_ptr<QObject> object) {
       Q_ASSERT(false);
    }
 
+   // Only now that the object knows its own primary key is it safe to read its properties into the secondary indexes
+   this->pimpl->indexObject(primaryKey, *object);
+
    //
    // Tell any bits of the UI that need to know that there's a new object
    //
@@ -1755,6 +2271,9 @@ int ObjectStore::insert(std::shared_ptr<QObject> object) {
 }
 
 void ObjectStore::update(std::shared_ptr<QObject> object) {
+   // Make sure any queued property changes get to the DB before this update does
+   ObjectStore::flush();
+
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
@@ -1763,86 +2282,57 @@ void ObjectStore::update(std::shared_ptr<QObject> object) {
                                QString("Update %1").arg(*this->pimpl->primaryTable.tableName)};
 
    //
-   // Construct the SQL, which will be of the form
+   // The SQL, which is constructed once in ObjectStore::impl::constructSql(), will be of the form
    //
    //    UPDATE tablename
    //    SET firstColumn = :firstColumn, secondColumn = :secondColumn, ...
    //    WHERE primaryKeyColumn = :primaryKeyColumn;
    //
-   // .:TBD:. A small optimisation might be to construct this just once rather than every time this function is called
-   //
-   QString queryString{"UPDATE "};
-   QTextStream queryStringAsStream{&queryString};
-   queryStringAsStream << this->pimpl->primaryTable.tableName << " SET ";
-
-   QString  const primaryKeyColumn {*this->pimpl->getPrimaryKeyColumn()};
-   QVariant const primaryKey       {this->pimpl->getPrimaryKey(*object)};
-
-   bool skippedPrimaryKey = false;
-   bool firstFieldOutput = false;
-   for (auto const & fieldDefn: this->pimpl->primaryTable.tableFields) {
-      if (!skippedPrimaryKey) {
-         skippedPrimaryKey = true;
-      } else {
-         if (!firstFieldOutput) {
-            firstFieldOutput = true;
-         } else {
-            queryStringAsStream << ", ";
-         }
-         queryStringAsStream << " " << fieldDefn.columnName << " = :" << fieldDefn.columnName;
-      }
-   }
-
-   queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+   QString  const & queryString {this->pimpl->sql().update};
+   QVariant const   primaryKey  {this->pimpl->getPrimaryKey(*object)};
 
    //
    // Bind the values.  Note that, because we're using bind names, it doesn't matter that the order in which we do the
    // binds is different than the order in which the fields appear in the query.
    //
-   BtSqlQuery sqlQuery{connection};
-   sqlQuery.prepare(queryString);
-   for (auto const & fieldDefn: this->pimpl->primaryTable.tableFields) {
-      QVariant bindValue{object->property(*fieldDefn.propertyName)};
+   {
+      Database::PreparedQuery sqlQuery = this->pimpl->database->preparedQuery(connection, queryString);
+      for (auto const & fieldDefn: this->pimpl->primaryTable.tableFields) {
+         QVariant bindValue{object->property(*fieldDefn.propertyName)};
 
-      // Fix-up the QVariant if needed, including converting enums to strings
-      this->pimpl->unwrapAndMapAsNeeded(this->pimpl->primaryTable, fieldDefn, bindValue);
+         // Fix-up the QVariant if needed, including converting enums to strings
+         this->pimpl->unwrapAndMapAsNeeded(this->pimpl->primaryTable, fieldDefn, bindValue);
 
-      sqlQuery.bindValue(QString{":"} + *fieldDefn.columnName, bindValue);
-   }
+         sqlQuery->bindValue(QString{":"} + *fieldDefn.columnName, bindValue);
+      }
 
-   //
-   // Run the query
-   //
-   if (!sqlQuery.exec()) {
-      qCritical() <<
-         Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-      return;
+      //
+      // Run the query
+      //
+      if (!sqlQuery->exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery->lastError().text();
+         return;
+      }
    }
 
    //
    // Now update data in the junction tables
    //
-   for (auto const & junctionTable : this->pimpl->junctionTables) {
+   for (qsizetype ii = 0; ii < this->pimpl->junctionTables.size(); ++ii) {
       qDebug() <<
-         Q_FUNC_INFO << "Updating property " << GetJunctionTableDefinitionPropertyName(junctionTable) <<
-         " in junction table " << junctionTable.tableName;
-
-      //
-      // The simplest thing to do with each junction table is to blat any rows relating to the current object and then
-      // write out data based on the current property values.  This may often mean we're deleting rows and rewriting
-      // them but, for the small quantity of data we're talking about, it doesn't seem worth the complexity of
-      // optimising (eg read what's in the DB, compare with what's in the object property, work out what deletes,
-      // inserts and updates are needed to sync them, etc.
-      //
-      if (!deleteFromJunctionTableDefinition(junctionTable, primaryKey, connection)) {
-         return;
-      }
-      if (!insertIntoJunctionTableDefinition(junctionTable, *object, primaryKey, connection)) {
+         Q_FUNC_INFO << "Updating property " <<
+         GetJunctionTableDefinitionPropertyName(this->pimpl->junctionTables[ii]) << " in junction table " <<
+         this->pimpl->junctionTables[ii].tableName;
+      if (!this->pimpl->rewriteJunctionTable(ii, *object, primaryKey, connection)) {
          return;
       }
    }
 
    dbTransaction.commit();
+
+   // Any of the indexed properties might have changed
+   this->pimpl->indexObject(primaryKey.toInt(), *object);
    return;
 }
 
@@ -1883,29 +2373,167 @@ int ObjectStore::insertOrUpdate(QObject & object) {
 }
 
 void ObjectStore::updateProperty(QObject const & object, BtStringConst const & propertyName) {
-   // Start transaction
-   // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
-   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
-   DbTransaction dbTransaction{
-      *this->pimpl->database,
-      connection,
-      QString("Update property %1 on %2").arg(*propertyName).arg(*this->pimpl->primaryTable.tableName)
-   };
+   int const primaryKey = this->pimpl->getPrimaryKey(object).toInt();
 
-   if (!this->pimpl->updatePropertyInDb(connection, object, propertyName)) {
-      // Something went wrong.  Bailing out here will abort the transaction and avoid sending the signal.
-      return;
+   if (!this->pimpl->queueWriteBehind(*this, primaryKey, propertyName)) {
+      // If we're not on the main thread, there might still be changes queued there, which need to get to the DB before
+      // this one does.  (If nothing is queued, this is cheap.)
+      ObjectStore::flush();
+
+      // Start transaction
+      // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
+      QSqlDatabase connection = this->pimpl->database->sqlDatabase();
+      DbTransaction dbTransaction{
+         *this->pimpl->database,
+         connection,
+         QString("Update property %1 on %2").arg(*propertyName).arg(*this->pimpl->primaryTable.tableName)
+      };
+
+      if (!this->pimpl->updatePropertyInDb(connection, object, propertyName)) {
+         // Something went wrong.  Bailing out here will abort the transaction and avoid sending the signal.
+         return;
+      }
+
+      // Everything went fine so we can commit the transaction
+      dbTransaction.commit();
    }
 
-   // Everything went fine so we can commit the transaction
-   dbTransaction.commit();
+   // Keep the secondary indexes in step before anyone receiving the signal below has a chance to use them
+   this->pimpl->reindexProperty(primaryKey, object, propertyName);
 
    // Tell any bits of the UI that need to know that the property was updated
-   emit this->signalPropertyChanged(this->pimpl->getPrimaryKey(object).toInt(), propertyName);
+   emit this->signalPropertyChanged(primaryKey, propertyName);
 
    return;
 }
 
+void ObjectStore::setWriteBehind(bool const enabled, int const flushDelay_ms) {
+   qInfo() << Q_FUNC_INFO << "Write-behind" << (enabled ? "on" : "off") << "; flush delay" << flushDelay_ms << "ms";
+   if (!enabled) {
+      ObjectStore::flush();
+   }
+   QMutexLocker locker(&writeBehindQueue.mutex);
+   writeBehindQueue.enabled = enabled;
+   writeBehindQueue.flushDelay_ms = flushDelay_ms;
+   return;
+}
+
+qsizetype ObjectStore::numQueuedWrites() {
+   QMutexLocker locker(&writeBehindQueue.mutex);
+   qsizetype numQueuedWrites = 0;
+   for (auto const & pendingWrite : writeBehindQueue.pendingWrites) {
+      numQueuedWrites += pendingWrite.propertyNames.size();
+   }
+   return numQueuedWrites;
+}
+
+bool ObjectStore::flush() {
+   QMutexLocker locker(&writeBehindQueue.mutex);
+
+   //
+   // The timer belongs to the main thread, so we can't stop it from anywhere else.  If it does fire after another
+   // thread has flushed, it will just find nothing to do.
+   //
+   auto const * application = QCoreApplication::instance();
+   bool const onMainThread = application && QThread::currentThread() == application->thread();
+   if (writeBehindQueue.timer && onMainThread) {
+      writeBehindQueue.timer->stop();
+   }
+   if (writeBehindQueue.pendingWrites.isEmpty()) {
+      return true;
+   }
+
+   //
+   // Take everything off the queue before we start.  Since we hold the mutex until we're done, nothing else can get
+   // queued in the meantime.
+   //
+   QVector<WriteBehindQueue::PendingWrite> pendingWrites = std::move(writeBehindQueue.pendingWrites);
+   writeBehindQueue.pendingWrites.clear();
+   writeBehindQueue.pendingWriteIndexes.clear();
+
+   qDebug() << Q_FUNC_INFO << "Flushing queued property changes for" << pendingWrites.size() << "object(s)";
+
+   //
+   // In practice, all the object stores use the same Database, so there will only be one transaction, but it costs us
+   // very little not to assume it.
+   //
+   QVector<Database *> databases;
+   for (auto const & pendingWrite : pendingWrites) {
+      if (!databases.contains(pendingWrite.objectStore->pimpl->database)) {
+         databases.append(pendingWrite.objectStore->pimpl->database);
+      }
+   }
+
+   QVector<Database *> failedDatabases;
+   for (Database * database : databases) {
+      // Start transaction
+      // (By the magic of RAII, this will abort if we exit this block without calling dbTransaction.commit()
+      QSqlDatabase connection = database->sqlDatabase();
+      DbTransaction dbTransaction{*database, connection, "Write-behind flush"};
+
+      bool wroteAll = true;
+      for (auto const & pendingWrite : pendingWrites) {
+         if (pendingWrite.objectStore->pimpl->database != database) {
+            continue;
+         }
+         for (BtStringConst const * propertyName : pendingWrite.propertyNames) {
+            if (!pendingWrite.objectStore->pimpl->updatePropertyInDb(connection, *pendingWrite.object, *propertyName)) {
+               wroteAll = false;
+               break;
+            }
+         }
+         if (!wroteAll) {
+            break;
+         }
+      }
+
+      if (!wroteAll || !dbTransaction.commit()) {
+         // We'll already have logged the details of what went wrong
+         qCritical() << Q_FUNC_INFO << "Unable to write queued property changes to database";
+         failedDatabases.append(database);
+      }
+   }
+
+   if (failedDatabases.isEmpty()) {
+      writeBehindQueue.lastFlushFailed = false;
+      return true;
+   }
+
+   //
+   // Anything that didn't get written (which, because each transaction was rolled back, is everything for a database
+   // where something went wrong) goes back on the queue, in the same order as before, to be retried on the next flush.
+   // Otherwise the DB would silently end up out of step with the in-memory objects.
+   //
+   for (auto & pendingWrite : pendingWrites) {
+      if (failedDatabases.contains(pendingWrite.objectStore->pimpl->database)) {
+         auto const key = std::make_pair(static_cast<ObjectStore const *>(pendingWrite.objectStore),
+                                         pendingWrite.objectStore->pimpl->getPrimaryKey(*pendingWrite.object).toInt());
+         writeBehindQueue.pendingWriteIndexes.insert(key, writeBehindQueue.pendingWrites.size());
+         writeBehindQueue.pendingWrites.append(std::move(pendingWrite));
+      }
+   }
+
+   bool const tellUser = !writeBehindQueue.lastFlushFailed && onMainThread && Application::isInteractive();
+   writeBehindQueue.lastFlushFailed = true;
+
+   //
+   // We can only show a message box on the main thread.  On other threads, the log message will have to do.  We must
+   // not hold the mutex while the message box is up, as its event loop can run the flush timer, or other code that
+   // changes properties.
+   //
+   locker.unlock();
+   if (tellUser) {
+      QMessageBox::critical(
+         nullptr,
+         QObject::tr("Database Failure"),
+         QObject::tr("Unable to save recent changes to the database.  We will keep trying, but see the log file for "
+                     "details of what went wrong.")
+      );
+   }
+
+   return false;
+}
+
 std::shared_ptr<QObject> ObjectStore::defaultSoftDelete(int id) {
    //
    // We assume on soft-delete that there is nothing to do on related objects - eg if a Mash is soft deleted (ie marked
@@ -1915,6 +2543,7 @@ std::shared_ptr<QObject> ObjectStore::defaultSoftDelete(int id) {
    auto object = this->pimpl->allObjects.value(id);
    if (this->pimpl->allObjects.contains(id)) {
       this->pimpl->allObjects.remove(id);
+      this->pimpl->unindexObject(id);
 
       // Tell any bits of the UI that need to know that an object was deleted
       emit this->signalObjectDeleted(id, object);
@@ -1932,6 +2561,10 @@ std::shared_ptr<QObject> ObjectStore::defaultHardDelete(int id) {
    //
    qDebug() << Q_FUNC_INFO << "Hard delete" << this->pimpl->m_className << "#" << id;
    auto object = this->pimpl->allObjects.value(id);
+
+   // Make sure any queued property changes get to the DB before this delete does
+   ObjectStore::flush();
+
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
    DbTransaction dbTransaction{*this->pimpl->database,
                                connection,
@@ -1949,8 +2582,13 @@ std::shared_ptr<QObject> ObjectStore::defaultHardDelete(int id) {
    //
    // So, first remove data in the junction tables
    //
-   for (auto const & junctionTable : this->pimpl->junctionTables) {
-      if (!deleteFromJunctionTableDefinition(junctionTable, primaryKey, connection)) {
+   ObjectStore::impl::CachedSql const & cachedSql = this->pimpl->sql();
+   for (qsizetype ii = 0; ii < this->pimpl->junctionTables.size(); ++ii) {
+      if (!deleteFromJunctionTableDefinition(this->pimpl->junctionTables[ii],
+                                             cachedSql.junctionDelete[ii],
+                                             primaryKey,
+                                             *this->pimpl->database,
+                                             connection)) {
          // We'll have already logged errors in deleteFromJunctionTableDefinition().  Not much more we can do other than
          // bail here.
          return object;
@@ -1961,36 +2599,32 @@ std::shared_ptr<QObject> ObjectStore::defaultHardDelete(int id) {
    // Now the main table row we want to remove is no longer referenced in the junction tables, we can delete it from the
    // primary table.
    //
-   // Construct the SQL, which will be of the form
+   // The SQL, which is constructed once in ObjectStore::impl::constructSql(), will be of the form
    //
    //    DELETE FROM tablename
    //    WHERE primaryKeyColumn = :primaryKeyColumn;
    //
-   // .:TBD:. A small optimisation might be to construct this just once rather than every time this function is called
-   //
-   QString queryString{"DELETE FROM "};
-   QTextStream queryStringAsStream{&queryString};
-   queryStringAsStream << this->pimpl->primaryTable.tableName;
+   QString const & queryString = cachedSql.hardDelete;
    BtStringConst const & primaryKeyColumn = this->pimpl->getPrimaryKeyColumn();
-   queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
    qDebug() <<
       Q_FUNC_INFO << "Deleting main table row #" << id << "with database query " << queryString;
 
-   //
-   // Bind the value
-   //
-   BtSqlQuery sqlQuery{connection};
-   sqlQuery.prepare(queryString);
-   sqlQuery.bindValue(QString{":"} + *primaryKeyColumn, primaryKey);
-   qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+   {
+      //
+      // Bind the value
+      //
+      Database::PreparedQuery sqlQuery = this->pimpl->database->preparedQuery(connection, queryString);
+      sqlQuery->bindValue(QString{":"} + *primaryKeyColumn, primaryKey);
+      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(*sqlQuery);
 
-   //
-   // Run the query
-   //
-   if (!sqlQuery.exec()) {
-      qCritical() <<
-         Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-      return object;
+      //
+      // Run the query
+      //
+      if (!sqlQuery->exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery->lastError().text();
+         return object;
+      }
    }
 
    dbTransaction.commit();
@@ -1999,6 +2633,7 @@ std::shared_ptr<QObject> ObjectStore::defaultHardDelete(int id) {
    // Remove the object from the cache
    //
    this->pimpl->allObjects.remove(id);
+   this->pimpl->unindexObject(id);
 
    // Tell any bits of the UI that need to know that an object was deleted
    emit this->signalObjectDeleted(id, object);
@@ -2074,6 +2709,86 @@ QVector<int> ObjectStore::idsOfAllMatching(
    return results;
 }
 
+bool ObjectStore::hasIndex(BtStringConst const & propertyName) const {
+   return nullptr != this->pimpl->findSecondaryIndex(propertyName);
+}
+
+QList<std::shared_ptr<QObject> > ObjectStore::findAllByIndex(BtStringConst const & propertyName,
+                                                             int const value) const {
+   auto const * index = this->pimpl->findSecondaryIndex(propertyName);
+   if (!index) {
+      // No index for this property, so we have to fall back to looking at every object
+      return this->findAllMatching(
+         [&propertyName, value](std::shared_ptr<QObject> obj) {return obj->property(*propertyName).toInt() == value;}
+      );
+   }
+
+   QList<std::shared_ptr<QObject> > results;
+   auto ids = index->valueToIds.constFind(value);
+   if (ids != index->valueToIds.cend()) {
+      results.reserve(ids->size());
+      for (int const id : *ids) {
+         // It's a coding error if the index has got out of step with the cache
+         Q_ASSERT(this->pimpl->allObjects.contains(id));
+         results.append(this->pimpl->allObjects.value(id));
+      }
+   }
+   return results;
+}
+
+QVector<int> ObjectStore::idsOfAllByIndex(BtStringConst const & propertyName, int const value) const {
+   auto const * index = this->pimpl->findSecondaryIndex(propertyName);
+   if (!index) {
+      return this->idsOfAllMatching(
+         [&propertyName, value](QObject const * obj) {return obj->property(*propertyName).toInt() == value;}
+      );
+   }
+
+   QSet<int> const ids = index->valueToIds.value(value);
+   return QVector<int>(ids.cbegin(), ids.cend());
+}
+
+std::shared_ptr<QObject> ObjectStore::findFirstByIndex(BtStringConst const & propertyName, int const value) const {
+   auto const * index = this->pimpl->findSecondaryIndex(propertyName);
+   if (!index) {
+      return this->findFirstMatching(
+         [&propertyName, value](std::shared_ptr<QObject> obj) {return obj->property(*propertyName).toInt() == value;}
+      );
+   }
+
+   auto ids = index->valueToIds.constFind(value);
+   if (ids == index->valueToIds.cend() || ids->isEmpty()) {
+      return nullptr;
+   }
+   return this->pimpl->allObjects.value(*ids->cbegin());
+}
+
+QList<std::shared_ptr<QObject> > ObjectStore::findAllByName(QString const & name) const {
+   return this->pimpl->findAllInNameIndex(
+      this->pimpl->nameIndex.nameToIds,
+      name,
+      [&name](QString const & objectName) {return objectName == name;}
+   );
+}
+
+bool ObjectStore::containsName(QString const & name) const {
+   if (this->pimpl->hasNameIndex) {
+      return this->pimpl->nameIndex.nameToIds.contains(name);
+   }
+   return !this->findAllByName(name).isEmpty();
+}
+
+QList<std::shared_ptr<QObject> > ObjectStore::findAllPossibleDuplicates(QString const & name) const {
+   QString const baseName = NamedEntity::nameWithoutDuplicateNumber(name);
+   return this->pimpl->findAllInNameIndex(
+      this->pimpl->nameIndex.baseNameToIds,
+      baseName,
+      [&name, &baseName](QString const & objectName) {
+         return objectName == name || NamedEntity::nameWithoutDuplicateNumber(objectName) == baseName;
+      }
+   );
+}
+
 QList<std::shared_ptr<QObject> > ObjectStore::getAll() const {
    // QHash already knows how to return a QList of its values
    return this->pimpl->allObjects.values();
@@ -2090,6 +2805,9 @@ QList<QObject *> ObjectStore::getAllRaw() const {
 }
 
 bool ObjectStore::writeAllToNewDb(Database & databaseNew, QSqlDatabase & connectionNew) const {
+   // We're about to copy the current DB, so make sure it's up-to-date
+   ObjectStore::flush();
+
    //
    // This is primarily used when someone is migrating data from, say, SQLite to PostgreSQL.
    //
@@ -2101,7 +2819,7 @@ bool ObjectStore::writeAllToNewDb(Database & databaseNew, QSqlDatabase & connect
    // is true.
    //
    for (auto object : this->pimpl->allObjects) {
-      if (this->pimpl->insertObjectInDb(connectionNew, *object, true) <= 0) {
+      if (this->pimpl->insertObjectInDb(databaseNew, connectionNew, *object, true) <= 0) {
          return false;
       }
    }
@@ -198,6 +198,20 @@ public:
    // This isn't strictly necessary, but it makes various declarations more concise
    typedef QVector<JunctionTableDefinition> JunctionTableDefinitions;
 
+   /**
+    * \brief Properties of the objects in this store on which we keep an in-memory secondary index, so that
+    *        \c findAllByIndex() etc can return all objects with a given property value without scanning every object
+    *        in the store.
+    *
+    *        Typically these are the foreign keys we use to find "owned" objects -- eg \c recipeId on
+    *        \c RecipeAdditionHop, \c ownerId on \c MashStep, \c ingredientId on \c InventoryHop.  For the moment at
+    *        least, an indexed property must be an \c int field in the primary table.
+    *
+    *        We store pointers to the property name constants (which, like the table definitions, live for the whole of
+    *        the program run) because \c BtStringConst is deliberately not assignable.
+    */
+   typedef QVector<BtStringConst const *> SecondaryIndexDefinitions;
+
    /**
     * \brief Constructor sets up mappings but does not read in data from DB
     *
@@ -206,11 +220,13 @@ public:
     *                   this object type are "optional" (ie wrapped in \c std::optional)
     * \param primaryTable  First in the list should be the primary key
     * \param junctionTables  Optional
+    * \param secondaryIndexes  Optional
     */
-   ObjectStore(char const *             const   className,
-               TypeLookup               const & typeLookup,
-               TableDefinition          const & primaryTable,
-               JunctionTableDefinitions const & junctionTables = JunctionTableDefinitions{});
+   ObjectStore(char const *              const   className,
+               TypeLookup                const & typeLookup,
+               TableDefinition           const & primaryTable,
+               JunctionTableDefinitions  const & junctionTables   = JunctionTableDefinitions{},
+               SecondaryIndexDefinitions const & secondaryIndexes = SecondaryIndexDefinitions{});
 
    ~ObjectStore();
 
@@ -240,10 +256,28 @@ public:
    bool addTableConstraints(Database & database, QSqlDatabase & connection) const;
 
    /**
-    * \brief Load from database all objects handled by this store
+    * \brief Read from the database everything needed to construct all the objects handled by this store, without
+    *        actually constructing any of them.  The results are held until the next call to \c loadAll().
+    *
+    *        This is the slow part of loading, and, because it doesn't create any \c QObject, it is safe to run on a
+    *        worker thread -- which is how \c InitialiseAllObjectStores() loads stores in parallel.  (Objects then get
+    *        constructed, by \c loadAll(), on the thread they are going to live on.)
     *
     * \param database Sets and stores the Database this store is going to work with.  If not supplied (or set to
     *                 nullptr) then the store will use \c Database::getInstance()
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool fetchAll(Database * database = nullptr);
+
+   /**
+    * \brief Load from database all objects handled by this store
+    *
+    *        If \c fetchAll() has already been called, we construct the objects from what it read.  Otherwise, we call
+    *        it first.  Either way, the objects are constructed on the calling thread, which should be the one they are
+    *        going to live on (normally the main one).
+    *
+    * \param database Passed to \c fetchAll() if we need to call it (and ignored otherwise)
     */
    void loadAll(Database * database = nullptr);
 
@@ -304,9 +338,51 @@ public:
 
    /**
     * \brief Update a single property of an existing object in the DB
+    *
+    *        If write-behind is enabled (see \c setWriteBehind()), the in-memory side of things (secondary indexes and
+    *        \c signalPropertyChanged) happens immediately as usual, but the write to the DB is queued until the next
+    *        \c flush().
     */
    void updateProperty(QObject const & object, BtStringConst const & propertyName);
 
+   /**
+    * \brief Turn write-behind on or off for all object stores.  It is off by default.
+    *
+    *        When it's on, each \c updateProperty() call just records which property of which object needs writing to
+    *        the DB.  Multiple changes to the same property of the same object are coalesced, and everything queued
+    *        gets written in a single transaction by \c flush(), which is called automatically \c flushDelay_ms after
+    *        the first change is queued.  Eg scaling a recipe, which changes dozens of properties across several object
+    *        stores, then results in one DB transaction rather than dozens.
+    *
+    *        Any other write (\c insert(), \c update(), hard delete) flushes the queue before it does anything else,
+    *        so the DB sees changes in the same order as before.
+    *
+    *        Write-behind only applies to changes made on the main (GUI) thread, as it relies on the event loop for the
+    *        timer.  Changes on other threads are written straight through, after flushing anything already queued.
+    *
+    *        Turning write-behind off flushes anything already queued.
+    */
+   static void setWriteBehind(bool const enabled, int const flushDelay_ms = 500);
+
+   /**
+    * \brief Write all queued property changes (for all object stores) to the DB in a single transaction.  Does nothing
+    *        if write-behind is not enabled or nothing is queued.  Safe to call from any thread.
+    *
+    *        As well as being called on a timer (see \c setWriteBehind()), this needs to be called before the DB is
+    *        unloaded at shutdown.
+    *
+    * \return \c true if succeeded (or nothing to do), \c false otherwise.  On failure, the changes stay queued (in
+    *         the same order) to be retried on the next flush, and, the first time it happens on the main thread of an
+    *         interactive session, the user is told.
+    */
+   static bool flush();
+
+   /**
+    * \brief The number of property changes currently waiting in the write-behind queue (see \c setWriteBehind()).
+    *        Multiple changes to the same property of the same object count once.
+    */
+   static qsizetype numQueuedWrites();
+
    /**
     * \brief Remove the object from our local in-memory cache
     *
@@ -416,6 +492,57 @@ public:
     */
    QVector<int> idsOfAllMatching(std::function<bool(QObject const *)> const & matchFunction) const;
 
+   /**
+    * \brief Returns \c true if this store keeps a secondary index on the specified property (see
+    *        \c SecondaryIndexDefinitions), \c false otherwise
+    */
+   bool hasIndex(BtStringConst const & propertyName) const;
+
+   /**
+    * \brief Returns all cached objects whose (integer) \c propertyName property has the value \c value.
+    *
+    *        If there is a secondary index on \c propertyName, this takes time proportional to the number of matching
+    *        objects rather than the total number of objects in the store.  If not, we fall back to a linear search
+    *        (which gives the right answer, just more slowly).
+    *
+    *        NB: This is non-virtual for the same reason as \c getById.  The order of the returned objects is not
+    *            defined, so callers that care about ordering need to sort the results.
+    */
+   QList<std::shared_ptr<QObject> > findAllByIndex(BtStringConst const & propertyName, int const value) const;
+
+   /**
+    * \brief Similar to \c findAllByIndex but returns a list of IDs
+    */
+   QVector<int> idsOfAllByIndex(BtStringConst const & propertyName, int const value) const;
+
+   /**
+    * \brief Similar to \c findAllByIndex but returns only one matching object (or \c nullptr if there are none)
+    */
+   std::shared_ptr<QObject> findFirstByIndex(BtStringConst const & propertyName, int const value) const;
+
+   /**
+    * \brief Returns all cached objects (including soft-deleted ones) whose name is exactly \c name.  For stores whose
+    *        primary table has a name column, this is a hash lookup rather than a linear search.
+    */
+   QList<std::shared_ptr<QObject> > findAllByName(QString const & name) const;
+
+   /**
+    * \brief Returns \c true if there is at least one cached object (including soft-deleted ones) whose name is exactly
+    *        \c name.  Used to avoid name clashes when importing records.
+    */
+   bool containsName(QString const & name) const;
+
+   /**
+    * \brief Returns all cached objects (including soft-deleted ones) that \b could be equal (per
+    *        \c NamedEntity::operator==) to an object called \c name -- ie all those whose names are the same as
+    *        \c name once any duplicate number (see \c NamedEntity::nameWithoutDuplicateNumber) is stripped off.  Callers
+    *        still need to use \c operator== to find out which, if any, of the returned objects actually are equal.
+    *
+    *        This is what allows us to detect duplicates during import without comparing every record read in against
+    *        every object in the store.
+    */
+   QList<std::shared_ptr<QObject> > findAllPossibleDuplicates(QString const & name) const;
+
    /**
     * \brief Special case of \c findAllMatching that returns a list of all cached objects of a given type
     */
@@ -427,7 +554,8 @@ public:
 
    /**
     * \brief Write everything in this object store to a new database.  Caller's responsibility to wrap everything in a
-    *        transaction and turn off foreign key constraints.
+    *        transaction and turn off foreign key constraints.  Any queued property changes are flushed to the current
+    *        database first (see \c flush()).
     *
     * \param databaseNew
     * \param connectionNew
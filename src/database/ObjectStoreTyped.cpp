@@ -16,6 +16,13 @@
 #include "database/ObjectStoreTyped.h"
 
 #include  <mutex> // for std::once_flag
+#include <variant>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
 
 #include "database/DbTransaction.h"
 #include "measurement/Unit.h"
@@ -71,6 +78,13 @@ namespace {
    template<class NE> ObjectStore::TableDefinition          const PRIMARY_TABLE  {"", {}};
    template<class NE> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES{};
 
+   //
+   // Most object stores don't need any secondary indexes, so, unlike PRIMARY_TABLE and JUNCTION_TABLES, we use the
+   // general template for most types and only specialise it for the ones that do.  See the end of this anonymous
+   // namespace for the specialisations.
+   //
+   template<class NE> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES{};
+
    //
    // NOTE: Unlike C++, SQL is generally case-insensitive, so we have slightly different naming conventions.
    //       Specifically, we use snake_case rather than camelCase for field and table names.  By convention, we also
@@ -884,27 +898,79 @@ namespace {
    // BrewNotes don't have children
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<BrewNote> {};
 
+   ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+   // Secondary indexes
+   //
+   // These are for the foreign keys by which "owned" objects are looked up on hot paths -- eg every Recipe::recalcAll()
+   // asks for all the RecipeAdditionFermentable objects with a given recipeId.  Without an index, each such lookup is a
+   // linear scan of all objects of that type.  Recipe::ancestorId is indexed so that a Recipe can tell whether it has
+   // descendants (ie later versions) without having to load every other Recipe's ancestry.
+   ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<BrewNote                 > {&PropertyNames::OwnedByRecipe::recipeId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<RecipeAdditionFermentable> {&PropertyNames::OwnedByRecipe::recipeId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<RecipeAdditionHop        > {&PropertyNames::OwnedByRecipe::recipeId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<RecipeAdditionMisc       > {&PropertyNames::OwnedByRecipe::recipeId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<RecipeAdditionYeast      > {&PropertyNames::OwnedByRecipe::recipeId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<RecipeAdjustmentSalt     > {&PropertyNames::OwnedByRecipe::recipeId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<RecipeUseOfWater         > {&PropertyNames::OwnedByRecipe::recipeId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<BoilStep                 > {&PropertyNames::Step::ownerId           };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<FermentationStep         > {&PropertyNames::Step::ownerId           };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<MashStep                 > {&PropertyNames::Step::ownerId           };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<InventoryFermentable     > {&PropertyNames::Inventory::ingredientId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<InventoryHop             > {&PropertyNames::Inventory::ingredientId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<InventoryMisc            > {&PropertyNames::Inventory::ingredientId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<InventorySalt            > {&PropertyNames::Inventory::ingredientId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<InventoryYeast           > {&PropertyNames::Inventory::ingredientId };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<Recipe                   > {&PropertyNames::Recipe::ancestorId      };
+
 }
 
 
+namespace {
+   /**
+    * \brief The singleton returned by \c ObjectStoreTyped<NE>::getInstance(), but without making sure it has loaded
+    *        its data.  \c InitialiseAllObjectStores() needs this so it can create each store on the main thread before
+    *        fetching its data on a worker thread.
+    */
+   template<class NE> ObjectStoreTyped<NE> & getUnloadedInstance() {
+      //
+      // As of C++11, simple "Meyers singleton" is now thread-safe -- see
+      // https://www.modernescpp.com/index.php/thread-safe-initialization-of-a-singleton#h3-guarantees-of-the-c-runtime
+      //
+      static ObjectStoreTyped<NE> ostSingleton{NE::typeLookup,
+                                               PRIMARY_TABLE<NE>,
+                                               JUNCTION_TABLES<NE>,
+                                               SECONDARY_INDEXES<NE>};
+      return ostSingleton;
+   }
+}
+
 template<class NE>
 ObjectStoreTyped<NE> & ObjectStoreTyped<NE>::getInstance() {
-   //
-   // As of C++11, simple "Meyers singleton" is now thread-safe -- see
-   // https://www.modernescpp.com/index.php/thread-safe-initialization-of-a-singleton#h3-guarantees-of-the-c-runtime
-   //
-   static ObjectStoreTyped<NE> ostSingleton{NE::typeLookup, PRIMARY_TABLE<NE>, JUNCTION_TABLES<NE>};
+   ObjectStoreTyped<NE> & ostSingleton = getUnloadedInstance<NE>();
 
-   // C++11 provides a thread-safe way to ensure singleton.loadAll() is called exactly once
    //
-   // NB: It's easier to just pass in nullptr to ObjectStoreTyped<NE>::loadAll than to do all the magic casting to
-   //     allow std::call_once to invoke it with the default parameter (which is nullptr).
+   // C++11 provides a thread-safe way to ensure singleton.loadAll() is called exactly once.  If
+   // InitialiseAllObjectStores() has already fetched the data on a worker thread, this is where the objects get
+   // constructed from it.
+   //
    static std::once_flag initFlag;
-   std::call_once(initFlag, &ObjectStoreTyped<NE>::loadAll, &ostSingleton, nullptr);
+   std::call_once(initFlag, [&ostSingleton]() {
+      ostSingleton.loadAll();
+      return;
+   });
 
    return ostSingleton;
 }
 
+template<class NE>
+std::unique_ptr<ObjectStoreTyped<NE>> ObjectStoreTyped<NE>::makeUnloadedInstance() {
+   return std::make_unique<ObjectStoreTyped<NE>>(NE::typeLookup,
+                                                 PRIMARY_TABLE<NE>,
+                                                 JUNCTION_TABLES<NE>,
+                                                 SECONDARY_INDEXES<NE>);
+}
+
 //
 // We have to make sure that each version of the above function gets instantiated.  NOTE: This is the 1st of 3 places we
 // need to add any new ObjectStoreTyped
@@ -941,39 +1007,198 @@ template ObjectStoreTyped<Style                    > & ObjectStoreTyped<Style
 template ObjectStoreTyped<Water                    > & ObjectStoreTyped<Water                    >::getInstance();
 template ObjectStoreTyped<Yeast                    > & ObjectStoreTyped<Yeast                    >::getInstance();
 
+//
+// makeUnloadedInstance() is only for testing, so we only instantiate it for the stores the unit tests need
+//
+template std::unique_ptr<ObjectStoreTyped<BrewNote   >> ObjectStoreTyped<BrewNote   >::makeUnloadedInstance();
+template std::unique_ptr<ObjectStoreTyped<Equipment  >> ObjectStoreTyped<Equipment  >::makeUnloadedInstance();
+template std::unique_ptr<ObjectStoreTyped<Fermentable>> ObjectStoreTyped<Fermentable>::makeUnloadedInstance();
+template std::unique_ptr<ObjectStoreTyped<Hop        >> ObjectStoreTyped<Hop        >::makeUnloadedInstance();
+template std::unique_ptr<ObjectStoreTyped<MashStep   >> ObjectStoreTyped<MashStep   >::makeUnloadedInstance();
+template std::unique_ptr<ObjectStoreTyped<Recipe     >> ObjectStoreTyped<Recipe     >::makeUnloadedInstance();
+template std::unique_ptr<ObjectStoreTyped<Style      >> ObjectStoreTyped<Style      >::makeUnloadedInstance();
+
+namespace {
+   /**
+    * \brief What InitialiseAllObjectStores() needs to know to load one object store
+    */
+   struct ObjectStoreLoader {
+      char const * name;
+      ObjectStore::TableDefinition const * primaryTable;
+      ObjectStore::JunctionTableDefinitions const * junctionTables;
+      ObjectStore & (*getUnloadedInstance)();
+      ObjectStore & (*getInstance)();
+   };
+
+   template<class NE> ObjectStoreLoader makeObjectStoreLoader(char const * name) {
+      return ObjectStoreLoader{name,
+                               &PRIMARY_TABLE<NE>,
+                               &JUNCTION_TABLES<NE>,
+                               []() -> ObjectStore & { return getUnloadedInstance<NE>(); },
+                               []() -> ObjectStore & { return ObjectStoreTyped<NE>::getInstance(); }};
+   }
+
+   /**
+    * \brief Group the supplied loaders into "tiers" such that every store in a tier only has foreign keys to stores in
+    *        earlier tiers.  (We use the foreign keys in the table definitions as these are the only cross-store
+    *        dependencies we know about generically.  Self-references, eg Recipe::ancestorId, don't count.)
+    *
+    *        Constructing objects tier by tier therefore means that, eg, all the Hops exist before any
+    *        RecipeAdditionHops.  NB: it doesn't actually matter for correctness if we get this wrong, because any store
+    *        that needs another one during loading gets it via ObjectStoreTyped<NE>::getInstance(), which will load it
+    *        there and then if need be.  But it is better to use the data we have already fetched in parallel.
+    */
+   QVector<QVector<ObjectStoreLoader const *>> getLoadingTiers(QVector<ObjectStoreLoader> const & loaders) {
+      // For each loader, the indexes of the other loaders it depends on
+      QVector<QSet<qsizetype>> dependencies(loaders.size());
+      auto addDependencies = [&loaders, &dependencies](qsizetype const loaderIndex,
+                                                       ObjectStore::TableDefinition const & tableDefinition) {
+         for (auto const & fieldDefn : tableDefinition.tableFields) {
+            if (!std::holds_alternative<ObjectStore::TableDefinition const *>(fieldDefn.valueDecoder)) {
+               continue;
+            }
+            auto const * foreignTable = std::get<ObjectStore::TableDefinition const *>(fieldDefn.valueDecoder);
+            for (qsizetype ii = 0; ii < loaders.size(); ++ii) {
+               if (ii != loaderIndex && loaders[ii].primaryTable == foreignTable) {
+                  dependencies[loaderIndex].insert(ii);
+               }
+            }
+         }
+         return;
+      };
+      for (qsizetype ii = 0; ii < loaders.size(); ++ii) {
+         addDependencies(ii, *loaders[ii].primaryTable);
+         for (auto const & junctionTable : *loaders[ii].junctionTables) {
+            addDependencies(ii, junctionTable);
+         }
+      }
+
+      // Now put each loader in the first tier after all the ones it depends on
+      QVector<QVector<ObjectStoreLoader const *>> tiers;
+      QSet<qsizetype> done;
+      while (done.size() < loaders.size()) {
+         QVector<qsizetype> nextTier;
+         for (qsizetype ii = 0; ii < loaders.size(); ++ii) {
+            if (!done.contains(ii) && done.contains(dependencies[ii])) {
+               nextTier.append(ii);
+            }
+         }
+         if (nextTier.isEmpty()) {
+            //
+            // This would mean there's a circular dependency in the table definitions, which would be a coding error.
+            // As explained above, we can still load everything, just not as efficiently.
+            //
+            qCritical() << Q_FUNC_INFO << "Circular foreign key dependency between object stores";
+            Q_ASSERT(false);
+            for (qsizetype ii = 0; ii < loaders.size(); ++ii) {
+               if (!done.contains(ii)) {
+                  nextTier.append(ii);
+               }
+            }
+         }
+         QVector<ObjectStoreLoader const *> tier;
+         for (qsizetype const ii : nextTier) {
+            tier.append(&loaders[ii]);
+            done.insert(ii);
+         }
+         tiers.append(tier);
+      }
+      return tiers;
+   }
+}
+
 bool InitialiseAllObjectStores(QString & errorMessage) {
+   // NOTE: This is the 2nd of 3 places we need to add any new ObjectStoreTyped
+   static QVector<ObjectStoreLoader> const loaders {
+      makeObjectStoreLoader<Boil                     >("Boil"                     ),
+      makeObjectStoreLoader<BoilStep                 >("BoilStep"                 ),
+      makeObjectStoreLoader<BrewNote                 >("BrewNote"                 ),
+      makeObjectStoreLoader<Equipment                >("Equipment"                ),
+      makeObjectStoreLoader<Fermentable              >("Fermentable"              ),
+      makeObjectStoreLoader<Fermentation             >("Fermentation"             ),
+      makeObjectStoreLoader<FermentationStep         >("FermentationStep"         ),
+      makeObjectStoreLoader<Hop                      >("Hop"                      ),
+      makeObjectStoreLoader<Instruction              >("Instruction"              ),
+      makeObjectStoreLoader<InventoryFermentable     >("InventoryFermentable"     ),
+      makeObjectStoreLoader<InventoryHop             >("InventoryHop"             ),
+      makeObjectStoreLoader<InventoryMisc            >("InventoryMisc"            ),
+      makeObjectStoreLoader<InventorySalt            >("InventorySalt"            ),
+      makeObjectStoreLoader<InventoryYeast           >("InventoryYeast"           ),
+      makeObjectStoreLoader<Mash                     >("Mash"                     ),
+      makeObjectStoreLoader<MashStep                 >("MashStep"                 ),
+      makeObjectStoreLoader<Misc                     >("Misc"                     ),
+      makeObjectStoreLoader<Recipe                   >("Recipe"                   ),
+      makeObjectStoreLoader<RecipeAdditionFermentable>("RecipeAdditionFermentable"),
+      makeObjectStoreLoader<RecipeAdditionHop        >("RecipeAdditionHop"        ),
+      makeObjectStoreLoader<RecipeAdditionMisc       >("RecipeAdditionMisc"       ),
+      makeObjectStoreLoader<RecipeAdditionYeast      >("RecipeAdditionYeast"      ),
+      makeObjectStoreLoader<RecipeAdjustmentSalt     >("RecipeAdjustmentSalt"     ),
+      makeObjectStoreLoader<RecipeUseOfWater         >("RecipeUseOfWater"         ),
+      makeObjectStoreLoader<Salt                     >("Salt"                     ),
+      makeObjectStoreLoader<Style                    >("Style"                    ),
+      makeObjectStoreLoader<Water                    >("Water"                    ),
+      makeObjectStoreLoader<Yeast                    >("Yeast"                    ),
+   };
+
+   //
+   // Each store does its own SELECT (plus one per junction table), and these are independent of each other, so we
+   // fetch the data for all the stores in parallel.  Each worker thread gets its own DB connection from
+   // Database::sqlDatabase(), which we close when the worker is done with it.
+   //
+   // Worker threads only read data though.  The stores themselves, and all the objects in them, are created here on
+   // the main thread, which is where they live.  (A QObject belongs to the thread that creates it, and handing it over
+   // to another thread afterwards is fragile.)  Constructing the objects is quick compared with fetching the data for
+   // them.
+   //
    // It's deliberate that we don't stop after the first error.  If there is a problem, it's quite useful to know how
    // extensive it is.
+   //
+   Q_ASSERT(QThread::currentThread() == QCoreApplication::instance()->thread());
+   QElapsedTimer totalTimer;
+   totalTimer.start();
+   Database & database = Database::instance();
+   {
+      QThreadPool threadPool;
+      for (auto const & loader : loaders) {
+         ObjectStore & objectStore = loader.getUnloadedInstance();
+         // Anything that's already been loaded (eg because something needed it early) doesn't need fetching again
+         if (objectStore.state() != ObjectStore::State::NotYetInitialised) {
+            continue;
+         }
+         threadPool.start([&loader, &objectStore, &database]() {
+            QElapsedTimer timer;
+            timer.start();
+            bool succeeded = false;
+            try {
+               succeeded = objectStore.fetchAll();
+            } catch (QString const & exceptionMessage) {
+               // Database::sqlDatabase() throws QString if it can't open a connection
+               qCritical() << Q_FUNC_INFO << "Error fetching" << loader.name << ":" << exceptionMessage;
+            }
+            // Pool threads can outlive us, so we don't want to leave their DB connections lying around
+            database.closeConnectionForThisThread();
+            //
+            // If something went wrong, ObjectStore::loadAll() will try fetching again (on the main thread) below, and
+            // it's that which determines whether we report an error.
+            //
+            qInfo() <<
+               Q_FUNC_INFO << "Fetched" << loader.name << "data in" << timer.elapsed() << "ms" <<
+               (succeeded ? "" : "WITH ERRORS");
+            return;
+         });
+      }
+      threadPool.waitForDone();
+   }
+
    QStringList errors;
-   // NOTE: This is the 2nd of 3 places we need to add any new ObjectStoreTyped
-   if (ObjectStoreTyped<Boil                     >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Boil"                     ; }
-   if (ObjectStoreTyped<BoilStep                 >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "BoilStep"                 ; }
-   if (ObjectStoreTyped<BrewNote                 >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "BrewNote"                 ; }
-   if (ObjectStoreTyped<Equipment                >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Equipment"                ; }
-   if (ObjectStoreTyped<Fermentable              >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Fermentable"              ; }
-   if (ObjectStoreTyped<Fermentation             >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Fermentation"             ; }
-   if (ObjectStoreTyped<FermentationStep         >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "FermentationStep"         ; }
-   if (ObjectStoreTyped<Hop                      >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Hop"                      ; }
-   if (ObjectStoreTyped<Instruction              >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Instruction"              ; }
-   if (ObjectStoreTyped<InventoryFermentable     >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "InventoryFermentable"     ; }
-   if (ObjectStoreTyped<InventoryHop             >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "InventoryHop"             ; }
-   if (ObjectStoreTyped<InventoryMisc            >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "InventoryMisc"            ; }
-   if (ObjectStoreTyped<InventorySalt            >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "InventorySalt"            ; }
-   if (ObjectStoreTyped<InventoryYeast           >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "InventoryYeast"           ; }
-   if (ObjectStoreTyped<Mash                     >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Mash"                     ; }
-   if (ObjectStoreTyped<MashStep                 >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "MashStep"                 ; }
-   if (ObjectStoreTyped<Misc                     >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Misc"                     ; }
-   if (ObjectStoreTyped<Recipe                   >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Recipe"                   ; }
-   if (ObjectStoreTyped<RecipeAdditionFermentable>::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "RecipeAdditionFermentable"; }
-   if (ObjectStoreTyped<RecipeAdditionHop        >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "RecipeAdditionHop"        ; }
-   if (ObjectStoreTyped<RecipeAdditionMisc       >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "RecipeAdditionMisc"       ; }
-   if (ObjectStoreTyped<RecipeAdditionYeast      >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "RecipeAdditionYeast"      ; }
-   if (ObjectStoreTyped<RecipeAdjustmentSalt     >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "RecipeAdjustmentSalt"     ; }
-   if (ObjectStoreTyped<RecipeUseOfWater         >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "RecipeUseOfWater"         ; }
-   if (ObjectStoreTyped<Salt                     >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Salt"                     ; }
-   if (ObjectStoreTyped<Style                    >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Style"                    ; }
-   if (ObjectStoreTyped<Water                    >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Water"                    ; }
-   if (ObjectStoreTyped<Yeast                    >::getInstance().state() == ObjectStore::State::ErrorInitialising) { errors << "Yeast"                    ; }
+   for (auto const & tier : getLoadingTiers(loaders)) {
+      for (ObjectStoreLoader const * loader : tier) {
+         if (loader->getInstance().state() == ObjectStore::State::ErrorInitialising) {
+            errors << loader->name;
+         }
+      }
+   }
+   qInfo() << Q_FUNC_INFO << "Loaded all object stores in" << totalTimer.elapsed() << "ms";
 
    if (errors.size() > 0) {
       errorMessage = QObject::tr("There were errors loading the following object store(s): %1").arg(errors.join(", "));
@@ -1044,12 +1269,20 @@ bool WriteAllObjectStoresToNewDb(Database & newDatabase, QSqlDatabase & connecti
    //
    DbTransaction dbTransaction{newDatabase, connectionNew, "Write All", DbTransaction::DISABLE_FOREIGN_KEYS};
 
+   bool succeeded = true;
    for (ObjectStore const * objectStore : getAllObjectStores()) {
       if (!objectStore->writeAllToNewDb(newDatabase, connectionNew)) {
-         return false;
+         succeeded = false;
+         break;
       }
    }
 
-   dbTransaction.commit();
-   return true;
+   // We won't be using the prepared INSERT statements on the new connection again, and the caller is responsible for
+   // closing that connection, so get rid of them now.
+   newDatabase.releasePreparedQueries(connectionNew);
+
+   if (succeeded) {
+      dbTransaction.commit();
+   }
+   return succeeded;
 }
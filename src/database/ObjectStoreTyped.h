@@ -36,10 +36,11 @@ public:
     *
     * \param primaryTable First in the list of fields in this table defn should be the primary key
     */
-   ObjectStoreTyped(TypeLookup               const & typeLookup,
-                    TableDefinition          const & primaryTable,
-                    JunctionTableDefinitions const & junctionTables = JunctionTableDefinitions{}) :
-      ObjectStore(NE::staticMetaObject.className(), typeLookup, primaryTable, junctionTables) {
+   ObjectStoreTyped(TypeLookup                const & typeLookup,
+                    TableDefinition           const & primaryTable,
+                    JunctionTableDefinitions  const & junctionTables   = JunctionTableDefinitions{},
+                    SecondaryIndexDefinitions const & secondaryIndexes = SecondaryIndexDefinitions{}) :
+      ObjectStore(NE::staticMetaObject.className(), typeLookup, primaryTable, junctionTables, secondaryIndexes) {
       return;
    }
 
@@ -52,6 +53,13 @@ public:
     */
    static ObjectStoreTyped<NE> & getInstance();
 
+   /**
+    * \brief Make a new store, separate from the singleton but for the same DB table(s), that has not yet loaded its
+    *        data.  This is only for testing -- eg to check that loading the same data in different ways gives the same
+    *        objects.  Everything else should use \c getInstance().
+    */
+   static std::unique_ptr<ObjectStoreTyped<NE>> makeUnloadedInstance();
+
    using ObjectStore::insert;
 
    /**
@@ -285,6 +293,43 @@ public:
       );
    }
 
+   /**
+    * \brief Return all cached objects whose (integer) \c propertyName property has the value \c value, using the
+    *        secondary index on that property if there is one.  See \c ObjectStore::findAllByIndex.
+    */
+   QList<std::shared_ptr<NE> > findAllByIndex(BtStringConst const & propertyName, int const value) const {
+      return this->convertShared(this->ObjectStore::findAllByIndex(propertyName, value));
+   }
+
+   /**
+    * \brief Raw pointer version of \c findAllByIndex
+    */
+   QList<NE *> findAllByIndexRaw(BtStringConst const & propertyName, int const value) const {
+      return this->convertRaw(this->ObjectStore::findAllByIndex(propertyName, value));
+   }
+
+   /**
+    * \brief Similar to \c findAllByIndex but returns only one matching object (or \c nullptr if there are none)
+    */
+   std::shared_ptr<NE> findFirstByIndex(BtStringConst const & propertyName, int const value) const {
+      return std::static_pointer_cast<NE>(this->ObjectStore::findFirstByIndex(propertyName, value));
+   }
+
+   /**
+    * \brief Return all cached objects called \c name.  See \c ObjectStore::findAllByName.
+    */
+   QList<std::shared_ptr<NE> > findAllByName(QString const & name) const {
+      return this->convertShared(this->ObjectStore::findAllByName(name));
+   }
+
+   /**
+    * \brief Return all cached objects that could be equal to one called \c name.  See
+    *        \c ObjectStore::findAllPossibleDuplicates.
+    */
+   QList<std::shared_ptr<NE> > findAllPossibleDuplicates(QString const & name) const {
+      return this->convertShared(this->ObjectStore::findAllPossibleDuplicates(name));
+   }
+
    /**
     * \brief Special case of \c findAllMatching that returns a list of all cached objects of a given type
     */
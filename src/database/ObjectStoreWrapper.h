@@ -225,6 +225,31 @@ namespace ObjectStoreWrapper {
       return ObjectStoreTyped<NE>::getInstance().idsOfAllMatching(matchFunction);
    }
 
+   /**
+    * \brief Returns all objects whose (integer) \c propertyName property has the value \c value.  Where the
+    *        \c ObjectStore for \c NE has a secondary index on \c propertyName (see \c SECONDARY_INDEXES in
+    *        ObjectStoreTyped.cpp), this is much quicker than the equivalent call to \c findAllMatching, eg:
+    *
+    *           ObjectStoreWrapper::findAllByIndex<RecipeAdditionHop>(PropertyNames::OwnedByRecipe::recipeId, 42)
+    *
+    *        NB: The order of the returned objects is not defined.
+    */
+   template<class NE> QList<std::shared_ptr<NE> > findAllByIndex(BtStringConst const & propertyName, int const value) {
+      return ObjectStoreTyped<NE>::getInstance().findAllByIndex(propertyName, value);
+   }
+
+   template<class NE> QList<NE *> findAllByIndexRaw(BtStringConst const & propertyName, int const value) {
+      return ObjectStoreTyped<NE>::getInstance().findAllByIndexRaw(propertyName, value);
+   }
+
+   template<class NE> std::shared_ptr<NE> findFirstByIndex(BtStringConst const & propertyName, int const value) {
+      return ObjectStoreTyped<NE>::getInstance().findFirstByIndex(propertyName, value);
+   }
+
+   template<class NE> QVector<int> idsOfAllByIndex(BtStringConst const & propertyName, int const value) {
+      return ObjectStoreTyped<NE>::getInstance().idsOfAllByIndex(propertyName, value);
+   }
+
    /**
     * \brief Given two IDs of some subclass of \c NamedEntity, return \c true if the corresponding objects are equal (or
     *        if both IDs are invalid), and \c false otherwise
@@ -27,14 +27,22 @@
 #include <QCommandLineParser>
 #include <QDate>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QMessageBox>
 #include <QSharedMemory>
+#include <QTextStream>
 
 #include "Application.h"
 #include "config.h"
 #include "database/Database.h"
+#include "database/ObjectStore.h"
+#include "database/ObjectStoreTyped.h"
+#include "database/ObjectStoreWrapper.h"
 #include "Localization.h"
 #include "Logging.h"
+#include "model/Recipe.h"
+#include "model/RecipeCalc.h"
 #include "PersistentSettings.h"
 #include "serialization/xml/BeerXml.h"
 #include "utils/MetaTypes.h"
@@ -54,11 +62,70 @@ namespace {
          qCritical() << "Unable to import" << filename << "Error: " << errorMessage;
          exit(1);
       }
+      ObjectStore::flush();
       Database::instance().unload();
       PersistentSettings::insert(PersistentSettings::Names::converted, QDate().currentDate().toString());
       exit(0);
    }
 
+   /*!
+    * \brief Calculates OG, FG, ABV, IBU and color for every (non-deleted) recipe in the database, without starting the
+    *        UI, and writes the results as CSV to the given file.  See \c RecipeCalc.
+    */
+   void writeRecipeReport(QString const & filename) {
+      Application::setInteractive(false);
+      Application::readSystemOptions();
+      registerMetaTypes();
+
+      if (!Database::instance().loadSuccessful()) {
+         qCritical() << "Unable to load database";
+         exit(1);
+      }
+      QString errorMessage;
+      if (!InitialiseAllObjectStores(errorMessage)) {
+         qCritical() << "Unable to read in from database:" << errorMessage;
+         exit(1);
+      }
+
+      QList<Recipe *> const recipes = ObjectStoreWrapper::findAllMatching<Recipe>(
+         [](Recipe * recipe) { return !recipe->deleted(); }
+      );
+
+      QElapsedTimer timer;
+      timer.start();
+      RecipeCalc::Inputs const inputs = RecipeCalc::snapshot(recipes);
+      qint64 const snapshotTime_ms = timer.restart();
+      RecipeCalc::Results const results = RecipeCalc::evaluate(inputs);
+      qInfo() <<
+         "Calculated" << recipes.size() << "recipes (snapshot" << snapshotTime_ms << "ms, evaluation" <<
+         timer.elapsed() << "ms)";
+
+      QFile file{filename};
+      if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+         qCritical() << "Unable to open" << filename << "for writing:" << file.errorString();
+         exit(1);
+      }
+      QTextStream out{&file};
+      out << "id,name,og,fg,abv_pct,ibu,color_srm\n";
+      for (qsizetype ii = 0; ii < recipes.size(); ++ii) {
+         std::size_t const rr = static_cast<std::size_t>(ii);
+         QString name = recipes.at(ii)->name();
+         name.replace('"', "\"\"");
+         out <<
+            inputs.recipeId[rr] << ",\"" << name << "\"," <<
+            QString::number(results.og       [rr], 'f', 3) << "," <<
+            QString::number(results.fg       [rr], 'f', 3) << "," <<
+            QString::number(results.abv_pct  [rr], 'f', 1) << "," <<
+            QString::number(results.ibu      [rr], 'f', 1) << "," <<
+            QString::number(results.color_srm[rr], 'f', 1) << "\n";
+      }
+      out.flush();
+      file.close();
+
+      Database::instance().unload();
+      exit(0);
+   }
+
    //! \brief Creates a blank database using the given filename.
    void createBlankDb(const QString & filename) {
       Database::instance().createBlank(filename);
@@ -136,6 +203,10 @@ int main(int argc, char **argv) {
    parser.addOption(importFromXmlOption);
    QCommandLineOption const createBlankDBOption("create-blank", "Creates an empty database in <file>", "file");
    parser.addOption(createBlankDBOption);
+   QCommandLineOption const recipeReportOption(
+      "recipe-report", "Writes OG, FG, ABV, IBU and color of all recipes, as CSV, to <file>", "file"
+   );
+   parser.addOption(recipeReportOption);
    /*!
     * \brief Forces the application to a specific user directory.
     *
@@ -226,6 +297,7 @@ int main(int argc, char **argv) {
 
    if (parser.isSet(importFromXmlOption)) importFromXml(parser.value(importFromXmlOption));
    if (parser.isSet(createBlankDBOption)) createBlankDb(parser.value(createBlankDBOption));
+   if (parser.isSet(recipeReportOption)) writeRecipeReport(parser.value(recipeReportOption));
 
    try {
       qInfo() <<
@@ -20,17 +20,34 @@
 
 #include <numbers> // For std::numbers::pi
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <mutex> // For std::once_flag etc
+#include <vector>
 
 #include <QDebug>
 #include <QObject>
 #include <QString>
 
-#include "Algorithms.h"
+#include "Logging.h"
 #include "measurement/Unit.h"
 #include "PersistentSettings.h"
 
 namespace {
+   /**
+    * \brief SMPH is not yet implemented, so we use Tinseth instead.  We log this the first time it happens rather than
+    *        on every calculation, as there can be a lot of those.
+    */
+   void warnSmphNotImplemented() {
+      static std::once_flag warnedFlag;
+      std::call_once(warnedFlag, []() {
+         qWarning() << Q_FUNC_INFO << "SMPH IBU formula is not yet implemented, so using Tinseth instead";
+         return;
+      });
+      return;
+   }
+
    double circleAreaFromRadius(double const radius) {
       return std::numbers::pi * radius * radius;
    }
@@ -89,58 +106,102 @@ namespace {
       return decimalAlphaAcidUtilization;
    }
 
+   //
+   // The formula functions below take plain doubles rather than an IbuCalculationParms so that they can be called both
+   // from getIbus() and from the tight loops in getIbusBatch().  They are deliberately branch-free (or close to it), so
+   // that the compiler can inline them and vectorise those loops.
+   //
+
    /*!
     * \brief Calculates the IBU by Tinseth's formula, as described at http://www.realbeer.com/hops/research.html
     */
-   double tinseth(IbuMethods::IbuCalculationParms const & parms) {
-      double const mgPerLiterOfAddedAlphaAcids = (parms.AArating * parms.hops_grams * 1000) / parms.postBoilVolume_liters;
-      double const decimalAlphaAcidUtilization = calculateDecimalAlphaAcidUtilization(parms.wortGravity_sg,
-                                                                                      parms.boilTime_minutes);
+   inline double tinseth(double const AArating,
+                         double const hops_grams,
+                         double const postBoilVolume_liters,
+                         double const wortGravity_sg,
+                         double const boilTime_minutes) {
+      double const mgPerLiterOfAddedAlphaAcids = (AArating * hops_grams * 1000) / postBoilVolume_liters;
+      double const decimalAlphaAcidUtilization = calculateDecimalAlphaAcidUtilization(wortGravity_sg, boilTime_minutes);
       return decimalAlphaAcidUtilization * mgPerLiterOfAddedAlphaAcids;
 ///      return ((AArating * hops_grams * 1000) / postBoilVolume_liters) * ((1.0 - exp(-0.04 * boilTime_minutes)) / 4.15) * (1.65 * pow(0.000125, (wortGravity_sg - 1)));
    }
 
-   double rager(IbuMethods::IbuCalculationParms const & parms) {
-      double const utilization = (18.11 + 13.86 * tanh((parms.boilTime_minutes - 31.32) / 18.17)) / 100.0;
+   inline double rager(double const AArating,
+                       double const hops_grams,
+                       double const postBoilVolume_liters,
+                       double const wortGravity_sg,
+                       double const boilTime_minutes) {
+      double const utilization = (18.11 + 13.86 * tanh((boilTime_minutes - 31.32) / 18.17)) / 100.0;
 
-      double const gravityFactor = (parms.wortGravity_sg > 1.050) ? (parms.wortGravity_sg - 1.050)/0.2 : 0.0;
+      double const gravityFactor = (wortGravity_sg > 1.050) ? (wortGravity_sg - 1.050)/0.2 : 0.0;
 
-      return (parms.hops_grams * utilization * parms.AArating * 1000) / (parms.postBoilVolume_liters * (1 + gravityFactor));
+      return (hops_grams * utilization * AArating * 1000) / (postBoilVolume_liters * (1 + gravityFactor));
    }
 
+   /**
+    * \brief Noonan's formula works in US customary units, so we need a couple of conversion constants.  We work these
+    *        out once per call to getIbus() or getIbusBatch() rather than once per hop addition.
+    */
+   struct NoonanConstants {
+      double const fiveUsGallons_liters = Measurement::Units::us_gallons.toCanonical(5.0).quantity;
+      double const oneOunce_grams       = Measurement::Units::ounces.toCanonical(1.0).quantity * 1000.0;
+   };
+
+   //! Coefficients of Noonan's utilization polynomial in boil time, lowest order first
+   constexpr std::array<double, 8> noonanCoefficients {
+      0.7000029428, -0.08868853463, 0.02720809386, -0.002340415323, 0.00009925450081, -0.000002102006144,
+      0.00000002132644293, -0.00000000008229488217
+   };
+
    /*!
     * \brief Calculates the IBU by Greg Noonan's formula
     */
-   double noonan(IbuMethods::IbuCalculationParms const & parms) {
-      double const volumeFactor = (Measurement::Units::us_gallons.toCanonical(5.0).quantity)/ parms.postBoilVolume_liters;
-      double const hopsFactor = parms.hops_grams/ (Measurement::Units::ounces.toCanonical(1.0).quantity * 1000.0);
-      static const Polynomial p(Polynomial() << 0.7000029428 << -0.08868853463 << 0.02720809386 << -0.002340415323 << 0.00009925450081 << -0.000002102006144 << 0.00000002132644293 << -0.00000000008229488217);
+   inline double noonan(double const AArating,
+                        double const hops_grams,
+                        double const postBoilVolume_liters,
+                        double const wortGravity_sg,
+                        double const boilTime_minutes,
+                        NoonanConstants const & constants) {
+      double const volumeFactor = constants.fiveUsGallons_liters / postBoilVolume_liters;
+      double const hopsFactor = hops_grams / constants.oneOunce_grams;
 
-      //using 60 boilTime_minutes as a general table
-      static double const utilizationFactorTable[4][2] =  {
-                        {1.050, 1},
-                        {1.065, 0.9286},
-                        {1.085, 0.8571},
-                        {1.100, 0.75}
-                     };
-
-      double utilizationFactor;
-
-      if (parms.wortGravity_sg <= utilizationFactorTable[0][0]) {
-         utilizationFactor = utilizationFactorTable[0][1];
-      } else if (parms.wortGravity_sg <= utilizationFactorTable[1][0]) {
-         utilizationFactor = utilizationFactorTable[1][1];
-      } else if (parms.wortGravity_sg <= utilizationFactorTable[2][0]) {
-         utilizationFactor = utilizationFactorTable[2][1];
-      } else {
-         utilizationFactor = utilizationFactorTable[3][1];
+      // Horner's method, which is equivalent to Polynomial::eval() but easier for the compiler to vectorise
+      double boilTimeFactor = 0.0;
+      for (auto coefficient = noonanCoefficients.crbegin(); coefficient != noonanCoefficients.crend(); ++coefficient) {
+         boilTimeFactor = boilTimeFactor * boilTime_minutes + *coefficient;
       }
 
-      return(volumeFactor * ( hopsFactor * (100 * parms.AArating) * p.eval(parms.boilTime_minutes) ) * utilizationFactor);
+      //using 60 boilTime_minutes as a general table
+      //
+      //    Gravity | Utilization factor
+      //    --------+-------------------
+      //    ≤ 1.050 | 1
+      //    ≤ 1.065 | 0.9286
+      //    ≤ 1.085 | 0.8571
+      //    > 1.085 | 0.75
+      //
+      double const utilizationFactor = (wortGravity_sg <= 1.050) ? 1.0    :
+                                       (wortGravity_sg <= 1.065) ? 0.9286 :
+                                       (wortGravity_sg <= 1.085) ? 0.8571 : 0.75;
+
+      return(volumeFactor * ( hopsFactor * (100 * AArating) * boilTimeFactor ) * utilizationFactor);
+   }
+
+   /**
+    * \brief The "b" parameter of the mIBU model of post-boil temperature decay (see computePostBoilUtilization)
+    */
+   double temperatureDecayRate(double const postBoilVolume_liters,
+                               double const kettleInternalDiameter_cm,
+                               double const kettleOpeningDiameter_cm) {
+      double const surfaceArea_cm2 = circleAreaFromRadius(kettleInternalDiameter_cm/2.0);
+      double const openingArea_cm2 = circleAreaFromRadius(kettleOpeningDiameter_cm/2.0);
+      double const effectiveArea_cm2 = sqrt(surfaceArea_cm2 * openingArea_cm2);
+      return (0.0002925 * effectiveArea_cm2 / postBoilVolume_liters) + 0.00538;
    }
 
    /**
-    * \brief Intermediate step used by mIBU formula
+    * \brief Intermediate step used by mIBU formula.  This is the "exact" version, which integrates numerically over
+    *        the post-boil time in small steps.  See also \c PostBoilUtilizationTable.
     */
    double computePostBoilUtilization(double const boilTime_minutes,
                                      double const wortGravity_sg,
@@ -149,10 +210,7 @@ namespace {
                                      double const kettleInternalDiameter_cm,
                                      double const kettleOpeningDiameter_cm) {
 
-      double const surfaceArea_cm2 = circleAreaFromRadius(kettleInternalDiameter_cm/2.0);
-      double const openingArea_cm2 = circleAreaFromRadius(kettleOpeningDiameter_cm/2.0);
-      double const effectiveArea_cm2 = sqrt(surfaceArea_cm2 * openingArea_cm2);
-      double const b = (0.0002925 * effectiveArea_cm2 / postBoilVolume_liters) + 0.00538;
+      double const b = temperatureDecayRate(postBoilVolume_liters, kettleInternalDiameter_cm, kettleOpeningDiameter_cm);
 
       double const integrationTime = 0.001;
       double decimalAArating = 0.0;
@@ -170,31 +228,202 @@ namespace {
       return decimalAArating;
    }
 
+   /**
+    * \brief Lookup table alternative to \c computePostBoilUtilization.
+    *
+    *        The integral computed by \c computePostBoilUtilization can be rearranged (by measuring time from flameout
+    *        rather than from the start of the boil) as:
+    *
+    *           K(wortGravity_sg) × exp(-0.04 × boilTime_minutes) × ∫ g(s, b) ds
+    *
+    *        where K(wortGravity_sg) = 1.65 × 0.000125^(wortGravity_sg - 1) × 0.04 / 4.15, b is the temperature decay
+    *        rate (which depends only on the kettle dimensions and the post-boil volume), and
+    *
+    *           g(s, b) = exp(-0.04 × s) × 2.39×10^11 × exp(-9773 / (53.70 × exp(-b × s) + 319.55))
+    *
+    *        (The one wrinkle is that, for the first 5 minutes of the boil, the degree of utilization is taken to be 1,
+    *        which we can integrate exactly.)  So all the hard work is in the cumulative integral G(c, b) of g(s, b)
+    *        from 0 to c, which depends on only two parameters, neither of which is the gravity or the boil time.  We
+    *        tabulate G once, using Simpson's rule, and then use bilinear interpolation to look it up.
+    *
+    *        Outside the range of the table (see \c maxCoolTime_minutes, \c minB, \c maxB) we fall back to the
+    *        numerical integration.
+    *
+    *        Comparing with \c computePostBoilUtilization for gravities of 1.030 to 1.100, boil times of 0 to 90
+    *        minutes, cool times of 0 to 60 minutes and b from 0.00538 to 0.19, the absolute difference in utilization
+    *        is always less than \c IbuMethods::postBoilUtilizationLookupTableMaxError (and is typically about 0.05%
+    *        of the utilization, which is a similar size to the discretisation error in the numerical integration
+    *        itself).  For 100g of 10% AA hops in 20 liters, this bound is 0.05 IBU.
+    */
+   class PostBoilUtilizationTable {
+   public:
+      static constexpr double maxCoolTime_minutes = 120.0;
+      static constexpr double coolTimeStep_minutes = 0.5;
+      static constexpr double minB = 0.005;
+      static constexpr double maxB = 0.2;
+      //! We space the entries for b logarithmically, as most real-world values are at the low end of the range
+      static constexpr int numBs = 32;
+      static constexpr int numCoolTimes = static_cast<int>(maxCoolTime_minutes / coolTimeStep_minutes) + 1;
+
+      /**
+       * \brief The table is built the first time it is needed.  (The compiler ensures this is thread-safe.)
+       */
+      static PostBoilUtilizationTable const & instance() {
+         static PostBoilUtilizationTable const table;
+         return table;
+      }
+
+      /**
+       * \return Same as \c computePostBoilUtilization, or \c std::nullopt if the parameters are outside the range of
+       *         the table
+       */
+      std::optional<double> postBoilUtilization(double const boilTime_minutes,
+                                                double const wortGravity_sg,
+                                                double const coolTime_minutes,
+                                                double const b) const {
+         if (coolTime_minutes > maxCoolTime_minutes || b < minB || b > maxB) {
+            return std::nullopt;
+         }
+         if (coolTime_minutes <= 0.0) {
+            return 0.0;
+         }
+
+         double const boilFactor = exp(-0.04 * boilTime_minutes);
+         double integral = 0.0;
+         if (boilTime_minutes < 5.0) {
+            // Degree of utilization is 1.0 up to the 5 minute mark, so we can integrate exactly
+            double const endOfFirstPart_minutes = std::min(5.0, boilTime_minutes + coolTime_minutes);
+            integral = (boilFactor - exp(-0.04 * endOfFirstPart_minutes)) / 0.04;
+            if (boilTime_minutes + coolTime_minutes > 5.0) {
+               integral += boilFactor * (this->lookUp(coolTime_minutes, b) - this->lookUp(5.0 - boilTime_minutes, b));
+            }
+         } else {
+            integral = boilFactor * this->lookUp(coolTime_minutes, b);
+         }
+
+         return 1.65 * pow(0.000125, (wortGravity_sg - 1.0)) * 0.04 / 4.15 * integral;
+      }
+
+   private:
+      PostBoilUtilizationTable() : m_cumulativeIntegrals(numBs * numCoolTimes, 0.0) {
+         // Number of Simpson's rule intervals per table step.  This is plenty, as g(s, b) is very smooth.
+         int const numSubSteps = 8;
+         double const subStep = coolTimeStep_minutes / numSubSteps;
+         for (int bIndex = 0; bIndex < numBs; ++bIndex) {
+            double const b = bAt(bIndex);
+            double cumulativeIntegral = 0.0;
+            for (int cIndex = 1; cIndex < numCoolTimes; ++cIndex) {
+               double const start = (cIndex - 1) * coolTimeStep_minutes;
+               for (int ii = 0; ii < numSubSteps; ++ii) {
+                  double const s0 = start + ii * subStep;
+                  cumulativeIntegral += subStep / 6.0 * (g(s0, b) + 4.0 * g(s0 + subStep / 2.0, b) + g(s0 + subStep, b));
+               }
+               this->m_cumulativeIntegrals[bIndex * numCoolTimes + cIndex] = cumulativeIntegral;
+            }
+         }
+         return;
+      }
+
+      static double bAt(int const bIndex) {
+         return minB * pow(maxB / minB, static_cast<double>(bIndex) / (numBs - 1));
+      }
+
+      static double g(double const s, double const b) {
+         return exp(-0.04 * s) * 2.39 * pow(10.0, 11.0) * exp(-9773.0 / (53.70 * exp(-b * s) + 319.55));
+      }
+
+      double lookUp(double const coolTime_minutes, double const b) const {
+         double const cPosition = coolTime_minutes / coolTimeStep_minutes;
+         int const cIndex = std::clamp(static_cast<int>(cPosition), 0, numCoolTimes - 2);
+         double const cFraction = cPosition - cIndex;
+
+         double const bPosition = log(b / minB) / log(maxB / minB) * (numBs - 1);
+         int const bIndex = std::clamp(static_cast<int>(bPosition), 0, numBs - 2);
+         double const bFraction = bPosition - bIndex;
+
+         auto at = [this](int const cc, int const bb) { return this->m_cumulativeIntegrals[bb * numCoolTimes + cc]; };
+         return (1.0 - bFraction) * ((1.0 - cFraction) * at(cIndex, bIndex    ) + cFraction * at(cIndex + 1, bIndex    )) +
+                       bFraction  * ((1.0 - cFraction) * at(cIndex, bIndex + 1) + cFraction * at(cIndex + 1, bIndex + 1));
+      }
+
+      //! G(c, b) for each b (outer) and c (inner)
+      std::vector<double> m_cumulativeIntegrals;
+   };
+
+   /**
+    * \brief The mIBU formula needs a few optional parameters.  We supply fallback values if they are not set, but they
+    *        likely won't be great.
+    */
+   struct MIbuKettleParms {
+      double const coolTime_minutes;
+      double const kettleInternalDiameter_cm;
+      double const kettleOpeningDiameter_cm;
+
+      MIbuKettleParms(std::optional<double> const maybeCoolTime_minutes,
+                      std::optional<double> const maybeKettleInternalDiameter_cm,
+                      std::optional<double> const maybeKettleOpeningDiameter_cm) :
+         coolTime_minutes         {maybeCoolTime_minutes         .value_or( 0.0)},
+         kettleInternalDiameter_cm{maybeKettleInternalDiameter_cm.value_or(45.0)},
+         kettleOpeningDiameter_cm {maybeKettleOpeningDiameter_cm .value_or(45.0)} {
+         if (!maybeCoolTime_minutes         ) { qWarning() << Q_FUNC_INFO << "coolTime_minutes          not set!"; }
+         if (!maybeKettleInternalDiameter_cm) { qWarning() << Q_FUNC_INFO << "kettleInternalDiameter_cm not set!"; }
+         if (!maybeKettleOpeningDiameter_cm ) { qWarning() << Q_FUNC_INFO << "kettleOpeningDiameter_cm  not set!"; }
+         return;
+      }
+   };
+
    /*!
     * \brief Calculates the IBU by the mIBU formula, developed by Paul-John Hosom, and described at
     *        https://alchemyoverlord.wordpress.com/2015/05/12/a-modified-ibu-measurement-especially-for-late-hopping/
+    *
+    *        This is the Tinseth utilization plus the additional utilization after flameout.
     */
-   double mIbu(IbuMethods::IbuCalculationParms const & parms) {
-      //
-      // Check optional parameters available for this formula.  We supply fallback values below, but they likely
-      // won't be great.
-      //
-      if (!parms.coolTime_minutes         ) { qWarning() << Q_FUNC_INFO << "coolTime_minutes          not set!"; }
-      if (!parms.kettleInternalDiameter_cm) { qWarning() << Q_FUNC_INFO << "kettleInternalDiameter_cm not set!"; }
-      if (!parms.kettleOpeningDiameter_cm ) { qWarning() << Q_FUNC_INFO << "kettleOpeningDiameter_cm  not set!"; }
-      double const decimalAlphaAcidUtilization = calculateDecimalAlphaAcidUtilization(parms.wortGravity_sg,
-                                                                                      parms.boilTime_minutes);
-      double const postBoilUtilization = computePostBoilUtilization(parms.boilTime_minutes,
-                                                                    parms.wortGravity_sg,
-                                                                    parms.postBoilVolume_liters,
-                                                                    parms.coolTime_minutes.value_or(0.0),
-                                                                    parms.kettleInternalDiameter_cm.value_or(45.0),
-                                                                    parms.kettleOpeningDiameter_cm.value_or(45.0));
+   double mIbu(double const AArating,
+               double const hops_grams,
+               double const postBoilVolume_liters,
+               double const wortGravity_sg,
+               double const boilTime_minutes,
+               MIbuKettleParms const & kettleParms) {
+      double const decimalAlphaAcidUtilization = calculateDecimalAlphaAcidUtilization(wortGravity_sg, boilTime_minutes);
+      double const postBoilUtilization = IbuMethods::postBoilUtilization(boilTime_minutes,
+                                                                         wortGravity_sg,
+                                                                         postBoilVolume_liters,
+                                                                         kettleParms.coolTime_minutes,
+                                                                         kettleParms.kettleInternalDiameter_cm,
+                                                                         kettleParms.kettleOpeningDiameter_cm);
 
       double const totalUtilization = decimalAlphaAcidUtilization + postBoilUtilization;
-      double const IBU = (totalUtilization * parms.AArating * parms.hops_grams * 1000.0) / parms.postBoilVolume_liters;
+      double const IBU = (totalUtilization * AArating * hops_grams * 1000.0) / postBoilVolume_liters;
       return IBU;
    }
+
+   /**
+    * \brief Applies \c formula to every element of the input spans.  The formula is a template parameter so that the
+    *        compiler sees a simple loop over contiguous arrays with a direct (and therefore inlinable) call in its body.
+    *
+    * \param extraArgs Any arguments to \c formula after the usual five, which are the same for every hop addition
+    */
+   template<auto formula, typename... ExtraArgs>
+   void applyToBatch(IbuMethods::IbuBatchParms const & parms,
+                     std::span<double> const ibus,
+                     ExtraArgs const &... extraArgs) {
+      std::size_t const numAdditions = ibus.size();
+      double const * const AArating         = parms.AArating        .data();
+      double const * const hops_grams       = parms.hops_grams      .data();
+      double const * const wortGravity_sg   = parms.wortGravity_sg  .data();
+      double const * const boilTime_minutes = parms.boilTime_minutes.data();
+      double       * const output           = ibus                  .data();
+      double const postBoilVolume_liters = parms.postBoilVolume_liters;
+      for (std::size_t ii = 0; ii < numAdditions; ++ii) {
+         output[ii] = formula(AArating[ii],
+                              hops_grams[ii],
+                              postBoilVolume_liters,
+                              wortGravity_sg[ii],
+                              boilTime_minutes[ii],
+                              extraArgs...);
+      }
+      return;
+   }
 }
 
 EnumStringMapping const IbuMethods::formulaStringMapping {
@@ -217,6 +446,11 @@ EnumStringMapping const IbuMethods::formulaDisplayNames {
 
 IbuMethods::IbuFormula IbuMethods::ibuFormula = IbuMethods::IbuFormula::Tinseth;
 
+IbuMethods::PostBoilUtilizationMethod IbuMethods::postBoilUtilizationMethod =
+   IbuMethods::PostBoilUtilizationMethod::LookupTable;
+
+double const IbuMethods::postBoilUtilizationLookupTableMaxError = 1.0e-4;
+
 void IbuMethods::loadIbuFormula() {
    QString text = PersistentSettings::value(PersistentSettings::Names::ibu_formula, "tinseth").toString();
    if (text == "tinseth") {
@@ -225,6 +459,8 @@ void IbuMethods::loadIbuFormula() {
       IbuMethods::ibuFormula = IbuMethods::IbuFormula::Rager;
    } else if (text == "noonan") {
        IbuMethods::ibuFormula = IbuMethods::IbuFormula::Noonan;
+   } else if (text == "mibu") {
+       IbuMethods::ibuFormula = IbuMethods::IbuFormula::mIbu;
    } else {
       qCritical() << Q_FUNC_INFO << "Bad ibu_formula type:" << text;
    }
@@ -243,12 +479,103 @@ QString IbuMethods::ibuFormulaName() {
 
 double IbuMethods::getIbus(IbuMethods::IbuCalculationParms const & parms) {
    switch(IbuMethods::ibuFormula) {
-      case IbuMethods::IbuFormula::Tinseth: return tinseth(parms);
-      case IbuMethods::IbuFormula::Rager  : return rager  (parms);
-      case IbuMethods::IbuFormula::Noonan : return noonan (parms);
+      case IbuMethods::IbuFormula::Tinseth:
+         return tinseth(parms.AArating, parms.hops_grams, parms.postBoilVolume_liters, parms.wortGravity_sg, parms.boilTime_minutes);
+      case IbuMethods::IbuFormula::Rager  :
+         return rager  (parms.AArating, parms.hops_grams, parms.postBoilVolume_liters, parms.wortGravity_sg, parms.boilTime_minutes);
+      case IbuMethods::IbuFormula::Noonan :
+         return noonan (parms.AArating, parms.hops_grams, parms.postBoilVolume_liters, parms.wortGravity_sg, parms.boilTime_minutes,
+                        NoonanConstants{});
+      case IbuMethods::IbuFormula::mIbu   :
+         return mIbu   (parms.AArating, parms.hops_grams, parms.postBoilVolume_liters, parms.wortGravity_sg, parms.boilTime_minutes,
+                        MIbuKettleParms{parms.coolTime_minutes, parms.kettleInternalDiameter_cm, parms.kettleOpeningDiameter_cm});
+      case IbuMethods::IbuFormula::Smph   :
+         // See comment in IbuMethods.h
+         warnSmphNotImplemented();
+         return tinseth(parms.AArating, parms.hops_grams, parms.postBoilVolume_liters, parms.wortGravity_sg, parms.boilTime_minutes);
+   }
+   qCritical() <<
+      Q_FUNC_INFO << "Unrecognized IBU formula type:" << static_cast<int>(IbuMethods::ibuFormula) <<
+      ".  Defaulting to Tinseth.";
+   return tinseth(parms.AArating, parms.hops_grams, parms.postBoilVolume_liters, parms.wortGravity_sg, parms.boilTime_minutes);
+}
+
+void IbuMethods::getIbusBatch(IbuMethods::IbuBatchParms const & parms, std::span<double> const ibus) {
+   // It's a coding error to supply spans of different lengths
+   Q_ASSERT(parms.AArating        .size() == ibus.size());
+   Q_ASSERT(parms.hops_grams      .size() == ibus.size());
+   Q_ASSERT(parms.wortGravity_sg  .size() == ibus.size());
+   Q_ASSERT(parms.boilTime_minutes.size() == ibus.size());
+
+   switch(IbuMethods::ibuFormula) {
+      case IbuMethods::IbuFormula::Tinseth:
+         applyToBatch<tinseth>(parms, ibus);
+         return;
+      case IbuMethods::IbuFormula::Rager  :
+         applyToBatch<rager>(parms, ibus);
+         return;
+      case IbuMethods::IbuFormula::Noonan :
+         applyToBatch<noonan>(parms, ibus, NoonanConstants{});
+         return;
+      case IbuMethods::IbuFormula::mIbu   :
+         {
+            MIbuKettleParms const kettleParms{parms.coolTime_minutes,
+                                              parms.kettleInternalDiameter_cm,
+                                              parms.kettleOpeningDiameter_cm};
+            // The Tinseth part of mIBU vectorises nicely, and, if the wort is cooled at flameout, it's all there is.  So
+            // we do it as a separate pass and then add in the post-boil part only if we need to.
+            applyToBatch<tinseth>(parms, ibus);
+            if (kettleParms.coolTime_minutes > 0.0) {
+               for (std::size_t ii = 0; ii < ibus.size(); ++ii) {
+                  double const postBoilUtilization = IbuMethods::postBoilUtilization(parms.boilTime_minutes[ii],
+                                                                                     parms.wortGravity_sg[ii],
+                                                                                     parms.postBoilVolume_liters,
+                                                                                     kettleParms.coolTime_minutes,
+                                                                                     kettleParms.kettleInternalDiameter_cm,
+                                                                                     kettleParms.kettleOpeningDiameter_cm);
+                  ibus[ii] += (postBoilUtilization * parms.AArating[ii] * parms.hops_grams[ii] * 1000.0) /
+                              parms.postBoilVolume_liters;
+               }
+            }
+         }
+         return;
+      case IbuMethods::IbuFormula::Smph   :
+         // See comment in IbuMethods.h
+         warnSmphNotImplemented();
+         applyToBatch<tinseth>(parms, ibus);
+         return;
    }
    qCritical() <<
       Q_FUNC_INFO << "Unrecognized IBU formula type:" << static_cast<int>(IbuMethods::ibuFormula) <<
       ".  Defaulting to Tinseth.";
-   return tinseth(parms);
+   applyToBatch<tinseth>(parms, ibus);
+   return;
+}
+
+double IbuMethods::postBoilUtilization(double const boilTime_minutes,
+                                       double const wortGravity_sg,
+                                       double const postBoilVolume_liters,
+                                       double const coolTime_minutes,
+                                       double const kettleInternalDiameter_cm,
+                                       double const kettleOpeningDiameter_cm,
+                                       std::optional<PostBoilUtilizationMethod> const method) {
+   if (method.value_or(IbuMethods::postBoilUtilizationMethod) == IbuMethods::PostBoilUtilizationMethod::LookupTable) {
+      double const b = temperatureDecayRate(postBoilVolume_liters, kettleInternalDiameter_cm, kettleOpeningDiameter_cm);
+      std::optional<double> const result = PostBoilUtilizationTable::instance().postBoilUtilization(boilTime_minutes,
+                                                                                                    wortGravity_sg,
+                                                                                                    coolTime_minutes,
+                                                                                                    b);
+      if (result) {
+         return *result;
+      }
+      qCDebug(Logging::calcs) <<
+         Q_FUNC_INFO << "Cool time" << coolTime_minutes << "/ decay rate" << b << "outside lookup table range, so "
+         "integrating instead";
+   }
+   return computePostBoilUtilization(boilTime_minutes,
+                                     wortGravity_sg,
+                                     postBoilVolume_liters,
+                                     coolTime_minutes,
+                                     kettleInternalDiameter_cm,
+                                     kettleOpeningDiameter_cm);
 }
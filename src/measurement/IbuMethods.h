@@ -19,6 +19,9 @@
 #define MEASUREMENT_IBUMETHODS_H
 #pragma once
 
+#include <optional>
+#include <span>
+
 #include "utils/EnumStringMapping.h"
 
 class QString;
@@ -46,6 +49,8 @@ namespace IbuMethods {
       Rager  ,
       Noonan ,
       mIbu   ,
+      //! .:TBD:. Not yet implemented, as it needs more info than we have (eg oxidized alpha and beta acids, and pH).
+      //!         For now, \c getIbus and \c getIbusBatch use Tinseth instead (and log a warning).
       Smph   ,
    };
    // Note that we can't use the Q_ENUM macro here to allow storing the above enum class in a QVariant, because Q_ENUM
@@ -120,6 +125,61 @@ namespace IbuMethods {
     * \return IBUs according to selected algorithm.
     */
    double getIbus(IbuCalculationParms const & parms);
+
+   /**
+    * \brief Parameters for \c getIbusBatch.  Each span has one entry per hop addition, and they must all be the same
+    *        length.  The other fields are as for \c IbuCalculationParms and are shared by all the additions.
+    */
+   struct IbuBatchParms {
+      std::span<double const> AArating;
+      std::span<double const> hops_grams;
+      std::span<double const> wortGravity_sg;
+      std::span<double const> boilTime_minutes;
+      double postBoilVolume_liters;
+      std::optional<double> coolTime_minutes          = std::nullopt;
+      std::optional<double> kettleInternalDiameter_cm = std::nullopt;
+      std::optional<double> kettleOpeningDiameter_cm  = std::nullopt;
+   };
+
+   /**
+    * \brief Gives the same results as calling \c getIbus for each hop addition in turn, but looks at the selected
+    *        formula only once, and then runs a simple loop over the arrays that the compiler can vectorise.  This is
+    *        worth having when there are lots of hop additions -- eg when trying out many different hop schedules.
+    *
+    * \param parms
+    * \param ibus Receives the IBUs for each hop addition.  Must be the same length as the spans in \c parms.
+    */
+   void getIbusBatch(IbuBatchParms const & parms, std::span<double> const ibus);
+
+   /**
+    * \brief How the mIBU formula calculates the additional utilization of alpha acids after flameout.
+    *
+    *        \c Integration is the original method of integrating numerically over the cool time (in steps of 0.001
+    *        minutes).  \c LookupTable interpolates in a precomputed table and is several thousand times faster.  The
+    *        results of the two differ by at most \c postBoilUtilizationLookupTableMaxError (see comments in
+    *        IbuMethods.cpp for details).
+    */
+   enum class PostBoilUtilizationMethod {
+      Integration,
+      LookupTable,
+   };
+
+   extern PostBoilUtilizationMethod postBoilUtilizationMethod;
+
+   //! Maximum absolute difference between the decimal utilizations given by the two \c PostBoilUtilizationMethod
+   extern double const postBoilUtilizationLookupTableMaxError;
+
+   /**
+    * \brief Intermediate step of the mIBU formula, exposed for testing.  Returns the decimal alpha acid utilization
+    *        after flameout, using \c method if supplied, or \c postBoilUtilizationMethod otherwise.
+    */
+   double postBoilUtilization(double const boilTime_minutes,
+                              double const wortGravity_sg,
+                              double const postBoilVolume_liters,
+                              double const coolTime_minutes,
+                              double const kettleInternalDiameter_cm,
+                              double const kettleOpeningDiameter_cm,
+                              std::optional<PostBoilUtilizationMethod> const method = std::nullopt);
 }
 
 #endif
@@ -158,13 +158,8 @@ namespace InventoryTools {
    */
    template<IsInventory Inv, IsIngredient Ing>
    std::shared_ptr<Inv> firstInventory(Ing const & ing) {
-      auto ingredientId = ing.key();
-      auto result = ObjectStoreWrapper::findFirstMatching<Inv>(
-         [ingredientId](std::shared_ptr<Inv> inventory) {
-            return inventory->ingredientId() == ingredientId;
-         }
-      );
-      return result;
+      // The ObjectStore for each type of Inventory has a secondary index on ingredientId, so this is a quick lookup
+      return ObjectStoreWrapper::findFirstByIndex<Inv>(PropertyNames::Inventory::ingredientId, ing.key());
    }
 
    /**
@@ -197,6 +197,17 @@ QRegularExpression const & NamedEntity::getDuplicateNameNumberMatcher() {
    return duplicateNameNumberMatcher;
 }
 
+QString NamedEntity::nameWithoutDuplicateNumber(QString const & name) {
+   QRegularExpressionMatch match = NamedEntity::getDuplicateNameNumberMatcher().match(name);
+   if (!match.hasMatch()) {
+      return name;
+   }
+   // There's some integer in brackets at the end of the name.  Chop it off.
+   QString strippedName{name};
+   strippedName.truncate(match.capturedStart(1));
+   return strippedName;
+}
+
 
 // See https://zpz.github.io/blog/overloading-equality-operator-in-cpp-class-hierarchy/ (and cross-references to
 // http://www.gotw.ca/publications/mill18.htm) for good discussion on implementation of operator== in a class
@@ -226,15 +237,11 @@ bool NamedEntity::operator==(NamedEntity const & other) const {
       // "Tettnang" and another called "Tettnang (1)" we wouldn't say they are different just because of the names.
       // So we want to strip off any number in brackets at the ends of the names and then compare again.
       //
-      QRegularExpression const & duplicateNameNumberMatcher = NamedEntity::getDuplicateNameNumberMatcher();
-      QString names[2] {this->m_name, other.m_name};
-      for (auto ii = 0; ii < 2; ++ii) {
-         QRegularExpressionMatch match = duplicateNameNumberMatcher.match(names[ii]);
-         if (match.hasMatch()) {
-            // There's some integer in brackets at the end of the name.  Chop it off.
-            names[ii].truncate(match.capturedStart(1));
-         }
-      }
+      // NB: ObjectStore::findAllPossibleDuplicates() relies on names that are equal after this stripping being the only
+      // ones that can compare equal.
+      //
+      QString const names[2] {NamedEntity::nameWithoutDuplicateNumber(this->m_name),
+                              NamedEntity::nameWithoutDuplicateNumber(other.m_name)};
 //      qDebug() << Q_FUNC_INFO << "Adjusted names to " << names[0] << " & " << names[1];
       if (names[0] != names[1]) {
          return false;
@@ -259,6 +259,13 @@ public:
     */
    static QRegularExpression const & getDuplicateNameNumberMatcher();
 
+   /**
+    * \brief Returns the supplied name with any number in brackets on the end chopped off (see
+    *        \c getDuplicateNameNumberMatcher).  Two objects whose names differ only by such a number can still be equal
+    *        (see \c operator==), so this is the name to use as a key when looking for possible duplicates.
+    */
+   static QString nameWithoutDuplicateNumber(QString const & name);
+
    void setName(QString const & var);
    void setDeleted(bool const var);
    void setDisplay(bool const var);
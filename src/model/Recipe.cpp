@@ -24,8 +24,11 @@
  =====================================================================================================================*/
 #include "model/Recipe.h"
 
+#include <bitset>
 #include <cmath> // For pow/log
 #include <compare> //
+#include <span>
+#include <vector>
 
 #include <QDate>
 #include <QDebug>
@@ -38,6 +41,7 @@
 #include "database/ObjectStoreWrapper.h"
 #include "HeatCalculations.h"
 #include "Localization.h"
+#include "Logging.h"
 #include "measurement/Amount.h"
 #include "measurement/ColorMethods.h"
 #include "measurement/IbuMethods.h"
@@ -60,6 +64,7 @@
 #include "model/RecipeAdditionMisc.h"
 #include "model/RecipeAdjustmentSalt.h"
 #include "model/RecipeAdditionYeast.h"
+#include "model/RecipeCalc.h"
 #include "model/RecipeUseOfWater.h"
 #include "model/Salt.h"
 #include "model/Style.h"
@@ -183,15 +188,6 @@ namespace {
    template<> std::shared_ptr<Yeast      > copyIfNeeded(Yeast       & var) = delete;
    template<> std::shared_ptr<Salt       > copyIfNeeded(Salt        & var) = delete;
    template<> std::shared_ptr<Water      > copyIfNeeded(Water       & var) = delete;
-
-   bool isFermentableSugar(Fermentable * fermy) {
-      // TODO: This probably doesn't work in languages other than English!
-      if (fermy->type() == Fermentable::Type::Sugar && fermy->name() == "Milk Sugar (Lactose)") {
-         return false;
-      }
-
-      return true;
-   }
 }
 
 //
@@ -223,6 +219,35 @@ template<> BtStringConst const & Recipe::propertyNameFor<Water
 class Recipe::impl {
 public:
 
+   //
+   // See "Calculation Dependency Tracking" below for what these are about
+   //
+   enum class CalcNode : std::size_t {
+      Grains     ,
+      TotalPoints,
+      Volumes    ,
+      Color      ,
+      SrmColor   ,
+      Og         ,
+      Fg         ,
+      Abv        ,
+      BoilGrav   ,
+      Ibu        ,
+      Calories   ,
+      NumNodes
+   };
+
+   enum class CalcInput {
+      Fermentables,
+      Hops        ,
+      Yeasts      ,
+      Equipment   ,
+      Mash        ,
+      Boil        ,
+      BatchSize   ,
+      Efficiency
+   };
+
    /**
     * Constructor
     */
@@ -243,8 +268,13 @@ public:
       m_grainsInMash_kg      {0.0},
       m_grains_kg            {0.0},
       m_SRMColor             {},
-      m_og_fermentable       {0.0},
-      m_fg_fermentable       {0.0} {
+      m_originalGravity      {},
+      m_fg_fermentable       {0.0},
+      m_totalPoints          {},
+      m_dirtyCalcs           {},
+      m_recalcScheduled      {false} {
+      // Everything needs calculating to start with
+      this->m_dirtyCalcs.set();
       return;
    }
 
@@ -315,10 +345,18 @@ public:
       return;
    }
 
+   /**
+    * \brief Returns the supplied calculated member variable, first doing any calculations needed to bring it up to
+    *        date.
+    *
+    * \param node The calculation that sets \c memberVariable
+    */
    template<typename T>
-   T getCalculated(T & memberVariable) {
+   T getCalculated(CalcNode const node, T & memberVariable) {
       if (this->m_self.m_uninitializedCalcs) {
          this->m_self.recalcAll();
+      } else if (this->m_self.m_calcsEnabled) {
+         this->ensureCalculated(node);
       }
       return memberVariable;
    }
@@ -329,10 +367,9 @@ public:
     */
    template<class NE>
    QList<std::shared_ptr<NE>> allMy() const {
-      int const recipeId = this->m_self.key();
-      return ObjectStoreWrapper::findAllMatching<NE>([recipeId](std::shared_ptr<NE> ne) {
-                                                        return ne->recipeId() == recipeId;
-                                                     });
+      // NB: This relies on the ObjectStore for NE having a secondary index on recipeId -- see SECONDARY_INDEXES in
+      //     database/ObjectStoreTyped.cpp
+      return ObjectStoreWrapper::findAllByIndex<NE>(PropertyNames::OwnedByRecipe::recipeId, this->m_self.key());
    }
 
    /**
@@ -341,10 +378,7 @@ public:
     */
    template<class NE>
    QList<NE *> allMyRaw() const {
-      int const recipeId = this->m_self.key();
-      return ObjectStoreWrapper::findAllMatching<NE>([recipeId](NE const * ne) {
-                                                        return ne->recipeId() == recipeId;
-                                                     });
+      return ObjectStoreWrapper::findAllByIndexRaw<NE>(PropertyNames::OwnedByRecipe::recipeId, this->m_self.key());
    }
 
    /**
@@ -353,10 +387,7 @@ public:
     */
    template<class NE>
    QVector<int> allMyIds() const {
-      int const recipeId = this->m_self.key();
-      return ObjectStoreWrapper::idsOfAllMatching<NE>([recipeId](NE const * ne) {
-                                                         return ne->recipeId() == recipeId;
-                                                      });
+      return ObjectStoreWrapper::idsOfAllByIndex<NE>(PropertyNames::OwnedByRecipe::recipeId, this->m_self.key());
    }
 
    //
@@ -493,7 +524,8 @@ public:
       connect(val.get(), &NamedEntity::changed, &this->m_self, &Recipe::acceptChangeToContainedObject);
       emit this->m_self.changed(this->m_self.metaProperty(*property), QVariant::fromValue<NE *>(val.get()));
 
-      this->m_self.recalcAll();
+      // This will mark as dirty whatever calculations depend on the Equipment, Mash, etc
+      this->m_self.recalcIfNeeded(NE::staticMetaObject.className());
       return;
    }
 
@@ -971,6 +1003,138 @@ public:
       return ret;
    }
 
+   //========================================= Calculation Dependency Tracking =========================================
+   //
+   // Each calculated property (or, in a few cases, group of calculated properties that are worked out together) is a
+   // node in a small dependency graph.  Each node declares the other nodes and the "inputs" (ie things outside the
+   // calculations, such as the fermentable additions or the equipment) it depends on.  When an input changes, all we
+   // do straight away is mark the nodes that depend on it, directly or indirectly, as dirty.  Dirty nodes then get
+   // recalculated either when someone asks for one of their values (see getCalculated()) or, so that everything
+   // listening to our changed() signal gets told about the new values, the next time the event loop runs (see
+   // scheduleRecalc()), whichever comes first.
+   //
+   // So, eg, a change to a hop's alpha acid only recalculates IBU, and a change of yeast only recalculates FG, ABV and
+   // calories.
+   //
+   // NB: The order of CalcNode values (see top of class) must be the same as in calcNodeDefinitions() below, and must
+   //     be such that each node comes after all the nodes it depends on.
+   //
+   struct CalcNodeDefinition {
+      CalcNode               node;
+      void (impl::*          recalc)();
+      std::vector<CalcNode>  dependsOnNodes;
+      std::vector<CalcInput> dependsOnInputs;
+   };
+
+   static std::vector<CalcNodeDefinition> const & calcNodeDefinitions() {
+      static std::vector<CalcNodeDefinition> const definitions {
+         {CalcNode::Grains     , &impl::recalcGrains         , {}                                  , {CalcInput::Fermentables}},
+         {CalcNode::TotalPoints, &impl::recalcTotalPoints    , {}                                  , {CalcInput::Fermentables}},
+         {CalcNode::Volumes    , &impl::recalcVolumeEstimates, {CalcNode::Grains}                  , {CalcInput::Fermentables,
+                                                                                                      CalcInput::Equipment   ,
+                                                                                                      CalcInput::Mash        ,
+                                                                                                      CalcInput::Boil        ,
+                                                                                                      CalcInput::BatchSize   }},
+         {CalcNode::Color      , &impl::recalcColor_srm      , {CalcNode::Volumes}                 , {CalcInput::Fermentables}},
+         {CalcNode::SrmColor   , &impl::recalcSRMColor       , {CalcNode::Color}                   , {}},
+         {CalcNode::Og         , &impl::recalcOg             , {CalcNode::TotalPoints,
+                                                                CalcNode::Volumes}                 , {CalcInput::Equipment   ,
+                                                                                                      CalcInput::Efficiency  }},
+         {CalcNode::Fg         , &impl::recalcFg             , {CalcNode::Og}                      , {CalcInput::Yeasts      }},
+         {CalcNode::Abv        , &impl::recalcABV_pct        , {CalcNode::Og, CalcNode::Fg}        , {}},
+         {CalcNode::BoilGrav   , &impl::recalcBoilGrav       , {CalcNode::TotalPoints}             , {CalcInput::Efficiency  ,
+                                                                                                      CalcInput::Boil        }},
+         {CalcNode::Ibu        , &impl::recalcIBU            , {CalcNode::Volumes, CalcNode::Og}   , {CalcInput::Hops        ,
+                                                                                                      CalcInput::Fermentables,
+                                                                                                      CalcInput::Equipment   ,
+                                                                                                      CalcInput::Boil        ,
+                                                                                                      CalcInput::BatchSize   }},
+         {CalcNode::Calories   , &impl::recalcCalories       , {CalcNode::Og, CalcNode::Fg}        , {}},
+      };
+      // It's a coding error if the table above has got out of step with the CalcNode enum
+      Q_ASSERT(definitions.size() == static_cast<std::size_t>(CalcNode::NumNodes));
+      return definitions;
+   }
+
+   /**
+    * \brief Mark the specified node, and everything that depends on it, as needing recalculation
+    */
+   void markDirty(CalcNode const node) {
+      this->m_dirtyCalcs.set(static_cast<std::size_t>(node));
+      for (auto const & defn : calcNodeDefinitions()) {
+         if (!this->m_dirtyCalcs.test(static_cast<std::size_t>(defn.node)) &&
+             std::find(defn.dependsOnNodes.cbegin(), defn.dependsOnNodes.cend(), node) != defn.dependsOnNodes.cend()) {
+            this->markDirty(defn.node);
+         }
+      }
+      return;
+   }
+
+   /**
+    * \brief Mark everything that depends on the specified input as needing recalculation, and arrange for that
+    *        recalculation to happen.
+    */
+   void inputChanged(CalcInput const input) {
+      for (auto const & defn : calcNodeDefinitions()) {
+         if (std::find(defn.dependsOnInputs.cbegin(), defn.dependsOnInputs.cend(), input) != defn.dependsOnInputs.cend()) {
+            this->markDirty(defn.node);
+         }
+      }
+      this->scheduleRecalc();
+      return;
+   }
+
+   /**
+    * \brief If the specified node is dirty, recalculate it, after first recalculating anything it depends on that is
+    *        also dirty.
+    */
+   void ensureCalculated(CalcNode const node) {
+      auto const index = static_cast<std::size_t>(node);
+      if (!this->m_dirtyCalcs.test(index)) {
+         return;
+      }
+      auto const & defn = calcNodeDefinitions().at(index);
+      for (CalcNode const dependency : defn.dependsOnNodes) {
+         this->ensureCalculated(dependency);
+      }
+      // Clear the flag before we start so that, if something listening to a signal emitted during the calculation
+      // asks for one of this node's values, we just give it what we have rather than going round in circles.
+      this->m_dirtyCalcs.reset(index);
+      (this->*defn.recalc)();
+      return;
+   }
+
+   /**
+    * \brief Recalculate everything that is marked dirty
+    */
+   void ensureAllCalculated() {
+      for (auto const & defn : calcNodeDefinitions()) {
+         this->ensureCalculated(defn.node);
+      }
+      return;
+   }
+
+   /**
+    * \brief Arrange for \c Recipe::recalcDirty() to be called the next time the event loop runs.  Multiple calls before
+    *        then (eg because lots of additions are being changed in one go) result in only one recalculation.
+    */
+   void scheduleRecalc() {
+      if (this->m_recalcScheduled) {
+         return;
+      }
+      this->m_recalcScheduled = true;
+      QMetaObject::invokeMethod(
+         &this->m_self,
+         [this]() {
+            this->m_recalcScheduled = false;
+            this->m_self.recalcDirty();
+            return;
+         },
+         Qt::QueuedConnection
+      );
+      return;
+   }
+
    //============================================== Calculation Functions ==============================================
    /**
     * Emits changed(grains_kg), changed(grainsInMash_kg). Depends on: --.
@@ -997,7 +1161,7 @@ public:
       }
 
       if (!qFuzzyCompare(calculatedGrains_kg, this->m_grains_kg)) {
-         qDebug() <<
+         qCDebug(Logging::calcs) <<
             Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
             "Calculated weight of grains: " << calculatedGrains_kg << ", stored weight: " << this->m_grains_kg;
          this->m_grains_kg = calculatedGrains_kg;
@@ -1008,7 +1172,7 @@ public:
       }
 
       if (!qFuzzyCompare(calculatedGrainsInMash_kg, this->m_grainsInMash_kg)) {
-         qDebug() <<
+         qCDebug(Logging::calcs) <<
             Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
             "Calculated weight of grains in mash: " << calculatedGrainsInMash_kg << ", stored weight: " <<
             this->m_grainsInMash_kg;
@@ -1153,7 +1317,7 @@ public:
       }
 
       if (! qFuzzyCompare(calculatedPostBoilVolume_l, this->m_postBoilVolume_l)) {
-         qDebug() <<
+         qCDebug(Logging::calcs) <<
             Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
             "Calculated post boil volume: " << calculatedPostBoilVolume_l << ", stored: " << this->m_postBoilVolume_l;
          this->m_postBoilVolume_l = calculatedPostBoilVolume_l;
@@ -1173,8 +1337,9 @@ public:
 
       for (auto const & fermentableAddition : this->m_self.fermentableAdditions()) {
          if (fermentableAddition->amountIsWeight()) {
-            // Conversion factor for lb/gal to kg/l = 8.34538.
-            mcu += fermentableAddition->fermentable()->color_srm() * 8.34538 * fermentableAddition->amount().quantity / m_finalVolumeNoLosses_l;
+            mcu += RecipeCalc::maltColorUnits(fermentableAddition->fermentable()->color_srm(),
+                                              fermentableAddition->amount().quantity,
+                                              this->m_finalVolumeNoLosses_l);
          } else {
             // .:TBD:. What do do about liquids
             qWarning() <<
@@ -1212,12 +1377,57 @@ public:
    }
 
    /**
-    * Emits changed(og), changed(fg).
-    * Depends on: m_wortFromMash_l, m_finalVolume_l
+    * \brief Does the work for \c Recipe::calcTotalPoints() and \c recalcTotalPoints()
+    */
+   Recipe::Sugars computeTotalPoints() const {
+      Recipe::Sugars ret;
+
+      for (auto const & fermentableAddition : this->m_self.fermentableAdditions()) {
+         auto const & fermentable = fermentableAddition->fermentable();
+         qCDebug(Logging::calcs) <<
+            "calcTotalPoints Rec" << this->m_self.key() << "(" << this->m_self.name() << ") "
+            "Ferm Add" << fermentable->key() << "(" << fermentable->name() << ") equivSucrose_kg" <<
+            fermentableAddition->equivSucrose_kg() << ", isSugar?" << fermentable->isSugar() << ", isExtract?" <<
+            fermentable->isExtract() << ", addAfterBoil?" <<
+            fermentableAddition->addAfterBoil() << ", isFermentableSugar?" <<
+            RecipeCalc::isFermentableSugar(*fermentable);
+
+         // If we have some sort of non-grain, we have to ignore efficiency.
+         if (fermentable->isSugar() || fermentable->isExtract()) {
+            ret.sugar_kg_ignoreEfficiency += fermentableAddition->equivSucrose_kg();
+
+            if (fermentableAddition->addAfterBoil()) {
+               ret.lateAddition_kg_ignoreEff += fermentableAddition->equivSucrose_kg();
+            }
+
+            if (!RecipeCalc::isFermentableSugar(*fermentable)) {
+               ret.nonFermentableSugars_kg += fermentableAddition->equivSucrose_kg();
+            }
+         } else {
+            ret.sugar_kg += fermentableAddition->equivSucrose_kg();
+
+            if (fermentableAddition->addAfterBoil()) {
+               ret.lateAddition_kg += fermentableAddition->equivSucrose_kg();
+            }
+         }
+      }
+
+      return ret;
+   }
+
+   /**
+    * Sets m_totalPoints. Depends on: --.
     */
-   void recalcOgFg() {
+   void recalcTotalPoints() {
+      this->m_totalPoints = this->computeTotalPoints();
+      return;
+   }
 
-      this->m_og_fermentable = this->m_fg_fermentable = 0.0;
+   /**
+    * Emits changed(og).
+    * Depends on: m_totalPoints, m_wortFromMash_l, m_finalVolume_l
+    */
+   void recalcOg() {
 
       // The first time through really has to get the m_og and m_fg from the
       // database, not use the initialized values of 1. I (maf) tried putting
@@ -1229,94 +1439,26 @@ public:
       // to calculate.
       if (this->m_self.m_uninitializedCalcs) {
          this->m_self.m_og = Localization::toDouble(this->m_self, PropertyNames::Recipe::og, Q_FUNC_INFO);
-         this->m_self.m_fg = Localization::toDouble(this->m_self, PropertyNames::Recipe::fg, Q_FUNC_INFO);
       }
 
-      // Find out how much sugar we have.
-      auto const sugars = this->m_self.calcTotalPoints();
-      double sugar_kg                  = sugars.sugar_kg;  // Mass of sugar that *is* affected by mash efficiency
-      double sugar_kg_ignoreEfficiency = sugars.sugar_kg_ignoreEfficiency;  // Mass of sugar that *is not* affected by mash efficiency
-      double nonFermentableSugars_kg   = sugars.nonFermentableSugars_kg;  // Mass of sugar that is not fermentable (also counted in sugar_kg_ignoreEfficiency)
-
-      // Uncomment for diagnosing problems with calculations
-//      qDebug() <<
-//         Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
-//         "sugar_kg: " << sugar_kg << ", sugar_kg_ignoreEfficiency: " << sugar_kg_ignoreEfficiency <<
-//         ", nonFermentableSugars_kg:" << nonFermentableSugars_kg;
-
       // We might lose some sugar in the form of Trub/Chiller loss and lauter deadspace.
       auto equipment = this->m_self.equipment();
-      if (equipment) {
-         double const kettleWort_l = (this->m_wortFromMash_l - equipment->getLauteringDeadspaceLoss_l()) +
-                                     equipment->topUpKettle_l().value_or(Equipment::default_topUpKettle_l);
-         double const postBoilWort_l = equipment->wortEndOfBoil_l(kettleWort_l);
-         double ratio = (postBoilWort_l - equipment->kettleTrubChillerLoss_l()) / postBoilWort_l;
-         if (ratio > 1.0) { // Usually happens when we don't have a mash yet.
-            ratio = 1.0;
-         } else if (ratio < 0.0) {
-            ratio = 0.0;
-         } else if (Algorithms::isNan(ratio)) {
-            ratio = 1.0;
-         }
-         // Ignore this again since it should be included in efficiency.
-         //sugar_kg *= ratio;
-         sugar_kg_ignoreEfficiency *= ratio;
-         if (nonFermentableSugars_kg != 0.0) {
-            nonFermentableSugars_kg *= ratio;
-         }
-      }
-
-      // Total sugars after accounting for efficiency and mash losses. Implicitly includes non-fermentable sugars
-      sugar_kg = sugar_kg * this->m_self.efficiency_pct() / 100.0 + sugar_kg_ignoreEfficiency;
-      double plato = Algorithms::getPlato(sugar_kg, this->m_finalVolumeNoLosses_l);
-
-      double calculatedOg = Algorithms::PlatoToSG_20C20C(plato);    // og from all sugars
-      double tmp_pnts = (calculatedOg - 1) * 1000.0; // points from all sugars
-      double tmp_nonferm_pnts;
-      if (nonFermentableSugars_kg != 0.0) {
-         double ferm_kg = sugar_kg - nonFermentableSugars_kg;  // Mass of only fermentable sugars
-         plato = Algorithms::getPlato(ferm_kg, this->m_finalVolumeNoLosses_l);   // Plato from fermentable sugars
-         this->m_og_fermentable = Algorithms::PlatoToSG_20C20C(plato);    // og from only fermentable sugars
-         plato = Algorithms::getPlato(nonFermentableSugars_kg, this->m_finalVolumeNoLosses_l);   // Plate from non-fermentable sugars
-         tmp_nonferm_pnts = ((Algorithms::PlatoToSG_20C20C(plato)) - 1) * 1000.0; // og points from non-fermentable sugars
-      } else {
-         this->m_og_fermentable = calculatedOg;
-         tmp_nonferm_pnts = 0.0;
-      }
-
-      // Calculage FG
-      double attenuation_pct = 0.0;
-      for (auto yeastAddition : this->m_self.yeastAdditions()) {
-         // Get the yeast with the greatest attenuation.
-         if (yeastAddition->attenuation_pct() > attenuation_pct) {
-            attenuation_pct = yeastAddition->yeast()->attenuationTypical_pct();
-         }
-      }
-      // This means we have yeast, but they neglected to provide attenuation percentages.
-      if (this->m_self.yeastAdditions().size() > 0 && attenuation_pct <= 0.0)  {
-         attenuation_pct = Yeast::DefaultAttenuation_pct; // Use an average attenuation.
-      }
-
-      double calculatedFg;
-      if (nonFermentableSugars_kg != 0.0) {
-         double tmp_ferm_pnts = (tmp_pnts - tmp_nonferm_pnts) * (1.0 - attenuation_pct / 100.0); // fg points from fermentable sugars
-         tmp_pnts = tmp_ferm_pnts + tmp_nonferm_pnts;  // FG points from both fermentable and non-fermentable sugars
-         //tmp_pnts *= (1.0 - attenuation_pct/100.0);  // WTF, this completely ignores all the calculations about non-fermentable sugars and just converts everything!
-         calculatedFg =  1 + tmp_pnts / 1000.0; // new FG value
-         this->m_fg_fermentable =  1 + tmp_ferm_pnts / 1000.0; // FG from fermentables only
-      } else {
-         tmp_pnts *= (1.0 - attenuation_pct / 100.0);
-         calculatedFg =  1 + tmp_pnts / 1000.0;
-         this->m_fg_fermentable = calculatedFg;
-      }
+      double const sugarRetention =
+         equipment ? RecipeCalc::sugarRetention(*equipment, this->m_wortFromMash_l) : 1.0;
+
+      this->m_originalGravity = RecipeCalc::originalGravity(
+         this->m_totalPoints.sugar_kg,
+         this->m_totalPoints.sugar_kg_ignoreEfficiency,
+         this->m_totalPoints.nonFermentableSugars_kg,
+         sugarRetention,
+         this->m_self.efficiency_pct(),
+         this->m_finalVolumeNoLosses_l
+      );
 
-      // Uncomment for diagnosing problems with calculations
-//      qDebug() <<
-//         Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
-//         "m_og_fermentable: " << m_og_fermentable << ", m_fg_fermentable: " << m_fg_fermentable;
+      double const calculatedOg = this->m_originalGravity.og;
 
       if (!qFuzzyCompare(this->m_self.m_og, calculatedOg)) {
-         qDebug() <<
+         qCDebug(Logging::calcs) <<
             Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
             "Calculated OG: " << calculatedOg << ", stored: " << this->m_self.m_og;
          this->m_self.m_og = calculatedOg;
@@ -1334,9 +1476,37 @@ public:
             emit this->m_self.changed(this->m_self.metaProperty(*PropertyNames::Recipe::points), (this->m_self.m_og - 1.0) * 1e3);
          }
       }
+      return;
+   }
+
+   /**
+    * Emits changed(fg).
+    * Depends on: m_originalGravity, yeast additions
+    */
+   void recalcFg() {
+
+      // See comment in recalcOg()
+      if (this->m_self.m_uninitializedCalcs) {
+         this->m_self.m_fg = Localization::toDouble(this->m_self, PropertyNames::Recipe::fg, Q_FUNC_INFO);
+      }
+
+      // Calculate FG
+      auto const yeastAdditions = this->m_self.yeastAdditions();
+      std::vector<double> additionAttenuation_pct;
+      std::vector<double> typicalAttenuation_pct;
+      for (auto const & yeastAddition : yeastAdditions) {
+         additionAttenuation_pct.push_back(yeastAddition->attenuation_pct().value_or(0.0));
+         typicalAttenuation_pct .push_back(yeastAddition->yeast()->attenuationTypical_pct());
+      }
+      RecipeCalc::FinalGravity const finalGravity = RecipeCalc::finalGravity(
+         this->m_originalGravity,
+         RecipeCalc::attenuation_pct(additionAttenuation_pct, typicalAttenuation_pct)
+      );
+      double const calculatedFg = finalGravity.fg;
+      this->m_fg_fermentable = finalGravity.fg_fermentable;
 
       if (!qFuzzyCompare(this->m_self.m_fg, calculatedFg)) {
-         qDebug() <<
+         qCDebug(Logging::calcs) <<
             Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
             "Calculated FG: " << calculatedFg << ", stored: " << this->m_self.m_fg;
          this->m_self.m_fg = calculatedFg;
@@ -1353,14 +1523,10 @@ public:
     * Emits changed(ABV_pct). Depends on: m_og, m_fg
     */
    void recalcABV_pct() {
-      // The complex formula, and variations comes from Ritchie Products Ltd, (Zymurgy, Summer 1995, vol. 18, no. 2)
-      // Michael L. Hall’s article Brew by the Numbers: Add Up What’s in Your Beer, and Designing Great Beers by Daniels.
-      double calculatedABV_pct =
-         (76.08 * (this->m_og_fermentable - this->m_fg_fermentable) / (1.775 - this->m_og_fermentable)) *
-         (this->m_fg_fermentable / 0.794);
+      double calculatedABV_pct = RecipeCalc::abv_pct(this->m_originalGravity.og_fermentable, this->m_fg_fermentable);
 
       if (!qFuzzyCompare(calculatedABV_pct, m_ABV_pct)) {
-         qDebug() <<
+         qCDebug(Logging::calcs) <<
             Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
             "Calculated ABV: " << calculatedABV_pct << ", stored: " << this->m_ABV_pct;
          this->m_ABV_pct = calculatedABV_pct;
@@ -1372,10 +1538,10 @@ public:
    }
 
    /**
-    * Emits changed(boilGrav). Depends on: _postBoilVolume_l, _boilVolume_l
+    * Emits changed(boilGrav). Depends on: m_totalPoints
     */
    void recalcBoilGrav() {
-      auto const sugars = this->m_self.calcTotalPoints();
+      auto const & sugars = this->m_totalPoints;
       double sugar_kg                  = sugars.sugar_kg;
       double sugar_kg_ignoreEfficiency = sugars.sugar_kg_ignoreEfficiency;
       double lateAddition_kg           = sugars.lateAddition_kg;
@@ -1389,7 +1555,7 @@ public:
       double calculatedBoilGrav = Algorithms::PlatoToSG_20C20C(Algorithms::getPlato(sugar_kg,
                                                                                     this->boilSizeInLitersOr(0.0)));
       if (! qFuzzyCompare(calculatedBoilGrav, this->m_boilGrav)) {
-         qDebug() <<
+         qCDebug(Logging::calcs) <<
             Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
             "Calculated Boil Grav: " << calculatedBoilGrav << ", stored: " << this->m_boilGrav;
          this->m_boilGrav = calculatedBoilGrav;
@@ -1400,6 +1566,13 @@ public:
       return;
    }
 
+   RecipeCalc::HopIbuSettings hopIbuSettings() const {
+      return RecipeCalc::hopIbuSettings(this->m_self.equipment().get(),
+                                        this->m_self.boil().get(),
+                                        RecipeCalc::firstWortHopAdjustment(),
+                                        RecipeCalc::mashHopAdjustment());
+   }
+
    /**
     * Emits changed(IBU). Depends on: _batchSize_l, _boilGrav, _boilVolume_l, _finalVolume_l
     */
@@ -1408,20 +1581,34 @@ public:
 
       // Bitterness due to hops...
       //
-      // Note that, normally, we don't want to take a reference to a smart pointer.  However, in this context, it's safe
-      // (because the hop additions aren't going to change while we look at them) and it gets rid of a compiler warning.
-      this->m_ibus.clear();
-      for (auto const & hopAddition : this->m_self.hopAdditions()) {
-         double tmp = this->m_self.ibuFromHopAddition(*hopAddition);
-         this->m_ibus.append(tmp);
-         calculatedIbu += tmp;
-      }
+      // We gather up the inputs for all the hop additions and then do the IBU calculations in one batch, which is
+      // quicker than going through IbuMethods::getIbus() for each addition in turn.
+      //
+      auto const hopAdditions = this->m_self.hopAdditions();
+      RecipeCalc::HopIbuSettings const settings = this->hopIbuSettings();
+      std::vector<RecipeCalc::HopIbuInputs> inputs;
+      inputs.reserve(static_cast<std::size_t>(hopAdditions.size()));
+      for (auto const & hopAddition : hopAdditions) {
+         inputs.push_back(RecipeCalc::hopIbuInputs(*hopAddition, settings));
+      }
+      this->m_ibus.resize(hopAdditions.size());
+      std::span<double> const perAdditionIbus{this->m_ibus.data(), static_cast<std::size_t>(this->m_ibus.size())};
+      RecipeCalc::HopIbusScratch scratch;
+      calculatedIbu += RecipeCalc::hopIbus(inputs,
+                                           this->m_self.m_og,
+                                           this->m_finalVolumeNoLosses_l,
+                                           settings,
+                                           scratch,
+                                           perAdditionIbus);
 
       // Bitterness due to hopped extracts...
       for (auto const & fermentableAddition : this->m_self.fermentableAdditions()) {
          if (fermentableAddition->amountIsWeight()) {
-            // Conversion factor for lb/gal to kg/l = 8.34538.
-            calculatedIbu += fermentableAddition->fermentable()->ibuGalPerLb().value_or(0.0) * (fermentableAddition->amount().quantity / this->m_self.batchSize_l()) / 8.34538;
+            calculatedIbu += RecipeCalc::hoppedExtractIbus(
+               fermentableAddition->fermentable()->ibuGalPerLb().value_or(0.0),
+               fermentableAddition->amount().quantity,
+               this->m_self.batchSize_l()
+            );
          } else {
             // .:TBD:. What do do about liquids
             qWarning() <<
@@ -1431,7 +1618,7 @@ public:
       }
 
       if (! qFuzzyCompare(calculatedIbu, this->m_IBU)) {
-         qDebug() <<
+         qCDebug(Logging::calcs) <<
             Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
             "Calculated IBU: " << calculatedIbu << ", stored: " << this->m_IBU;
          this->m_IBU = calculatedIbu;
@@ -1490,7 +1677,7 @@ public:
       }
 
       if (!qFuzzyCompare(calculatedCaloriesPerLiter, this->m_caloriesPerLiter)) {
-         qDebug() <<
+         qCDebug(Logging::calcs) <<
             Q_FUNC_INFO << "Recipe #" << this->m_self.key() << "(" << this->m_self.name() << ") "
             "Calculated calories/liter: " << calculatedCaloriesPerLiter << ", stored: " << this->m_caloriesPerLiter;
          this->m_caloriesPerLiter = calculatedCaloriesPerLiter;
@@ -1523,8 +1710,14 @@ public:
    double        m_grainsInMash_kg      ;
    double        m_grains_kg            ;
    QColor        m_SRMColor             ;
-   double        m_og_fermentable       ;
+   // Result of recalcOg(), including the split between fermentable and non-fermentable sugars needed by recalcFg()
+   RecipeCalc::OriginalGravity m_originalGravity;
    double        m_fg_fermentable       ;
+   Recipe::Sugars m_totalPoints         ;
+
+   // Which calculations are out of date (indexed by CalcNode), and whether we have asked for them to be redone
+   std::bitset<static_cast<std::size_t>(CalcNode::NumNodes)> m_dirtyCalcs;
+   bool          m_recalcScheduled      ;
 
 };
 
@@ -2404,10 +2597,10 @@ void Recipe::setBatchSize_l(double var) {
                       this->m_batchSize_l,
                       this->enforceMin(var, "batch size"));
 
-   // NOTE: this is bad, but we have to call recalcAll(), because the estimated
-   // boil/batch volumes depend on the target volumes when there are no mash
-   // steps to actually provide an estimate for the volumes.
-   recalcAll();
+   // The estimated boil/batch volumes depend on the target volumes when there are no mash steps to actually provide
+   // an estimate for the volumes, so pretty much everything needs recalculating.
+   this->pimpl->inputChanged(impl::CalcInput::BatchSize);
+   return;
 }
 
 void Recipe::setEfficiency_pct(double val) {
@@ -2415,10 +2608,9 @@ void Recipe::setEfficiency_pct(double val) {
                       this->m_efficiency_pct,
                       this->enforceMinAndMax(val, "efficiency", 0.0, 100.0, 70.0));
 
-   // If you change the efficency, you really should recalc. And I'm afraid it
-   // means recalc all, since og and fg will change, which means your ratios
-   // change
-   recalcAll();
+   // If you change the efficency, og and fg will change, which means your ratios change
+   this->pimpl->inputChanged(impl::CalcInput::Efficiency);
+   return;
 }
 
 void Recipe::setAsstBrewer(const QString & val) {
@@ -2540,7 +2732,21 @@ bool Recipe::isMyAncestor(Recipe const & maybe) const {
 }
 
 bool Recipe::hasDescendants() const {
-   return this->m_hasDescendants;
+   if (this->m_hasDescendants) {
+      return true;
+   }
+   //
+   // m_hasDescendants is not stored in the DB, and only gets set as a side effect of something asking for ancestors, so
+   // it's not enough on its own -- eg straight after start-up, when no Recipe has yet been asked for its ancestors.  So
+   // we also look for any other Recipe whose immediate ancestor we are.  (A Recipe without ancestors has itself as its
+   // ancestor, so we need to skip ourselves.)
+   //
+   for (int const id : ObjectStoreWrapper::idsOfAllByIndex<Recipe>(PropertyNames::Recipe::ancestorId, this->key())) {
+      if (id != this->key()) {
+         return true;
+      }
+   }
+   return false;
 }
 void Recipe::setHasDescendants(bool spawned) {
    // This is not explicitly stored in the database, so no setAndNotify call etc here
@@ -2587,7 +2793,9 @@ void Recipe::setAncestor(Recipe & ancestor) {
          // Give our existing ancestors them to the new direct ancestor (aka immediate prior version).  Note that it's
          // a coding error if this new direct ancestor already has its own ancestors.
          Q_ASSERT(ancestor.m_ancestor_id == ancestor.key() || ancestor.m_ancestor_id <= 0);
-         ancestor.m_ancestor_id = this->m_ancestor_id;
+         // As in setKey(), we want this stored in the DB (and in the ObjectStore's index of ancestor IDs, which
+         // hasDescendants() relies on) but we don't want to signal the UI about it.
+         ancestor.setAncestorId(this->m_ancestor_id, false);
          ancestor.m_ancestors = this->ancestors();
       }
    }
@@ -2629,14 +2837,14 @@ Recipe * Recipe::revertToPreviousVersion() {
 
 //==========================Calculated Getters============================
 
-double        Recipe::og              () { return this->pimpl->getCalculated(this->m_og); }
-double        Recipe::fg              () { return this->pimpl->getCalculated(this->m_fg); }
-double        Recipe::color_srm       () { return this->pimpl->getCalculated(this->pimpl->m_color_srm       ); }
-double        Recipe::ABV_pct         () { return this->pimpl->getCalculated(this->pimpl->m_ABV_pct         ); }
-double        Recipe::IBU             () { return this->pimpl->getCalculated(this->pimpl->m_IBU             ); }
-QList<double> Recipe::IBUs            () { return this->pimpl->getCalculated(this->pimpl->m_ibus            ); }
-double        Recipe::boilGrav        () { return this->pimpl->getCalculated(this->pimpl->m_boilGrav        ); }
-double        Recipe::caloriesPerLiter() { return this->pimpl->getCalculated(this->pimpl->m_caloriesPerLiter); }
+double        Recipe::og              () { return this->pimpl->getCalculated(impl::CalcNode::Og, this->m_og); }
+double        Recipe::fg              () { return this->pimpl->getCalculated(impl::CalcNode::Fg, this->m_fg); }
+double        Recipe::color_srm       () { return this->pimpl->getCalculated(impl::CalcNode::Color, this->pimpl->m_color_srm       ); }
+double        Recipe::ABV_pct         () { return this->pimpl->getCalculated(impl::CalcNode::Abv, this->pimpl->m_ABV_pct         ); }
+double        Recipe::IBU             () { return this->pimpl->getCalculated(impl::CalcNode::Ibu, this->pimpl->m_IBU             ); }
+QList<double> Recipe::IBUs            () { return this->pimpl->getCalculated(impl::CalcNode::Ibu, this->pimpl->m_ibus            ); }
+double        Recipe::boilGrav        () { return this->pimpl->getCalculated(impl::CalcNode::BoilGrav, this->pimpl->m_boilGrav        ); }
+double        Recipe::caloriesPerLiter() { return this->pimpl->getCalculated(impl::CalcNode::Calories, this->pimpl->m_caloriesPerLiter); }
 double        Recipe::caloriesPer33cl  () { return this->caloriesPerLiter() * 0.33          ; }
 double        Recipe::caloriesPerUs12oz() {
    static double const us12ozInLiters = Measurement::Units::us_fluidOunces.toCanonical(12.0).quantity;
@@ -2646,13 +2854,13 @@ double        Recipe::caloriesPerUsPint() {
    static double const usPintInLiters = Measurement::Units::us_fluidOunces.toCanonical(16.0).quantity;
    return this->caloriesPerLiter() * usPintInLiters;
 }
-double        Recipe::wortFromMash_l  () { return this->pimpl->getCalculated(this->pimpl->m_wortFromMash_l  );}
-double        Recipe::boilVolume_l    () { return this->pimpl->getCalculated(this->pimpl->m_boilVolume_l    );}
-double        Recipe::postBoilVolume_l() { return this->pimpl->getCalculated(this->pimpl->m_postBoilVolume_l);}
-double        Recipe::finalVolume_l   () { return this->pimpl->getCalculated(this->pimpl->m_finalVolume_l   );}
-QColor        Recipe::SRMColor        () { return this->pimpl->getCalculated(this->pimpl->m_SRMColor        );}
-double        Recipe::grainsInMash_kg () { return this->pimpl->getCalculated(this->pimpl->m_grainsInMash_kg );}
-double        Recipe::grains_kg       () { return this->pimpl->getCalculated(this->pimpl->m_grains_kg       );}
+double        Recipe::wortFromMash_l  () { return this->pimpl->getCalculated(impl::CalcNode::Volumes, this->pimpl->m_wortFromMash_l  );}
+double        Recipe::boilVolume_l    () { return this->pimpl->getCalculated(impl::CalcNode::Volumes, this->pimpl->m_boilVolume_l    );}
+double        Recipe::postBoilVolume_l() { return this->pimpl->getCalculated(impl::CalcNode::Volumes, this->pimpl->m_postBoilVolume_l);}
+double        Recipe::finalVolume_l   () { return this->pimpl->getCalculated(impl::CalcNode::Volumes, this->pimpl->m_finalVolume_l   );}
+QColor        Recipe::SRMColor        () { return this->pimpl->getCalculated(impl::CalcNode::SrmColor, this->pimpl->m_SRMColor        );}
+double        Recipe::grainsInMash_kg () { return this->pimpl->getCalculated(impl::CalcNode::Grains, this->pimpl->m_grainsInMash_kg );}
+double        Recipe::grains_kg       () { return this->pimpl->getCalculated(impl::CalcNode::Grains, this->pimpl->m_grains_kg       );}
 
 double Recipe::points() {
    return (this->og() - 1.0) * 1e3;
@@ -2698,12 +2906,7 @@ QVector<int> Recipe::getInstructionIds() const {
 QList<BrewNote *> Recipe::brewNotes() const {
    // The Recipe owns its BrewNotes, but, for the moment at least, it's the BrewNote that knows which Recipe it's in
    // rather than the Recipe which knows which BrewNotes it has, so we have to ask.
-   int const recipeId = this->key();
-   return ObjectStoreTyped<BrewNote>::getInstance().findAllMatching(
-      [recipeId](BrewNote const * bn) {
-         return bn->recipeId() == recipeId;
-      }
-   );
+   return this->pimpl->allMyRaw<BrewNote>();
 }
 
 template<typename NE> QList< std::shared_ptr<NE> > Recipe::getAll() const {
@@ -2767,25 +2970,40 @@ void Recipe::recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged) {
    qDebug() << Q_FUNC_INFO << classNameOfWhatWasAddedOrChanged;
    // We could just compare with "Hop", "Equipment", etc but there's then no compile-time checking of typos.  Using
    // ::staticMetaObject.className() is a bit more clunky but it's safer.
+   //
+   // Note that we don't do any calculations here -- we just mark the ones that are affected by the change as needing
+   // to be redone.  See comments in Recipe::impl about calculation dependency tracking.
 
    if (classNameOfWhatWasAddedOrChanged ==               Hop::staticMetaObject.className() ||
        classNameOfWhatWasAddedOrChanged == RecipeAdditionHop::staticMetaObject.className()) {
-      this->pimpl->recalcIBU();
+      this->pimpl->inputChanged(impl::CalcInput::Hops);
       return;
    }
 
-   if (classNameOfWhatWasAddedOrChanged ==                 Equipment::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged ==               Fermentable::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged == RecipeAdditionFermentable::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged ==                      Mash::staticMetaObject.className()) {
-      this->recalcAll();
+   if (classNameOfWhatWasAddedOrChanged ==               Fermentable::staticMetaObject.className() ||
+       classNameOfWhatWasAddedOrChanged == RecipeAdditionFermentable::staticMetaObject.className()) {
+      this->pimpl->inputChanged(impl::CalcInput::Fermentables);
       return;
    }
 
    if (classNameOfWhatWasAddedOrChanged ==               Yeast::staticMetaObject.className() ||
        classNameOfWhatWasAddedOrChanged == RecipeAdditionYeast::staticMetaObject.className()) {
-      this->pimpl->recalcOgFg();
-      this->pimpl->recalcABV_pct();
+      this->pimpl->inputChanged(impl::CalcInput::Yeasts);
+      return;
+   }
+
+   if (classNameOfWhatWasAddedOrChanged == Equipment::staticMetaObject.className()) {
+      this->pimpl->inputChanged(impl::CalcInput::Equipment);
+      return;
+   }
+
+   if (classNameOfWhatWasAddedOrChanged == Mash::staticMetaObject.className()) {
+      this->pimpl->inputChanged(impl::CalcInput::Mash);
+      return;
+   }
+
+   if (classNameOfWhatWasAddedOrChanged == Boil::staticMetaObject.className()) {
+      this->pimpl->inputChanged(impl::CalcInput::Boil);
       return;
    }
 
@@ -2810,16 +3028,8 @@ void Recipe::recalcAll() {
       return;
    }
 
-   // Times are in seconds, and are cumulative.
-   this->pimpl->recalcGrains(); // 0.03
-   this->pimpl->recalcVolumeEstimates(); // 0.06
-   this->pimpl->recalcColor_srm(); // 0.08
-   this->pimpl->recalcSRMColor(); // 0.08
-   this->pimpl->recalcOgFg(); // 0.11
-   this->pimpl->recalcABV_pct(); // 0.12
-   this->pimpl->recalcBoilGrav(); // 0.14
-   this->pimpl->recalcIBU(); // 0.15
-   this->pimpl->recalcCalories();
+   this->pimpl->m_dirtyCalcs.set();
+   this->pimpl->ensureAllCalculated();
 
    this->m_uninitializedCalcs = false;
 
@@ -2827,42 +3037,43 @@ void Recipe::recalcAll() {
    return;
 }
 
-// Other efficiency calculations need access to the maximum theoretical sugars
-// available. The only way I can see of doing that which doesn't suck is to
-// split that calculation out of recalcOgFg();
-Recipe::Sugars Recipe::calcTotalPoints() {
-   Recipe::Sugars ret;
+bool Recipe::ensureCalculationsDone() {
+   this->recalcDirty();
+   // If calculations are disabled, getCalculated() just returns the stored values, so nothing is pending
+   return !this->m_calcsEnabled || (!this->m_uninitializedCalcs && this->pimpl->m_dirtyCalcs.none());
+}
 
-   for (auto const & fermentableAddition : this->fermentableAdditions()) {
-      auto const & fermentable = fermentableAddition->fermentable();
-      qDebug() <<
-         "calcTotalPoints Rec" << this->key() << "(" << this->name() << ") "
-         "Ferm Add" << fermentable->key() << "(" << fermentable->name() << ") equivSucrose_kg" <<
-         fermentableAddition->equivSucrose_kg() << ", isSugar?" << fermentable->isSugar() << ", isExtract?" <<
-         fermentable->isExtract() << ", addAfterBoil?" <<
-         fermentableAddition->addAfterBoil() << ", isFermentableSugar?" << isFermentableSugar(fermentable);
-
-      // If we have some sort of non-grain, we have to ignore efficiency.
-      if (fermentable->isSugar() || fermentable->isExtract()) {
-         ret.sugar_kg_ignoreEfficiency += fermentableAddition->equivSucrose_kg();
-
-         if (fermentableAddition->addAfterBoil()) {
-            ret.lateAddition_kg_ignoreEff += fermentableAddition->equivSucrose_kg();
-         }
+void Recipe::recalcDirty() {
+   if (!this->m_calcsEnabled) {
+      // Nothing gets cleared, so everything that is dirty will get recalculated when calculations are re-enabled
+      return;
+   }
 
-         if (!isFermentableSugar(fermentable)) {
-            ret.nonFermentableSugars_kg += fermentableAddition->equivSucrose_kg();
-         }
-      } else {
-         ret.sugar_kg += fermentableAddition->equivSucrose_kg();
+   // If we haven't yet done the initial calculations, we need to do everything
+   if (this->m_uninitializedCalcs) {
+      this->recalcAll();
+      return;
+   }
 
-         if (fermentableAddition->addAfterBoil()) {
-            ret.lateAddition_kg += fermentableAddition->equivSucrose_kg();
-         }
-      }
+   // Same logic as in recalcAll()
+   if (!this->m_recalcMutex.tryLock()) {
+      return;
    }
 
-   return ret;
+   this->pimpl->ensureAllCalculated();
+
+   this->m_recalcMutex.unlock();
+   return;
+}
+
+// Other efficiency calculations need access to the maximum theoretical sugars
+// available. The only way I can see of doing that which doesn't suck is to
+// split that calculation out of recalcOg();
+Recipe::Sugars Recipe::calcTotalPoints() {
+   if (!this->m_calcsEnabled) {
+      return this->pimpl->computeTotalPoints();
+   }
+   return this->pimpl->getCalculated(impl::CalcNode::TotalPoints, this->pimpl->m_totalPoints);
 }
 
 
@@ -2870,99 +3081,26 @@ Recipe::Sugars Recipe::calcTotalPoints() {
 //====================================Helpers===========================================
 
 double Recipe::ibuFromHopAddition(RecipeAdditionHop const & hopAddition) {
-   auto equipment = this->equipment();
-   double ibus = 0.0;
-   double fwhAdjust = Localization::toDouble(
-      PersistentSettings::value(PersistentSettings::Names::firstWortHopAdjustment, 1.1).toString(),
-      Q_FUNC_INFO
-   );
-   double mashHopAdjust = Localization::toDouble(
-      PersistentSettings::value(PersistentSettings::Names::mashHopAdjustment, 0).toString(),
-      Q_FUNC_INFO
-   );
-
    // It's a coding error to ask one recipe about another's hop additions!
    Q_ASSERT(hopAddition.recipeId() == this->key());
 
-   double AArating = hopAddition.hop()->alpha_pct() / 100.0;
-   // .:TBD:.  What to do if hopAddition is measured by volume?
-   //
-   // Per https://beersmith.com/blog/2016/08/31/using-hop-extracts-for-beer-brewing/, for CO2 Hop Extract, a first
-   // approximation would be 1 gram hop = 1 ml of hop extract.
-   //
-   // The same page suggests that, for Isomerized Hop Extract,
-   //    IBU = (extract_vol_ml * alpha_content_pct * 1000) / (volume_beer_liters)
-   //
-   if (!hopAddition.amountIsWeight()) {
-      qCritical() << Q_FUNC_INFO << "Using Hop volume as weight - THIS IS PROBABLY WRONG!";
-   }
-   double grams = hopAddition.quantity() * 1000.0;
-   double minutes = hopAddition.addAtTime_mins().value_or(0.0);
-   // Assume 100% utilization until further notice
-   double hopUtilization = 1.0;
-   // Assume 60 min boil until further notice
-   double boilTime_mins = 60.0;
-
-   // NOTE: we used to carefully calculate the average boil gravity and use it in the
-   // IBU calculations. However, due to John Palmer
-   // (http://homebrew.stackexchange.com/questions/7343/does-wort-gravity-affect-hopAddition-utilization),
-   // it seems more appropriate to just use the OG directly, since it is the total
-   // amount of break material that truly affects the IBUs.
-
-   if (equipment) {
-      hopUtilization = equipment->hopUtilization_pct().value_or(Equipment::default_hopUtilization_pct) / 100.0;
-      boilTime_mins = static_cast<int>(equipment->boilTime_min().value_or(Equipment::default_boilTime_mins));
-   }
-
-   auto boil = this->boil();
-   if (boil) {
-      boilTime_mins = boil->boilTime_mins();
-   }
-
-   IbuMethods::IbuCalculationParms parms = {
-      .AArating              = AArating,
-      .hops_grams            = grams,
-      .postBoilVolume_liters = this->pimpl->m_finalVolumeNoLosses_l,
-      .wortGravity_sg        = m_og,
-      .boilTime_minutes      = boilTime_mins,  // Seems unlikely in reality that there would be fractions of a minute
-      .coolTime_minutes          = boil->coolTime_mins(),
-      .kettleInternalDiameter_cm = equipment->kettleInternalDiameter_cm(),
-      .kettleOpeningDiameter_cm  = equipment->kettleOpeningDiameter_cm (),
+   RecipeCalc::HopIbuSettings const settings = this->pimpl->hopIbuSettings();
+   RecipeCalc::HopIbuInputs const inputs = RecipeCalc::hopIbuInputs(hopAddition, settings);
+   if (inputs.multiplier == 0.0) {
+      return 0.0;
+   }
+
+   IbuMethods::IbuCalculationParms const parms = {
+      .AArating                  = inputs.AArating,
+      .hops_grams                = inputs.grams,
+      .postBoilVolume_liters     = this->pimpl->m_finalVolumeNoLosses_l,
+      .wortGravity_sg            = this->m_og,
+      .boilTime_minutes          = inputs.boilTime_mins,
+      .coolTime_minutes          = settings.coolTime_mins,
+      .kettleInternalDiameter_cm = settings.kettleInternalDiameter_cm,
+      .kettleOpeningDiameter_cm  = settings.kettleOpeningDiameter_cm,
    };
-   if (hopAddition.isFirstWort()) {
-      ibus = fwhAdjust * IbuMethods::getIbus(parms);
-   } else if (hopAddition.stage() == RecipeAddition::Stage::Boil) {
-      parms.boilTime_minutes = minutes;
-      ibus = IbuMethods::getIbus(parms);
-   } else if (hopAddition.stage() == RecipeAddition::Stage::Mash && mashHopAdjust > 0.0) {
-      ibus = mashHopAdjust * IbuMethods::getIbus(parms);
-   }
-
-   // Adjust for hopAddition form. Tinseth's table was created from whole cone data,
-   // and it seems other formulae are optimized that way as well. So, the
-   // utilization is considered unadjusted for whole cones, and adjusted
-   // up for plugs and pellets.
-   //
-   // - http://www.realbeer.com/hops/FAQ.html
-   // - https://groups.google.com/forum/#!topic"brewtarget.h"lp/mv2qvWBC4sU
-   auto const hopForm = hopAddition.hop()->form();
-   if (hopForm) {
-      switch (*hopForm) {
-         case Hop::Form::Plug:
-            hopUtilization *= 1.02;
-            break;
-         case Hop::Form::Pellet:
-            hopUtilization *= 1.10;
-            break;
-         default:
-            break;
-      }
-   }
-
-   // Adjust for hopAddition utilization.
-   ibus *= hopUtilization;
-
-   return ibus;
+   return inputs.multiplier * IbuMethods::getIbus(parms);
 }
 
 QList<QString> Recipe::getReagents(QList<std::shared_ptr<RecipeAdditionFermentable>> fermentableAdditions) {
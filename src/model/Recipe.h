@@ -642,6 +642,7 @@ public:
    // Other junk.
    bool hasAncestors() const;
    bool isMyAncestor(Recipe const & maybe) const;
+   //! \brief Whether this Recipe has any later versions.  Does not depend on anything having loaded our ancestry.
    bool hasDescendants() const;
 
    // Helpers
@@ -705,6 +706,17 @@ public:
     */
    virtual void hardDeleteOrphanedEntities();
 
+   /**
+    * \brief Do any outstanding calculations now, rather than waiting for the event loop or for a calculated property to
+    *        be read.  This needs to be called (on the main thread) before calculated properties are read on another
+    *        thread (eg during export), as doing the calculations modifies the Recipe and emits signals.
+    *
+    * \return \c true if reading calculated properties will not now trigger any calculations, \c false otherwise (which
+    *         can only happen if we are called from inside a recalculation of this Recipe).  If calculations are
+    *         disabled, we return \c true, because the calculated properties will not be recalculated when read.
+    */
+   bool ensureCalculationsDone();
+
 signals:
 
 public slots:
@@ -774,6 +786,13 @@ private:
     * WARNING: this call took 0.15s in rev 916!
     */
    void recalcAll();
+
+   /**
+    * \brief Recalculates only those calculated properties whose inputs have changed since they were last calculated.
+    *        Normally called from the event loop, via \c Recipe::impl::scheduleRecalc(), after \c recalcIfNeeded etc
+    *        have marked what needs to be redone.
+    */
+   void recalcDirty();
 };
 
 // Need specialisations for abstract types
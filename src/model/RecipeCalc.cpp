@@ -0,0 +1,526 @@
+/*======================================================================================================================
+ * model/RecipeCalc.cpp is part of Brewken, and is copyright the following authors 2024:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#include "model/RecipeCalc.h"
+
+#include <algorithm>
+#include <span>
+
+#include <QDebug>
+#include <QThread>
+#include <QThreadPool>
+
+#include "Algorithms.h"
+#include "Localization.h"
+#include "measurement/ColorMethods.h"
+#include "measurement/IbuMethods.h"
+#include "model/Boil.h"
+#include "model/Equipment.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+#include "model/Mash.h"
+#include "model/Recipe.h"
+#include "model/RecipeAdditionFermentable.h"
+#include "model/RecipeAdditionHop.h"
+#include "model/RecipeAdditionYeast.h"
+#include "model/Yeast.h"
+#include "PersistentSettings.h"
+
+bool RecipeCalc::isFermentableSugar(Fermentable const & fermentable) {
+   // TODO: This probably doesn't work in languages other than English!
+   if (fermentable.type() == Fermentable::Type::Sugar && fermentable.name() == "Milk Sugar (Lactose)") {
+      return false;
+   }
+   return true;
+}
+
+double RecipeCalc::sugarRetention(Equipment const & equipment, double const wortFromMash_l) {
+   double const kettleWort_l = (wortFromMash_l - equipment.getLauteringDeadspaceLoss_l()) +
+                               equipment.topUpKettle_l().value_or(Equipment::default_topUpKettle_l);
+   double const postBoilWort_l = equipment.wortEndOfBoil_l(kettleWort_l);
+   double const ratio = (postBoilWort_l - equipment.kettleTrubChillerLoss_l()) / postBoilWort_l;
+   if (ratio > 1.0) { // Usually happens when we don't have a mash yet.
+      return 1.0;
+   }
+   if (ratio < 0.0) {
+      return 0.0;
+   }
+   if (Algorithms::isNan(ratio)) {
+      return 1.0;
+   }
+   return ratio;
+}
+
+RecipeCalc::OriginalGravity RecipeCalc::originalGravity(double const sugar_kg,
+                                                        double const sugar_kg_ignoreEfficiency,
+                                                        double const nonFermentableSugars_kg,
+                                                        double const sugarRetention,
+                                                        double const efficiency_pct,
+                                                        double const finalVolumeNoLosses_l) {
+   // We might lose some sugar in the form of Trub/Chiller loss and lauter deadspace.  (Sugars that are affected by
+   // mash efficiency are not adjusted here, since this loss should be included in efficiency.)
+   double const retainedNonFermentableSugars_kg = nonFermentableSugars_kg * sugarRetention;
+
+   // Total sugars after accounting for efficiency and mash losses. Implicitly includes non-fermentable sugars
+   double const totalSugar_kg = sugar_kg * efficiency_pct / 100.0 + sugar_kg_ignoreEfficiency * sugarRetention;
+
+   OriginalGravity ret;
+   ret.og = Algorithms::PlatoToSG_20C20C(Algorithms::getPlato(totalSugar_kg, finalVolumeNoLosses_l));
+   ret.hasNonFermentableSugars = (retainedNonFermentableSugars_kg != 0.0);
+   if (ret.hasNonFermentableSugars) {
+      ret.og_fermentable = Algorithms::PlatoToSG_20C20C(
+         Algorithms::getPlato(totalSugar_kg - retainedNonFermentableSugars_kg, finalVolumeNoLosses_l)
+      );
+      ret.nonFermentablePoints = (Algorithms::PlatoToSG_20C20C(
+         Algorithms::getPlato(retainedNonFermentableSugars_kg, finalVolumeNoLosses_l)
+      ) - 1) * 1000.0;
+   } else {
+      ret.og_fermentable = ret.og;
+      ret.nonFermentablePoints = 0.0;
+   }
+   return ret;
+}
+
+double RecipeCalc::attenuation_pct(std::span<double const> const additionAttenuation_pct,
+                                   std::span<double const> const typicalAttenuation_pct) {
+   double attenuation_pct = 0.0;
+   for (std::size_t ii = 0; ii < additionAttenuation_pct.size(); ++ii) {
+      // Get the yeast with the greatest attenuation.
+      if (additionAttenuation_pct[ii] > attenuation_pct) {
+         attenuation_pct = typicalAttenuation_pct[ii];
+      }
+   }
+   // This means we have yeast, but they neglected to provide attenuation percentages.
+   if (!additionAttenuation_pct.empty() && attenuation_pct <= 0.0) {
+      attenuation_pct = Yeast::DefaultAttenuation_pct; // Use an average attenuation.
+   }
+   return attenuation_pct;
+}
+
+RecipeCalc::FinalGravity RecipeCalc::finalGravity(OriginalGravity const & originalGravity,
+                                                  double const attenuation_pct) {
+   double const ogPoints = (originalGravity.og - 1) * 1000.0;
+   FinalGravity ret;
+   if (originalGravity.hasNonFermentableSugars) {
+      // FG points from fermentable sugars
+      double const fermentablePoints =
+         (ogPoints - originalGravity.nonFermentablePoints) * (1.0 - attenuation_pct / 100.0);
+      ret.fg = 1 + (fermentablePoints + originalGravity.nonFermentablePoints) / 1000.0;
+      ret.fg_fermentable = 1 + fermentablePoints / 1000.0;
+   } else {
+      ret.fg = 1 + ogPoints * (1.0 - attenuation_pct / 100.0) / 1000.0;
+      ret.fg_fermentable = ret.fg;
+   }
+   return ret;
+}
+
+double RecipeCalc::abv_pct(double const og_fermentable, double const fg_fermentable) {
+   // The complex formula, and variations comes from Ritchie Products Ltd, (Zymurgy, Summer 1995, vol. 18, no. 2)
+   // Michael L. Hall’s article Brew by the Numbers: Add Up What’s in Your Beer, and Designing Great Beers by Daniels.
+   return (76.08 * (og_fermentable - fg_fermentable) / (1.775 - og_fermentable)) * (fg_fermentable / 0.794);
+}
+
+double RecipeCalc::maltColorUnits(double const color_srm, double const amount_kg, double const finalVolumeNoLosses_l) {
+   // Conversion factor for lb/gal to kg/l = 8.34538.
+   return color_srm * 8.34538 * amount_kg / finalVolumeNoLosses_l;
+}
+
+double RecipeCalc::hoppedExtractIbus(double const ibuGalPerLb, double const amount_kg, double const batchSize_l) {
+   // Conversion factor for lb/gal to kg/l = 8.34538.
+   return ibuGalPerLb * (amount_kg / batchSize_l) / 8.34538;
+}
+
+double RecipeCalc::firstWortHopAdjustment() {
+   return Localization::toDouble(
+      PersistentSettings::value(PersistentSettings::Names::firstWortHopAdjustment, 1.1).toString(),
+      Q_FUNC_INFO
+   );
+}
+
+double RecipeCalc::mashHopAdjustment() {
+   return Localization::toDouble(
+      PersistentSettings::value(PersistentSettings::Names::mashHopAdjustment, 0).toString(),
+      Q_FUNC_INFO
+   );
+}
+
+RecipeCalc::HopIbuSettings RecipeCalc::hopIbuSettings(Equipment const * equipment,
+                                                      Boil const * boil,
+                                                      double const fwhAdjust,
+                                                      double const mashHopAdjust) {
+   HopIbuSettings settings {
+      .fwhAdjust = fwhAdjust,
+      .mashHopAdjust = mashHopAdjust,
+      // Assume 100% utilization until further notice
+      .hopUtilization = 1.0,
+      // Assume 60 min boil until further notice
+      .boilTime_mins = 60.0,
+      .coolTime_mins             = boil      ? boil->coolTime_mins()                   : std::nullopt,
+      .kettleInternalDiameter_cm = equipment ? equipment->kettleInternalDiameter_cm() : std::nullopt,
+      .kettleOpeningDiameter_cm  = equipment ? equipment->kettleOpeningDiameter_cm () : std::nullopt,
+   };
+
+   if (equipment) {
+      settings.hopUtilization = equipment->hopUtilization_pct().value_or(Equipment::default_hopUtilization_pct) / 100.0;
+      settings.boilTime_mins = static_cast<int>(equipment->boilTime_min().value_or(Equipment::default_boilTime_mins));
+   }
+   if (boil) {
+      settings.boilTime_mins = boil->boilTime_mins();
+   }
+   return settings;
+}
+
+RecipeCalc::HopIbuInputs RecipeCalc::hopIbuInputs(RecipeAdditionHop const & hopAddition,
+                                                  HopIbuSettings const & settings) {
+   // .:TBD:.  What to do if hopAddition is measured by volume?
+   //
+   // Per https://beersmith.com/blog/2016/08/31/using-hop-extracts-for-beer-brewing/, for CO2 Hop Extract, a first
+   // approximation would be 1 gram hop = 1 ml of hop extract.
+   //
+   // The same page suggests that, for Isomerized Hop Extract,
+   //    IBU = (extract_vol_ml * alpha_content_pct * 1000) / (volume_beer_liters)
+   //
+   if (!hopAddition.amountIsWeight()) {
+      qCritical() << Q_FUNC_INFO << "Using Hop volume as weight - THIS IS PROBABLY WRONG!";
+   }
+
+   // NOTE: we used to carefully calculate the average boil gravity and use it in the
+   // IBU calculations. However, due to John Palmer
+   // (http://homebrew.stackexchange.com/questions/7343/does-wort-gravity-affect-hopAddition-utilization),
+   // it seems more appropriate to just use the OG directly, since it is the total
+   // amount of break material that truly affects the IBUs.
+   HopIbuInputs inputs {
+      .AArating      = hopAddition.hop()->alpha_pct() / 100.0,
+      .grams         = hopAddition.quantity() * 1000.0,
+      .boilTime_mins = settings.boilTime_mins, // Seems unlikely in reality that there would be fractions of a minute
+      .multiplier    = 0.0,
+   };
+   if (hopAddition.isFirstWort()) {
+      inputs.multiplier = settings.fwhAdjust;
+   } else if (hopAddition.stage() == RecipeAddition::Stage::Boil) {
+      inputs.multiplier = 1.0;
+      inputs.boilTime_mins = hopAddition.addAtTime_mins().value_or(0.0);
+   } else if (hopAddition.stage() == RecipeAddition::Stage::Mash && settings.mashHopAdjust > 0.0) {
+      inputs.multiplier = settings.mashHopAdjust;
+   }
+
+   // Adjust for hopAddition form. Tinseth's table was created from whole cone data,
+   // and it seems other formulae are optimized that way as well. So, the
+   // utilization is considered unadjusted for whole cones, and adjusted
+   // up for plugs and pellets.
+   //
+   // - http://www.realbeer.com/hops/FAQ.html
+   // - https://groups.google.com/forum/#!topic"brewtarget.h"lp/mv2qvWBC4sU
+   double hopUtilization = settings.hopUtilization;
+   auto const hopForm = hopAddition.hop()->form();
+   if (hopForm) {
+      switch (*hopForm) {
+         case Hop::Form::Plug:
+            hopUtilization *= 1.02;
+            break;
+         case Hop::Form::Pellet:
+            hopUtilization *= 1.10;
+            break;
+         default:
+            break;
+      }
+   }
+
+   // Adjust for hopAddition utilization.
+   inputs.multiplier *= hopUtilization;
+
+   return inputs;
+}
+
+double RecipeCalc::hopIbus(std::span<HopIbuInputs const> const hopAdditions,
+                           double const wortGravity_sg,
+                           double const postBoilVolume_liters,
+                           HopIbuSettings const & settings,
+                           HopIbusScratch & scratch,
+                           std::span<double> const perAdditionIbus) {
+   // It's a coding error to ask for per-addition IBUs without giving us the right amount of space for them
+   Q_ASSERT(perAdditionIbus.empty() || perAdditionIbus.size() == hopAdditions.size());
+
+   scratch.AArating       .clear();
+   scratch.grams          .clear();
+   scratch.boilTime_mins  .clear();
+   scratch.additionIndexes.clear();
+   for (std::size_t ii = 0; ii < hopAdditions.size(); ++ii) {
+      HopIbuInputs const & inputs = hopAdditions[ii];
+      if (inputs.multiplier == 0.0) {
+         continue;
+      }
+      scratch.AArating       .push_back(inputs.AArating     );
+      scratch.grams          .push_back(inputs.grams        );
+      scratch.boilTime_mins  .push_back(inputs.boilTime_mins);
+      scratch.additionIndexes.push_back(ii);
+   }
+   std::size_t const batchSize = scratch.additionIndexes.size();
+   scratch.wortGravity_sg.assign(batchSize, wortGravity_sg);
+   scratch.ibus.resize(batchSize);
+   IbuMethods::getIbusBatch(
+      IbuMethods::IbuBatchParms{
+         .AArating                  = scratch.AArating,
+         .hops_grams                = scratch.grams,
+         .wortGravity_sg            = scratch.wortGravity_sg,
+         .boilTime_minutes          = scratch.boilTime_mins,
+         .postBoilVolume_liters     = postBoilVolume_liters,
+         .coolTime_minutes          = settings.coolTime_mins,
+         .kettleInternalDiameter_cm = settings.kettleInternalDiameter_cm,
+         .kettleOpeningDiameter_cm  = settings.kettleOpeningDiameter_cm,
+      },
+      scratch.ibus
+   );
+
+   std::fill(perAdditionIbus.begin(), perAdditionIbus.end(), 0.0);
+   double totalIbus = 0.0;
+   for (std::size_t ii = 0; ii < batchSize; ++ii) {
+      std::size_t const additionIndex = scratch.additionIndexes[ii];
+      double const additionIbus = hopAdditions[additionIndex].multiplier * scratch.ibus[ii];
+      if (!perAdditionIbus.empty()) {
+         perAdditionIbus[additionIndex] = additionIbus;
+      }
+      totalIbus += additionIbus;
+   }
+   return totalIbus;
+}
+
+namespace {
+   // Below this many recipes, it's not worth the overhead of farming the work out to other threads
+   int const minRecipesPerThread = 64;
+
+   /**
+    * \brief Calculate the results for recipes [begin, end).  Each call writes to a different part of \c results, so
+    *        it is safe to run several calls at once on different ranges.
+    */
+   void evaluateRange(RecipeCalc::Inputs const & inputs,
+                      RecipeCalc::Results & results,
+                      std::size_t const begin,
+                      std::size_t const end) {
+      using Flag = RecipeCalc::Inputs::FermentableFlag;
+      // Scratch space for the IBU calculations, reused across recipes to save reallocating
+      RecipeCalc::HopIbusScratch hopIbusScratch;
+      for (std::size_t rr = begin; rr < end; ++rr) {
+         double const finalVolumeNoLosses_l = inputs.finalVolumeNoLosses_l[rr];
+
+         //
+         // Sugars, OG and color -- see Recipe::impl::computeTotalPoints(), Recipe::impl::recalcOg() and
+         // Recipe::impl::recalcColor_srm()
+         //
+         double sugar_kg                  = 0.0;
+         double sugar_kg_ignoreEfficiency = 0.0;
+         double nonFermentableSugars_kg   = 0.0;
+         double mcu                       = 0.0;
+         double extractIbu                = 0.0;
+         for (std::size_t ff = inputs.fermentableBegin[rr]; ff < inputs.fermentableBegin[rr + 1]; ++ff) {
+            std::uint8_t const flags = inputs.fermentableFlags[ff];
+            if (flags & Flag::IgnoresEfficiency) {
+               sugar_kg_ignoreEfficiency += inputs.fermentableEquivSucrose_kg[ff];
+               if (flags & Flag::NonFermentable) {
+                  nonFermentableSugars_kg += inputs.fermentableEquivSucrose_kg[ff];
+               }
+            } else {
+               sugar_kg += inputs.fermentableEquivSucrose_kg[ff];
+            }
+            if (flags & Flag::MeasuredByWeight) {
+               mcu += RecipeCalc::maltColorUnits(inputs.fermentableColor_srm[ff],
+                                                 inputs.fermentableAmount_kg[ff],
+                                                 finalVolumeNoLosses_l);
+               extractIbu += RecipeCalc::hoppedExtractIbus(inputs.fermentableIbuGalPerLb[ff],
+                                                           inputs.fermentableAmount_kg[ff],
+                                                           inputs.batchSize_l[rr]);
+            }
+         }
+
+         RecipeCalc::OriginalGravity const originalGravity = RecipeCalc::originalGravity(
+            sugar_kg,
+            sugar_kg_ignoreEfficiency,
+            nonFermentableSugars_kg,
+            inputs.sugarRetention[rr],
+            inputs.efficiency_pct[rr],
+            finalVolumeNoLosses_l
+         );
+
+         //
+         // FG and ABV -- see Recipe::impl::recalcFg() and Recipe::impl::recalcABV_pct()
+         //
+         std::size_t const yeastBegin = inputs.yeastBegin[rr];
+         std::size_t const numYeasts  = inputs.yeastBegin[rr + 1] - yeastBegin;
+         RecipeCalc::FinalGravity const finalGravity = RecipeCalc::finalGravity(
+            originalGravity,
+            RecipeCalc::attenuation_pct(
+               std::span(inputs.yeastAdditionAttenuation_pct).subspan(yeastBegin, numYeasts),
+               std::span(inputs.yeastTypicalAttenuation_pct ).subspan(yeastBegin, numYeasts)
+            )
+         );
+
+         results.og       [rr] = originalGravity.og;
+         results.fg       [rr] = finalGravity.fg;
+         results.abv_pct  [rr] = RecipeCalc::abv_pct(originalGravity.og_fermentable, finalGravity.fg_fermentable);
+         results.color_srm[rr] = ColorMethods::mcuToSrm(mcu);
+
+         //
+         // IBU -- see Recipe::impl::recalcIBU()
+         //
+         std::size_t const hopBegin = inputs.hopBegin[rr];
+         std::size_t const numHops  = inputs.hopBegin[rr + 1] - hopBegin;
+         results.ibu[rr] = extractIbu + RecipeCalc::hopIbus(std::span(inputs.hopIbuInputs).subspan(hopBegin, numHops),
+                                                            originalGravity.og,
+                                                            finalVolumeNoLosses_l,
+                                                            inputs.hopIbuSettings[rr],
+                                                            hopIbusScratch);
+      }
+      return;
+   }
+}
+
+RecipeCalc::Inputs RecipeCalc::snapshot(QList<Recipe *> const & recipes) {
+   RecipeCalc::Inputs inputs;
+
+   std::size_t const numRecipes = static_cast<std::size_t>(recipes.size());
+   inputs.recipeId             .reserve(numRecipes);
+   inputs.efficiency_pct       .reserve(numRecipes);
+   inputs.batchSize_l          .reserve(numRecipes);
+   inputs.finalVolumeNoLosses_l.reserve(numRecipes);
+   inputs.sugarRetention       .reserve(numRecipes);
+   inputs.hopIbuSettings       .reserve(numRecipes);
+   inputs.fermentableBegin     .reserve(numRecipes + 1);
+   inputs.hopBegin             .reserve(numRecipes + 1);
+   inputs.yeastBegin           .reserve(numRecipes + 1);
+
+   // These settings are the same for all recipes, so we only need to read them once
+   double const fwhAdjust     = RecipeCalc::firstWortHopAdjustment();
+   double const mashHopAdjust = RecipeCalc::mashHopAdjustment();
+
+   for (Recipe const * recipe : recipes) {
+      auto const equipment = recipe->equipment();
+      auto const mash      = recipe->mash();
+      auto const boil      = recipe->boil();
+
+      inputs.recipeId      .push_back(recipe->key());
+      inputs.efficiency_pct.push_back(recipe->efficiency_pct());
+      inputs.batchSize_l   .push_back(recipe->batchSize_l());
+      inputs.finalVolumeNoLosses_l.push_back(
+         recipe->batchSize_l() + (equipment ? equipment->kettleTrubChillerLoss_l() : 0.0)
+      );
+
+      inputs.fermentableBegin.push_back(inputs.fermentableFlags.size());
+      double grainsInMash_kg = 0.0;
+      for (auto const & fermentableAddition : recipe->fermentableAdditions()) {
+         auto const * fermentable = fermentableAddition->fermentable();
+         std::uint8_t flags = 0;
+         if (fermentable->isSugar() || fermentable->isExtract()) {
+            flags |= Inputs::IgnoresEfficiency;
+            if (!RecipeCalc::isFermentableSugar(*fermentable)) {
+               flags |= Inputs::NonFermentable;
+            }
+         }
+         if (fermentableAddition->addAfterBoil()) {
+            flags |= Inputs::AddedAfterBoil;
+         }
+         double amount_kg = 0.0;
+         if (fermentableAddition->amountIsWeight()) {
+            flags |= Inputs::MeasuredByWeight;
+            amount_kg = fermentableAddition->amount().quantity;
+            if (fermentable->type() == Fermentable::Type::Grain &&
+                fermentableAddition->stage() == RecipeAddition::Stage::Mash) {
+               grainsInMash_kg += amount_kg;
+            }
+         }
+         inputs.fermentableEquivSucrose_kg.push_back(fermentableAddition->equivSucrose_kg());
+         inputs.fermentableAmount_kg      .push_back(amount_kg);
+         inputs.fermentableColor_srm      .push_back(fermentable->color_srm());
+         inputs.fermentableIbuGalPerLb    .push_back(fermentable->ibuGalPerLb().value_or(0.0));
+         inputs.fermentableFlags          .push_back(flags);
+      }
+
+      //
+      // Work out what proportion of sugars that are not affected by efficiency survive lautering and kettle losses --
+      // see Recipe::impl::recalcVolumeEstimates() and Recipe::impl::recalcOg()
+      //
+      double sugarRetention = 1.0;
+      if (equipment) {
+         double wortFromMash_l = 0.0;
+         if (mash) {
+            wortFromMash_l = mash->totalMashWater_l() -
+                             equipment->mashTunGrainAbsorption_LKg().value_or(
+                                Equipment::default_mashTunGrainAbsorption_LKg
+                             ) * grainsInMash_kg;
+         }
+         sugarRetention = RecipeCalc::sugarRetention(*equipment, wortFromMash_l);
+      }
+      inputs.sugarRetention.push_back(sugarRetention);
+
+      RecipeCalc::HopIbuSettings const settings =
+         RecipeCalc::hopIbuSettings(equipment.get(), boil.get(), fwhAdjust, mashHopAdjust);
+      inputs.hopIbuSettings.push_back(settings);
+
+      inputs.hopBegin.push_back(inputs.hopIbuInputs.size());
+      for (auto const & hopAddition : recipe->hopAdditions()) {
+         inputs.hopIbuInputs.push_back(RecipeCalc::hopIbuInputs(*hopAddition, settings));
+      }
+
+      inputs.yeastBegin.push_back(inputs.yeastTypicalAttenuation_pct.size());
+      for (auto const & yeastAddition : recipe->yeastAdditions()) {
+         inputs.yeastAdditionAttenuation_pct.push_back(yeastAddition->attenuation_pct().value_or(0.0));
+         inputs.yeastTypicalAttenuation_pct .push_back(yeastAddition->yeast()->attenuationTypical_pct());
+      }
+   }
+
+   // Each of the xxxBegin vectors has an extra entry to mark the end of the last recipe's additions
+   inputs.fermentableBegin.push_back(inputs.fermentableFlags.size());
+   inputs.hopBegin        .push_back(inputs.hopIbuInputs.size());
+   inputs.yeastBegin      .push_back(inputs.yeastTypicalAttenuation_pct.size());
+
+   return inputs;
+}
+
+RecipeCalc::Results RecipeCalc::evaluate(RecipeCalc::Inputs const & inputs, int const maxThreads) {
+   std::size_t const numRecipes = inputs.size();
+
+   // The results vectors are sized up-front so that each thread can write to its own part of them
+   RecipeCalc::Results results;
+   results.og       .resize(numRecipes);
+   results.fg       .resize(numRecipes);
+   results.abv_pct  .resize(numRecipes);
+   results.ibu      .resize(numRecipes);
+   results.color_srm.resize(numRecipes);
+
+   int const numThreads = std::clamp(
+      static_cast<int>(numRecipes / minRecipesPerThread),
+      1,
+      maxThreads > 0 ? maxThreads : QThread::idealThreadCount()
+   );
+   qDebug() << Q_FUNC_INFO << "Evaluating" << numRecipes << "recipes using" << numThreads << "thread(s)";
+
+   if (numThreads <= 1) {
+      evaluateRange(inputs, results, 0, numRecipes);
+      return results;
+   }
+
+   QThreadPool threadPool;
+   threadPool.setMaxThreadCount(numThreads);
+   std::size_t const chunkSize = (numRecipes + numThreads - 1) / numThreads;
+   for (std::size_t begin = 0; begin < numRecipes; begin += chunkSize) {
+      std::size_t const end = std::min(begin + chunkSize, numRecipes);
+      threadPool.start([&inputs, &results, begin, end]() {
+         evaluateRange(inputs, results, begin, end);
+         return;
+      });
+   }
+   threadPool.waitForDone();
+
+   return results;
+}
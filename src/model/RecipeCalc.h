@@ -0,0 +1,284 @@
+/*======================================================================================================================
+ * model/RecipeCalc.h is part of Brewken, and is copyright the following authors 2024:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#ifndef MODEL_RECIPECALC_H
+#define MODEL_RECIPECALC_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <QList>
+
+class Boil;
+class Equipment;
+class Fermentable;
+class Recipe;
+class RecipeAdditionHop;
+
+/*!
+ * \brief Headless, batch evaluation of the main calculated properties (OG, FG, ABV, IBU, color) of lots of recipes at
+ *        once -- eg for reports over a whole recipe library.
+ *
+ *        This is a two-step process:
+ *          - \c snapshot() copies everything the calculations need out of the \c Recipe objects (and their additions,
+ *            equipment etc) into \c Inputs.  This has to be done on the main thread, but it is quick, as it does not
+ *            call \c Recipe::recalcAll() or any of the calculated getters on \c Recipe.
+ *          - \c evaluate() then does the calculations, in parallel, without touching any \c Recipe objects.  So there
+ *            are no Qt signals emitted and nothing is written to the database.
+ *
+ *        The formulas themselves are also here, below, and \c Recipe::impl uses the same functions for its calculated
+ *        properties, so the results match what the UI shows.
+ */
+namespace RecipeCalc {
+
+   //================================================= Shared formulas =================================================
+   //
+   // These are the pure calculations behind the calculated properties of Recipe.  They are used both by Recipe::impl,
+   // for one Recipe at a time, and by evaluate(), for lots of recipes at once, so that the two always agree.
+   //
+
+   /**
+    * \brief Whether the sugars in a sugar or extract are fermentable
+    */
+   bool isFermentableSugar(Fermentable const & fermentable);
+
+   /**
+    * \brief What proportion of the sugars that are not affected by mash efficiency survive lautering and kettle losses.
+    *        (Without equipment, we assume they all do.)
+    *
+    * \param equipment
+    * \param wortFromMash_l
+    */
+   double sugarRetention(Equipment const & equipment, double const wortFromMash_l);
+
+   struct OriginalGravity {
+      double og;
+      //! The OG we would have from the fermentable sugars alone
+      double og_fermentable;
+      //! Gravity points (ie (SG - 1) * 1000) from the non-fermentable sugars
+      double nonFermentablePoints;
+      bool   hasNonFermentableSugars;
+   };
+
+   /**
+    * \param sugar_kg Mass of sugar that \b is affected by mash efficiency
+    * \param sugar_kg_ignoreEfficiency Mass of sugar that \b is \b not affected by mash efficiency, including
+    *                                  \c nonFermentableSugars_kg
+    * \param nonFermentableSugars_kg
+    * \param sugarRetention See \c sugarRetention()
+    * \param efficiency_pct
+    * \param finalVolumeNoLosses_l
+    */
+   OriginalGravity originalGravity(double const sugar_kg,
+                                   double const sugar_kg_ignoreEfficiency,
+                                   double const nonFermentableSugars_kg,
+                                   double const sugarRetention,
+                                   double const efficiency_pct,
+                                   double const finalVolumeNoLosses_l);
+
+   /**
+    * \brief The attenuation we use to get from OG to FG
+    *
+    * \param additionAttenuation_pct \c RecipeAdditionYeast::attenuation_pct (or 0 if not set) for each yeast addition
+    * \param typicalAttenuation_pct \c Yeast::attenuationTypical_pct for each yeast addition
+    */
+   double attenuation_pct(std::span<double const> const additionAttenuation_pct,
+                          std::span<double const> const typicalAttenuation_pct);
+
+   struct FinalGravity {
+      double fg;
+      //! The FG we would have from the fermentable sugars alone
+      double fg_fermentable;
+   };
+
+   FinalGravity finalGravity(OriginalGravity const & originalGravity, double const attenuation_pct);
+
+   double abv_pct(double const og_fermentable, double const fg_fermentable);
+
+   //! \brief Malt color units (MCU) contributed by a fermentable addition measured by weight
+   double maltColorUnits(double const color_srm, double const amount_kg, double const finalVolumeNoLosses_l);
+
+   //! \brief IBUs contributed by a hopped extract addition measured by weight
+   double hoppedExtractIbus(double const ibuGalPerLb, double const amount_kg, double const batchSize_l);
+
+   /**
+    * \brief The things that affect the IBUs of all the hop additions in a recipe, other than the wort itself.  We look
+    *        these up once per IBU calculation rather than once per hop addition.
+    */
+   struct HopIbuSettings {
+      double fwhAdjust;
+      double mashHopAdjust;
+      double hopUtilization;
+      double boilTime_mins;
+      std::optional<double> coolTime_mins;
+      std::optional<double> kettleInternalDiameter_cm;
+      std::optional<double> kettleOpeningDiameter_cm;
+   };
+
+   //! \brief First wort hop adjustment from \c PersistentSettings
+   double firstWortHopAdjustment();
+
+   //! \brief Mash hop adjustment from \c PersistentSettings
+   double mashHopAdjustment();
+
+   /**
+    * \param equipment Can be \c nullptr
+    * \param boil Can be \c nullptr
+    * \param fwhAdjust See \c firstWortHopAdjustment()
+    * \param mashHopAdjust See \c mashHopAdjustment()
+    */
+   HopIbuSettings hopIbuSettings(Equipment const * equipment,
+                                 Boil const * boil,
+                                 double const fwhAdjust,
+                                 double const mashHopAdjust);
+
+   /**
+    * \brief What we need to know about an individual hop addition to work out its IBUs
+    */
+   struct HopIbuInputs {
+      //! Decimal alpha acid rating, eg 0.04 for 4%
+      double AArating;
+      double grams;
+      //! How long the addition is boiled for, which, for first wort and mash hops, is the whole boil
+      double boilTime_mins;
+      //! Product of first wort or mash hop adjustment, hop utilization and hop form adjustment.  Zero for additions
+      //  that do not contribute any bitterness (eg dry hops).
+      double multiplier;
+   };
+
+   HopIbuInputs hopIbuInputs(RecipeAdditionHop const & hopAddition, HopIbuSettings const & settings);
+
+   /**
+    * \brief Working space for \c hopIbus(), which can be reused across calls to save reallocating
+    */
+   struct HopIbusScratch {
+      std::vector<double> AArating;
+      std::vector<double> grams;
+      std::vector<double> wortGravity_sg;
+      std::vector<double> boilTime_mins;
+      std::vector<double> ibus;
+      //! For each entry in the above, the index of the hop addition it is for
+      std::vector<std::size_t> additionIndexes;
+   };
+
+   /**
+    * \brief Total IBUs from a set of hop additions, calculated in one batch with \c IbuMethods::getIbusBatch.
+    *
+    *        Additions with a zero multiplier (eg dry hops) contribute no bitterness, so we leave them out of the batch
+    *        rather than multiply their IBUs by 0.  (Otherwise, if the post-boil volume is 0, eg because the recipe has
+    *        no equipment yet, we would get 0 * infinity = NaN.)
+    *
+    * \param hopAdditions
+    * \param wortGravity_sg
+    * \param postBoilVolume_liters
+    * \param settings
+    * \param scratch
+    * \param perAdditionIbus If not empty, must be the same length as \c hopAdditions, and receives the IBUs from each
+    *                        addition
+    */
+   double hopIbus(std::span<HopIbuInputs const> const hopAdditions,
+                  double const wortGravity_sg,
+                  double const postBoilVolume_liters,
+                  HopIbuSettings const & settings,
+                  HopIbusScratch & scratch,
+                  std::span<double> const perAdditionIbus = {});
+
+   //================================================= Batch evaluation ================================================
+
+   /**
+    * \brief Snapshot of the inputs for a set of recipes, in "structure of arrays" layout.
+    *
+    *        Per-recipe vectors all have one entry per recipe, in the same order.  Per-addition vectors hold the
+    *        additions of all the recipes, one after another, and the additions of recipe \c r are the ones with indexes
+    *        in the range [ \c xxxBegin[r], \c xxxBegin[r + 1] ).  (So the \c xxxBegin vectors have one more entry than
+    *        there are recipes.)
+    */
+   struct Inputs {
+      //! Bit flags for \c fermentableFlags
+      enum FermentableFlag : std::uint8_t {
+         IgnoresEfficiency = 1 << 0, // Sugars and extracts are not affected by mash efficiency
+         AddedAfterBoil    = 1 << 1,
+         NonFermentable    = 1 << 2,
+         MeasuredByWeight  = 1 << 3,
+      };
+
+      //================================================== Per recipe ==================================================
+      std::vector<int>    recipeId;
+      std::vector<double> efficiency_pct;
+      std::vector<double> batchSize_l;
+      //! Batch size plus kettle trub & chiller loss
+      std::vector<double> finalVolumeNoLosses_l;
+      //! Fraction of the sugars not affected by mash efficiency that survive lautering and kettle losses
+      std::vector<double> sugarRetention;
+      //! See \c RecipeCalc::hopIbuSettings()
+      std::vector<HopIbuSettings> hopIbuSettings;
+
+      std::vector<std::size_t> fermentableBegin;
+      std::vector<std::size_t> hopBegin;
+      std::vector<std::size_t> yeastBegin;
+
+      //============================================ Per fermentable addition ==========================================
+      std::vector<double>       fermentableEquivSucrose_kg;
+      //! Amount in kg, or 0 if measured by volume
+      std::vector<double>       fermentableAmount_kg;
+      std::vector<double>       fermentableColor_srm;
+      std::vector<double>       fermentableIbuGalPerLb;
+      std::vector<std::uint8_t> fermentableFlags;
+
+      //================================================ Per hop addition ==============================================
+      //! See \c RecipeCalc::hopIbuInputs()
+      std::vector<HopIbuInputs> hopIbuInputs;
+
+      //=============================================== Per yeast addition =============================================
+      //! \c RecipeAdditionYeast::attenuation_pct (or 0 if not set)
+      std::vector<double> yeastAdditionAttenuation_pct;
+      //! \c Yeast::attenuationTypical_pct
+      std::vector<double> yeastTypicalAttenuation_pct;
+
+      std::size_t size() const { return this->recipeId.size(); }
+   };
+
+   /**
+    * \brief Results of \c evaluate(), again in structure of arrays layout.  Entry \c r of each vector is for the recipe
+    *        at entry \c r of the \c Inputs.
+    */
+   struct Results {
+      std::vector<double> og;
+      std::vector<double> fg;
+      std::vector<double> abv_pct;
+      std::vector<double> ibu;
+      std::vector<double> color_srm;
+   };
+
+   /**
+    * \brief Copy out of the supplied recipes everything \c evaluate() needs.  Must be called on the thread that owns
+    *        the recipes (ie the main thread).
+    */
+   Inputs snapshot(QList<Recipe *> const & recipes);
+
+   /**
+    * \brief Calculate OG, FG, ABV, IBU and color for all the recipes in \c inputs.
+    *
+    * \param inputs
+    * \param maxThreads If 0, we use \c QThread::idealThreadCount()
+    */
+   Results evaluate(Inputs const & inputs, int const maxThreads = 0);
+}
+
+#endif
@@ -27,6 +27,7 @@
 
 #include "database/ObjectStoreWrapper.h"
 #include "model/Recipe.h"
+#include "model/Step.h"
 #include "utils/CuriouslyRecurringTemplateBase.h"
 
 //======================================================================================================================
@@ -125,9 +126,9 @@ public:
             steps.append(ObjectStoreWrapper::getById<DerivedStep>(ii));
          }
       } else {
-         steps = ObjectStoreWrapper::findAllMatching<DerivedStep>(
-            [myId](std::shared_ptr<DerivedStep> const step) {return step->ownerId() == myId && !step->deleted();}
-         );
+         // The ObjectStore for each type of Step has a secondary index on ownerId, so this is a quick lookup
+         steps = ObjectStoreWrapper::findAllByIndex<DerivedStep>(PropertyNames::Step::ownerId, myId);
+         steps.removeIf([](std::shared_ptr<DerivedStep> const step) {return step->deleted();});
 
          // Now we've got the Steps, we need to make sure they're in the right order
          std::sort(steps.begin(),
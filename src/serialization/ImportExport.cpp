@@ -16,12 +16,25 @@
  =====================================================================================================================*/
 #include "serialization/ImportExport.h"
 
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <QApplication>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QMessageBox>
+#include <QMutex>
 #include <QObject>
+#include <QProgressDialog>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 #include "MainWindow.h"
+#include "database/Database.h"
+#include "database/DbTransaction.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
 #include "model/Hop.h"
@@ -176,6 +189,220 @@ namespace {
       return;
    }
 
+   /**
+    * \brief Where we are with one of the files in a multi-file import
+    */
+   struct FileToImport {
+      QString fileName;
+      //! What we want to tell the user about this file
+      QString userMessage;
+      //! Set by the worker thread once it has read and validated the file (if that succeeded)
+      std::optional<ImportExport::LoadAndStore> loadAndStore;
+      //! Set by the worker thread when it's finished with the file (whether or not it succeeded)
+      bool prepared = false;
+      bool succeeded = false;
+   };
+
+   /**
+    * \brief What happened in a multi-file import
+    */
+   struct ImportResults {
+      std::vector<FileToImport> files;
+      //! How many of \c files we got through (which is fewer than all of them if the user cancelled)
+      std::size_t numProcessed = 0;
+
+      //! \return \c true if all files were imported
+      bool allSucceeded() const {
+         return this->numProcessed == this->files.size() &&
+                std::all_of(this->files.begin(),
+                            this->files.end(),
+                            [](FileToImport const & file) { return file.succeeded; });
+      }
+   };
+
+   /**
+    * \brief Do the first stage of importing a file (see \c ImportExport::LoadAndStore).  Safe to call on any thread.
+    *
+    * \param fileName
+    * \param userMessage
+    * \param isDefaultContent See \c ImportExport::importDefaultContent
+    */
+   std::optional<ImportExport::LoadAndStore> prepareImport(QString const & fileName,
+                                                           QTextStream & userMessage,
+                                                           bool const isDefaultContent) {
+      if (fileName.endsWith("json", Qt::CaseInsensitive)) {
+         return BeerJson::prepareImport(fileName, userMessage, !isDefaultContent);
+      }
+      if (fileName.endsWith("xml", Qt::CaseInsensitive)) {
+         return BeerXML::getInstance().prepareImport(fileName, userMessage);
+      }
+      qInfo() << Q_FUNC_INFO << "Don't understand file extension on" << fileName << "so ignoring!";
+      return std::nullopt;
+   }
+
+   /**
+    * \brief After importing several files, show the user one message summarising what happened, rather than one per
+    *        file.  The per-file messages go in the "details" part of the message box.
+    *
+    * \param results
+    */
+   void importSummaryMsg(ImportResults const & results) {
+      std::vector<FileToImport> const & files = results.files;
+      std::size_t const numProcessed = results.numProcessed;
+      std::size_t numSucceeded = 0;
+      QString details;
+      QTextStream detailsAsStream{&details};
+      for (std::size_t ii = 0; ii < numProcessed; ++ii) {
+         FileToImport const & file = files[ii];
+         if (file.succeeded) {
+            ++numSucceeded;
+         }
+         detailsAsStream <<
+            QFileInfo{file.fileName}.fileName() << ": " <<
+            (file.succeeded ? QObject::tr("OK") : QObject::tr("FAILED")) << "\n" << file.userMessage << "\n\n";
+      }
+      detailsAsStream.flush();
+
+      QString messageBoxText{
+         QObject::tr("Successfully read %1 of %2 files.").arg(numSucceeded).arg(files.size())
+      };
+      if (numProcessed < files.size()) {
+         messageBoxText += "\n\n" + QObject::tr("Import was cancelled after %1 files.").arg(numProcessed);
+      }
+      if (numSucceeded < numProcessed) {
+         messageBoxText += "\n\n" + QObject::tr("See details for the errors.  Log file may contain more details.");
+      }
+      qDebug() << Q_FUNC_INFO << "Message box text : " << messageBoxText;
+      QMessageBox msgBox{numSucceeded == numProcessed ? QMessageBox::Information : QMessageBox::Warning,
+                         numSucceeded == numProcessed ? QObject::tr("Success!") : QObject::tr("ERROR"),
+                         messageBoxText};
+      msgBox.setDetailedText(details);
+      msgBox.exec();
+      return;
+   }
+
+   /**
+    * \brief Import several files at once.
+    *
+    *        Reading, parsing and validating the files is done on a pool of worker threads, which can all run at once.
+    *        The second stage -- creating objects and storing them in the DB -- has to be done on the main thread, one
+    *        file at a time, and in the order the files were given to us (so that, eg, if two files have the same
+    *        recipe, we keep the same one as we would have done importing them one after another).  So the main thread
+    *        just stores each file's contents as soon as it's ready.
+    *
+    *        Normally, we show a progress dialog, which the user can use to cancel the import.  For default content, we
+    *        don't, because \c ImportExport::importDefaultContent has a DB transaction open around the whole import.
+    *        Keeping the dialog going would mean processing events, which would let other things (eg the UI or
+    *        \c ObjectStore write-behind) write to the DB inside that transaction, and cancelling would leave us
+    *        committing part of the default content.
+    *
+    *        The caller is responsible for telling the user what happened (see \c importSummaryMsg).
+    *
+    * \param inputFiles
+    * \param isDefaultContent See \c ImportExport::importDefaultContent
+    */
+   ImportResults importMultipleFiles(QStringList const & inputFiles, bool const isDefaultContent) {
+      ImportResults results;
+      std::vector<FileToImport> & files = results.files;
+      files.resize(static_cast<std::size_t>(inputFiles.size()));
+      for (std::size_t ii = 0; ii < files.size(); ++ii) {
+         files[ii].fileName = inputFiles.at(static_cast<qsizetype>(ii));
+      }
+
+      QMutex mutex;
+      QWaitCondition filePrepared;
+      QThreadPool threadPool;
+      //
+      // We don't want the worker threads to get too far ahead of the main thread, otherwise, for a big import, we
+      // could end up with the parsed contents of all the files in memory at once.  So we only start preparing a file
+      // when there are fewer than this many prepared but not yet stored.
+      //
+      std::size_t const maxFilesInFlight = 2 * static_cast<std::size_t>(threadPool.maxThreadCount());
+      std::size_t numStarted = 0;
+      auto startPreparingNextFile = [&files, &numStarted, &mutex, &filePrepared, &threadPool, isDefaultContent]() {
+         FileToImport & file = files[numStarted];
+         ++numStarted;
+         threadPool.start([&file, &mutex, &filePrepared, isDefaultContent]() {
+            QString userMessage;
+            QTextStream userMessageAsStream{&userMessage};
+            std::optional<ImportExport::LoadAndStore> loadAndStore =
+               prepareImport(file.fileName, userMessageAsStream, isDefaultContent);
+            userMessageAsStream.flush();
+            QMutexLocker locker(&mutex);
+            file.userMessage = userMessage;
+            file.loadAndStore = std::move(loadAndStore);
+            file.prepared = true;
+            filePrepared.wakeAll();
+            return;
+         });
+      };
+
+      // NB: QProgressDialog::setValue() processes events when the dialog is modal, so we don't create one at all for
+      //     default content.
+      std::optional<QProgressDialog> progress;
+      if (!isDefaultContent) {
+         progress.emplace(QObject::tr("Importing files..."),
+                          QObject::tr("Cancel"),
+                          0,
+                          static_cast<int>(files.size()),
+                          &MainWindow::instance());
+         progress->setWindowModality(Qt::WindowModal);
+         progress->setMinimumDuration(0);
+      }
+      auto wasCanceled = [&progress]() { return progress && progress->wasCanceled(); };
+
+      std::size_t & numProcessed = results.numProcessed;
+      for (; numProcessed < files.size() && !wasCanceled(); ++numProcessed) {
+         while (numStarted < files.size() && numStarted - numProcessed < maxFilesInFlight) {
+            startPreparingNextFile();
+         }
+
+         FileToImport & file = files[numProcessed];
+         if (progress) {
+            progress->setLabelText(QObject::tr("Importing %1").arg(QFileInfo{file.fileName}.fileName()));
+         }
+         {
+            QMutexLocker locker(&mutex);
+            while (!file.prepared && !wasCanceled()) {
+               if (!progress) {
+                  filePrepared.wait(&mutex);
+                  continue;
+               }
+               // Wake up every so often so that the progress dialog (and its Cancel button) keep working.  If the user
+               // cancels, we stop waiting, as the file we're waiting for might be a big one that takes a while to read.
+               filePrepared.wait(&mutex, 100);
+               locker.unlock();
+               QApplication::processEvents();
+               locker.relock();
+            }
+         }
+         if (wasCanceled()) {
+            break;
+         }
+
+         qDebug() << Q_FUNC_INFO << "Storing contents of" << file.fileName;
+         if (file.loadAndStore) {
+            QTextStream userMessageAsStream{&file.userMessage, QIODevice::WriteOnly | QIODevice::Append};
+            file.succeeded = (*file.loadAndStore)(userMessageAsStream);
+            // We're done with the parsed contents of the file, so we can free up the memory now
+            file.loadAndStore.reset();
+         }
+         qDebug() << Q_FUNC_INFO << "Import of" << file.fileName << (file.succeeded ? "succeeded" : "failed");
+         if (progress) {
+            progress->setValue(static_cast<int>(numProcessed + 1));
+         }
+      }
+
+      // If the user cancelled, there's no point preparing any more files, but we have to wait for the ones in progress
+      threadPool.clear();
+      threadPool.waitForDone();
+      if (progress) {
+         progress->close();
+      }
+
+      return results;
+   }
+
    /**
     * \brief Turn a possibly null list into a set
     */
@@ -217,6 +444,13 @@ bool ImportExport::importFromFiles(std::optional<QStringList> inputFiles) {
       return false;
    }
 
+   if (inputFiles->size() > 1) {
+      ImportResults const results = importMultipleFiles(*inputFiles, false);
+      importSummaryMsg(results);
+      MainWindow::instance().showChanges();
+      return results.allSucceeded();
+   }
+
    bool allSucceeded = true;
    for (QString filename : *inputFiles) {
       //
@@ -245,44 +479,182 @@ bool ImportExport::importFromFiles(std::optional<QStringList> inputFiles) {
    return allSucceeded;
 }
 
+bool ImportExport::importDefaultContent(QStringList const & inputFiles) {
+   //
+   // Normally, each record we store is its own DB transaction and, on SQLite at least, committing a transaction is
+   // relatively slow, as it has to wait for the data to be written to disk.  With several thousand records in the
+   // default content, it's a lot quicker to store them all in one transaction.  (The transaction for each record is
+   // then nested inside this one -- see DbTransaction.)
+   //
+   // We commit even if some of the files failed, because the object stores already hold the records that were stored
+   // and we don't want them to be out of step with the DB.  (This is the same as what would happen if the files were
+   // imported one by one.)
+   //
+   // Nothing inside the transaction processes events (see importMultipleFiles), so nothing else gets to write to the DB
+   // until we've committed, and the import can't be cancelled part way through.  We tell the user how it went after
+   // that, as showing them a message box also processes events.
+   //
+   Database & database = Database::instance();
+   QSqlDatabase connection = database.sqlDatabase();
+   bool committed = false;
+   ImportResults results;
+   {
+      DbTransaction dbTransaction{database, connection, "Import Default Content"};
+      results = importMultipleFiles(inputFiles, true);
+      committed = dbTransaction.commit();
+   }
 
-void ImportExport::exportToFile(QList<Recipe      const *> const * recipes,
-                                QList<Equipment   const *> const * equipments,
-                                QList<Fermentable const *> const * fermentables,
-                                QList<Hop         const *> const * hops,
-                                QList<Misc        const *> const * miscs,
-                                QList<Style       const *> const * styles,
-                                QList<Water       const *> const * waters,
-                                QList<Yeast       const *> const * yeasts) {
-   // It's the caller's responsibility to ensure that at least one list is supplied and that at least one of the
-   // supplied lists is non-empty
-   Q_ASSERT((recipes      && recipes     ->size() > 0) ||
-            (equipments   && equipments  ->size() > 0) ||
-            (fermentables && fermentables->size() > 0) ||
-            (hops         && hops        ->size() > 0) ||
-            (miscs        && miscs       ->size() > 0) ||
-            (styles       && styles      ->size() > 0) ||
-            (waters       && waters      ->size() > 0) ||
-            (yeasts       && yeasts      ->size() > 0));
+   importSummaryMsg(results);
+   MainWindow::instance().showChanges();
 
-   auto selectedFiles = selectFiles(ImportOrExport::EXPORT);
-   if (!selectedFiles) {
-      return;
+   return results.allSucceeded() && committed;
+}
+
+template<class SliceResult>
+bool ImportExport::exportInParallel(qsizetype const numRecords,
+                                    std::function<SliceResult(qsizetype const begin,
+                                                              qsizetype const end)> const & serialiseSlice,
+                                    std::function<void(SliceResult & sliceResult)> const & writeSlice,
+                                    ExportProgress const & progress) {
+   //
+   // Slices need to be big enough that we're not spending all our time handing work out to threads, but small enough
+   // that all the threads get a share of the work even when we're only exporting a few dozen records.
+   //
+   qsizetype const sliceSize = 16;
+   std::size_t const numSlices = static_cast<std::size_t>((numRecords + sliceSize - 1) / sliceSize);
+
+   // If there's only one slice, it's quicker to do it here than to start up a thread for it
+   if (numSlices <= 1) {
+      SliceResult sliceResult = serialiseSlice(0, numRecords);
+      writeSlice(sliceResult);
+      return !progress || progress(numRecords);
    }
-   QString filename = (*selectedFiles)[0];
 
+   std::vector<std::optional<SliceResult>> sliceResults(numSlices);
+
+   QMutex mutex;
+   QWaitCondition sliceSerialised;
+   QThreadPool threadPool;
+   // Same logic as in importMultipleFiles for not letting the worker threads get too far ahead of the writing
+   std::size_t const maxSlicesInFlight = 2 * static_cast<std::size_t>(threadPool.maxThreadCount());
+   std::size_t numStarted = 0;
+   auto startSerialisingNextSlice = [&]() {
+      std::size_t const sliceIndex = numStarted;
+      ++numStarted;
+      threadPool.start([&, sliceIndex]() {
+         qsizetype const begin = static_cast<qsizetype>(sliceIndex) * sliceSize;
+         SliceResult sliceResult = serialiseSlice(begin, std::min(begin + sliceSize, numRecords));
+         QMutexLocker locker(&mutex);
+         sliceResults[sliceIndex] = std::move(sliceResult);
+         sliceSerialised.wakeAll();
+         return;
+      });
+   };
+
+   bool cancelled = false;
+   for (std::size_t numWritten = 0; numWritten < numSlices && !cancelled; ++numWritten) {
+      while (numStarted < numSlices && numStarted - numWritten < maxSlicesInFlight) {
+         startSerialisingNextSlice();
+      }
+
+      std::optional<SliceResult> & sliceResult = sliceResults[numWritten];
+      {
+         QMutexLocker locker(&mutex);
+         while (!sliceResult && !cancelled) {
+            // Wake up every so often so that the caller can keep the UI (and its Cancel button) working
+            sliceSerialised.wait(&mutex, 100);
+            locker.unlock();
+            cancelled = progress && !progress(0);
+            locker.relock();
+         }
+      }
+      if (cancelled) {
+         break;
+      }
+
+      writeSlice(*sliceResult);
+      // We're done with the serialised records, so we can free up the memory now
+      sliceResult.reset();
+
+      qsizetype const numRecordsInSlice =
+         std::min(sliceSize, numRecords - static_cast<qsizetype>(numWritten) * sliceSize);
+      cancelled = progress && !progress(numRecordsInSlice);
+   }
+
+   // If the user cancelled, there's no point serialising any more slices, but we have to wait for the ones in progress
+   threadPool.clear();
+   threadPool.waitForDone();
+
+   return !cancelled;
+}
+//
+// Instantiate the above template function for the types that are going to use it
+//
+template bool ImportExport::exportInParallel(qsizetype const numRecords,
+                                             std::function<QString(qsizetype const begin,
+                                                                   qsizetype const end)> const & serialiseSlice,
+                                             std::function<void(QString & sliceResult)> const & writeSlice,
+                                             ExportProgress const & progress);
+template bool ImportExport::exportInParallel(qsizetype const numRecords,
+                                             std::function<std::string(qsizetype const begin,
+                                                                       qsizetype const end)> const & serialiseSlice,
+                                             std::function<void(std::string & sliceResult)> const & writeSlice,
+                                             ExportProgress const & progress);
+
+bool ImportExport::exportToNamedFile(
+   QString const & filename,
+   ImportExport::ExportProgress const & progress,
+   std::function<void(qsizetype const numRecordsToWrite)> const & setNumRecordsToWrite,
+   QList<Recipe      const *> const * recipes,
+   QList<Equipment   const *> const * equipments,
+   QList<Fermentable const *> const * fermentables,
+   QList<Hop         const *> const * hops,
+   QList<Misc        const *> const * miscs,
+   QList<Style       const *> const * styles,
+   QList<Water       const *> const * waters,
+   QList<Yeast       const *> const * yeasts
+) {
    QString userMessage;
    QTextStream userMessageAsStream{&userMessage};
 
+   //
+   // The records are serialised on worker threads (see exportInParallel), so the objects we're exporting must not
+   // change until we're done.  In exportToFile(), the progress dialog is application modal, so the user can't edit
+   // anything in the meantime (including in the editor windows, which are separate top-level windows).  We also need to
+   // make sure Recipes don't have any calculations outstanding, as these would otherwise get done (and modify the
+   // Recipe) when the worker threads read the calculated properties.
+   //
+   if (recipes) {
+      for (Recipe const * recipe : *recipes) {
+         // Doing outstanding calculations isn't really changing the Recipe, so it's OK to cast away const here
+         if (!const_cast<Recipe *>(recipe)->ensureCalculationsDone()) {
+            // This shouldn't happen, as we're not being called from inside a recalculation
+            qCritical() <<
+               Q_FUNC_INFO << "Unable to bring calculations up to date on Recipe #" << recipe->key() << "(" <<
+               recipe->name() << ") so not exporting";
+            Q_ASSERT(false);
+            return false;
+         }
+      }
+   }
+
    // Destructor will close the file if nec when we exit the function
    QFile outFile;
    outFile.setFileName(filename);
 
    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
       qWarning() << Q_FUNC_INFO << "Could not open" << filename << "for writing.";
-      return;
+      return false;
    }
 
+   // If the user cancels, we don't want to leave a partly-written file behind
+   auto exportCancelled = [&outFile]() {
+      qInfo() << Q_FUNC_INFO << "Export to" << outFile.fileName() << "cancelled";
+      outFile.close();
+      outFile.remove();
+      return;
+   };
+
    if (filename.endsWith("json", Qt::CaseInsensitive)) {
       //
       // It's not strictly required by the BeerJSON standard, but we'll get a better export of Recipe if we also
@@ -308,18 +680,28 @@ void ImportExport::exportToFile(QList<Recipe      const *> const * recipes,
          }
       }
 
-      BeerJson::Exporter exporter(outFile, userMessageAsStream);
-      if (!setOfFermentable.isEmpty()   ) { exporter.add(setOfFermentable.values()); }
-      if (!setOfHop        .isEmpty()   ) { exporter.add(setOfHop        .values()); }
-      if (!setOfMisc       .isEmpty()   ) { exporter.add(setOfMisc       .values()); }
-      if (!setOfYeast      .isEmpty()   ) { exporter.add(setOfYeast      .values()); }
-      if (!setOfStyle      .isEmpty()   ) { exporter.add(setOfStyle      .values()); }
-      if (!setOfEquipment  .isEmpty()   ) { exporter.add(setOfEquipment  .values()); }
-      if (!setOfWater      .isEmpty()   ) { exporter.add(setOfWater      .values()); }
-      if (recipes && recipes->size() > 0) { exporter.add(*recipes                 ); }
+      if (setNumRecordsToWrite) {
+         setNumRecordsToWrite(setOfFermentable.size() + setOfHop  .size() + setOfMisc     .size() + setOfYeast.size() +
+                              setOfStyle      .size() + setOfWater.size() + setOfEquipment.size() +
+                              (recipes ? recipes->size() : 0));
+      }
+
+      BeerJson::Exporter exporter(outFile, userMessageAsStream, progress);
+      bool const completed =
+         (setOfFermentable.isEmpty()    || exporter.add(setOfFermentable.values())) &&
+         (setOfHop        .isEmpty()    || exporter.add(setOfHop        .values())) &&
+         (setOfMisc       .isEmpty()    || exporter.add(setOfMisc       .values())) &&
+         (setOfYeast      .isEmpty()    || exporter.add(setOfYeast      .values())) &&
+         (setOfStyle      .isEmpty()    || exporter.add(setOfStyle      .values())) &&
+         (setOfEquipment  .isEmpty()    || exporter.add(setOfEquipment  .values())) &&
+         (setOfWater      .isEmpty()    || exporter.add(setOfWater      .values())) &&
+         (!recipes || recipes->isEmpty() || exporter.add(*recipes                 ));
 
       exporter.close();
-      return;
+      if (!completed) {
+         exportCancelled();
+      }
+      return completed;
    }
 
    if (filename.endsWith("xml", Qt::CaseInsensitive)) {
@@ -341,19 +723,81 @@ void ImportExport::exportToFile(QList<Recipe      const *> const * recipes,
       //    RECIPES
       //    EQUIPMENTS
       //
-      if (hops         && hops        ->size() > 0) { bxml.toXml(*hops,         outFile); }
-      if (fermentables && fermentables->size() > 0) { bxml.toXml(*fermentables, outFile); }
-      if (yeasts       && yeasts      ->size() > 0) { bxml.toXml(*yeasts,       outFile); }
-      if (miscs        && miscs       ->size() > 0) { bxml.toXml(*miscs,        outFile); }
-      if (waters       && waters      ->size() > 0) { bxml.toXml(*waters,       outFile); }
-      if (styles       && styles      ->size() > 0) { bxml.toXml(*styles,       outFile); }
-      if (recipes      && recipes     ->size() > 0) { bxml.toXml(*recipes,      outFile); }
-      if (equipments   && equipments  ->size() > 0) { bxml.toXml(*equipments,   outFile); }
+      auto sizeOf = [](auto const * list) { return list ? list->size() : 0; };
+      if (setNumRecordsToWrite) {
+         setNumRecordsToWrite(sizeOf(hops  ) + sizeOf(fermentables) + sizeOf(yeasts ) + sizeOf(miscs     ) +
+                              sizeOf(waters) + sizeOf(styles      ) + sizeOf(recipes) + sizeOf(equipments));
+      }
 
-      return;
+      // BeerXML::toXml does nothing for an empty list, so we only need to check for null ones
+      bool const completed =
+         (!hops         || bxml.toXml(*hops,         outFile, progress)) &&
+         (!fermentables || bxml.toXml(*fermentables, outFile, progress)) &&
+         (!yeasts       || bxml.toXml(*yeasts,       outFile, progress)) &&
+         (!miscs        || bxml.toXml(*miscs,        outFile, progress)) &&
+         (!waters       || bxml.toXml(*waters,       outFile, progress)) &&
+         (!styles       || bxml.toXml(*styles,       outFile, progress)) &&
+         (!recipes      || bxml.toXml(*recipes,      outFile, progress)) &&
+         (!equipments   || bxml.toXml(*equipments,   outFile, progress));
+
+      if (!completed) {
+         exportCancelled();
+      }
+      return completed;
    }
 
    qInfo() << Q_FUNC_INFO << "Don't understand file extension on" << filename << "so ignoring!";
 
+   return false;
+}
+
+void ImportExport::exportToFile(QList<Recipe      const *> const * recipes,
+                                QList<Equipment   const *> const * equipments,
+                                QList<Fermentable const *> const * fermentables,
+                                QList<Hop         const *> const * hops,
+                                QList<Misc        const *> const * miscs,
+                                QList<Style       const *> const * styles,
+                                QList<Water       const *> const * waters,
+                                QList<Yeast       const *> const * yeasts) {
+   // It's the caller's responsibility to ensure that at least one list is supplied and that at least one of the
+   // supplied lists is non-empty
+   Q_ASSERT((recipes      && recipes     ->size() > 0) ||
+            (equipments   && equipments  ->size() > 0) ||
+            (fermentables && fermentables->size() > 0) ||
+            (hops         && hops        ->size() > 0) ||
+            (miscs        && miscs       ->size() > 0) ||
+            (styles       && styles      ->size() > 0) ||
+            (waters       && waters      ->size() > 0) ||
+            (yeasts       && yeasts      ->size() > 0));
+
+   auto selectedFiles = selectFiles(ImportOrExport::EXPORT);
+   if (!selectedFiles) {
+      return;
+   }
+   QString const filename = (*selectedFiles)[0];
+
+   QProgressDialog progressDialog{QObject::tr("Exporting to %1...").arg(QFileInfo{filename}.fileName()),
+                                  QObject::tr("Cancel"),
+                                  0,
+                                  0,
+                                  &MainWindow::instance()};
+   // See comment in exportToNamedFile() for why we need the dialog to be application modal
+   progressDialog.setWindowModality(Qt::ApplicationModal);
+   qsizetype numRecordsWritten = 0;
+   ImportExport::ExportProgress const progress = [&progressDialog, &numRecordsWritten](qsizetype const numJustWritten) {
+      numRecordsWritten += numJustWritten;
+      progressDialog.setValue(static_cast<int>(numRecordsWritten));
+      QApplication::processEvents();
+      return !progressDialog.wasCanceled();
+   };
+   ImportExport::exportToNamedFile(
+      filename,
+      progress,
+      [&progressDialog](qsizetype const numRecordsToWrite) {
+         progressDialog.setMaximum(static_cast<int>(numRecordsToWrite));
+         return;
+      },
+      recipes, equipments, fermentables, hops, miscs, styles, waters, yeasts
+   );
    return;
 }
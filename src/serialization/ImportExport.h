@@ -18,9 +18,12 @@
 #define SERIALIZATION_IMPORTEXPORT_H
 #pragma once
 
+#include <functional>
 #include <optional>
 
 #include <QList>
+#include <QStringList>
+#include <QTextStream>
 
 class Equipment;
 class Fermentable;
@@ -33,6 +36,52 @@ class Yeast;
 
 namespace ImportExport {
 
+   /**
+    * \brief The second stage of importing a file, as returned by \c BeerJson::prepareImport and
+    *        \c BeerXML::prepareImport: creating objects from the (already read and validated) contents of the file and
+    *        storing them in the DB.  This must be called on the main thread.
+    *
+    *        The parameter and return value are as for \c BeerJson::import.
+    */
+   using LoadAndStore = std::function<bool(QTextStream & userMessage)>;
+
+   /**
+    * \brief Used by \c BeerJson::Exporter and \c BeerXML::toXml to report progress during export, and to find out
+    *        whether the user wants to cancel it.  This is always called on the main thread.
+    *
+    * \param numRecordsWritten How many records have been written since the last call.  (This can be 0, as we also
+    *                          call periodically while waiting for records to be serialised, so that the UI can stay
+    *                          responsive.)
+    *
+    * \return \c false if the export should stop
+    */
+   using ExportProgress = std::function<bool(qsizetype const numRecordsWritten)>;
+
+   /**
+    * \brief Serialise a list of records on worker threads and write the results out, in order, on the calling thread.
+    *
+    *        The records are split into slices of consecutive records.  Each slice is serialised by one call to
+    *        \c serialiseSlice on a worker thread.  The results are passed, in order, to \c writeSlice on the calling
+    *        thread.  We only keep a few slices ahead of the one being written, so we never hold much of the output in
+    *        memory at once.
+    *
+    *        It is the caller's responsibility to ensure the objects being exported are not modified until we return.
+    *        (In particular, see \c Recipe::ensureCalculationsDone.)
+    *
+    * \param numRecords
+    * \param serialiseSlice Serialises the records with indexes in the range [ \c begin, \c end ).  Must be safe to
+    *                       call from several threads at once.
+    * \param writeSlice Writes out the result of one call to \c serialiseSlice
+    * \param progress Can be empty (ie \c nullptr)
+    *
+    * \return \c false if the user cancelled, \c true otherwise
+    */
+   template<class SliceResult>
+   bool exportInParallel(qsizetype const numRecords,
+                         std::function<SliceResult(qsizetype const begin, qsizetype const end)> const & serialiseSlice,
+                         std::function<void(SliceResult & sliceResult)> const & writeSlice,
+                         ExportProgress const & progress);
+
    /**
     * \brief Import recipes, hops, equipment, etc from BeerXML or BeerJSON files either specified by the user or in the
     *        parameter.
@@ -47,6 +96,23 @@ namespace ImportExport {
     */
    bool importFromFiles(std::optional<QStringList> inputFiles = std::nullopt);
 
+   /**
+    * \brief Import the default content files that ship with the program (see \c DefaultContentLoader).  This is the
+    *        same as \c importFromFiles, except that:
+    *          - Everything is stored in a single DB transaction, rather than one per record, which is a lot quicker.
+    *          - BeerJSON files are not validated against the JSON schema.  These are our own files, which have not
+    *            changed since we shipped them, so validating them again each time just slows down first launch (and
+    *            upgrades).  (BeerXML files are still validated, as Xerces does this while parsing.)
+    *          - There is no progress dialog, and so no way to cancel part way through.  (Keeping a dialog going would
+    *            mean processing events inside the transaction.)
+    *          - The user gets one summary message at the end, rather than one per file.
+    *
+    * \param inputFiles Full paths of the files to import, in the order they should be imported
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool importDefaultContent(QStringList const & inputFiles);
+
    /**
     * \brief Import recipes, hops, equipment, etc to a BeerXML or BeerJSON file specified by the user
     *        (We'll work out whether it's BeerXML or BeerJSON based on the filename extension, so doesn't need to be
@@ -72,6 +138,31 @@ namespace ImportExport {
                      QList<Style       const *> const * styles       = nullptr,
                      QList<Water       const *> const * waters       = nullptr,
                      QList<Yeast       const *> const * yeasts       = nullptr);
+
+   /**
+    * \brief Does the work of \c exportToFile once we know which file to write to, without needing any UI (so it can
+    *        also be used in unit tests).  The objects being exported must not be modified until we return.
+    *
+    * \param filename As for \c exportToFile, the extension determines whether we write BeerXML or BeerJSON
+    * \param progress Can be \c nullptr
+    * \param setNumRecordsToWrite If not \c nullptr, called once, before any records are written, with the total number
+    *                             of records we are going to write
+    * \param recipes, equipments, fermentables, hops, miscs, styles, waters, yeasts As for \c exportToFile
+    *
+    * \return \c true if the export completed, \c false if it failed or \c progress cancelled it (in which case we
+    *         remove the partly-written file)
+    */
+   bool exportToNamedFile(QString const & filename,
+                          ExportProgress const & progress,
+                          std::function<void(qsizetype const numRecordsToWrite)> const & setNumRecordsToWrite,
+                          QList<Recipe      const *> const * recipes,
+                          QList<Equipment   const *> const * equipments   = nullptr,
+                          QList<Fermentable const *> const * fermentables = nullptr,
+                          QList<Hop         const *> const * hops         = nullptr,
+                          QList<Misc        const *> const * miscs        = nullptr,
+                          QList<Style       const *> const * styles       = nullptr,
+                          QList<Water       const *> const * waters       = nullptr,
+                          QList<Yeast       const *> const * yeasts       = nullptr);
 }
 
 #endif
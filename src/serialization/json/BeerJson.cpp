@@ -16,11 +16,15 @@
 #include "serialization/json/BeerJson.h"
 
 #include <cstdlib>
+#include <sstream>
+#include <string>
+#include <string_view>
 
 // We could just include <boost/json.hpp> which pulls all the Boost.JSON headers in, but that seems overkill
 #include <boost/json/kind.hpp>
 #include <boost/json/parse_options.hpp>
 #include <boost/json/parse.hpp>
+#include <boost/json/serialize.hpp>
 #include <boost/json/string.hpp>
 
 #include <valijson/adapters/boost_json_adapter.hpp>
@@ -30,8 +34,8 @@
 
 #include <QApplication>
 #include <QDebug>
+#include <QFileInfo>
 
-#include "database/ObjectStoreWrapper.h"
 #include "model/Boil.h"
 #include "model/BrewNote.h"
 #include "model/Equipment.h"
@@ -63,6 +67,13 @@ namespace {
    // min/max versions we can read plus whatever version we write.
    BtStringConst const jsonVersionWeSupport{"2.06"};
 
+   //
+   // Files at least this big get read in one record at a time (see JsonCoding::streamValidateLoadAndStoreInDb) rather
+   // than all in one go.  Smaller files are read in one go because then we can reject an invalid file before storing
+   // anything from it.
+   //
+   qint64 constexpr minFileSizeForStreamedImport = 16 * 1024 * 1024;
+
    // These are only used in BEER_JSON_RECORD_DEFN<Equipment>
    BtStringConst const nameForHlt            {"Hot Liquor Tank" };
    BtStringConst const nameForMashTun        {"Mash Tun"        };
@@ -1160,9 +1171,28 @@ namespace {
    //=-=-=-=-=-=-=-=-
 
    /**
-    * \brief This function first validates the input file against a JSON schema (https://json-schema.org/)
+    * \brief This function reads the input file and validates it against a JSON schema (https://json-schema.org/).  See
+    *        \c BeerJson::prepareImport for why we don't load it here as well.
     */
-   bool validateAndLoad(QString const & fileName, QTextStream & userMessage) {
+   std::optional<ImportExport::LoadAndStore> validateAndPrepare(QString const & fileName,
+                                                                QTextStream & userMessage,
+                                                                bool const validateAgainstSchema = true) {
+      qint64 const fileSize = QFileInfo{fileName}.size();
+      if (fileSize >= minFileSizeForStreamedImport) {
+         //
+         // In this case, the version number only gets checked (by schema validation) once all the records have been
+         // read.  That's OK because, for now, there is only one version of BeerJSON (see below).
+         //
+         // Because we store each record as soon as we've read it, all the work here has to be done on the main thread,
+         // so there's nothing we can do in advance.
+         //
+         qInfo() << Q_FUNC_INFO << fileName << "is" << fileSize << "bytes, so reading it one record at a time";
+         return [fileName, validateAgainstSchema](QTextStream & userMessage) {
+            RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
+            return BEER_JSON_1_CODING.streamValidateLoadAndStoreInDb(fileName, userMessage, validateAgainstSchema);
+         };
+      }
+
       boost::json::value inputDocument;
       try {
          inputDocument = JsonUtils::loadJsonDocument(fileName);
@@ -1170,7 +1200,7 @@ namespace {
          qWarning() <<
             Q_FUNC_INFO << "Caught exception while reading" << fileName << ":" << exception.what();
          userMessage << exception.what();
-         return false;
+         return std::nullopt;
       }
 
       //
@@ -1221,7 +1251,7 @@ namespace {
       if (beerJsonVersion.isEmpty()) {
          qWarning() << Q_FUNC_INFO << "Unable to read BeerJSON version from" << fileName;
          userMessage << "Invalid BeerJSON file: could not read version number";
-         return false;
+         return std::nullopt;
       }
 
       //
@@ -1240,7 +1270,21 @@ namespace {
       // line.
 //      qDebug() << Q_FUNC_INFO << "JSON file read in is:" << inputDocument;
 
-      return BEER_JSON_1_CODING.validateLoadAndStoreInDb(inputDocument, userMessage);
+      if (!validateAgainstSchema) {
+         qInfo() << Q_FUNC_INFO << "Skipping schema validation of" << fileName;
+      } else if (!BEER_JSON_1_CODING.validate(inputDocument, userMessage)) {
+         return std::nullopt;
+      }
+
+      return [inputDocument = std::move(inputDocument)](QTextStream & userMessage) mutable {
+         //
+         // During importation we do not want automatic versioning turned on because, during the process of reading in
+         // a Recipe we'll end up creating load of versions of it.  The magic of RAII means it's a one-liner to suspend
+         // automatic versioning, in an exception-safe way, until the end of this function.
+         //
+         RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
+         return BEER_JSON_1_CODING.loadAndStoreInDb(inputDocument, userMessage);
+      };
    }
 
 }
@@ -1251,27 +1295,45 @@ bool BeerJson::import(QString const & filename, QTextStream & userMessage) {
    //          bits to one place.
 
    //
-   // During importation we do not want automatic versioning turned on because, during the process of reading in a
-   // Recipe we'll end up creating load of versions of it.  The magic of RAII means it's a one-liner to suspend
-   // automatic versioning, in an exception-safe way, until the end of this function.
-   //
-   RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
-
-   //
-   // Slightly more manually, we also change the cursor to show "busy" while we're doing the import as, for large
-   // imports, processing can take a few seconds or so.
+   // We change the cursor to show "busy" while we're doing the import as, for large imports, processing can take a few
+   // seconds or so.  (Automatic versioning of recipes is suspended by the load-and-store stage.)
    //
    QApplication::setOverrideCursor(Qt::WaitCursor);
    QApplication::processEvents();
-   bool result = validateAndLoad(filename, userMessage);
+   std::optional<ImportExport::LoadAndStore> loadAndStore = validateAndPrepare(filename, userMessage);
+   bool const result = loadAndStore && (*loadAndStore)(userMessage);
    QApplication::restoreOverrideCursor();
    return result;
 }
 
+std::optional<ImportExport::LoadAndStore> BeerJson::prepareImport(QString const & filename,
+                                                                  QTextStream & userMessage,
+                                                                  bool const validateAgainstSchema) {
+   return validateAndPrepare(filename, userMessage, validateAgainstSchema);
+}
+
 namespace BeerJson {
    //
    // This private implementation class holds all private non-virtual members of Exporter
    //
+   // Rather than building the whole document in memory and serialising it at the end, we write the beginning of the
+   // document straight away, and then records as soon as they are converted to JSON.  (Records are converted in small
+   // groups on worker threads -- see ImportExport::exportInParallel.)  So, however much we are exporting, we only ever
+   // hold a few dozen records at a time in memory.  The output is laid out as follows:
+   //
+   //    {
+   //      "beerjson": {
+   //        "version": 2.1,
+   //        "fermentables": [
+   //          {
+   //            ...
+   //          },
+   //          ...
+   //        ],
+   //        ...
+   //      }
+   //    }
+   //
    class Exporter::impl {
    public:
 
@@ -1280,14 +1342,17 @@ namespace BeerJson {
       */
       impl(Exporter & self,
          QFile & outFile,
-         QTextStream & userMessage) : self{self},
-                                      outFile{outFile},
-                                      userMessage{userMessage},
-                                      writtenToFile{false},
-                                      outputDocument{} {
+         QTextStream & userMessage,
+         ImportExport::ExportProgress const & progress) : self{self},
+                                                          outFile{outFile},
+                                                          userMessage{userMessage},
+                                                          progress{progress},
+                                                          outStream{outFile},
+                                                          writtenToFile{false} {
+         this->outStream << "{\n" << indent << "\"beerjson\": {\n" << indent << indent << "\"version\": ";
          // We have to pass in jsonVersionWeSupport as a double, not a char * or a std::string, otherwise it will get
          // quotes put around it.
-         this->outputDocument["beerjson"] = { {"version", std::atof(*jsonVersionWeSupport)} };
+         JsonUtils::serialize(this->outStream, boost::json::value(std::atof(*jsonVersionWeSupport)), indent);
          return;
       }
 
@@ -1296,17 +1361,20 @@ namespace BeerJson {
       */
       ~impl() = default;
 
+      //! Indentation for one level of nesting in the output
+      static constexpr std::string_view indent{"  "};
+
       Exporter & self;
       QFile & outFile;
       QTextStream & userMessage;
+      ImportExport::ExportProgress const progress;
+      OStreamWriterForQFile outStream;
+      //! Set once we've written the end of the document
       bool writtenToFile;
-
-      boost::json::object outputDocument;
-
    };
 
-   Exporter::Exporter(QFile & outFile, QTextStream & userMessage) :
-      pimpl{std::make_unique<impl>(*this, outFile, userMessage)} {
+   Exporter::Exporter(QFile & outFile, QTextStream & userMessage, ImportExport::ExportProgress const & progress) :
+      pimpl{std::make_unique<impl>(*this, outFile, userMessage, progress)} {
       return;
    }
 
@@ -1315,23 +1383,62 @@ namespace BeerJson {
       return;
    }
 
-   template<class NE> void Exporter::add(QList<NE const *> const & nes) {
-      QList< std::shared_ptr<NamedEntity> > objectsToWrite;
-      objectsToWrite.reserve(nes.size());
-      for (NE const * ne : nes) {
-         //
-         // We have to cast away const on ne, as otherwise we'll end up with static_pointer to const that's harder to
-         // cast away.  Or we'd have to write const and non-const versions of all the functions we're calling, which
-         // is strictly correct but a bit overkill here.
-         //
-         objectsToWrite.append(
-            std::static_pointer_cast<NamedEntity>(ObjectStoreWrapper::getSharedFromRaw(const_cast<NE *>(ne)))
-         );
-      }
-      boost::json::array outputArray;
-      JsonRecord::listToJson(objectsToWrite, outputArray, BEER_JSON_1_CODING, BEER_JSON_RECORD_DEFN<NE>);
-      this->pimpl->outputDocument["beerjson"].get_object()[*BEER_JSON_RECORD_DEFN<NE>.m_recordName] = outputArray;
-      return;
+   template<class NE> bool Exporter::add(QList<NE const *> const & nes) {
+      // It's a coding error to try to add things after the end of the document has been written
+      Q_ASSERT(!this->pimpl->writtenToFile);
+
+      std::string const arrayIndent = std::string{impl::indent} + std::string{impl::indent};
+
+      // Per the comment in JsonUtils::serialize, the key needs to be escaped in case it contains special characters
+      boost::json::string_view const key{*BEER_JSON_RECORD_DEFN<NE>.m_recordName};
+      this->pimpl->outStream << ",\n" << arrayIndent << boost::json::serialize(key) << ": [";
+
+      //
+      // Each record is written with a comma in front of it, and we remove the one in front of the first record we
+      // write.  (We can't just leave it off the first record in the list, as that might be one we can't export.)
+      //
+      bool firstWritten = false;
+      bool const completed = ImportExport::exportInParallel<std::string>(
+         nes.size(),
+         [&nes, &arrayIndent](qsizetype const begin, qsizetype const end) {
+            std::ostringstream sliceJson;
+            std::string recordIndent = arrayIndent + std::string{impl::indent};
+            for (qsizetype ii = begin; ii < end; ++ii) {
+               NE const & ne = *nes.at(ii);
+               // We need the containing entity to be a value of type object.  See comments on JsonRecord constructor
+               // in json/JsonRecord.h for why we have to take care about object vs value.  (Also, we can't use braces
+               // on this constructor until Boost 1.81!)
+               boost::json::value neJson(boost::json::object_kind);
+               std::unique_ptr<JsonRecord> jsonRecord{BEER_JSON_RECORD_DEFN<NE>.makeRecord(BEER_JSON_1_CODING, neJson)};
+               if (!jsonRecord->toJson(ne)) {
+                  qWarning() <<
+                     Q_FUNC_INFO << "Unable to export" << ne.metaObject()->className() << "#" << ne.key() <<
+                     "so skipping it";
+                  continue;
+               }
+               sliceJson << ",\n" << recordIndent;
+               JsonUtils::serialize(sliceJson, neJson, impl::indent, &recordIndent);
+            }
+            return sliceJson.str();
+         },
+         [this, &firstWritten](std::string & sliceJson) {
+            if (sliceJson.empty()) {
+               return;
+            }
+            std::string_view toWrite{sliceJson};
+            if (!firstWritten) {
+               toWrite.remove_prefix(1);
+               firstWritten = true;
+            }
+            // OStreamWriterForQFile is unbuffered, so it's fine (and quicker) to write a whole slice direct to the file
+            this->pimpl->outFile.write(toWrite.data(), static_cast<qint64>(toWrite.size()));
+            return;
+         },
+         this->pimpl->progress
+      );
+
+      this->pimpl->outStream << "\n" << arrayIndent << "]";
+      return completed;
    }
 
    //
@@ -1339,26 +1446,26 @@ namespace BeerJson {
    // (This is all just a trick to allow the template definition to be here in the .cpp file and not in the header,
    // which means, amongst other things, that we can reference the pimpl.)
    //
-   template void Exporter::add(QList<Hop         const *> const & nes);
-   template void Exporter::add(QList<Fermentable const *> const & nes);
-   template void Exporter::add(QList<Yeast       const *> const & nes);
-   template void Exporter::add(QList<Misc        const *> const & nes);
-   template void Exporter::add(QList<Water       const *> const & nes);
-   template void Exporter::add(QList<Style       const *> const & nes);
-   template void Exporter::add(QList<MashStep    const *> const & nes);
-   template void Exporter::add(QList<Mash        const *> const & nes);
-   template void Exporter::add(QList<Equipment   const *> const & nes);
-   template void Exporter::add(QList<Instruction const *> const & nes);
-   template void Exporter::add(QList<BrewNote    const *> const & nes); // TBD: Not part of BeerJSON
-   template void Exporter::add(QList<Recipe      const *> const & nes);
+   template bool Exporter::add(QList<Hop         const *> const & nes);
+   template bool Exporter::add(QList<Fermentable const *> const & nes);
+   template bool Exporter::add(QList<Yeast       const *> const & nes);
+   template bool Exporter::add(QList<Misc        const *> const & nes);
+   template bool Exporter::add(QList<Water       const *> const & nes);
+   template bool Exporter::add(QList<Style       const *> const & nes);
+   template bool Exporter::add(QList<MashStep    const *> const & nes);
+   template bool Exporter::add(QList<Mash        const *> const & nes);
+   template bool Exporter::add(QList<Equipment   const *> const & nes);
+   template bool Exporter::add(QList<Instruction const *> const & nes);
+   template bool Exporter::add(QList<BrewNote    const *> const & nes); // TBD: Not part of BeerJSON
+   template bool Exporter::add(QList<Recipe      const *> const & nes);
 
    void Exporter::close() {
       if (this->pimpl->writtenToFile) {
          return;
       }
 
-      OStreamWriterForQFile outStream(this->pimpl->outFile);
-      JsonUtils::serialize(outStream, this->pimpl->outputDocument, "  ");
+      this->pimpl->outStream << "\n" << impl::indent << "}\n}\n";
+      this->pimpl->outStream.flush();
 
       this->pimpl->writtenToFile = true;
 
@@ -18,12 +18,15 @@
 #pragma once
 
 #include <memory> // For PImpl
+#include <optional>
 
 #include <QFile>
 #include <QList>
 #include <QString>
 #include <QTextStream>
 
+#include "serialization/ImportExport.h"
+
 namespace BeerJson {
    /*!
     * \brief Import ingredients, recipes, etc from a BeerJSON file
@@ -36,6 +39,23 @@ namespace BeerJson {
     */
    bool import(QString const & filename, QTextStream & userMessage);
 
+   /*!
+    * \brief First stage of \c import: read the file and validate it against the schema, without creating any objects
+    *        or touching the DB.  Unlike \c import, this is safe to call on any thread, so several files can be prepared
+    *        in parallel (see \c ImportExport::importFromFiles).
+    *
+    * \param filename
+    * \param userMessage As for \c import
+    * \param validateAgainstSchema Only set to \c false for files we know to be valid, ie our own default content (see
+    *                              \c ImportExport::importDefaultContent)
+    *
+    * \return The second stage of the import, to be called on the main thread, or \c std::nullopt if the file could not
+    *         be read or is not valid (in which case \c userMessage says why)
+    */
+   std::optional<ImportExport::LoadAndStore> prepareImport(QString const & filename,
+                                                           QTextStream & userMessage,
+                                                           bool const validateAgainstSchema = true);
+
    /**
     * \brief Objects of this class are intended to be relatively short-lived, existing only for the time it takes to
     *        construct the serialized representation and write it to a file.
@@ -46,17 +66,23 @@ namespace BeerJson {
       * \param outFile Should be open already.  Caller is responsible for closing it after \c close() or our destructor
       *                is called
       * \param userMessage
+      * \param progress See \c ImportExport::ExportProgress
       */
-      Exporter(QFile & outFile, QTextStream & userMessage);
+      Exporter(QFile & outFile, QTextStream & userMessage, ImportExport::ExportProgress const & progress = nullptr);
       ~Exporter();
 
       /**
-      * \brief Add a list of \c NamedEntity objects to the serializer
+      * \brief Serialize a list of \c NamedEntity objects and write them to the file.  Records are serialized on worker
+      *        threads (see \c ImportExport::exportInParallel), so must not be modified until this function returns,
+      *        and are written out in small groups as soon as they are ready, so we never hold the whole document in
+      *        memory.  Should be called at most once for each type of \c NamedEntity.
+      *
+      * \return \c false if the user cancelled the export, \c true otherwise
       */
-      template<class NE> void add(QList<NE const *> const & nes);
+      template<class NE> bool add(QList<NE const *> const & nes);
 
       /**
-      * \brief Write the serialized data to the file.  Will be called in destructor if not already invoked directly.
+      * \brief Write the end of the document to the file.  Will be called in destructor if not already invoked directly.
       */
       void close();
 
@@ -16,8 +16,11 @@
 #include "serialization/json/JsonCoding.h"
 
 #include <algorithm>
+#include <optional>
 #include <stdexcept>
+#include <string>
 
+#include <boost/json/array.hpp>
 #include <boost/json/object.hpp>
 
 #include <QDebug>
@@ -54,6 +57,41 @@ public:
     */
    ~impl() = default;
 
+   /**
+    * \brief Used by \c streamValidateLoadAndStoreInDb to deal with each record as it is read in
+    *
+    * \param schema If \c nullptr, the record is not validated
+    */
+   bool validateLoadAndStoreRecord(JsonSchema const * schema,
+                                   std::string_view const arrayName,
+                                   boost::json::value & record,
+                                   QTextStream & userMessage,
+                                   ImportRecordCount & stats) const {
+      if (schema) {
+         // In the schema, what's allowed in each array of records is given by the array's "items" node
+         std::string const subSchemaPointer{"/properties/beerjson/properties/" + std::string{arrayName} + "/items"};
+         if (!schema->validate(record, subSchemaPointer, userMessage)) {
+            qWarning() << Q_FUNC_INFO << "Validation failed for record in" << std::string{arrayName}.c_str();
+            return false;
+         }
+      }
+
+      //
+      // Rather than have a separate code path for reading a single record, we give JsonRecord a root record that
+      // contains just this one record, eg { "hop_varieties": [ {...} ] }.  Other fields of the root record (eg
+      // "version") will be missing, but that's fine, as JsonRecord::load skips over anything not present, and the
+      // caller validates the rest of the document separately.
+      //
+      boost::json::object rootObject;
+      rootObject.emplace(arrayName, boost::json::array{std::move(record)});
+      boost::json::value rootRecordData{std::move(rootObject)};
+      JsonRecord rootRecord{this->m_self, rootRecordData, this->m_rootRecordDefinition};
+      if (!rootRecord.load(userMessage)) {
+         return false;
+      }
+      return JsonRecord::ProcessingResult::Failed != rootRecord.normaliseAndStoreInDb(nullptr, userMessage, stats);
+   }
+
    // Member variables for impl
    JsonCoding & m_self;
    QString const m_name;
@@ -84,6 +122,10 @@ JsonRecordDefinition const & JsonCoding::getRoot() const {
 
 bool JsonCoding::validateLoadAndStoreInDb(boost::json::value & inputDocument,
                                           QTextStream & userMessage) const {
+   return this->validate(inputDocument, userMessage) && this->loadAndStoreInDb(inputDocument, userMessage);
+}
+
+bool JsonCoding::validate(boost::json::value const & inputDocument, QTextStream & userMessage) const {
    try {
       JsonSchema const & schema = JsonSchema::instance(this->pimpl->m_schemaId);
       if (!schema.validate(inputDocument, userMessage)) {
@@ -99,7 +141,10 @@ bool JsonCoding::validateLoadAndStoreInDb(boost::json::value & inputDocument,
    }
 
    qDebug() << Q_FUNC_INFO << "Schema validation succeeded";
+   return true;
+}
 
+bool JsonCoding::loadAndStoreInDb(boost::json::value & inputDocument, QTextStream & userMessage) const {
    //
    // We're expecting the root of the JSON document to be an object named "beerjson".  This should have been
    // established by the validation above.
@@ -152,3 +197,41 @@ bool JsonCoding::validateLoadAndStoreInDb(boost::json::value & inputDocument,
    // true otherwise
    return stats.writeToUserMessage(userMessage);
 }
+
+bool JsonCoding::streamValidateLoadAndStoreInDb(QString const & fileName,
+                                                QTextStream & userMessage,
+                                                bool const validateAgainstSchema) const {
+   if (!validateAgainstSchema) {
+      qInfo() << Q_FUNC_INFO << "Skipping schema validation of" << fileName;
+   }
+   ImportRecordCount stats;
+   try {
+      JsonSchema const * schema =
+         validateAgainstSchema ? &JsonSchema::instance(this->pimpl->m_schemaId) : nullptr;
+      std::optional<boost::json::value> restOfDocument = JsonUtils::streamJsonDocument(
+         fileName,
+         "beerjson",
+         [&](std::string_view const arrayName, boost::json::value & record) {
+            return this->pimpl->validateLoadAndStoreRecord(schema, arrayName, record, userMessage, stats);
+         }
+      );
+      if (!restOfDocument) {
+         return false;
+      }
+
+      //
+      // Now check everything that wasn't a record (eg that there is a version number).  Since the arrays of records
+      // are now empty, this is quick.
+      //
+      if (schema && !schema->validate(*restOfDocument, userMessage)) {
+         qWarning() << Q_FUNC_INFO << "Schema validation failed";
+         return false;
+      }
+   } catch (std::exception const & exception) {
+      qWarning() << Q_FUNC_INFO << "Caught exception while reading" << fileName << ":" << exception.what();
+      userMessage << exception.what();
+      return false;
+   }
+
+   return stats.writeToUserMessage(userMessage);
+}
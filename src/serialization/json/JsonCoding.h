@@ -85,6 +85,42 @@ public:
    bool validateLoadAndStoreInDb(boost::json::value & inputDocument,
                                  QTextStream & userMessage) const;
 
+   /**
+    * \brief First half of \c validateLoadAndStoreInDb: validate JSON file against schema.  This does not create any
+    *        objects or touch the DB, so, unlike the second half, it is safe to call from any thread.
+    *
+    * \return \c true if file validated OK, \c false otherwise
+    */
+   bool validate(boost::json::value const & inputDocument, QTextStream & userMessage) const;
+
+   /**
+    * \brief Second half of \c validateLoadAndStoreInDb: load the contents of an already-validated JSON file into
+    *        objects and store them in the DB.  Must be called on the main thread.
+    *
+    * \return As for \c validateLoadAndStoreInDb
+    */
+   bool loadAndStoreInDb(boost::json::value & inputDocument, QTextStream & userMessage) const;
+
+   /**
+    * \brief As \c validateLoadAndStoreInDb, but reads the file one top-level record (hop variety, recipe, etc) at a
+    *        time, validating and storing each record before reading the next, so that memory use does not depend on
+    *        the size of the file.  See \c JsonUtils::streamJsonDocument().
+    *
+    *        NB: Because we store records as we go, if there is a problem part way through the file, the records before
+    *        it will already have been stored.  (\c validateLoadAndStoreInDb, by contrast, validates the whole document
+    *        before storing anything.)
+    *
+    * \param fileName The JSON file to read
+    * \param userMessage As for \c validateLoadAndStoreInDb
+    * \param validateAgainstSchema If \c false, we skip schema validation (eg because we are reading our own default
+    *                              content, which we know is valid)
+    *
+    * \return As for \c validateLoadAndStoreInDb
+    */
+   bool streamValidateLoadAndStoreInDb(QString const & fileName,
+                                       QTextStream & userMessage,
+                                       bool const validateAgainstSchema = true) const;
+
 private:
    // Private implementation details - see https://herbsutter.com/gotw/_100/
    class impl;
@@ -17,12 +17,17 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 
 #include <QDebug>
 #include <QMap>
 #include <QObject>
 #include <QString>
 
+#include <boost/json/array.hpp>
+#include <boost/json/object.hpp>
+
 #include <valijson/adapters/boost_json_adapter.hpp>
 #include <valijson/schema.hpp>
 #include <valijson/schema_parser.hpp>
@@ -62,6 +67,13 @@ namespace {
    // why we are not using static variables to hold them.)
    std::map<JsonSchema::Id, std::unique_ptr<JsonSchema const>> jsonSchemas;
 
+   //
+   // Imports can validate documents on worker threads (see ImportExport::importFromFiles).  Validating against a schema
+   // that has been built is read-only, but building one is not, so this guards jsonSchemas and, for each schema, its
+   // sub-schemas and cache of schema files.
+   //
+   std::mutex schemaBuildMutex;
+
    //
    // A JSON schema can be spread across several files linked together via "$ref" statements in the JSON.  Valijson uses
    // callbacks to fetch such referenced JSON documents when it is loading in a schema.  We cannot use a non-static
@@ -113,6 +125,35 @@ namespace {
          Q_FUNC_INFO << "At node" << nodePath.asString() << "error was" << validationError.description.c_str();
       return QObject::tr("At node %1, error was %2").arg(nodePath.asString()).arg(validationError.description.c_str());
    }
+
+   /**
+    * \brief Validate a JSON document (or part of one) against a schema (or part of one)
+    */
+   bool validateAgainst(valijson::Schema const & schema,
+                        boost::json::value const & document,
+                        QTextStream & userMessage) {
+      // Pass the input document into Valijson (via a wrapper as with the base schema document) and validate it against
+      // the schema
+      valijson::adapters::BoostJsonAdapter inputAdapter{document};
+      valijson::Validator validator;
+      valijson::ValidationResults validationResults;
+      if (!validator.validate(schema, inputAdapter, &validationResults)) {
+         qWarning() << Q_FUNC_INFO << validationResults.numErrors() << "validation errors in JSON file";
+         // If there is more than one error, then we'll log them all here but only show the first one to the user on
+         // the screen.  (Otherwise we might risk information overload.)
+         userMessage <<
+            QObject::tr("%1 errors found in JSON file.  First error: ").arg(validationResults.numErrors()) <<
+            validationErrorToString(*validationResults.begin());
+         int errNum = 1;
+         for (auto err = validationResults.begin(); err != validationResults.end(); ++err, ++errNum) {
+            qWarning() << Q_FUNC_INFO << "Validation error #" << errNum << ":" << validationErrorToString(*err);
+         }
+         return false;
+      }
+
+      qDebug() << Q_FUNC_INFO << "Validation succeeded";
+      return true;
+   }
 }
 
 // This private implementation class holds all private non-virtual members of JsonSchema
@@ -130,7 +171,8 @@ public:
       schemaFileCache{},
       schemaAdapter{*this->getReferencedDocument(std::string(fileName))},
       jsonSchema{},
-      schemaParser{} {
+      schemaParser{},
+      subSchemas{} {
 
       return;
    }
@@ -210,6 +252,54 @@ public:
       return this->schemaFileCache.value(schemaFilePath).get();
    }
 
+   /**
+    * \brief Get the schema for the node at \c subSchemaPointer in our base file, building it if we haven't already.
+    *
+    * \return \c nullptr if there is no such node
+    */
+   valijson::Schema const * getSubSchema(std::string_view const subSchemaPointer) {
+      std::lock_guard const lock{schemaBuildMutex};
+      auto const existing = this->subSchemas.find(subSchemaPointer);
+      if (existing != this->subSchemas.end()) {
+         return &existing->second.schema;
+      }
+
+      boost::json::value const & baseDocument = *this->getReferencedDocument(std::string(this->fileName));
+      std::error_code errorCode;
+      boost::json::value const * subSchemaNode = baseDocument.find_pointer(subSchemaPointer, errorCode);
+      if (!subSchemaNode) {
+         qWarning() <<
+            Q_FUNC_INFO << "No node at" << std::string(subSchemaPointer).c_str() << "in" << this->fileName << ":" <<
+            errorCode.message().c_str();
+         return nullptr;
+      }
+
+      //
+      // The node will usually just be a reference to a definition in one of the other files, eg
+      // { "$ref": "hop.json#/definitions/VarietyInformation" }.  For Valijson to resolve it exactly as it does when
+      // parsing the whole schema, we put it inside a small document with the same $schema and $id as the base file.
+      //
+      boost::json::object wrapper;
+      boost::json::object const & baseObject = baseDocument.as_object();
+      for (char const * const key : {"$schema", "$id"}) {
+         if (boost::json::value const * value = baseObject.if_contains(key)) {
+            wrapper.emplace(key, *value);
+         }
+      }
+      wrapper.emplace("allOf", boost::json::array{*subSchemaNode});
+
+      SubSchema & subSchema = this->subSchemas.try_emplace(std::string{subSchemaPointer}).first->second;
+      subSchema.document = std::move(wrapper);
+      currentJsonSchema = &this->self;
+      valijson::adapters::BoostJsonAdapter wrapperAdapter{subSchema.document};
+      this->schemaParser.populateSchema(wrapperAdapter,
+                                        subSchema.schema,
+                                        &JsonSchema::fetchReferencedDocument,
+                                        &freeReferencedDocument);
+      qDebug() << Q_FUNC_INFO << "Sub-schema" << std::string(subSchemaPointer).c_str() << "populated";
+      return &subSchema.schema;
+   }
+
 
    // Member variables
    JsonSchema & self;
@@ -221,6 +311,16 @@ public:
    valijson::adapters::BoostJsonAdapter schemaAdapter;
    valijson::Schema jsonSchema;
    valijson::SchemaParser schemaParser;
+
+   //! See \c getSubSchema
+   struct SubSchema {
+      boost::json::value document;
+      valijson::Schema schema;
+   };
+   // We use std::map rather than QMap for the same reason as for jsonSchemas above.  (Also, std::map never moves its
+   // elements, so it's safe for Valijson to hang on to references into SubSchema::document.)  The std::less<> allows
+   // us to look up with std::string_view.
+   std::map<std::string, SubSchema, std::less<>> subSchemas;
 };
 
 
@@ -243,6 +343,7 @@ JsonSchema const & JsonSchema::instance(JsonSchema::Id id) {
    ///if (jsonSchemas.contains(id)) {
    ///   return *jsonSchemas.value(id);
    ///}
+   std::lock_guard const lock{schemaBuildMutex};
    auto result = jsonSchemas.find(id);
    if (result != jsonSchemas.end()) {
       return *result->second;
@@ -274,28 +375,18 @@ JsonSchema const & JsonSchema::instance(JsonSchema::Id id) {
 
 
 bool JsonSchema::validate(boost::json::value const & document, QTextStream & userMessage) const {
+   return validateAgainst(this->pimpl->jsonSchema, document, userMessage);
+}
 
-   // Now pass the input document into Valijson (via a wrapper as with the base schema document) and validate it against
-   // the schema
-   valijson::adapters::BoostJsonAdapter inputAdapter{document};
-   valijson::Validator validator;
-   valijson::ValidationResults validationResults;
-   if (!validator.validate(this->pimpl->jsonSchema, inputAdapter, &validationResults)) {
-      qWarning() << Q_FUNC_INFO << validationResults.numErrors() << "validation errors in JSON file";
-      // If there is more than one error, then we'll log them all here but only show the first one to the user on
-      // the screen.  (Otherwise we might risk information overload.)
-      userMessage <<
-         QObject::tr("%1 errors found in JSON file.  First error: ").arg(validationResults.numErrors()) <<
-         validationErrorToString(*validationResults.begin());
-      int errNum = 1;
-      for (auto err = validationResults.begin(); err != validationResults.end(); ++err, ++errNum) {
-         qWarning() << Q_FUNC_INFO << "Validation error #" << errNum << ":" << validationErrorToString(*err);
-      }
+bool JsonSchema::validate(boost::json::value const & document,
+                          std::string_view const subSchemaPointer,
+                          QTextStream & userMessage) const {
+   valijson::Schema const * subSchema = this->pimpl->getSubSchema(subSchemaPointer);
+   if (!subSchema) {
+      userMessage << QObject::tr("Unexpected JSON element %1").arg(std::string(subSchemaPointer).c_str());
       return false;
    }
-
-   qDebug() << Q_FUNC_INFO << "Validation succeeded";
-   return true;
+   return validateAgainst(*subSchema, document, userMessage);
 }
 
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <memory> // For PImpl
+#include <string_view>
 
 #include <boost/json/value.hpp>
 
@@ -70,6 +71,24 @@ public:
     */
    bool validate(boost::json::value const & document, QTextStream & userMessage) const;
 
+   /**
+    * \brief Validate part of a JSON document against the corresponding part of the schema.  Eg, when we are streaming
+    *        records in from a large file (see \c JsonUtils::streamJsonDocument()) we validate each record on its own.
+    *
+    *        The first call for a given \c subSchemaPointer builds the sub-schema, which we then keep for subsequent
+    *        calls.
+    *
+    * \param document The part of the JSON document to validate, eg one hop variety record
+    * \param subSchemaPointer JSON Pointer (RFC 6901) to the node in the base file of the schema that \c document
+    *                         should be validated against, eg "/properties/beerjson/properties/hop_varieties/items"
+    * \param userMessage As for the other overload
+    *
+    * \return As for the other overload.  Also \c false if there is no node at \c subSchemaPointer in the schema.
+    */
+   bool validate(boost::json::value const & document,
+                 std::string_view const subSchemaPointer,
+                 QTextStream & userMessage) const;
+
 private:
    // Private implementation details - see https://herbsutter.com/gotw/_100/
    class impl;
@@ -15,15 +15,22 @@
  =====================================================================================================================*/
 #include "serialization/json/JsonUtils.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
 // We could just include <boost/json.hpp> which pulls all the Boost.JSON headers in, but that seems overkill
+#include <boost/json/array.hpp>
+#include <boost/json/basic_parser_impl.hpp>
+#include <boost/json/object.hpp>
 #include <boost/json/parse_options.hpp>
 #include <boost/json/parse.hpp>
 #include <boost/json/string.hpp>
 #include <boost/json/serialize.hpp>
 #include <boost/json/stream_parser.hpp>
+#include <boost/json/value_stack.hpp>
 
 #include <QDebug>
 #include <QFile>
@@ -32,31 +39,302 @@
 #include "utils/BtException.h"
 #include "utils/BtStringStream.h"
 #include "utils/ErrorCodeToStream.h"
+#include "utils/MappedFile.h"
+
+namespace {
+   /**
+    * \brief Open (and map) a JSON file for reading and check it's not empty
+    *
+    * \throw BtException containing text that can be displayed to the user
+    */
+   void openInputFile(MappedFile & inputFile, QString const & fileName) {
+      if (!inputFile.open()) {
+         // Some slight duplication here but there's value in having the log messages in English and the on-screen
+         // display message in the user's preferred language
+         qWarning() <<
+            Q_FUNC_INFO << "Could not open " << fileName << " for reading (error #" << inputFile.file().error() <<
+            ":" << inputFile.file().errorString() << ")";
+         QString errorMessage{
+            QObject::tr("Could not open %1 for reading (error # %2)").arg(fileName).arg(inputFile.file().error())
+         };
+         throw BtException(errorMessage);
+      }
 
-[[nodiscard]] boost::json::value JsonUtils::loadJsonDocument(QString const & fileName, bool allowComments) {
-
-   QFile inputFile(fileName);
+      qint64 fileSize = inputFile.contents().size();
+      if (fileSize <= 0) {
+         BtStringStream errorMessage;
+         errorMessage << "File " << fileName << " has no data (length is " << fileSize << " bytes)";
+         qWarning() << Q_FUNC_INFO << errorMessage.asString();
+         throw BtException(errorMessage.asString());
+      }
+      return;
+   }
 
-   if (!inputFile.open(QIODevice::ReadOnly)) {
-      // Some slight duplication here but there's value in having the log messages in English and the on-screen display
-      // message in the user's preferred language
-      qWarning() <<
-         Q_FUNC_INFO << "Could not open " << fileName << " for reading (error #" << inputFile.error() << ":" <<
-         inputFile.errorString() << ")";
-      QString errorMessage{
-         QObject::tr("Could not open %1 for reading (error # %2)").arg(fileName).arg(inputFile.error())
-      };
-      throw BtException(errorMessage);
+   /**
+    * \brief Remove the first line (including its newline, if it has one) from \c remaining and return it.  If the line
+    *        is longer than \c maxSize bytes, we just return the first \c maxSize bytes of it.
+    */
+   QByteArrayView takeLine(QByteArrayView & remaining, qsizetype const maxSize) {
+      qsizetype const limit = std::min(remaining.size(), maxSize);
+      void const * newline = std::memchr(remaining.data(), '\n', static_cast<std::size_t>(limit));
+      qsizetype const lineLength = newline ? static_cast<char const *>(newline) - remaining.data() + 1 : limit;
+      QByteArrayView const line = remaining.first(lineLength);
+      remaining = remaining.sliced(lineLength);
+      return line;
    }
 
-   qint64 fileSize = inputFile.size();
-   if (fileSize <= 0) {
-      BtStringStream errorMessage;
-      errorMessage << "File " << fileName << " has no data (length is " << fileSize << " bytes)";
-      qWarning() << Q_FUNC_INFO << errorMessage.asString();
-      throw BtException(errorMessage.asString());
+   bool isAllWhitespace(QByteArrayView const text) {
+      return std::all_of(text.begin(),
+                         text.end(),
+                         [](char const cc) { return std::isspace(static_cast<unsigned char>(cc)); });
    }
 
+   /**
+    * \brief Handler for \c boost::json::basic_parser that does the work for \c JsonUtils::streamJsonDocument().
+    *
+    *        The parser tells us about each bit of the document as it reads it (start of an object, a key, a string,
+    *        etc).  We build values from these with \c boost::json::value_stack (which is what Boost.JSON's own DOM
+    *        parser uses): one stack for the record we are currently reading, and one for everything else (the
+    *        "skeleton" of the document).
+    *
+    *        Depth is the number of objects/arrays we are inside.  So the root object's members are at depth 1, the
+    *        container object's members (eg "version", "hop_varieties") at depth 2 and records at depth 3.
+    */
+   class RecordStreamingHandler {
+   public:
+      // These are required by boost::json::basic_parser
+      static constexpr std::size_t max_object_size = boost::json::object::max_size();
+      static constexpr std::size_t max_array_size  = boost::json::array::max_size();
+      static constexpr std::size_t max_key_size    = boost::json::string::max_size();
+      static constexpr std::size_t max_string_size = boost::json::string::max_size();
+
+      RecordStreamingHandler(std::string_view const containerName, JsonUtils::RecordCallback const & recordCallback) :
+         m_containerName  {containerName},
+         m_recordCallback {recordCallback},
+         m_skeleton       {},
+         m_record         {},
+         m_depth          {0},
+         m_recordDepth    {-1},
+         m_inContainer    {false},
+         m_inRecordArray  {false},
+         m_recordArrayName{},
+         m_key            {},
+         m_partialKey     {},
+         m_stopped        {false},
+         m_numRecords     {0} {
+         return;
+      }
+
+      //! \return \c true if we stopped because the record callback asked us to
+      bool stopped() const { return this->m_stopped; }
+
+      std::size_t numRecords() const { return this->m_numRecords; }
+
+      //! Call once the document has been completely parsed
+      boost::json::value releaseSkeleton() { return this->m_skeleton.release(); }
+
+      bool on_document_begin([[maybe_unused]] boost::json::error_code & ec) {
+         this->m_skeleton.reset();
+         return true;
+      }
+
+      bool on_document_end([[maybe_unused]] boost::json::error_code & ec) {
+         return true;
+      }
+
+      bool on_object_begin([[maybe_unused]] boost::json::error_code & ec) {
+         this->beginValue();
+         if (!this->inRecord() && this->m_depth == 1 && this->m_key == this->m_containerName) {
+            this->m_inContainer = true;
+         }
+         ++this->m_depth;
+         return true;
+      }
+
+      bool on_object_end(std::size_t const numMembers, boost::json::error_code & ec) {
+         this->stack().push_object(numMembers);
+         --this->m_depth;
+         if (this->m_inContainer && this->m_depth == 1) {
+            this->m_inContainer = false;
+         }
+         return this->endValue(ec);
+      }
+
+      bool on_array_begin([[maybe_unused]] boost::json::error_code & ec) {
+         this->beginValue();
+         if (!this->inRecord() && this->m_inContainer && this->m_depth == 2) {
+            this->m_inRecordArray = true;
+            this->m_recordArrayName = this->m_key;
+         }
+         ++this->m_depth;
+         return true;
+      }
+
+      bool on_array_end(std::size_t const numElements, boost::json::error_code & ec) {
+         --this->m_depth;
+         if (!this->inRecord() && this->m_inRecordArray && this->m_depth == 2) {
+            // The records have all been passed to the callback, so, in the skeleton, the array is empty
+            this->m_inRecordArray = false;
+            this->m_skeleton.push_array(0);
+         } else {
+            this->stack().push_array(numElements);
+         }
+         return this->endValue(ec);
+      }
+
+      bool on_key_part(boost::json::string_view const part,
+                       [[maybe_unused]] std::size_t const numCharsSoFar,
+                       [[maybe_unused]] boost::json::error_code & ec) {
+         this->stack().push_chars(part);
+         if (!this->inRecord()) {
+            this->m_partialKey.append(part.data(), part.size());
+         }
+         return true;
+      }
+
+      bool on_key(boost::json::string_view const lastPart,
+                  [[maybe_unused]] std::size_t const numChars,
+                  [[maybe_unused]] boost::json::error_code & ec) {
+         this->stack().push_key(lastPart);
+         if (!this->inRecord()) {
+            this->m_key = this->m_partialKey;
+            this->m_key.append(lastPart.data(), lastPart.size());
+            this->m_partialKey.clear();
+         }
+         return true;
+      }
+
+      bool on_string_part(boost::json::string_view const part,
+                          [[maybe_unused]] std::size_t const numCharsSoFar,
+                          [[maybe_unused]] boost::json::error_code & ec) {
+         this->beginValue();
+         this->stack().push_chars(part);
+         return true;
+      }
+
+      bool on_string(boost::json::string_view const lastPart,
+                     [[maybe_unused]] std::size_t const numChars,
+                     boost::json::error_code & ec) {
+         this->beginValue();
+         this->stack().push_string(lastPart);
+         return this->endValue(ec);
+      }
+
+      // We don't need the text of numbers, just their values, which we get from on_int64 etc
+      bool on_number_part([[maybe_unused]] boost::json::string_view const part,
+                          [[maybe_unused]] boost::json::error_code & ec) {
+         return true;
+      }
+
+      bool on_int64(std::int64_t const value,
+                    [[maybe_unused]] boost::json::string_view const text,
+                    boost::json::error_code & ec) {
+         this->beginValue();
+         this->stack().push_int64(value);
+         return this->endValue(ec);
+      }
+
+      bool on_uint64(std::uint64_t const value,
+                     [[maybe_unused]] boost::json::string_view const text,
+                     boost::json::error_code & ec) {
+         this->beginValue();
+         this->stack().push_uint64(value);
+         return this->endValue(ec);
+      }
+
+      bool on_double(double const value,
+                     [[maybe_unused]] boost::json::string_view const text,
+                     boost::json::error_code & ec) {
+         this->beginValue();
+         this->stack().push_double(value);
+         return this->endValue(ec);
+      }
+
+      bool on_bool(bool const value, boost::json::error_code & ec) {
+         this->beginValue();
+         this->stack().push_bool(value);
+         return this->endValue(ec);
+      }
+
+      bool on_null(boost::json::error_code & ec) {
+         this->beginValue();
+         this->stack().push_null();
+         return this->endValue(ec);
+      }
+
+      bool on_comment_part([[maybe_unused]] boost::json::string_view const part,
+                           [[maybe_unused]] boost::json::error_code & ec) {
+         return true;
+      }
+
+      bool on_comment([[maybe_unused]] boost::json::string_view const lastPart,
+                      [[maybe_unused]] boost::json::error_code & ec) {
+         return true;
+      }
+
+   private:
+      bool inRecord() const {
+         return this->m_recordDepth >= 0;
+      }
+
+      boost::json::value_stack & stack() {
+         return this->inRecord() ? this->m_record : this->m_skeleton;
+      }
+
+      //! Called at the start of each value (and, harmlessly, for each subsequent part of a string value)
+      void beginValue() {
+         if (!this->inRecord() && this->m_inRecordArray && this->m_depth == 3) {
+            this->m_record.reset();
+            this->m_recordDepth = this->m_depth;
+         }
+         return;
+      }
+
+      //! Called at the end of each value.  If it's the end of a record, we pass the record on to the callback.
+      bool endValue(boost::json::error_code & ec) {
+         if (this->m_recordDepth != this->m_depth) {
+            return true;
+         }
+         this->m_recordDepth = -1;
+         ++this->m_numRecords;
+         boost::json::value record = this->m_record.release();
+         if (!this->m_recordCallback(this->m_recordArrayName, record)) {
+            this->m_stopped = true;
+            // The parser needs an error code to stop
+            ec = boost::json::error::exception;
+            return false;
+         }
+         return true;
+      }
+
+      std::string_view const m_containerName;
+      JsonUtils::RecordCallback const & m_recordCallback;
+      boost::json::value_stack m_skeleton;
+      boost::json::value_stack m_record;
+      int m_depth;
+      //! Depth at which the current record started, or -1 if we are not in a record
+      int m_recordDepth;
+      bool m_inContainer;
+      bool m_inRecordArray;
+      std::string m_recordArrayName;
+      //! Last key we saw outside of a record
+      std::string m_key;
+      //! If a key arrives in several parts, this holds the parts we have so far
+      std::string m_partialKey;
+      bool m_stopped;
+      std::size_t m_numRecords;
+   };
+}
+
+[[nodiscard]] boost::json::value JsonUtils::loadJsonDocument(QString const & fileName, bool allowComments) {
+
+   //
+   // We map the file into memory rather than reading it, so that we don't need a copy of the file's contents in memory
+   // as well as the tree that Boost.JSON builds from it.
+   //
+   MappedFile inputFile(fileName);
+   openInputFile(inputFile, fileName);
+
    //
    // A few notes on how we do the parsing:
    //
@@ -148,14 +426,12 @@
          boost::json::storage_ptr{}, // Default memory resource
          parseOptions,               // Default parse options (strict parsing)
       };
-      QByteArray rawInputLine{};
-      for (auto [lineNumber, bytesLeftToRead] = std::tuple{1, fileSize};
-         bytesLeftToRead > 0;
-         ++lineNumber, bytesLeftToRead -= rawInputLine.size()) {
+      QByteArrayView remainingInput = inputFile.contents();
+      for (int lineNumber = 1; !remainingInput.isEmpty(); ++lineNumber) {
          // Because of the way UTF-8 is encoded (see eg https://www.johndcook.com/blog/2019/09/09/how-utf-8-works/), it
          // is entirely valid to treat it as an ASCII file for many purposes, including "give me a line of text".
-         rawInputLine = inputFile.readLine();
-         boost::json::string_view inputStringView{rawInputLine.data()};
+         QByteArrayView const rawInputLine = takeLine(remainingInput, remainingInput.size());
+         boost::json::string_view inputStringView{rawInputLine.data(), static_cast<std::size_t>(rawInputLine.size())};
          streamParser.write(inputStringView, errorCode);
          if (errorCode) {
             BtStringStream errorMessage{};
@@ -185,6 +461,74 @@
    }
 }
 
+[[nodiscard]] std::optional<boost::json::value> JsonUtils::streamJsonDocument(QString const & fileName,
+                                                                              std::string_view const containerName,
+                                                                              RecordCallback const & recordCallback,
+                                                                              bool allowComments) {
+   MappedFile inputFile(fileName);
+   openInputFile(inputFile, fileName);
+
+   //
+   // See comments in loadJsonDocument above for why we map the file and parse it line by line.  The difference here is
+   // that we can't assume that lines are a sensible length (it's perfectly valid for a JSON document to be all on one
+   // line), so we also cap how much we give the parser at a time.  The parser keeps track of where it is between calls,
+   // so it doesn't matter if we split the input in the middle of a string or a number.  (Since the file is mapped
+   // rather than read, the OS can page out what we've parsed, so memory use stays bounded either way.)
+   //
+   constexpr qsizetype maxChunkSize = 64 * 1024;
+   try {
+      boost::json::parse_options parseOptions;
+      parseOptions.allow_comments = allowComments;
+      boost::json::basic_parser<RecordStreamingHandler> parser{parseOptions, containerName, recordCallback};
+      boost::json::error_code errorCode;
+
+      QByteArrayView remainingInput = inputFile.contents();
+      for (int lineNumber = 1; !remainingInput.isEmpty(); ) {
+         QByteArrayView const chunk = takeLine(remainingInput, maxChunkSize);
+         auto const chunkSize = static_cast<std::size_t>(chunk.size());
+         std::size_t const numParsed =
+            parser.done() ? 0 : parser.write_some(true, chunk.data(), chunkSize, errorCode);
+         if (!errorCode && numParsed < chunkSize && !isAllWhitespace(chunk.sliced(static_cast<qsizetype>(numParsed)))) {
+            // Something other than whitespace after the end of the document
+            errorCode = boost::json::error::extra_data;
+         }
+         if (errorCode) {
+            if (parser.handler().stopped()) {
+               qInfo() << Q_FUNC_INFO << "Stopped reading" << fileName << "at line" << lineNumber;
+               return std::nullopt;
+            }
+            BtStringStream errorMessage{};
+            errorMessage <<
+               "Parsing failed at line " << lineNumber << ": " << static_cast<std::error_code>(errorCode);
+            qWarning() << Q_FUNC_INFO << errorMessage.asString();
+            throw BtException(errorMessage.asString());
+         }
+         if (chunk.endsWith('\n')) {
+            ++lineNumber;
+         }
+      }
+
+      if (!parser.done()) {
+         parser.write_some(false, nullptr, 0, errorCode);
+         if (errorCode) {
+            BtStringStream errorMessage;
+            errorMessage <<
+               "Parsing failed after reading last line: " << static_cast<std::error_code>(errorCode);
+            qWarning() << Q_FUNC_INFO << errorMessage.asString();
+            throw BtException(errorMessage.asString());
+         }
+      }
+
+      qDebug() << Q_FUNC_INFO << "Read" << parser.handler().numRecords() << "records from" << fileName;
+      return parser.handler().releaseSkeleton();
+   } catch (std::bad_alloc const & exception) {
+      BtStringStream errorMessage;
+      errorMessage << "Memory allocation error (" << exception.what() << ") while parsing " << fileName;
+      qWarning() << Q_FUNC_INFO << errorMessage.asString();
+      throw BtException(errorMessage.asString());
+   }
+}
+
 void JsonUtils::serialize(std::ostream & stream,
                           boost::json::value const & val,
                           std::string_view const tabString,
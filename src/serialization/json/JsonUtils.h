@@ -17,6 +17,10 @@
 #define SERIALIZATION_JSON_JSONUTILS_H
 #pragma once
 
+#include <functional>
+#include <optional>
+#include <string_view>
+
 #include <boost/json/value.hpp>
 
 class QDebug;
@@ -43,6 +47,42 @@ namespace JsonUtils {
     */
    [[nodiscard]] boost::json::value loadJsonDocument(QString const & fileName, bool allowComments = true);
 
+   /**
+    * \brief Callback for \c streamJsonDocument()
+    *
+    * \param arrayName The name of the array the record came from, eg "hop_varieties"
+    * \param record    The record, which the callback is free to modify or move from, as it is discarded afterwards
+    *
+    * \return \c true to carry on reading the document, \c false to stop
+    */
+   using RecordCallback = std::function<bool(std::string_view const arrayName, boost::json::value & record)>;
+
+   /**
+    * \brief Alternative to \c loadJsonDocument() for documents that might be too big to want to hold in memory all at
+    *        once.  (A Boost.JSON tree takes up several times the space of the text it was parsed from, and an export of
+    *        a large recipe library can run to hundreds of megabytes of text.)
+    *
+    *        We expect the document to be of the form { "container": { "records": [ {...}, {...}, ... ], ... } }, eg
+    *        { "beerjson": { "version": 2.06, "hop_varieties": [ ... ], "recipes": [ ... ] } }.  Each element of each
+    *        array directly inside the container object is parsed on its own, passed to \c recordCallback as soon as it
+    *        has been read, and then discarded.  So memory use depends on the size of the biggest record, rather than on
+    *        the size of the document.
+    *
+    * \param fileName As for \c loadJsonDocument()
+    * \param containerName The name of the object, inside the root object, whose arrays hold the records
+    * \param recordCallback Called for each record, in the order the records appear in the document
+    * \param allowComments As for \c loadJsonDocument()
+    *
+    * \return Everything in the document apart from the records (ie with each array of records replaced by an empty
+    *         array), or \c std::nullopt if \c recordCallback asked us to stop.
+    *
+    * \throw BtException containing text that can be displayed to the user
+    */
+   [[nodiscard]] std::optional<boost::json::value> streamJsonDocument(QString const & fileName,
+                                                                      std::string_view const containerName,
+                                                                      RecordCallback const & recordCallback,
+                                                                      bool allowComments = true);
+
    /**
     * \brief Output a \c boost::json::value to a stream as nicely formatted valid JSON.  Essentially adds nice
     *        formatting (aka pretty printing) to \c boost::json::serialize
@@ -49,10 +49,12 @@
 #include "model/Style.h"
 #include "model/Water.h"
 #include "model/Yeast.h"
+#include "serialization/xml/BtDomDocumentOwner.h"
 #include "serialization/xml/BtDomErrorHandler.h"
 #include "serialization/xml/MibEnum.h"
 #include "serialization/xml/XmlCoding.h"
 #include "serialization/xml/XmlRecord.h"
+#include "utils/MappedFile.h"
 
 //
 // Variables and constant definitions that we need only in this file
@@ -1091,27 +1093,28 @@ namespace {
    };
 
    /**
-    * \brief Validate XML file against schema and load its contents
+    * \brief Validate XML file against schema.  See \c BeerXML::prepareImport for why we don't load its contents here
+    *        as well.
     *
     * \param fileName Fully-qualified name of the file to validate
     * \param userMessage Any message that we want the top-level caller to display to the user (either about an error
     *                    or, in the event of success, summarising what was read in) should be appended to this string.
     *
-    * \return true if file validated OK (including if there were "errors" that we can safely ignore)
-    *         false if there was a problem that means it's not worth trying to read in the data from the file
+    * \return Function to load the file's contents if file validated OK (including if there were "errors" that we can
+    *         safely ignore), or \c std::nullopt if there was a problem that means it's not worth trying to read in the
+    *         data from the file
     */
-   bool validateAndLoad(QString const & fileName, QTextStream & userMessage) {
+   std::optional<ImportExport::LoadAndStore> validateAndPrepare(QString const & fileName, QTextStream & userMessage) {
 
-      QFile inputFile;
-      inputFile.setFileName(fileName);
+      MappedFile inputFile{fileName};
 
-      if(!inputFile.open(QIODevice::ReadOnly)) {
+      if (!inputFile.open()) {
          qWarning() << Q_FUNC_INFO << ": Could not open " << fileName << " for reading";
-         return false;
+         return std::nullopt;
       }
 
       //
-      // Rather than just read the XML file into memory, we actually make a small on-the-fly modification to it to
+      // Rather than just parse the XML file as-is, we actually make a small on-the-fly modification to it to
       // place all the top-level content inside a <BEER_XML>...</BEER_XML> field.  This massively simplifies the XSD
       // (as explained in a comment therein) at the cost of some minor complexity here.  Essentially, the added tag
       // pair is (much as we might have wished it were part of the original BeerXML 1.0 Specification to make BeerXML
@@ -1135,6 +1138,11 @@ namespace {
       //  - We read in the rest of the file unchanged (so what was line 2 on disk will be line 3 in memory and so on)
       //  - We append a new final line that says "</BEER_XML>"
       //
+      // We don't actually build a modified copy of the file in memory though.  The file is mapped into memory (see
+      // MappedFile) and we give XmlCoding a list of the pieces -- first line, inserted tag, rest of the file, closing
+      // tag -- which Xerces then reads one after another as though they were one document.  For a big file, this saves
+      // reading it into one buffer and then copying it into another.
+      //
       // We then give enough information to our instance of BtDomErrorHandler to allow it to correct the line numbers
       // for any errors it needs to log.  (And we get a bit of help from this class when we need to make similar
       // adjustments during exception processing.)
@@ -1149,9 +1157,12 @@ namespace {
       // Since we're unlikely ever to need to change (or make much more widespread use of) this tag, we've gone with
       // readability over purity, and left it hard-coded, for now at least.
       //
-      QByteArray documentData = inputFile.readLine();
-      QString firstLine{documentData};
-      qDebug() << Q_FUNC_INFO << "First line of " << inputFile.fileName() << " was " << firstLine;
+      QByteArrayView const fileContents = inputFile.contents();
+      qsizetype const endOfFirstLine = fileContents.indexOf('\n');
+      QByteArrayView const firstLineData =
+         endOfFirstLine < 0 ? fileContents : fileContents.first(endOfFirstLine + 1);
+      QString const firstLine = QString::fromUtf8(firstLineData);
+      qDebug() << Q_FUNC_INFO << "First line of " << fileName << " was " << firstLine;
       if (!firstLine.startsWith(QString("<?xml version="))) {
          //
          // For the moment, we're being strict and bailing out here.  An alternative approach would be to accept files
@@ -1161,16 +1172,21 @@ namespace {
             Q_FUNC_INFO << "Unexpected first line of file (should begin with '<?xml version=' but doesn't): " <<
             firstLine;
          userMessage << "Unexpected first line (not the XML declaration mandated by BeerXML).";
-         return false;
+         return std::nullopt;
       }
-      documentData += "<BEER_XML>\n";
-      documentData += inputFile.readAll();
-      documentData += "\n</BEER_XML>";
-      qDebug() << Q_FUNC_INFO << "Input file " << inputFile.fileName() << ": " << documentData.length() << " bytes";
+      QList<QByteArrayView> const documentParts{
+         firstLineData,
+         "<BEER_XML>\n",
+         fileContents.sliced(firstLineData.size()),
+         "\n</BEER_XML>"
+      };
+      qDebug() <<
+         Q_FUNC_INFO << "Input file " << fileName << ": " << fileContents.size() << " bytes" <<
+         (inputFile.isMapped() ? "(mapped)" : "(read)");
 
       // It is sometimes helpful to uncomment the next line for debugging, but usually leave it commented out as can
       // put a _lot_ of data in the logs in DEBUG mode.
-      // qDebug().noquote() << Q_FUNC_INFO << "Full content of " << inputFile.fileName() << " is:\n" << QString(documentData);
+      // qDebug().noquote() << Q_FUNC_INFO << "Full content of " << fileName << " is:\n" << QString::fromUtf8(fileContents);
 
       //
       // Some errors we explicitly want to ignore.  In particular, the BeerXML 1.0 standard says:
@@ -1203,8 +1219,25 @@ namespace {
       };
       BtDomErrorHandler domErrorHandler(&errorPatternsToIgnore, 1, 1);
 
-      return BEER_XML_1_CODING.validateLoadAndStoreInDb(documentData, fileName, domErrorHandler, userMessage);
+      //
+      // Once the document is parsed, Xerces has its own copy of everything it needs, so it doesn't matter that
+      // inputFile will be unmapped when we return.
+      //
+      std::shared_ptr<BtDomDocumentOwner> domDocumentOwner =
+         BEER_XML_1_CODING.validate(documentParts, fileName, domErrorHandler, userMessage);
+      if (!domDocumentOwner) {
+         return std::nullopt;
+      }
 
+      return [domDocumentOwner](QTextStream & userMessage) {
+         //
+         // During importation we do not want automatic versioning turned on because, during the process of reading in
+         // a Recipe we'll end up creating load of versions of it.  The magic of RAII means it's a one-liner to suspend
+         // automatic versioning, in an exception-safe way, until the end of this function.
+         //
+         RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
+         return BEER_XML_1_CODING.loadAndStoreInDb(*domDocumentOwner, userMessage);
+      };
    }
 
 }
@@ -1234,6 +1267,63 @@ BeerXML::~BeerXML() = default;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+   /**
+    * \brief Collects XML output in memory and writes it to a file in big chunks, converting to ISO-8859-1 (Latin 1),
+    *        which is the encoding BeerXML specifies.
+    *
+    *        This is quicker than having a \c QTextStream write straight to the file, as that converts and writes the
+    *        text in small pieces.  The buffer is allocated up-front and reused for each chunk.
+    */
+   class ChunkedLatin1Writer {
+   public:
+      //! Number of characters we collect before writing them to the file
+      static constexpr qsizetype chunkSize = 1024 * 1024;
+
+      ChunkedLatin1Writer(QFile & outFile) :
+         m_outFile{outFile},
+         m_buffer{},
+         m_stream{&m_buffer} {
+         // Writing out one record can take us past chunkSize, so we allow a bit extra to avoid reallocating
+         this->m_buffer.reserve(chunkSize + chunkSize / 4);
+         return;
+      }
+
+      ~ChunkedLatin1Writer() {
+         this->writeToFile();
+         return;
+      }
+
+      QTextStream & stream() {
+         return this->m_stream;
+      }
+
+      //! Call after each record (or group of records) to write the buffer to the file if it's full
+      void writeIfFull() {
+         this->m_stream.flush();
+         if (this->m_buffer.size() >= chunkSize) {
+            this->writeToFile();
+         }
+         return;
+      }
+
+      void writeToFile() {
+         this->m_stream.flush();
+         if (!this->m_buffer.isEmpty()) {
+            this->m_outFile.write(this->m_buffer.toLatin1());
+            // Unlike clear(), resize() never gives back the memory, so we can reuse it for the next chunk
+            this->m_buffer.resize(0);
+         }
+         return;
+      }
+
+   private:
+      QFile & m_outFile;
+      QString m_buffer;
+      QTextStream m_stream;
+   };
+}
+
 void BeerXML::createXmlFile(QFile & outFile) const {
    QTextStream out(&outFile);
    // BeerXML specifies the ISO-8859-1 (Latin 1) encoding
@@ -1247,63 +1337,79 @@ void BeerXML::createXmlFile(QFile & outFile) const {
    return;
 }
 
-template<class NE> void BeerXML::toXml(QList<NE const *> const & nes, QFile & outFile) const {
+template<class NE> bool BeerXML::toXml(QList<NE const *> const & nes,
+                                       QFile & outFile,
+                                       ImportExport::ExportProgress const & progress) const {
    // We don't want to output empty container records
    if (nes.empty()) {
-      return;
+      return true;
    }
 
    // It is a feature of BeerXML that the tag name for a list of elements is just the tag name for an individual
    // element with an S on the end, even when this is not grammatically correct.  Thus a list of <HOP>...</HOP> records
    // is contained inside <HOPS>...</HOPS> tags, a list of <MISC>...</MISC> records is contained inside
    // <MISCS>...</MISCS> tags and so on.
-   QTextStream out(&outFile);
-   // BeerXML specifies the ISO-8859-1 encoding
-   out.setEncoding(QStringConverter::Latin1);
-   out << "<" << BEER_XML_RECORD_DEFN<NE>.m_recordName << "S>\n";
-   for (NE const * ne : nes) {
-      std::unique_ptr<XmlRecord> xmlRecord{
-         BEER_XML_RECORD_DEFN<NE>.makeRecord(BEER_XML_1_CODING)
-      };
-      xmlRecord->toXml(*ne, out, true);
-   }
-   out << "</" << BEER_XML_RECORD_DEFN<NE>.m_recordName << "S>\n";
-   return;
+   ChunkedLatin1Writer writer{outFile};
+   writer.stream() << "<" << BEER_XML_RECORD_DEFN<NE>.m_recordName << "S>\n";
+   bool const completed = ImportExport::exportInParallel<QString>(
+      nes.size(),
+      [&nes](qsizetype const begin, qsizetype const end) {
+         QString sliceXml;
+         QTextStream out{&sliceXml};
+         // Since XmlRecord::toXml is const, one XmlRecord (and the child records it creates) can export the whole
+         // slice.  But we can't share it with other slices, as they are being exported on other threads.
+         std::unique_ptr<XmlRecord> xmlRecord{
+            BEER_XML_RECORD_DEFN<NE>.makeRecord(BEER_XML_1_CODING)
+         };
+         for (qsizetype ii = begin; ii < end; ++ii) {
+            xmlRecord->toXml(*nes.at(ii), out, true);
+         }
+         out.flush();
+         return sliceXml;
+      },
+      [&writer](QString & sliceXml) {
+         writer.stream() << sliceXml;
+         writer.writeIfFull();
+         return;
+      },
+      progress
+   );
+   writer.stream() << "</" << BEER_XML_RECORD_DEFN<NE>.m_recordName << "S>\n";
+   return completed;
 }
 //
 // Instantiate the above template function for the types that are going to use it
 // (This is all just a trick to allow the template definition to be here in the .cpp file and not in the header, which
 // means, amongst other things, that we can reference the pimpl.)
 //
-template void BeerXML::toXml(QList<Hop         const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<Fermentable const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<Yeast       const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<Misc        const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<Water       const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<Style       const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<MashStep    const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<Mash        const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<Equipment   const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<Instruction const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<BrewNote    const *> const & nes, QFile & outFile) const;
-template void BeerXML::toXml(QList<Recipe      const *> const & nes, QFile & outFile) const;
+template bool BeerXML::toXml(QList<Hop         const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<Fermentable const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<Yeast       const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<Misc        const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<Water       const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<Style       const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<MashStep    const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<Mash        const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<Equipment   const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<Instruction const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<BrewNote    const *> const &, QFile &, ImportExport::ExportProgress const &) const;
+template bool BeerXML::toXml(QList<Recipe      const *> const &, QFile &, ImportExport::ExportProgress const &) const;
 
 // fromXml ====================================================================
 bool BeerXML::importFromXML(QString const & filename, QTextStream & userMessage) {
    //
-   // During importation we do not want automatic versioning turned on because, during the process of reading in a
-   // Recipe we'll end up creating load of versions of it.  The magic of RAII means it's a one-liner to suspend
-   // automatic versioning, in an exception-safe way, until the end of this function.
-   //
-   RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
-
-   //
-   // Slightly more manually, we also change the cursor to show "busy" while we're doing the import as, for large
-   // imports, processing can take a few seconds or so.
+   // We change the cursor to show "busy" while we're doing the import as, for large imports, processing can take a few
+   // seconds or so.  (Automatic versioning of recipes is suspended by the load-and-store stage.)
    //
    QApplication::setOverrideCursor(Qt::WaitCursor);
    QApplication::processEvents();
-   bool result = validateAndLoad(filename, userMessage);
+   std::optional<ImportExport::LoadAndStore> loadAndStore = validateAndPrepare(filename, userMessage);
+   bool const result = loadAndStore && (*loadAndStore)(userMessage);
    QApplication::restoreOverrideCursor();
    return result;
 }
+
+std::optional<ImportExport::LoadAndStore> BeerXML::prepareImport(QString const & filename,
+                                                                 QTextStream & userMessage) const {
+   return validateAndPrepare(filename, userMessage);
+}
@@ -18,10 +18,14 @@
 #define SERIALIZATION_XML_BEERXML_H
 #pragma once
 
+#include <optional>
+
 #include <QFile>
 #include <QString>
 #include <QTextStream>
 
+#include "serialization/ImportExport.h"
+
 /*!
  * \class BeerXML
  *
@@ -48,9 +52,16 @@ public:
    void createXmlFile(QFile & outFile) const;
 
    /**
-    * \brief Write a list of objects to the supplied file
+    * \brief Write a list of objects to the supplied file.  The objects are serialised on worker threads (see
+    *        \c ImportExport::exportInParallel), so must not be modified until this function returns.
+    *
+    * \param progress See \c ImportExport::ExportProgress
+    *
+    * \return \c false if the user cancelled the export, \c true otherwise
     */
-   template<class NE> void toXml(QList<NE const *> const & nes, QFile & outFile) const;
+   template<class NE> bool toXml(QList<NE const *> const & nes,
+                                 QFile & outFile,
+                                 ImportExport::ExportProgress const & progress = nullptr) const;
 
    /*! Import ingredients, recipes, etc from BeerXML documents.
     * \param filename
@@ -60,6 +71,19 @@ public:
     */
    bool importFromXML(QString const & filename, QTextStream & userMessage);
 
+   /*!
+    * \brief First stage of \c importFromXML: read the file and validate it against the schema, without creating any
+    *        objects or touching the DB.  Unlike \c importFromXML, this is safe to call on any thread, so several files
+    *        can be prepared in parallel (see \c ImportExport::importFromFiles).
+    *
+    * \param filename
+    * \param userMessage As for \c importFromXML
+    *
+    * \return The second stage of the import, to be called on the main thread, or \c std::nullopt if the file could not
+    *         be read or is not valid (in which case \c userMessage says why)
+    */
+   std::optional<ImportExport::LoadAndStore> prepareImport(QString const & filename, QTextStream & userMessage) const;
+
 private:
 
    /**
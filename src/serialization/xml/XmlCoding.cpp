@@ -15,8 +15,18 @@
  =====================================================================================================================*/
 #include "serialization/xml/XmlCoding.h"
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
 
 #include <xercesc/dom/DOMConfiguration.hpp>
 #include <xercesc/dom/DOMDocument.hpp>
@@ -25,13 +35,17 @@
 #include <xercesc/dom/DOMImplementationRegistry.hpp>
 #include <xercesc/dom/DOMLSParser.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
+#include <xercesc/framework/BinOutputStream.hpp>
 #include <xercesc/framework/MemBufInputSource.hpp>
 #include <xercesc/framework/Wrapper4InputSource.hpp>
 #include <xercesc/framework/XMLGrammarPoolImpl.hpp>
+#include <xercesc/sax/InputSource.hpp>
 #include <xercesc/sax/SAXException.hpp>
+#include <xercesc/util/BinInputStream.hpp>
 #include <xercesc/util/PlatformUtils.hpp>
 #include <xercesc/util/XMLException.hpp>
 #include <xercesc/util/XMLUniDefs.hpp>
+#include <xercesc/util/XercesVersion.hpp>
 
 #include <xalanc/XalanDOM/XalanDocument.hpp>
 #include <xalanc/XalanDOM/XalanNode.hpp>
@@ -41,6 +55,7 @@
 #include <xalanc/XercesParserLiaison/XercesDOMSupport.hpp>
 #include <xalanc/XPath/XPathEvaluator.hpp>
 
+#include "PersistentSettings.h"
 #include "serialization/xml/BtDomDocumentOwner.h"
 #include "serialization/xml/XercesHelpers.h"
 #include "utils/ImportRecordCount.h"
@@ -93,6 +108,118 @@
 // using a huge number of different function calls.
 //
 
+namespace {
+   /**
+    * \brief Xerces input stream that reads a list of memory buffers one after another, as though they were a single
+    *        buffer.
+    *
+    *        This allows a caller to give us, eg, a memory-mapped file with a few extra bits of text before and after it
+    *        without having to copy everything into a new buffer to join it all together.  (\c MemBufInputSource would
+    *        require that single buffer.)
+    */
+   class SegmentedBinInputStream : public xercesc::BinInputStream {
+   public:
+      SegmentedBinInputStream(QList<QByteArrayView> const & segments) :
+         m_segments{segments},
+         m_currentSegment{0},
+         m_offsetInSegment{0},
+         m_totalBytesRead{0} {
+         return;
+      }
+      ~SegmentedBinInputStream() = default;
+
+      XMLFilePos curPos() const override {
+         return this->m_totalBytesRead;
+      }
+
+      XMLSize_t readBytes(XMLByte * const toFill, XMLSize_t const maxToRead) override {
+         XMLSize_t numRead = 0;
+         while (numRead < maxToRead && this->m_currentSegment < this->m_segments.size()) {
+            QByteArrayView const & segment = this->m_segments.at(this->m_currentSegment);
+            XMLSize_t const numLeftInSegment = static_cast<XMLSize_t>(segment.size() - this->m_offsetInSegment);
+            XMLSize_t const numToCopy = std::min(maxToRead - numRead, numLeftInSegment);
+            std::memcpy(toFill + numRead, segment.data() + this->m_offsetInSegment, numToCopy);
+            numRead += numToCopy;
+            this->m_offsetInSegment += static_cast<qsizetype>(numToCopy);
+            if (this->m_offsetInSegment >= segment.size()) {
+               ++this->m_currentSegment;
+               this->m_offsetInSegment = 0;
+            }
+         }
+         this->m_totalBytesRead += numRead;
+         return numRead;
+      }
+
+      XMLCh const * getContentType() const override {
+         // We don't know the content type, and Xerces doesn't need us to
+         return nullptr;
+      }
+
+   private:
+      QList<QByteArrayView> const & m_segments;
+      qsizetype m_currentSegment;
+      qsizetype m_offsetInSegment;
+      XMLFilePos m_totalBytesRead;
+   };
+
+   /**
+    * \brief Xerces input source for \c SegmentedBinInputStream.  Note that, like \c MemBufInputSource, we do not copy
+    *        or own the data, so the caller needs to keep it alive until parsing is finished.
+    */
+   class SegmentedInputSource : public xercesc::InputSource {
+   public:
+      /**
+       * \param segments The buffers to read, in order
+       * \param systemId Just a name for the object, which will show up in error messages
+       */
+      SegmentedInputSource(QList<QByteArrayView> const & segments, char const * const systemId) :
+         xercesc::InputSource{systemId},
+         m_segments{segments} {
+         return;
+      }
+      ~SegmentedInputSource() = default;
+
+      xercesc::BinInputStream * makeStream() const override {
+         // Per the Xerces docs, the caller adopts the returned stream
+         return new SegmentedBinInputStream{this->m_segments};
+      }
+
+   private:
+      QList<QByteArrayView> const & m_segments;
+   };
+
+   /**
+    * \brief Xerces output stream that writes to a Qt \c QIODevice (eg a \c QFile), which we use for writing our cached
+    *        grammars.
+    */
+   class QIODeviceBinOutputStream : public xercesc::BinOutputStream {
+   public:
+      QIODeviceBinOutputStream(QIODevice & device) :
+         m_device{device},
+         m_totalBytesWritten{0} {
+         return;
+      }
+      ~QIODeviceBinOutputStream() = default;
+
+      XMLFilePos curPos() const override {
+         return this->m_totalBytesWritten;
+      }
+
+      void writeBytes(XMLByte const * const toGo, XMLSize_t const maxToWrite) override {
+         // If the write fails, QSaveFile will remember, and its commit() will return false
+         this->m_device.write(reinterpret_cast<char const *>(toGo), static_cast<qint64>(maxToWrite));
+         this->m_totalBytesWritten += maxToWrite;
+         return;
+      }
+
+   private:
+      QIODevice & m_device;
+      XMLFilePos m_totalBytesWritten;
+   };
+
+   //! Subdirectory of the user data directory in which we cache compiled grammars
+   char const * const grammarCacheDirName = "cache";
+}
 
 //
 // Private implementation class for XmlCoding
@@ -108,14 +235,14 @@ public:
         QString const schemaResource,
         XmlRecordDefinition const & rootRecordDefinition) :
       m_self{self},
-      m_initialised{false},
       m_name{name},
       m_schemaResource{schemaResource},
       m_rootRecordDefinition{rootRecordDefinition},
-    // grammarPool(xercesc::XMLPlatformUtils::fgMemoryManager),
+      m_grammarPool{nullptr},
       m_domImplementation{nullptr},
-      m_parser{nullptr} {
-      // We don't want to call loadSchema yet, as the main application will not have initialised Xerces and Xalan
+      m_parserPoolMutex{},
+      m_idleParsers{} {
+      // We don't want to call createParser yet, as the main application will not have initialised Xerces and Xalan
       return;
    }
 
@@ -125,16 +252,21 @@ public:
    ~impl() = default;
 
    /**
-    * \brief Load in the schema(s) we're going to use for validating XML documents.
+    * \brief Create a parser and, if this is the first one, load in the schema(s) we're going to use for validating XML
+    *        documents.
     *
     *        This is the complicated bit of using Xerces.  Once this is done, remaining usage is pretty
     *        straightforward!
     *
-    * \param schemaResource The XSD schema file to load in.  The expectation is that this has been compiled into the
-    *                       app as a Qt resource, so we don't need to bother with a lot of boilerplate error-handling
-    *                       for file permissions or file not found etc.
+    *        Caller should hold \c m_parserPoolMutex.
     */
-   void loadSchema(QString const & schemaResource) {
+   xercesc::DOMLSParser * createParser() {
+      //
+      // All our parsers share one grammar pool, so the schema only needs to be loaded once, and, most of the time, we
+      // can get it from the on-disk cache rather than parsing the XSD.
+      //
+      bool const needToLoadSchema = !this->m_grammarPool && !this->readGrammarCache();
+
       //
       // See https://stackoverflow.com/questions/52275608/xerces-c-validate-xml-with-hardcoded-xsd and
       // http://www.codesynthesis.com/~boris/blog/2010/03/15/validating-external-schemas-xerces-cxx/ (plus linked
@@ -179,11 +311,11 @@ public:
       // other schema language).   Since we completely control the schemas we're using, there seems little benefit in
       // trying to specify such restrictions here.
       //
-      this->m_parser =
+      xercesc::DOMLSParser * parser =
          this->m_domImplementation->createLSParser(xercesc::DOMImplementationLS::MODE_SYNCHRONOUS,
-                                                   nullptr  /*,
-                                                   xercesc::XMLPlatformUtils::fgMemoryManager, .:TBD:. Shall we reenable the grammar pool stuff?
-                                                   &this->grammarPool*/);
+                                                   nullptr,
+                                                   xercesc::XMLPlatformUtils::fgMemoryManager,
+                                                   this->m_grammarPool);
 
       //
       // See https://xerces.apache.org/xerces-c/program-dom-3.html for full details of these config options
@@ -210,7 +342,7 @@ public:
       // anything but will cause a subsequent error of "implementation does not support the requested type of object or
       // operation" when you, say, try to parse a document.
       //
-      xercesc::DOMConfiguration * config = this->m_parser->getDomConfig();
+      xercesc::DOMConfiguration * config = parser->getDomConfig();
 
       // "comments" - false = Discard Comment nodes in document
       config->setParameter(xercesc::XMLUni::fgDOMComments, false);
@@ -263,21 +395,46 @@ public:
       // Xerces functionality from Xalan.
       config->setParameter(xercesc::XMLUni::fgXercesDOMHasPSVIInfo, true);
 
+      if (needToLoadSchema) {
+         this->loadSchema(*parser);
+      }
+
+      // "http://apache.org/xml/features/validation/use-cachedGrammarInParse"
+      // true = Use cached grammar if it exists in the pool
+      config->setParameter(xercesc::XMLUni::fgXercesUseCachedGrammarInParse, true);
+
+      // "http://apache.org/xml/features/validating/load-schema"
+      // false = Don't load the schema if it wasn't found in the grammar pool, ie don't load schemas from any other
+      //         source (e.g., from XML document's xsi:schemaLocation attributes).
+      config->setParameter(xercesc::XMLUni::fgXercesLoadSchema, false);
+
+      // "http://apache.org/xml/features/dom/user-adopts-DOMDocument"
+      // true = The caller will adopt the DOMDocument that is returned from the parse method and thus is responsible to
+      //        call xercesc::DOMDocument::release() to release the associated memory. The parser will not release it.
+      //        The ownership is transferred from the parser to the caller.
+      //
+      // The reason for setting this to true is that we reuse the parser, so we don't want to wait until its destructor
+      // is called for all the DOMDocument objects to be released.
+      config->setParameter(xercesc::XMLUni::fgXercesUserAdoptsDOMDocument, true);
+
+      return parser;
+   }
+
+   /**
+    * \brief Parse the schema (\c m_schemaResource) with \c parser, which loads its grammar into \c m_grammarPool.  Then
+    *        lock the pool and write it to the on-disk cache so that, next time, we can use \c readGrammarCache instead.
+    *
+    *        The expectation is that the schema has been compiled into the app as a Qt resource, so we don't need to
+    *        bother with a lot of boilerplate error-handling for file permissions or file not found etc.
+    */
+   void loadSchema(xercesc::DOMLSParser & parser) {
+      xercesc::DOMConfiguration * config = parser.getDomConfig();
+
       BtDomErrorHandler domErrorHandler;
       config->setParameter(xercesc::XMLUni::fgDOMErrorHandler, &domErrorHandler);
 
-      QFile schemaFile(schemaResource);
-      if (!schemaFile.open(QIODevice::ReadOnly)) {
-         // This should pretty much never happen, as we're loading from a QResource compiled into the binary rather
-         // than reading from the file system at run-time.
-         qCritical() <<
-            Q_FUNC_INFO << "Could not open schema file resource " << schemaFile.fileName() << " for reading";
-         throw std::runtime_error("Could not open schema file resource");
-      }
-
-      QByteArray schemaData = schemaFile.readAll();
-      qDebug() <<
-         Q_FUNC_INFO << "Schema file " << schemaFile.fileName() << ": " << schemaData.length() << " bytes";
+      QFile schemaFile(this->m_schemaResource);
+      QByteArray schemaData = this->readSchemaResource();
 
       // Don't want qDebug to escape newlines, as there will be lots in the list of parameter settings, hence
       // ".noquote()" here.
@@ -300,9 +457,9 @@ public:
       // not be deleted by the user.
       // Strictly, we should try/catch this for SAXException, XMLException. DOMException.  However, we are not
       // expecting any of these because we are parsing our own XSD file that is compiled into the program binary.
-      xercesc::Grammar * grammar = this->m_parser->loadGrammar(&schemaAsDOMLSInput,
-                                                             xercesc::Grammar::SchemaGrammarType,
-                                                             true);
+      xercesc::Grammar * grammar = parser.loadGrammar(&schemaAsDOMLSInput,
+                                                     xercesc::Grammar::SchemaGrammarType,
+                                                     true);
       if (!grammar) {
          // As above, this shouldn't happen "in production" as it's our own schema file, so we should make it parseable
          qCritical() << Q_FUNC_INFO << "Unable to parse schema " << schemaFile.fileName();
@@ -314,37 +471,180 @@ public:
          throw std::runtime_error("Error parsing schema -- see log file for more details");
       }
 
-      xercesc::Grammar * rootGrammar = this->m_parser->getRootGrammar();
+      xercesc::Grammar * rootGrammar = parser.getRootGrammar();
 
       qDebug() <<
          Q_FUNC_INFO << "Schema " << schemaFile.fileName() << " loaded OK.  Grammar:" << grammar << ", root grammar:" <<
          rootGrammar;
 
-      // "http://apache.org/xml/features/validation/use-cachedGrammarInParse"
-      // true = Use cached grammar if it exists in the pool
-      config->setParameter(xercesc::XMLUni::fgXercesUseCachedGrammarInParse, true);
+      this->m_grammarPool->lockPool();
+      this->writeGrammarCache();
+      return;
+   }
 
-      // "http://apache.org/xml/features/validating/load-schema"
-      // false = Don't load the schema if it wasn't found in the grammar pool, ie don't load schemas from any other
-      //         source (e.g., from XML document's xsi:schemaLocation attributes).
-      config->setParameter(xercesc::XMLUni::fgXercesLoadSchema, false);
+   /**
+    * \brief Read the schema file (\c m_schemaResource) into memory
+    */
+   QByteArray readSchemaResource() const {
+      QFile schemaFile(this->m_schemaResource);
+      if (!schemaFile.open(QIODevice::ReadOnly)) {
+         // This should pretty much never happen, as we're loading from a QResource compiled into the binary rather
+         // than reading from the file system at run-time.
+         qCritical() <<
+            Q_FUNC_INFO << "Could not open schema file resource " << schemaFile.fileName() << " for reading";
+         throw std::runtime_error("Could not open schema file resource");
+      }
 
-      // "http://apache.org/xml/features/dom/user-adopts-DOMDocument"
-      // true = The caller will adopt the DOMDocument that is returned from the parse method and thus is responsible to
-      //        call xercesc::DOMDocument::release() to release the associated memory. The parser will not release it.
-      //        The ownership is transferred from the parser to the caller.
-      //
-      // The reason for setting this to true is that we reuse the parser, so we don't want to wait until its destructor
-      // is called for all the DOMDocument objects to be released.
-      config->setParameter(xercesc::XMLUni::fgXercesUserAdoptsDOMDocument, true);
+      QByteArray schemaData = schemaFile.readAll();
+      qDebug() <<
+         Q_FUNC_INFO << "Schema file " << schemaFile.fileName() << ": " << schemaData.length() << " bytes";
+      return schemaData;
+   }
+
+   /**
+    * \brief Xerces can serialise a grammar pool, and read it back in a lot more quickly than it can parse the XSD, so
+    *        we keep a copy of our grammar pool in the user data directory.
+    *
+    *        The file name includes a checksum of the XSD and the Xerces version, so we won't find a cache file that was
+    *        written for a different version of the schema or by a different version of Xerces.
+    */
+   QString grammarCacheFilePath() const {
+      QCryptographicHash checksum{QCryptographicHash::Sha256};
+      checksum.addData(this->readSchemaResource());
+      checksum.addData(QByteArrayView{XERCES_FULLVERSIONDOT});
+      QString const baseName = QString{this->m_name}.replace(QRegularExpression{"[^A-Za-z0-9]"}, "_");
+      return PersistentSettings::getUserDataDir().filePath(
+         QString{"%1/%2-%3.grammar"}.arg(grammarCacheDirName,
+                                         baseName,
+                                         QString::fromLatin1(checksum.result().toHex().left(16)))
+      );
+   }
+
+   /**
+    * \brief Create \c m_grammarPool and try to fill it from our on-disk cache (see \c grammarCacheFilePath).  If that
+    *        succeeds, the pool is locked and ready to use.
+    *
+    * \return \c true if we read the grammar from the cache, \c false if the caller needs to parse the schema
+    */
+   bool readGrammarCache() {
+      this->m_grammarPool = new xercesc::XMLGrammarPoolImpl{xercesc::XMLPlatformUtils::fgMemoryManager};
 
+      QFile cacheFile{this->grammarCacheFilePath()};
+      if (!cacheFile.exists()) {
+         qInfo() << Q_FUNC_INFO << "No cached grammar for" << this->m_name << "at" << cacheFile.fileName();
+         return false;
+      }
+      if (!cacheFile.open(QIODevice::ReadOnly)) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not open" << cacheFile.fileName() << "for reading:" << cacheFile.errorString();
+         return false;
+      }
+      QByteArray const cacheData = cacheFile.readAll();
+      QList<QByteArrayView> const cacheDataAsSegments{cacheData};
+      SegmentedBinInputStream cacheDataAsStream{cacheDataAsSegments};
+      try {
+         this->m_grammarPool->deserializeGrammars(&cacheDataAsStream);
+      } catch (xercesc::XMLException const & xe) {
+         //
+         // The pool might be half-filled, so we start again with a new one.  (We also get rid of the cache file, and
+         // a new one will be written once we've parsed the schema.)
+         //
+         qWarning() <<
+            Q_FUNC_INFO << "Could not read cached grammar from" << cacheFile.fileName() << ":" <<
+            XQString(xe.getType()) << ": " << XQString(xe.getMessage());
+         cacheFile.remove();
+         delete this->m_grammarPool;
+         this->m_grammarPool = new xercesc::XMLGrammarPoolImpl{xercesc::XMLPlatformUtils::fgMemoryManager};
+         return false;
+      }
+
+      this->m_grammarPool->lockPool();
+      qInfo() << Q_FUNC_INFO << "Read cached grammar for" << this->m_name << "from" << cacheFile.fileName();
+      return true;
+   }
+
+   /**
+    * \brief Write \c m_grammarPool to our on-disk cache (see \c grammarCacheFilePath), removing any cache files left
+    *        over from previous versions of the schema.  Failure here isn't a problem, it just means we'll have to parse
+    *        the schema again next time.
+    */
+   void writeGrammarCache() const {
+      QString const cacheFilePath = this->grammarCacheFilePath();
+      QFileInfo const cacheFileInfo{cacheFilePath};
+      QDir cacheDir = cacheFileInfo.dir();
+      if (!cacheDir.mkpath(".")) {
+         qWarning() << Q_FUNC_INFO << "Could not create directory" << cacheDir.absolutePath();
+         return;
+      }
+      QString const oldCacheFilePattern = cacheFileInfo.fileName().section('-', 0, -2) + "-*.grammar";
+      for (QString const & oldCacheFile : cacheDir.entryList({oldCacheFilePattern}, QDir::Files)) {
+         qDebug() << Q_FUNC_INFO << "Removing old cache file" << oldCacheFile;
+         cacheDir.remove(oldCacheFile);
+      }
+
+      // Using QSaveFile means we won't leave a half-written file behind if something goes wrong
+      QSaveFile cacheFile{cacheFilePath};
+      if (!cacheFile.open(QIODevice::WriteOnly)) {
+         qWarning() << Q_FUNC_INFO << "Could not open" << cacheFilePath << "for writing:" << cacheFile.errorString();
+         return;
+      }
+      QIODeviceBinOutputStream cacheFileAsStream{cacheFile};
+      try {
+         this->m_grammarPool->serializeGrammars(&cacheFileAsStream);
+      } catch (xercesc::XMLException const & xe) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not write cached grammar to" << cacheFilePath << ":" << XQString(xe.getType()) <<
+            ": " << XQString(xe.getMessage());
+         cacheFile.cancelWriting();
+      }
+      if (cacheFile.commit()) {
+         qInfo() << Q_FUNC_INFO << "Wrote cached grammar for" << this->m_name << "to" << cacheFilePath;
+      }
       return;
    }
 
    /**
-    * \brief Validate XML file against schema, then call other functions to load its contents and store them in the DB
+    * \brief A Xerces parser can only be used by one thread at a time, and we want to be able to validate several files
+    *        in parallel (see \c ImportExport::importFromFiles).  So we keep a pool of parsers (each with the schema
+    *        already loaded) and lend one out for each parse.  In the usual case of reading one file at a time, the pool
+    *        will only ever have one parser in it.
     *
-    * \param documentData The contents of the XML file, which the caller should already have loaded into memory
+    *        As before we had the pool, we don't release the parsers, because we need to be careful about doing so
+    *        before the Xerces & Xalan libraries are terminated in main().
+    */
+   class BorrowedParser {
+   public:
+      BorrowedParser(impl & owner) : m_owner{owner}, m_parser{nullptr} {
+         std::lock_guard const lock{this->m_owner.m_parserPoolMutex};
+         if (this->m_owner.m_idleParsers.empty()) {
+            this->m_parser = this->m_owner.createParser();
+         } else {
+            this->m_parser = this->m_owner.m_idleParsers.back();
+            this->m_owner.m_idleParsers.pop_back();
+         }
+         return;
+      }
+
+      ~BorrowedParser() {
+         std::lock_guard const lock{this->m_owner.m_parserPoolMutex};
+         this->m_owner.m_idleParsers.push_back(this->m_parser);
+         return;
+      }
+
+      xercesc::DOMLSParser * operator->() const {
+         return this->m_parser;
+      }
+
+   private:
+      impl & m_owner;
+      xercesc::DOMLSParser * m_parser;
+   };
+
+   /**
+    * \brief Validate XML file against schema.  See \c XmlCoding::validate.
+    *
+    * \param documentParts The contents of the XML file, which the caller should already have loaded (or mapped) into
+    *                      memory, possibly split into several parts that are read one after the other
     * \param fileName Used only for logging / error message
     * \param domErrorHandler The rules for handling any errors encountered in the file - in particular which errors
     *                        should ignored and whether any adjustment needs to be made to the line numbers where
@@ -354,28 +654,19 @@ public:
     * \param userMessage Any message that we want the top-level caller to display to the user (either about an error
     *                    or, in the event of success, summarising what was read in) should be appended to this string.
     *
-    * \return true if file validated OK (including if there were "errors" that we can safely ignore)
-    *         false if there was a problem that means it's not worth trying to read in the data from the file
+    * \return The parsed document if file validated OK (including if there were "errors" that we can safely ignore)
+    *         \c nullptr if there was a problem that means it's not worth trying to read in the data from the file
     */
-   bool validateLoadAndStoreInDb(QByteArray const & documentData,
-                                 QString const & fileName,
-                                 BtDomErrorHandler & domErrorHandler,
-                                 QTextStream & userMessage) {
-      if (!m_initialised) {
-         this->loadSchema(m_schemaResource);
-         m_initialised = true;
-      }
-
+   std::shared_ptr<BtDomDocumentOwner> validate(QList<QByteArrayView> const & documentParts,
+                                                QString const & fileName,
+                                                BtDomErrorHandler & domErrorHandler,
+                                                QTextStream & userMessage) {
       // See https://www.codesynthesis.com/pipermail/xsd-users/2010-April/002805.html for list of all exceptions Xerces
       // can throw.
       try {
-         // Probably not 100% necessary to lock the pool against modifications, as we're not planning any after start-up, but...
-         //this->grammarPool.lockPool();
-
-         /// TBD probably need to lock other things here ///
+         BorrowedParser parser{*this};
 
-
-         xercesc::DOMConfiguration * config = this->m_parser->getDomConfig();
+         xercesc::DOMConfiguration * config = parser->getDomConfig();
          config->setParameter(xercesc::XMLUni::fgDOMErrorHandler, &domErrorHandler);
 
          // Don't want qDebug to escape newlines, as there will be lots in the list of parameter settings, hence
@@ -385,40 +676,38 @@ public:
 
          QByteArray fileNameAsCString = fileName.toLocal8Bit();
 
-         // Per comment above, third parameter is just a name for the object, which will show up in error messages.
+         // Per comment above, second parameter is just a name for the object, which will show up in error messages.
          // File name seems sensible.
-         xercesc::MemBufInputSource documentAsInputSource{reinterpret_cast<const XMLByte *>(documentData.constData()),
-                                                          static_cast<XMLSize_t>(documentData.length()),
-                                                          fileNameAsCString.constData()};
+         SegmentedInputSource documentAsInputSource{documentParts, fileNameAsCString.constData()};
 
          xercesc::Wrapper4InputSource documentAsDOMLSInput{&documentAsInputSource, false};
 
 
          // The BtDomDocumentOwner object will, in its destructor, handle telling Xerces to release resources related
-         // to the document
-         // std::shared_ptr<BtDomDocumentOwner> domDocumentOwner{new BtDomDocumentOwner{this->m_parser->parse(&documentAsDOMLSInput)}}
-         BtDomDocumentOwner domDocumentOwner{this->m_parser->parse(&documentAsDOMLSInput)};
+         // to the document.  We need a shared pointer to it because the caller may hold on to it (in a copyable
+         // std::function) until it's ready to load the document.
+         auto domDocumentOwner = std::make_shared<BtDomDocumentOwner>(parser->parse(&documentAsDOMLSInput));
 
          bool parsedOk = !domErrorHandler.failed();
          qDebug() << Q_FUNC_INFO << "Parse of input file " << fileName << (parsedOk ? "succeeded" : "FAILED");
 
          if (!parsedOk) {
             userMessage << domErrorHandler.getlastError();
-            return false;
+            return nullptr;
          }
 
-         if (nullptr == domDocumentOwner.getDomDocument()) {
+         if (nullptr == domDocumentOwner->getDomDocument()) {
             //
             // This really should never happen.  Xerces is only supposed to return null from parse() if it in
             // asynchronous mode (which it shouln't be).
             //
             qCritical() << Q_FUNC_INFO << "Got null pointer back from document parse!";
             userMessage << tr("Internal Error! (Document parse returned null pointer.)");
-            return false;
+            return nullptr;
          }
 
-         // If we got this far, the validation has succeeded, and we can now proceed to loading
-         return this->loadValidated(domDocumentOwner.getDomDocument(), userMessage);
+         // If we got this far, the validation has succeeded, and the caller can now proceed to loading
+         return domDocumentOwner;
 
       } catch(const std::exception& se) {
          qCritical() << Q_FUNC_INFO << "Caught std::exception: " << se.what();
@@ -444,6 +733,23 @@ public:
       //
       // If we reach here it's because we caught an exception
       //
+      return nullptr;
+   }
+
+   /**
+    * \brief Load the contents of a validated XML file and store them in the DB.  See \c XmlCoding::loadAndStoreInDb.
+    */
+   bool loadAndStoreInDb(BtDomDocumentOwner & domDocumentOwner, QTextStream & userMessage) {
+      try {
+         return this->loadValidated(domDocumentOwner.getDomDocument(), userMessage);
+      } catch(const std::exception& se) {
+         qCritical() << Q_FUNC_INFO << "Caught std::exception: " << se.what();
+         userMessage << "Caught std::exception: " << se.what();
+      } catch (const xercesc::DOMException & de) {
+         qCritical() <<
+            Q_FUNC_INFO << "Caught xerces::DOMException #" << de.code << ": " << XQString(de.getMessage());
+         userMessage << "DOMException #" << de.code << ": " << XQString(de.getMessage());
+      }
       return false;
    }
 
@@ -537,7 +843,6 @@ public:
 
    // =========================================== Member variables for impl ============================================
    XmlCoding & m_self;
-   bool m_initialised;
    QString const m_name;
    QString const m_schemaResource;
    XmlRecordDefinition const & m_rootRecordDefinition;
@@ -546,14 +851,17 @@ public:
    // Xerces.  However, since Xerces 3.0.0 release, it is now part of the public API -- see
    // https://xerces.apache.org/xerces-c/migrate-archive-3.html#NewAPI300
    //
-   // NB: For the moment, this is commented out as I think we don't need it.  If we want to play around with it more
-   //     then we need to be careful about ensuring it is destructed before the Xerces & Xalan libraries are terminated
-   //     in main().
+   // This is shared by all the parsers in m_idleParsers, and is locked (ie read-only, which makes it safe for parsers
+   // on different threads to use it at the same time) once the schema is loaded into it.  As with the parsers, we don't
+   // delete it, as it must not be destructed after the Xerces & Xalan libraries are terminated in main().
    //
-   // xercesc::XMLGrammarPoolImpl grammarPool;
+   xercesc::XMLGrammarPoolImpl * m_grammarPool;
 
    xercesc::DOMImplementation * m_domImplementation;
-   xercesc::DOMLSParser * m_parser;
+   //! Guards \c m_grammarPool, \c m_domImplementation and \c m_idleParsers
+   std::mutex m_parserPoolMutex;
+   //! See \c BorrowedParser
+   std::vector<xercesc::DOMLSParser *> m_idleParsers;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -575,9 +883,22 @@ XmlRecordDefinition const & XmlCoding::getRoot() const {
    return this->pimpl->m_rootRecordDefinition;
 }
 
-bool XmlCoding::validateLoadAndStoreInDb(QByteArray const & documentData,
+bool XmlCoding::validateLoadAndStoreInDb(QList<QByteArrayView> const & documentParts,
                                          QString const & fileName,
                                          BtDomErrorHandler & domErrorHandler,
                                          QTextStream & userMessage) const {
-   return this->pimpl->validateLoadAndStoreInDb(documentData, fileName, domErrorHandler, userMessage);
+   std::shared_ptr<BtDomDocumentOwner> domDocumentOwner =
+      this->pimpl->validate(documentParts, fileName, domErrorHandler, userMessage);
+   return domDocumentOwner && this->pimpl->loadAndStoreInDb(*domDocumentOwner, userMessage);
+}
+
+std::shared_ptr<BtDomDocumentOwner> XmlCoding::validate(QList<QByteArrayView> const & documentParts,
+                                                        QString const & fileName,
+                                                        BtDomErrorHandler & domErrorHandler,
+                                                        QTextStream & userMessage) const {
+   return this->pimpl->validate(documentParts, fileName, domErrorHandler, userMessage);
+}
+
+bool XmlCoding::loadAndStoreInDb(BtDomDocumentOwner & domDocumentOwner, QTextStream & userMessage) const {
+   return this->pimpl->loadAndStoreInDb(domDocumentOwner, userMessage);
 }
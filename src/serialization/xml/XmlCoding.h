@@ -18,7 +18,9 @@
 #pragma once
 
 #include <memory> // For smart pointers
+#include <QByteArrayView>
 #include <QHash>
+#include <QList>
 #include <QObject>
 #include <QString>
 #include <QTextStream>
@@ -34,6 +36,8 @@
 #include "serialization/xml/XmlMashStepRecord.h"
 #include "serialization/xml/XmlRecipeRecord.h"
 
+class BtDomDocumentOwner;
+
 /**
  * \brief An instance of this class holds information about a particular XML encoding (eg BeerXML 1.0) including the
  *        parameters needed to construct the various \b XmlRecord objects used to parse a document of this encoding.
@@ -147,7 +151,10 @@ public:
    /**
     * \brief Validate XML file against schema, load its contents into objects, and store then in the DB
     *
-    * \param documentData The contents of the XML file, which the caller should already have loaded into memory
+    * \param documentParts The contents of the XML file, which the caller should already have loaded (or mapped) into
+    *                      memory.  This can be split into several parts (eg if the caller needs to insert some extra
+    *                      text), which are parsed one after the other as though they were a single buffer.  We do not
+    *                      copy the data, so it needs to remain valid until this function returns.
     * \param fileName Used only for logging / error message
     * \param domErrorHandler The rules for handling any errors encountered in the file - in particular which errors
     *                        should ignored and whether any adjustment needs to be made to the line numbers where
@@ -160,11 +167,35 @@ public:
     * \return true if file validated OK (including if there were "errors" that we can safely ignore)
     *         false if there was a problem that means it's not worth trying to read in the data from the file
     */
-   bool validateLoadAndStoreInDb(QByteArray const & documentData,
+   bool validateLoadAndStoreInDb(QList<QByteArrayView> const & documentParts,
                                  QString const & fileName,
                                  BtDomErrorHandler & domErrorHandler,
                                  QTextStream & userMessage) const;
 
+   /**
+    * \brief First half of \c validateLoadAndStoreInDb: validate XML file against schema.  This does not create any
+    *        objects or touch the DB, so, unlike the second half, it is safe to call from any thread.
+    *
+    * \param documentParts
+    * \param fileName
+    * \param domErrorHandler
+    * \param userMessage All as for \c validateLoadAndStoreInDb
+    *
+    * \return The parsed document to pass to \c loadAndStoreInDb, or \c nullptr if the file did not validate
+    */
+   std::shared_ptr<BtDomDocumentOwner> validate(QList<QByteArrayView> const & documentParts,
+                                                QString const & fileName,
+                                                BtDomErrorHandler & domErrorHandler,
+                                                QTextStream & userMessage) const;
+
+   /**
+    * \brief Second half of \c validateLoadAndStoreInDb: load the contents of a document returned by \c validate into
+    *        objects and store them in the DB.  Must be called on the main thread.
+    *
+    * \return As for \c validateLoadAndStoreInDb
+    */
+   bool loadAndStoreInDb(BtDomDocumentOwner & domDocumentOwner, QTextStream & userMessage) const;
+
 private:
 
    // Private implementation details - see https://herbsutter.com/gotw/_100/
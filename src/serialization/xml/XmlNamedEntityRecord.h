@@ -94,9 +94,15 @@ protected:
       // It's a coding error if we are searching for a duplicate of a null object
       Q_ASSERT(nullptr != this->m_namedEntity.get());
 
-      // This copy of the pointer is just to make it clearer what we're passing to lambda in findFirstMatching() below
       std::shared_ptr<NE const> const currentEntity = std::static_pointer_cast<NE const>(this->m_namedEntity);
-      auto matchResult = ObjectStoreTyped<NE>::getInstance().findFirstMatching(
+
+      //
+      // Rather than compare against every object in the store, we only need to look at the ones whose names could
+      // make them equal to this one (see ObjectStore::findAllPossibleDuplicates), which is usually none or one.
+      //
+      std::shared_ptr<NE> matchResult = nullptr;
+      for (auto const & ne :
+           ObjectStoreTyped<NE>::getInstance().findAllPossibleDuplicates(currentEntity->name())) {
          //
          // Note that, because we run this check both before and after something has been stored in the database (for
          // reasons explained in XmlRecord::normaliseAndStoreInDb) we need to be particularly careful NOT to match the
@@ -105,12 +111,11 @@ protected:
          // Note too that we don't want to match against soft-deleted entities.  (Otherwise, if you delete something and
          // then try to import it again, it will never import!)
          //
-         [currentEntity](std::shared_ptr<NE> ne) {
-            return (*ne == *currentEntity) &&
-                   (ne->key() != currentEntity->key()) &&
-                   (!ne->deleted());
+         if ((ne->key() != currentEntity->key()) && (!ne->deleted()) && (*ne == *currentEntity)) {
+            matchResult = ne;
+            break;
          }
-      );
+      }
       if (matchResult) {
          qDebug() <<
             Q_FUNC_INFO << "Found a match (#" << matchResult->key() << "," << matchResult->name() <<
@@ -138,16 +143,12 @@ protected:
    virtual void normaliseName() {
       QString currentName = this->m_namedEntity->name();
 
-      while (
-         //
-         // At the moment, we're pretty strict here and count a name clash even for things that are soft deleted.  If
-         // we wanted to allow clashes with such soft-deleted things then we could add a check against ne->deleted()
-         // as in the isDuplicate() function.
-         //
-         auto matchResult = ObjectStoreTyped<NE>::getInstance().findFirstMatching(
-            [currentName](std::shared_ptr<NE> ne) {return ne->name() == currentName;}
-         )
-      ) {
+      //
+      // At the moment, we're pretty strict here and count a name clash even for things that are soft deleted.  If we
+      // wanted to allow clashes with such soft-deleted things then we could use ObjectStore::findAllByName() and check
+      // ne->deleted() as in the isDuplicate() function.
+      //
+      while (ObjectStoreTyped<NE>::getInstance().containsName(currentName)) {
          qDebug() << Q_FUNC_INFO << "Found existing " << NE::staticMetaObject.className() << "named" << currentName;
 
          XmlRecord::modifyClashingName(currentName);
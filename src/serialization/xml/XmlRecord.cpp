@@ -68,7 +68,8 @@ XmlRecord::XmlRecord(XmlCoding           const & xmlCoding,
    SerializationRecord{},
    m_coding{xmlCoding},
    m_recordDefinition{recordDefinition},
-   m_childRecordSets{} {
+   m_childRecordSets{},
+   m_exportSubRecords{} {
    return;
 }
 
@@ -839,6 +840,14 @@ bool XmlRecord::normaliseAndStoreChildRecordsInDb(QTextStream & userMessage,
    return true;
 }
 
+XmlRecord const & XmlRecord::exportSubRecord(XmlRecordDefinition const & childRecordDefinition) const {
+   std::unique_ptr<XmlRecord> & subRecord = this->m_exportSubRecords[&childRecordDefinition];
+   if (!subRecord) {
+      subRecord = childRecordDefinition.makeRecord(this->m_coding);
+   }
+   return *subRecord;
+}
+
 void XmlRecord::toXml(NamedEntity const & namedEntityToExport,
                       QTextStream & out,
                       bool const includeRecordNameTags,
@@ -900,9 +909,9 @@ void XmlRecord::toXml(NamedEntity const & namedEntityToExport,
             out << "<" << xPathElements.at(ii) << ">\n";
          }
          qDebug() <<
-            Q_FUNC_INFO << "Creating XmlRecord for" << fieldDefinition.propertyPath << ".  XPath:" << xPathElements <<
+            Q_FUNC_INFO << "Using XmlRecord for" << fieldDefinition.propertyPath << ".  XPath:" << xPathElements <<
             ";" << xPathElements.last();
-         std::unique_ptr<XmlRecord> subRecord{childRecordDefinition.makeRecord(this->m_coding)};
+         XmlRecord const & subRecord = this->exportSubRecord(childRecordDefinition);
 
          if (XmlRecordDefinition::FieldType::Record == fieldDefinition.type) {
             //
@@ -939,13 +948,13 @@ void XmlRecord::toXml(NamedEntity const & namedEntityToExport,
 
             if (childNamedEntity) {
                // For a "base record", having numContainingTags == -1 means the fourth parameter here is still correct!
-               subRecord->toXml(*childNamedEntity,
-                                out,
-                                numContainingTags >= 0,
-                                indentLevel + numContainingTags + 1,
-                                indentString);
+               subRecord.toXml(*childNamedEntity,
+                               out,
+                               numContainingTags >= 0,
+                               indentLevel + numContainingTags + 1,
+                               indentString);
             } else {
-               this->writeNone(*subRecord, namedEntityToExport, out, indentLevel + numContainingTags + 1, indentString);
+               this->writeNone(subRecord, namedEntityToExport, out, indentLevel + numContainingTags + 1, indentString);
             }
          } else {
             //
@@ -956,7 +965,7 @@ void XmlRecord::toXml(NamedEntity const & namedEntityToExport,
             // Instead, we get the subclass of this class (eg XmlRecipeRecord) to do the work
             //
             this->subRecordToXml(fieldDefinition,
-                                 *subRecord,
+                                 subRecord,
                                  namedEntityToExport,
                                  out,
                                  indentLevel + numContainingTags + 1,
@@ -17,6 +17,8 @@
 #define SERIALIZATION_XML_XMLRECORD_H
 #pragma once
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <QTextStream>
@@ -117,6 +119,9 @@ public:
     *                              fields to be enclosed in another tag pair
     * \param indentLevel Current number of indents to put before each opening tag (default 1)
     * \param indentString String to use for each indent (default two spaces)
+    *
+    *        The same \c XmlRecord can (and, for speed, should) be used to export any number of objects of the same
+    *        type, but not from more than one thread at a time.
     */
    void toXml(NamedEntity const & namedEntityToExport,
               QTextStream & out,
@@ -136,6 +141,12 @@ private:
                          std::vector<xalanc::XalanNode *> & nodesForCurrentXPath,
                          QTextStream & userMessage);
 
+   /**
+    * \brief Used by \c toXml to get an \c XmlRecord for writing out child records.  These are created on first use and
+    *        then kept for the lifetime of this object.
+    */
+   XmlRecord const & exportSubRecord(XmlRecordDefinition const & childRecordDefinition) const;
+
 protected:
    bool normaliseAndStoreChildRecordsInDb(QTextStream & userMessage,
                                           ImportRecordCount & stats);
@@ -198,6 +209,12 @@ protected:
    };
 
    std::vector<ChildRecordSet> m_childRecordSets;
+
+   //
+   // When writing TO an XML file, we need an XmlRecord for each type of child record.  Because exporting is const, one
+   // of each will do for all the child records of all the records we export, so we only make them once.
+   //
+   mutable std::unordered_map<XmlRecordDefinition const *, std::unique_ptr<XmlRecord>> m_exportSubRecords;
 };
 
 #endif
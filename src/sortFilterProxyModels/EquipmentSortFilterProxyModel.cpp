@@ -16,30 +16,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/EquipmentSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool EquipmentSortFilterProxyModel::isLessThan(EquipmentTableModel::ColumnIndex const columnIndex,
-                                               QVariant const & leftItem,
-                                               QVariant const & rightItem) const {
-   switch (columnIndex) {
-       case EquipmentTableModel::ColumnIndex::Name:
-         return leftItem.toString() < rightItem.toString();
-
-      case EquipmentTableModel::ColumnIndex::MashTunVolume:
-      case EquipmentTableModel::ColumnIndex::KettleVolume   :
-      case EquipmentTableModel::ColumnIndex::FermenterVolume:
-         return (Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Volume) <
-                 Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Volume));
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(Equipment)
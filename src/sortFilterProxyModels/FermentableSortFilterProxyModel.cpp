@@ -22,37 +22,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/FermentableSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool FermentableSortFilterProxyModel::isLessThan(FermentableTableModel::ColumnIndex const columnIndex,
-                                                 QVariant const & leftItem,
-                                                 QVariant const & rightItem) const {
-   switch (columnIndex) {
-      case FermentableTableModel::ColumnIndex::Name              :
-      case FermentableTableModel::ColumnIndex::Type              :
-      case FermentableTableModel::ColumnIndex::TotalInventoryType:
-         return leftItem.toString() < rightItem.toString();
-
-      case FermentableTableModel::ColumnIndex::TotalInventory:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Mass);
-
-      case FermentableTableModel::ColumnIndex::Yield:
-         return Measurement::extractRawFromString<double>( leftItem.toString()) <
-                Measurement::extractRawFromString<double>(rightItem.toString());
-
-      case FermentableTableModel::ColumnIndex::Color:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Color) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Color);
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(Fermentable)
@@ -0,0 +1,248 @@
+/*======================================================================================================================
+ * sortFilterProxyModels/FilterQuery.cpp is part of Brewken, and is copyright the following authors 2024:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#include "sortFilterProxyModels/FilterQuery.h"
+
+#include <optional>
+
+#include <QDebug>
+#include <QRegularExpression>
+
+#include "measurement/Measurement.h"
+#include "measurement/PhysicalQuantity.h"
+#include "tableModels/BtTableModel.h"
+#include "utils/FuzzyCompare.h"
+
+namespace {
+   //
+   // A column term is a column name, an operator and a value, with optional spaces in between.  The value is either a
+   // quoted string (which may contain spaces) or runs up to the next space.  Note that the two-character operators
+   // need to come before the one-character ones in the alternation, so that, eg, "<=" is not read as "<".
+   //
+   QRegularExpression const columnTermRegExp{R"((\w+)\s*(<=|>=|!=|<|>|=|:)\s*("[^"]*"|[^\s"]+))"};
+
+   std::optional<FilterQuery::Operator> operatorFromString(QString const & text) {
+      if (text == ":" ) { return FilterQuery::Operator::Contains      ; }
+      if (text == "=" ) { return FilterQuery::Operator::Equal         ; }
+      if (text == "!=") { return FilterQuery::Operator::NotEqual      ; }
+      if (text == "<" ) { return FilterQuery::Operator::Less          ; }
+      if (text == "<=") { return FilterQuery::Operator::LessOrEqual   ; }
+      if (text == ">" ) { return FilterQuery::Operator::Greater       ; }
+      if (text == ">=") { return FilterQuery::Operator::GreaterOrEqual; }
+      return std::nullopt;
+   }
+
+   //! \return Index of the column with the supplied name or label (ignoring case), or -1 if there isn't one
+   int findColumn(QString const & name, BtTableModel const & tableModel) {
+      for (int column = 0; column < tableModel.columnCount(); ++column) {
+         BtTableModel::ColumnInfo const & columnInfo = tableModel.getColumnInfo(static_cast<size_t>(column));
+         if (name.compare(QString{columnInfo.columnName}, Qt::CaseInsensitive) == 0 ||
+             name.compare(columnInfo.label              , Qt::CaseInsensitive) == 0) {
+            return column;
+         }
+      }
+      return -1;
+   }
+
+   /**
+    * \brief Convert the value in a column term to what we'll compare with \c TableModelBase::sortKey: a number in
+    *        canonical units for numeric columns, otherwise the string as typed.
+    */
+   std::variant<double, QString> parseValue(QString const & valueText,
+                                            FilterQuery::Operator const op,
+                                            BtTableModel::ColumnInfo const & columnInfo) {
+      if (op == FilterQuery::Operator::Contains) {
+         return valueText;
+      }
+
+      // If there's no number at the start of the value, it can only be a string comparison
+      bool ok = false;
+      double const rawValue = Measurement::extractRawFromString<double>(valueText, &ok);
+      if (!ok) {
+         return valueText;
+      }
+
+      TypeInfo const & typeInfo = columnInfo.typeInfo;
+      if (std::holds_alternative<NonPhysicalQuantity>(*typeInfo.fieldType)) {
+         switch (std::get<NonPhysicalQuantity>(*typeInfo.fieldType)) {
+            case NonPhysicalQuantity::Percentage    :
+            case NonPhysicalQuantity::OrdinalNumeral:
+            case NonPhysicalQuantity::Dimensionless :
+               return rawValue;
+            case NonPhysicalQuantity::Date  :
+            case NonPhysicalQuantity::String:
+            case NonPhysicalQuantity::Bool  :
+            case NonPhysicalQuantity::Enum  :
+               return valueText;
+            // No default case as we want the compiler to warn us if we missed one
+         }
+         // Should be unreachable
+         return valueText;
+      }
+
+      if (columnInfo.extras && std::holds_alternative<Measurement::ChoiceOfPhysicalQuantity>(*columnInfo.extras)) {
+         // This is the drop-down for choosing between eg mass and volume, which we compare as a string
+         return valueText;
+      }
+
+      Measurement::PhysicalQuantity const physicalQuantity =
+         std::holds_alternative<Measurement::PhysicalQuantity>(*typeInfo.fieldType) ?
+            std::get<Measurement::PhysicalQuantity>(*typeInfo.fieldType) :
+            Measurement::defaultPhysicalQuantity(std::get<Measurement::ChoiceOfPhysicalQuantity>(*typeInfo.fieldType));
+      return Measurement::qStringToSI(valueText,
+                                      physicalQuantity,
+                                      columnInfo.getForcedSystemOfMeasurement(),
+                                      columnInfo.getForcedRelativeScale()).quantity;
+   }
+
+   bool isLowerBound(FilterQuery::Operator const op) {
+      return op == FilterQuery::Operator::Greater || op == FilterQuery::Operator::GreaterOrEqual;
+   }
+   bool isUpperBound(FilterQuery::Operator const op) {
+      return op == FilterQuery::Operator::Less || op == FilterQuery::Operator::LessOrEqual;
+   }
+}
+
+bool FilterQuery::Term::matches(QVariant const & value) const {
+   if (!value.isValid()) {
+      // Unset optional values don't match anything except "not equal to"
+      return this->op == Operator::NotEqual;
+   }
+
+   if (std::holds_alternative<double>(this->value)) {
+      bool ok = false;
+      double const actual = value.toDouble(&ok);
+      if (!ok) {
+         return false;
+      }
+      double const wanted = std::get<double>(this->value);
+      switch (this->op) {
+         case Operator::Contains      :
+         case Operator::Equal         : return  Utils::FuzzyCompare(actual, wanted);
+         case Operator::NotEqual      : return !Utils::FuzzyCompare(actual, wanted);
+         case Operator::Less          : return actual <  wanted;
+         case Operator::LessOrEqual   : return actual <= wanted;
+         case Operator::Greater       : return actual >  wanted;
+         case Operator::GreaterOrEqual: return actual >= wanted;
+         // No default case as we want the compiler to warn us if we missed one
+      }
+      // Should be unreachable
+      return false;
+   }
+
+   QString const actual = value.toString();
+   QString const & wanted = std::get<QString>(this->value);
+   if (this->op == Operator::Contains) {
+      return actual.contains(wanted, Qt::CaseInsensitive);
+   }
+   int const comparison = actual.compare(wanted, Qt::CaseInsensitive);
+   switch (this->op) {
+      case Operator::Contains      : // Handled above, but compiler doesn't know that
+      case Operator::Equal         : return comparison == 0;
+      case Operator::NotEqual      : return comparison != 0;
+      case Operator::Less          : return comparison <  0;
+      case Operator::LessOrEqual   : return comparison <= 0;
+      case Operator::Greater       : return comparison >  0;
+      case Operator::GreaterOrEqual: return comparison >= 0;
+      // No default case as we want the compiler to warn us if we missed one
+   }
+   // Should be unreachable
+   return false;
+}
+
+bool FilterQuery::Term::isNarrowingOf(Term const & previous) const {
+   if (*this == previous) {
+      return true;
+   }
+   if (this->column != previous.column || this->value.index() != previous.value.index()) {
+      return false;
+   }
+
+   if (std::holds_alternative<QString>(this->value)) {
+      // Eg "saaz" is narrower than "saa", because anything containing the former also contains the latter
+      return this->op == Operator::Contains && previous.op == Operator::Contains &&
+             std::get<QString>(this->value).contains(std::get<QString>(previous.value), Qt::CaseInsensitive);
+   }
+
+   double const newBound = std::get<double>(this->value);
+   double const oldBound = std::get<double>(previous.value);
+   // Eg "alpha>10" is narrower than "alpha>5".  At the same bound, ">" is narrower than ">=", but not vice versa.
+   if (isLowerBound(this->op) && isLowerBound(previous.op)) {
+      return newBound > oldBound || (newBound == oldBound && this->op == Operator::Greater);
+   }
+   if (isUpperBound(this->op) && isUpperBound(previous.op)) {
+      return newBound < oldBound || (newBound == oldBound && this->op == Operator::Less);
+   }
+   return false;
+}
+
+FilterQuery::FilterQuery() : m_terms{} {
+   return;
+}
+
+FilterQuery::FilterQuery(QString const & text, BtTableModel const & tableModel, int const defaultColumn) :
+   m_terms{} {
+   // Anything that isn't a column term is plain text to match against the default column.  As when the filter was a
+   // fixed string, several words together are one phrase, so "east kent" does not match "Kent East".
+   auto addPlainText = [&](QString const & plainText) {
+      QString const phrase = plainText.trimmed();
+      if (!phrase.isEmpty()) {
+         this->m_terms.push_back(Term{defaultColumn, Operator::Contains, phrase});
+      }
+   };
+
+   qsizetype position = 0;
+   for (QRegularExpressionMatch const & match : columnTermRegExp.globalMatch(text)) {
+      int const column = findColumn(match.captured(1), tableModel);
+      if (column < 0) {
+         // Not a column we know about, so the whole thing will get treated as plain text
+         continue;
+      }
+      addPlainText(text.mid(position, match.capturedStart() - position));
+      position = match.capturedEnd();
+
+      Operator const op = *operatorFromString(match.captured(2));
+      QString valueText = match.captured(3);
+      if (valueText.startsWith('"')) {
+         valueText = valueText.mid(1, valueText.length() - 2);
+      }
+      this->m_terms.push_back(
+         Term{column, op, parseValue(valueText, op, tableModel.getColumnInfo(static_cast<size_t>(column)))}
+      );
+   }
+   addPlainText(text.mid(position));
+
+   qDebug() << Q_FUNC_INFO << "Filter" << text << "has" << this->m_terms.size() << "term(s)";
+   return;
+}
+
+FilterQuery::~FilterQuery() = default;
+
+bool FilterQuery::isEmpty() const {
+   return this->m_terms.empty();
+}
+
+bool FilterQuery::isNarrowingOf(FilterQuery const & previous) const {
+   // Extra terms can only narrow things further, but each of the previous terms needs to be narrowed (or kept)
+   if (this->m_terms.size() < previous.m_terms.size()) {
+      return false;
+   }
+   for (std::size_t ii = 0; ii < previous.m_terms.size(); ++ii) {
+      if (!this->m_terms[ii].isNarrowingOf(previous.m_terms[ii])) {
+         return false;
+      }
+   }
+   return true;
+}
@@ -0,0 +1,120 @@
+/*======================================================================================================================
+ * sortFilterProxyModels/FilterQuery.h is part of Brewken, and is copyright the following authors 2024:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#ifndef SORTFILTERPROXYMODELS_FILTERQUERY_H
+#define SORTFILTERPROXYMODELS_FILTERQUERY_H
+#pragma once
+
+#include <variant>
+#include <vector>
+
+#include <QString>
+#include <QVariant>
+
+class BtTableModel;
+
+/**
+ * \brief A search, as typed by the user into the filter box of a catalog (eg \c HopCatalog), parsed ("compiled") once
+ *        so that it can be quickly tested against each row of a table model.
+ *
+ *        The search text is a list of terms, all of which must match for a row to be shown.  A term is either:
+ *          - plain text, which matches if the name contains it (ignoring case).  Several words together are one
+ *            phrase, so "east kent" matches "East Kent Goldings" but not "Kent East"; or
+ *          - a column name, an operator and a value, eg "alpha>10", "form=pellet" or "type:grain".  The column name is
+ *            either the internal name (eg "TotalInventory") or the header label (eg "Inventory"), ignoring case.  The
+ *            operators are \c < \c <= \c > \c >= \c = \c != and \c : (contains).  For columns holding an amount, the
+ *            value can have units (eg "inventory<500g"), otherwise it is taken to be in the units shown in the column.
+ *
+ *        If a word looks like a column term but the column name is not recognised, it is treated as plain text.
+ *
+ *        Terms are tested against the values from \c TableModelBase::sortKey, ie canonical amounts rather than the
+ *        formatted strings in the table.
+ */
+class FilterQuery {
+public:
+   enum class Operator {
+      Contains      ,
+      Equal         ,
+      NotEqual      ,
+      Less          ,
+      LessOrEqual   ,
+      Greater       ,
+      GreaterOrEqual,
+   };
+
+   struct Term {
+      int column;
+      Operator op;
+      //! A number, in canonical units, for numeric comparisons; otherwise the string to compare with
+      std::variant<double, QString> value;
+
+      bool operator==(Term const & other) const = default;
+
+      /**
+       * \brief Returns \c true if \c value (as returned by \c TableModelBase::sortKey) satisfies this term
+       */
+      bool matches(QVariant const & value) const;
+
+      /**
+       * \brief Returns \c true if everything that matches this term would also match \c previous.  Eg "saaz" is
+       *        narrower than "saa", and "alpha>10" is narrower than "alpha>5".
+       */
+      bool isNarrowingOf(Term const & previous) const;
+   };
+
+   //! Default constructor makes an empty query, which matches everything
+   FilterQuery();
+
+   /**
+    * \param text what the user typed
+    * \param tableModel used to find columns by name, and how to parse values for them
+    * \param defaultColumn the column that plain text is matched against, normally the name
+    */
+   FilterQuery(QString const & text, BtTableModel const & tableModel, int const defaultColumn);
+
+   ~FilterQuery();
+
+   bool isEmpty() const;
+
+   /**
+    * \brief Returns \c true if every row that matches this query would also have matched \c previous, in which case,
+    *        rows that didn't match \c previous don't need to be tested against this query.  This is typically the case
+    *        when the user types more characters into the filter box.
+    *
+    *        Note that a \c false return does not mean the query is not narrower, only that we can't easily tell.
+    */
+   bool isNarrowingOf(FilterQuery const & previous) const;
+
+   /**
+    * \brief Returns \c true if the row for which \c getValue gives the column values matches all the terms of this query
+    *
+    * \param getValue Functor taking column number and returning \c QVariant from \c TableModelBase::sortKey.  It is
+    *                 only called for the columns we need, and we stop at the first term that doesn't match.
+    */
+   template<class GetValue>
+   bool matches(GetValue getValue) const {
+      for (Term const & term : this->m_terms) {
+         if (!term.matches(getValue(term.column))) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+private:
+   std::vector<Term> m_terms;
+};
+
+#endif
@@ -21,34 +21,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/HopSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool HopSortFilterProxyModel::isLessThan(HopTableModel::ColumnIndex const columnIndex,
-                                         QVariant const & leftItem,
-                                         QVariant const & rightItem) const {
-   switch (columnIndex) {
-      case HopTableModel::ColumnIndex::Name:
-      case HopTableModel::ColumnIndex::Form:
-      case HopTableModel::ColumnIndex::Year:
-      case HopTableModel::ColumnIndex::TotalInventoryType:
-         return leftItem.toString() < rightItem.toString();
-
-      case HopTableModel::ColumnIndex::Alpha:
-         return Measurement::extractRawFromString<double>( leftItem.toString()) <
-                Measurement::extractRawFromString<double>(rightItem.toString());
-
-      case HopTableModel::ColumnIndex::TotalInventory:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Mass);
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(Hop)
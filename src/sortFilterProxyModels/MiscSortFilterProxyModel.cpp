@@ -20,36 +20,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/MiscSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool MiscSortFilterProxyModel::isLessThan(MiscTableModel::ColumnIndex const columnIndex,
-                                          QVariant const & leftItem,
-                                          QVariant const & rightItem) const {
-   switch (columnIndex) {
-      case MiscTableModel::ColumnIndex::Name:
-      case MiscTableModel::ColumnIndex::Type:
-///      case MiscTableModel::ColumnIndex::Use:
-      case MiscTableModel::ColumnIndex::TotalInventoryType:
-         return leftItem.toString() < rightItem.toString();
-
-      case MiscTableModel::ColumnIndex::TotalInventory:
-         // It's probably wrong to assume everything is mass, but OTOH, it's not instantly obvious how to sort a mixture
-         // of masses and volumes
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Mass);
-
-///      case MiscTableModel::ColumnIndex::Time:
-///         return (Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Time) <
-///                 Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Time));
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(Misc)
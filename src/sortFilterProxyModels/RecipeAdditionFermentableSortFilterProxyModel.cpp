@@ -21,43 +21,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/RecipeAdditionFermentableSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool RecipeAdditionFermentableSortFilterProxyModel::isLessThan(RecipeAdditionFermentableTableModel::ColumnIndex const columnIndex,
-                                                               QVariant const & leftItem,
-                                                               QVariant const & rightItem) const {
-   switch (columnIndex) {
-      case RecipeAdditionFermentableTableModel::ColumnIndex::Name      :
-      case RecipeAdditionFermentableTableModel::ColumnIndex::Type      :
-      case RecipeAdditionFermentableTableModel::ColumnIndex::AmountType:
-      case RecipeAdditionFermentableTableModel::ColumnIndex::Stage     :
-         return leftItem.toString() < rightItem.toString();
-
-      case RecipeAdditionFermentableTableModel::ColumnIndex::TotalInventory:
-      case RecipeAdditionFermentableTableModel::ColumnIndex::Amount:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Mass);
-
-      case RecipeAdditionFermentableTableModel::ColumnIndex::Time:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Time) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Time);
-
-      case RecipeAdditionFermentableTableModel::ColumnIndex::Yield:
-         return Measurement::extractRawFromString<double>( leftItem.toString()) <
-                Measurement::extractRawFromString<double>(rightItem.toString());
-
-      case RecipeAdditionFermentableTableModel::ColumnIndex::Color:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Color) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Color);
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(RecipeAdditionFermentable)
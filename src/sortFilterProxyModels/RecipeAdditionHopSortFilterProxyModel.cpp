@@ -21,40 +21,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/RecipeAdditionHopSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool RecipeAdditionHopSortFilterProxyModel::isLessThan(RecipeAdditionHopTableModel::ColumnIndex const columnIndex,
-                                                       QVariant const & leftItem,
-                                                       QVariant const & rightItem) const {
-   switch (columnIndex) {
-      case RecipeAdditionHopTableModel::ColumnIndex::Name:
-      case RecipeAdditionHopTableModel::ColumnIndex::Form:
-      case RecipeAdditionHopTableModel::ColumnIndex::Year:
-      case RecipeAdditionHopTableModel::ColumnIndex::Stage:
-      case RecipeAdditionHopTableModel::ColumnIndex::AmountType:
-         return leftItem.toString() < rightItem.toString();
-
-      case RecipeAdditionHopTableModel::ColumnIndex::Alpha:
-         return Measurement::extractRawFromString<double>( leftItem.toString()) <
-                Measurement::extractRawFromString<double>(rightItem.toString());
-
-      case RecipeAdditionHopTableModel::ColumnIndex::TotalInventory:
-      case RecipeAdditionHopTableModel::ColumnIndex::Amount:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Mass);
-
-      case RecipeAdditionHopTableModel::ColumnIndex::Time:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Time) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Time);
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(RecipeAdditionHop)
@@ -21,35 +21,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/RecipeAdditionMiscSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool RecipeAdditionMiscSortFilterProxyModel::isLessThan(RecipeAdditionMiscTableModel::ColumnIndex const columnIndex,
-                                                       QVariant const & leftItem,
-                                                       QVariant const & rightItem) const {
-   switch (columnIndex) {
-      case RecipeAdditionMiscTableModel::ColumnIndex::Name:
-      case RecipeAdditionMiscTableModel::ColumnIndex::Type:
-      case RecipeAdditionMiscTableModel::ColumnIndex::Stage:
-      case RecipeAdditionMiscTableModel::ColumnIndex::AmountType:
-         return leftItem.toString() < rightItem.toString();
-
-      case RecipeAdditionMiscTableModel::ColumnIndex::TotalInventory:
-      case RecipeAdditionMiscTableModel::ColumnIndex::Amount:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Mass);
-
-      case RecipeAdditionMiscTableModel::ColumnIndex::Time:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Time) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Time);
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(RecipeAdditionMisc)
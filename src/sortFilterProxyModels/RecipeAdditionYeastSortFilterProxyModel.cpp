@@ -21,45 +21,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/RecipeAdditionYeastSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool RecipeAdditionYeastSortFilterProxyModel::isLessThan(RecipeAdditionYeastTableModel::ColumnIndex const columnIndex,
-                                                         QVariant const & leftItem,
-                                                         QVariant const & rightItem) const {
-   switch (columnIndex) {
-      case RecipeAdditionYeastTableModel::ColumnIndex::Name:
-      case RecipeAdditionYeastTableModel::ColumnIndex::Laboratory:
-      case RecipeAdditionYeastTableModel::ColumnIndex::ProductId:
-      case RecipeAdditionYeastTableModel::ColumnIndex::Type:
-      case RecipeAdditionYeastTableModel::ColumnIndex::Form:
-      case RecipeAdditionYeastTableModel::ColumnIndex::Stage:
-      case RecipeAdditionYeastTableModel::ColumnIndex::Step:
-      case RecipeAdditionYeastTableModel::ColumnIndex::AmountType:
-         return leftItem.toString() < rightItem.toString();
-
-      case RecipeAdditionYeastTableModel::ColumnIndex::Attenuation:
-         // Attenuation on a RecipeAdditionYeast is std::optional<double> in the underlying model.  But here, the
-         // leftItem and rightItem QVariants will contain QString eg "75.0 %" or "" (for std::nullopt).
-         //
-         // Measurement::extractRawFromString does pretty much what we want though TODO we should explicitly tell it
-         // blanks are OK.
-         //
-         return Measurement::extractRawFromString<double>( leftItem.toString()) <
-                Measurement::extractRawFromString<double>(rightItem.toString());
-
-      case RecipeAdditionYeastTableModel::ColumnIndex::TotalInventory:
-      case RecipeAdditionYeastTableModel::ColumnIndex::Amount:
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Mass);
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(RecipeAdditionYeast)
@@ -18,7 +18,13 @@
 #define SORTFILTERPROXYMODELS_SORTFILTERPROXYMODELBASE_H
 #pragma once
 
+#include <utility>
+
 #include <QDebug>
+#include <QSet>
+#include <QVariant>
+
+#include "sortFilterProxyModels/FilterQuery.h"
 #include "utils/CuriouslyRecurringTemplateBase.h"
 
 /**
@@ -30,14 +36,51 @@
  *                            \          /
  *                          HopSortFilterProxyModel
  *
- *        Derived classes need to implement lessThan to provide the right per-column logic for this.
+ *        When the source model is a table model, we sort on \c TableModelBase::sortKey, which gives us typed values
+ *        (eg amounts in canonical units) that can be compared directly.  List models (eg \c StyleListModel) only have
+ *        the name column, so, for them, we just compare the display strings.
+ *
+ *        Similarly, for table models, filtering is done with a \c FilterQuery (see \c setFilterQuery) that is tested
+ *        against the same typed values.
  */
 template<class Derived> class SortFilterProxyModelPhantom;
 template<class Derived, class NeTableModel, class NeListModel>
 class SortFilterProxyModelBase : public CuriouslyRecurringTemplateBase<SortFilterProxyModelPhantom, Derived> {
 public:
    SortFilterProxyModelBase(bool filter) :
-      m_filter{filter} {
+      m_filter{filter},
+      m_filterQuery{},
+      m_narrowing{false},
+      m_acceptedItems{},
+      m_previouslyAcceptedItems{} {
+      return;
+   }
+
+   /**
+    * \brief Set the search text (see \c FilterQuery for its syntax) to filter the rows of the source table model by.
+    *
+    *        The text is parsed once here, rather than once per row.  If the new query is narrower than the current one
+    *        (typically because the user has typed more characters into the filter box), then only rows currently
+    *        shown need to be tested against it.
+    */
+   void setFilterQuery(QString const & text) {
+      NeTableModel * tableModel = qobject_cast<NeTableModel *>(this->derived().sourceModel());
+      if (!tableModel) {
+         // It's a coding error to call this for a proxy for a list model
+         qCritical() << Q_FUNC_INFO << "No source table model";
+         Q_ASSERT(false);
+         return;
+      }
+
+      FilterQuery newQuery{text, *tableModel, static_cast<int>(NeTableModel::ColumnIndex::Name)};
+      this->m_narrowing = newQuery.isNarrowingOf(this->m_filterQuery);
+      this->m_filterQuery = std::move(newQuery);
+      this->m_previouslyAcceptedItems.swap(this->m_acceptedItems);
+      this->m_acceptedItems.clear();
+      // This will call filterAcceptsRow for every source row
+      this->derived().invalidateFilter();
+      this->m_narrowing = false;
+      this->m_previouslyAcceptedItems.clear();
       return;
    }
 
@@ -75,22 +118,33 @@ protected:
       //
       NeTableModel * tableModel = qobject_cast<NeTableModel *>(this->derived().sourceModel());
       if (tableModel) {
-         QModelIndex index = tableModel->index(source_row, 0, source_parent);
-
          if (!this->m_filter) {
             // No filter, so we accept
             return true;
          }
-         if (!tableModel->getRow(source_row)->display()) {
+         auto row = tableModel->getRow(source_row);
+         if (!row->display()) {
             // Row not displayed, so reject
             return false;
          }
 
-         // The filterRegularExpression() member function we call here is inherited from QSortFilterProxyModel
-         QRegularExpression const filterRegExp {this->derived().filterRegularExpression()};
-         QString const dataAsString {tableModel->data(index).toString()};
-         QRegularExpressionMatch const match {filterRegExp.match(dataAsString)};
-         return match.hasMatch();
+         if (this->m_narrowing && !this->m_previouslyAcceptedItems.contains(row.get())) {
+            // Didn't match the previous query, so can't match this narrower one
+            return false;
+         }
+
+         bool const accepted = this->m_filterQuery.matches(
+            [&](int const column) {
+               return tableModel->sortKey(tableModel->index(source_row, column, source_parent));
+            }
+         );
+         // Rows get re-tested individually when they change, so we need to keep the record of what matched up-to-date
+         if (accepted) {
+            this->m_acceptedItems.insert(row.get());
+         } else {
+            this->m_acceptedItems.remove(row.get());
+         }
+         return accepted;
       }
 
       NeListModel* listModel = qobject_cast<NeListModel*>(this->derived().sourceModel());
@@ -109,21 +163,37 @@ protected:
    }
 
    bool doLessThan(QModelIndex const & left, QModelIndex const & right) const {
-      QAbstractItemModel * source = this->derived().sourceModel();
-      QVariant leftItem, rightItem;
-      if (source) {
-         leftItem = source->data(left);
-         rightItem = source->data(right);
+      NeTableModel * tableModel = qobject_cast<NeTableModel *>(this->derived().sourceModel());
+      if (tableModel) {
+         QVariant const  leftKey = tableModel->sortKey(left);
+         QVariant const rightKey = tableModel->sortKey(right);
+         // Unset values sort before everything else
+         if (!leftKey.isValid() || !rightKey.isValid()) {
+            return !leftKey.isValid() && rightKey.isValid();
+         }
+         return QVariant::compare(leftKey, rightKey) == QPartialOrdering::Less;
       }
 
-      // As per more detailed comment in tableModels/ItemDelegate.h, we need "typename" here only until Apple ship Clang
-      // 16 or later as their standard C++ compiler.
-      auto const columnIndex = static_cast<typename NeTableModel::ColumnIndex>(left.column());
-      return this->derived().isLessThan(columnIndex, leftItem, rightItem);
+      QAbstractItemModel * source = this->derived().sourceModel();
+      if (!source) {
+         return false;
+      }
+      return source->data(left).toString() < source->data(right).toString();
    }
 
 private:
    bool const m_filter;
+
+   FilterQuery m_filterQuery;
+
+   //! True only while \c setFilterQuery is re-filtering for a query that is narrower than the previous one
+   bool m_narrowing;
+
+   //! Items that matched \c m_filterQuery when last tested
+   mutable QSet<void const *> m_acceptedItems;
+
+   //! Items that matched the previous query, used only while \c m_narrowing is true
+   QSet<void const *> m_previouslyAcceptedItems;
 };
 
 
@@ -149,11 +219,6 @@ private:
       virtual bool filterAcceptsRow(int source_row, QModelIndex const & source_parent) const;   \
       /* Override QSortFilterProxyModel::lessThan                                  */           \
       virtual bool lessThan(QModelIndex const & left, QModelIndex const & right) const;         \
-   private:                                                                                     \
-      /* Called from lessThan to do the work specific to this class                */           \
-      bool isLessThan(NeName##TableModel::ColumnIndex const columnIndex,                        \
-                      QVariant const & leftItem,                                                \
-                      QVariant const & rightItem) const;                                        \
 
 /**
  * \brief Derived classes should include this in their implementation file
@@ -17,27 +17,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/StyleSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool StyleSortFilterProxyModel::isLessThan(StyleTableModel::ColumnIndex const columnIndex,
-                                           QVariant const & leftItem,
-                                           QVariant const & rightItem) const {
-    switch (columnIndex) {
-       case StyleTableModel::ColumnIndex::Name          :
-       case StyleTableModel::ColumnIndex::Type          :
-       case StyleTableModel::ColumnIndex::Category      :
-       case StyleTableModel::ColumnIndex::CategoryNumber:
-       case StyleTableModel::ColumnIndex::StyleLetter   :
-       case StyleTableModel::ColumnIndex::StyleGuide    :
-         return leftItem.toString() < rightItem.toString();
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(Style)
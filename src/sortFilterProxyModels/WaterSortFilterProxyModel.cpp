@@ -17,38 +17,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/WaterSortFilterProxyModel.h"
 
-#include <iostream>
-
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool WaterSortFilterProxyModel::isLessThan(WaterTableModel::ColumnIndex const columnIndex,
-                                           QVariant const & leftItem,
-                                           QVariant const & rightItem) const {
-   switch (columnIndex) {
-      case WaterTableModel::ColumnIndex::Name:
-         return leftItem.toString() < rightItem.toString();
-
-///      case WaterTableModel::ColumnIndex::Amount:
-///         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Volume) <
-///                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Volume);
-
-      case WaterTableModel::ColumnIndex::Calcium    :
-      case WaterTableModel::ColumnIndex::Bicarbonate:
-      case WaterTableModel::ColumnIndex::Sulfate    :
-      case WaterTableModel::ColumnIndex::Chloride   :
-      case WaterTableModel::ColumnIndex::Sodium     :
-      case WaterTableModel::ColumnIndex::Magnesium  :
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::MassFractionOrConc) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::MassFractionOrConc);
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(Water)
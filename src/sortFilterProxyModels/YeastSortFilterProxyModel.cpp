@@ -20,35 +20,5 @@
  =====================================================================================================================*/
 #include "sortFilterProxyModels/YeastSortFilterProxyModel.h"
 
-#include "measurement/Measurement.h"
-#include "measurement/PhysicalQuantity.h"
-
-bool YeastSortFilterProxyModel::isLessThan(YeastTableModel::ColumnIndex const columnIndex,
-                                           QVariant const & leftItem,
-                                           QVariant const & rightItem) const {
-   switch (columnIndex) {
-      case YeastTableModel::ColumnIndex::Name      :
-      case YeastTableModel::ColumnIndex::Laboratory:
-      case YeastTableModel::ColumnIndex::Type      :
-      case YeastTableModel::ColumnIndex::Form      :
-      case YeastTableModel::ColumnIndex::ProductId :
-      case YeastTableModel::ColumnIndex::TotalInventoryType :
-         return leftItem.toString() < rightItem.toString();
-
-      case YeastTableModel::ColumnIndex::TotalInventory:
-         // This is a lie. I need to figure out if they are weights or volumes.
-         // and then figure some reasonable way to compare weights to volumes.
-         // Maybe lying isn't such a bad idea
-         return Measurement::qStringToSI( leftItem.toString(), Measurement::PhysicalQuantity::Volume) <
-                Measurement::qStringToSI(rightItem.toString(), Measurement::PhysicalQuantity::Volume);
-
-      // No default case as we want the compiler to warn us if we missed one
-   }
-
-   // Should be unreachable
-   Q_ASSERT(false);
-   return true;
-}
-
 // Insert the boiler-plate stuff that we cannot do in SortFilterProxyModelBase
 SORT_FILTER_PROXY_MODEL_COMMON_CODE(Yeast)
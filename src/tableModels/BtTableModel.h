@@ -100,6 +100,13 @@ class BtTableModel : public QAbstractTableModel {
    template<class Derived, class NE> friend class TableModelBase;
 
 public:
+   /**
+    * \brief Custom item data role for which \c TableModelBase returns a value suitable for sorting on, rather than a
+    *        formatted string.  Eg, for an amount, it is the quantity in canonical units.  See
+    *        \c TableModelBase::sortKey.
+    */
+   static constexpr int SortRole = Qt::UserRole + 1;
+
    /**
     * \brief Extra info stored in \c ColumnInfo (see below) for enum types
     */
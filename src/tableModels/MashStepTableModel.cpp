@@ -85,7 +85,7 @@ QVariant MashStepTableModel::data(QModelIndex const & index, int role) const {
    }
 
    auto const columnIndex = static_cast<MashStepTableModel::ColumnIndex>(index.column());
-   if (MashStepTableModel::ColumnIndex::Temp == columnIndex) {
+   if (MashStepTableModel::ColumnIndex::Temp == columnIndex && role != BtTableModel::SortRole) {
       auto row = this->rows[index.row()];
       if (row->type() == MashStep::Type::Decoction) {
          return QVariant("---");
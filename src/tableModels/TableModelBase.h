@@ -17,10 +17,14 @@
 #define TABLEMODELS_TABLEMODELBASE_H
 #pragma once
 
+#include  <optional>
 #include  <type_traits>
+#include  <vector>
 
+#include <QHash>
 #include <QList>
 #include <QModelIndex>
+#include <QSet>
 
 #include "database/ObjectStoreTyped.h"
 #include "database/ObjectStoreWrapper.h"
@@ -135,7 +139,7 @@ public:
    using ColumnIndex = typename TableModelTraits<Derived>::ColumnIndex;
 
 protected:
-   TableModelBase() : rows{} {
+   TableModelBase() : rows{}, m_rowIndexes{}, m_sortKeys{} {
       return;
    }
    // Need a virtual destructor as we have a virtual member function
@@ -229,12 +233,17 @@ public:
    QList< std::shared_ptr<NE> > removeDuplicates(QList< std::shared_ptr<NE> > items,
                                                  Recipe const * recipe = nullptr) {
       decltype(items) tmp;
+      tmp.reserve(items.size());
+      // As well as the items we already have, we need to skip any that appear more than once in items
+      QSet<NE const *> seen;
+      seen.reserve(items.size());
 
       for (auto ii : items) {
          if (!recipe && (ii->deleted() || !ii->display())) {
             continue;
          }
-         if (!this->rows.contains(ii) ) {
+         if (!this->m_rowIndexes.contains(ii.get()) && !seen.contains(ii.get())) {
+            seen.insert(ii.get());
             tmp.append(ii);
          }
       }
@@ -247,12 +256,16 @@ public:
    QList< std::shared_ptr<NE> > removeDuplicatesIgnoreDisplay(QList< std::shared_ptr<NE> > items,
                                                               Recipe const * recipe = nullptr) {
       decltype(items) tmp;
+      tmp.reserve(items.size());
+      QSet<NE const *> seen;
+      seen.reserve(items.size());
 
       for (auto ii : items) {
          if (!recipe && ii->deleted() ) {
             continue;
          }
-         if (!this->rows.contains(ii) ) {
+         if (!this->m_rowIndexes.contains(ii.get()) && !seen.contains(ii.get())) {
+            seen.insert(ii.get());
             tmp.append(ii);
          }
       }
@@ -271,25 +284,55 @@ public:
     *        be the case with our rows.  (Eg in SaltTableModel, new Salts are only stored in the DB when the window is
     *        closed with OK.)
     *
-    *        Function name is for consistency with \c QList::indexOf
+    *        Function name is for consistency with \c QList::indexOf, but, unlike that function, this is a hash lookup
+    *        rather than a linear search.
     *
     * \param object  what to search for
     * \return index of object in this->rows or -1 if it's not found
     */
    int findIndexOf(NE const * object) const {
-      for (int index = 0; index < this->rows.size(); ++index) {
-         if (this->rows.at(index).get() == object) {
-            return index;
-         }
+      int const index = this->m_rowIndexes.value(object, -1);
+      // If this fails, someone has modified this->rows without calling reindexRows()
+      Q_ASSERT(index < 0 || this->rows.at(index).get() == object);
+      return index;
+   }
+
+   /**
+    * \brief Returns the value to sort on for the cell at \c index.  This is the raw value of the underlying property,
+    *        rather than the formatted string we return for \c Qt::DisplayRole, so that sort/filter proxy models do not
+    *        need to parse display strings back into numbers and units to compare them.  Specifically:
+    *          - Amounts (and other physical quantities) are returned as a \c double in canonical units
+    *          - Enums and bools are returned as their display string, so that they sort as the user sees them
+    *          - Unset optional values are returned as an invalid \c QVariant
+    *          - Everything else (names, percentages, etc) is returned as-is
+    *
+    *        Values are cached per column, and invalidated when rows change.  (As well as sorting, the cached values are
+    *        used by \c FilterQuery when filtering.)  Columns whose property path goes through another object (eg the
+    *        alpha acid of the \c Hop in a \c RecipeAdditionHop) are not cached, because that object can change without
+    *        our row emitting \c changed().
+    */
+   QVariant sortKey(QModelIndex const & index) const {
+      auto const & columnInfo = this->get_ColumnInfo(static_cast<ColumnIndex>(index.column()));
+      if (columnInfo.propertyPath.properties().size() > 1) {
+         return this->readSortKeyFromModel(index);
+      }
+
+      std::vector<std::optional<QVariant>> & columnKeys = this->m_sortKeys[index.column()];
+      if (columnKeys.size() != static_cast<std::size_t>(this->rows.size())) {
+         columnKeys.assign(this->rows.size(), std::nullopt);
+      }
+      std::optional<QVariant> & cachedKey = columnKeys[index.row()];
+      if (!cachedKey) {
+         cachedKey = this->readSortKeyFromModel(index);
       }
-      return -1;
+      return *cachedKey;
    }
 
    void add(std::shared_ptr<NE> item) {
       qDebug() << Q_FUNC_INFO << item->name();
 
       // Check to see if it's already in the list
-      if (this->rows.contains(item)) {
+      if (this->m_rowIndexes.contains(item.get())) {
          return;
       }
 
@@ -310,6 +353,8 @@ public:
       int size = this->rows.size();
       this->derived().beginInsertRows(QModelIndex(), size, size);
       this->rows.append(item);
+      this->m_rowIndexes.insert(item.get(), size);
+      this->invalidateSortKeys();
       this->derived().connect(item.get(), &NamedEntity::changed, &this->derived(), &Derived::changed);
       this->derived().added(item);
       //reset(); // Tell everybody that the table has changed.
@@ -333,11 +378,13 @@ public:
 
    //! \returns true if \c item is successfully found and removed.
    bool remove(std::shared_ptr<NE> item) {
-      int rowNum = this->rows.indexOf(item);
+      int rowNum = this->findIndexOf(item.get());
       if (rowNum >= 0)  {
          this->derived().beginRemoveRows(QModelIndex(), rowNum, rowNum);
          this->derived().disconnect(item.get(), nullptr, &this->derived(), nullptr);
          this->rows.removeAt(rowNum);
+         this->m_rowIndexes.remove(item.get());
+         this->reindexRows(rowNum);
 
          this->derived().removed(item);
 
@@ -379,8 +426,46 @@ protected:
       return nullptr;
    }
 
+   /**
+    * \brief Update \c m_rowIndexes after \c this->rows has been changed other than by the member functions of this
+    *        class (eg by \c StepTableModelBase), or after row(s) have been removed from the middle of it.
+    *
+    * \param from  Index of the first row whose position might have changed.  Entries for rows before this are assumed
+    *              to be correct.  If 0, the whole index is rebuilt (so removed rows are also dropped from it).
+    */
+   void reindexRows(int const from = 0) {
+      if (from == 0) {
+         this->m_rowIndexes.clear();
+         this->m_rowIndexes.reserve(this->rows.size());
+      }
+      for (int index = from; index < this->rows.size(); ++index) {
+         this->m_rowIndexes.insert(this->rows.at(index).get(), index);
+      }
+      this->invalidateSortKeys();
+      return;
+   }
+
+   /**
+    * \brief Discard cached sort keys (see \c sortKey) for all rows, or just for the specified row
+    */
+   void invalidateSortKeys(std::optional<int> const rowNum = std::nullopt) const {
+      if (!rowNum) {
+         this->m_sortKeys.clear();
+         return;
+      }
+      for (auto & columnKeys : this->m_sortKeys) {
+         if (*rowNum >= 0 && static_cast<std::size_t>(*rowNum) < columnKeys.size()) {
+            columnKeys[*rowNum].reset();
+         }
+      }
+      return;
+   }
+
    /**
     * \brief Watch all the \c NE for changes.
+    *
+    *        All the new rows are inserted in one go, with a single \c beginInsertRows() / \c endInsertRows() pair, so
+    *        that adding N items to M existing rows is O(N + M) rather than O(N·M).
     */
    void addItems(QList< std::shared_ptr<NE> > items) {
       qDebug() <<
@@ -396,6 +481,7 @@ protected:
          this->derived().beginInsertRows(QModelIndex(), size, size + tmp.size() - 1);
 
          this->rows.append(tmp);
+         this->reindexRows(size);
 
          for (auto item : tmp) {
             this->derived().connect(item.get(), &NamedEntity::changed, &this->derived(), &Derived::changed);
@@ -419,6 +505,8 @@ protected:
             this->derived().disconnect(item.get(), nullptr, &this->derived(), nullptr);
             //this->derived().removed(item); // Shouldn't be necessary as we call updateTotals() below
          }
+         this->m_rowIndexes.clear();
+         this->invalidateSortKeys();
          this->derived().endRemoveRows();
          this->derived().updateTotals();
       }
@@ -468,7 +556,7 @@ protected:
          return false;
       }
 
-      if (role != Qt::DisplayRole && role != Qt::EditRole) {
+      if (role != Qt::DisplayRole && role != Qt::EditRole && role != BtTableModel::SortRole) {
          // No need to log anything here, as it's perfectly normal to get called with other roles
          return false;
       }
@@ -497,6 +585,10 @@ protected:
       //    HopItemDelegate::setEditorData()
       //    QAbstractItemView::edit()
       //
+      if (role == BtTableModel::SortRole) {
+         return this->sortKey(index);
+      }
+
       auto row = this->rows[index.row()];
       auto const columnIndex = static_cast<ColumnIndex>(index.column());
       auto const & columnInfo = this->get_ColumnInfo(columnIndex);
@@ -689,6 +781,58 @@ protected:
       return modelData;
    }
 
+   /**
+    * \brief Does the work for \c sortKey, without caching
+    */
+   QVariant readSortKeyFromModel(QModelIndex const & index) const {
+      auto row = this->rows[index.row()];
+      auto const & columnInfo = this->get_ColumnInfo(static_cast<ColumnIndex>(index.column()));
+      TypeInfo const & typeInfo = columnInfo.typeInfo;
+
+      QVariant modelData = columnInfo.propertyPath.getValue(*row);
+      if (typeInfo.isOptional()) {
+         bool hasValue = false;
+         Optional::removeOptionalWrapper(modelData, typeInfo, &hasValue);
+         if (!hasValue) {
+            return QVariant{};
+         }
+      }
+
+      if (std::holds_alternative<NonPhysicalQuantity>(*typeInfo.fieldType)) {
+         auto const nonPhysicalQuantity = std::get<NonPhysicalQuantity>(*typeInfo.fieldType);
+         if (nonPhysicalQuantity == NonPhysicalQuantity::Enum) {
+            Q_ASSERT(columnInfo.extras);
+            Q_ASSERT(std::holds_alternative<BtTableModel::EnumInfo>(*columnInfo.extras));
+            BtTableModel::EnumInfo const & enumInfo = std::get<BtTableModel::EnumInfo>(*columnInfo.extras);
+            return enumInfo.displayNames.enumAsIntToString(modelData.toInt()).value_or(QString{});
+         }
+         if (nonPhysicalQuantity == NonPhysicalQuantity::Bool) {
+            Q_ASSERT(columnInfo.extras);
+            Q_ASSERT(std::holds_alternative<BtTableModel::BoolInfo>(*columnInfo.extras));
+            BtTableModel::BoolInfo const & info = std::get<BtTableModel::BoolInfo>(*columnInfo.extras);
+            return modelData.toBool() ? info.setDisplay : info.unsetDisplay;
+         }
+         return modelData;
+      }
+
+      // As in readDataFromModel, a double holding a physical quantity is already in canonical units
+      if (typeInfo.typeIndex == typeid(double)) {
+         return modelData.toDouble();
+      }
+
+      Measurement::Amount const amount = modelData.value<Measurement::Amount>();
+      if (!amount.isValid()) {
+         // readDataFromModel will already have complained about this
+         return QVariant{};
+      }
+      if (columnInfo.extras &&
+          std::holds_alternative<Measurement::ChoiceOfPhysicalQuantity>(*columnInfo.extras)) {
+         // This is the drop-down for the PhysicalQuantity of the Amount, so we sort as it is displayed
+         return Measurement::physicalQuantityDisplayNames.enumToString(amount.unit->getPhysicalQuantity());
+      }
+      return amount.unit->toCanonical(amount.quantity).quantity;
+   }
+
    /**
     * \brief Child classes should call this from their \c setData() member function (overriding
     *        \c QAbstractTableModel::setData()) to write data for any column that does not require special handling
@@ -851,6 +995,7 @@ protected:
             if (InventoryTools::hasInventory<NE>(*ingredient)) {
                std::shared_ptr<typename NE::InventoryClass> inventory = InventoryTools::getInventory(*ingredient);
                if (inventory->key() == invKey) {
+                  this->invalidateSortKeys(ii);
                   emit this->derived().dataChanged(
                      this->derived().createIndex(ii, static_cast<int>(Derived::ColumnIndex::TotalInventory)),
                      this->derived().createIndex(ii, static_cast<int>(Derived::ColumnIndex::TotalInventory))
@@ -918,6 +1063,7 @@ protected:
             return;
          }
 
+         this->invalidateSortKeys(ii);
          this->derived().updateTotals();
          emit this->derived().dataChanged(this->derived().createIndex(ii, 0),
                                      this->derived().createIndex(ii, this->derived().columnCount() - 1));
@@ -937,6 +1083,18 @@ protected:
    //================================================ Member Variables =================================================
 
    QList< std::shared_ptr<NE> > rows;
+
+   /**
+    * \brief Index in \c rows of each object we hold, so we don't have to search \c rows to find one.  Any code that
+    *        modifies \c rows directly needs to call \c reindexRows() afterwards.
+    */
+   QHash<NE const *, int> m_rowIndexes;
+
+   /**
+    * \brief Cached results of \c sortKey, indexed by column and then by row.  Unset entries have not yet been
+    *        calculated, or have changed.
+    */
+   mutable QHash<int, std::vector<std::optional<QVariant>>> m_sortKeys;
 };
 
 /**
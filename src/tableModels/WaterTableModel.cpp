@@ -225,6 +225,10 @@ QVariant WaterTableModel::data(const QModelIndex & index, int role) const {
       return QVariant();
    }
 
+   if (role == BtTableModel::SortRole) {
+      return this->sortKey(index);
+   }
+
    auto row = this->rows[index.row()];
 
    auto const columnIndex = static_cast<WaterTableModel::ColumnIndex>(index.column());
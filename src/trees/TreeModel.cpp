@@ -19,9 +19,12 @@
  =====================================================================================================================*/
 #include "trees/TreeModel.h"
 
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QList>
 #include <QMessageBox>
 #include <QMimeData>
@@ -50,6 +53,13 @@
 #include "PersistentSettings.h"
 
 namespace {
+   /**
+    * \brief Same as \c Recipe::hasAncestors, but without loading the ancestors
+    */
+   bool hasAncestors(Recipe const & recipe) {
+      return recipe.getAncestorId() > 0 && recipe.getAncestorId() != recipe.key();
+   }
+
    NamedEntity * getElement(TreeNode::Type oType, int id) {
       switch (oType) {
          // .:TODO:. For now we just pull the raw pointer out of the shared pointer, but the rest of this code needs refactoring
@@ -374,6 +384,7 @@ bool TreeModel::insertRow(int row,
       type = (victimType ? *victimType : type);
       TreeNode * added = pItem->child(row);
       added->setData(type, victim);
+      this->indexNode(added);
    }
    endInsertRows();
 
@@ -384,47 +395,124 @@ bool TreeModel::removeRows(int row, int count, const QModelIndex & parent) {
    TreeNode * pItem = item(parent);
 
    this->beginRemoveRows(parent, row, row + count - 1);
+   for (int ii = row; ii < row + count && ii < pItem->childCount(); ++ii) {
+      this->unindexSubtree(pItem->child(ii));
+   }
    bool success = pItem->removeChildren(row, count);
    this->endRemoveRows();
 
    return success;
 }
 
+void TreeModel::indexNode(TreeNode * node) {
+   if (node->type() == TreeNode::Type::Folder) {
+      Folder * folder = node->getData<Folder>();
+      if (folder) {
+         this->m_folderNodesByPath.insert(folder->fullPath(), node);
+      }
+      return;
+   }
+
+   NamedEntity * thing = node->thing();
+   if (thing) {
+      this->m_nodesByThing.insert(thing, node);
+   }
+   return;
+}
+
+void TreeModel::unindexSubtree(TreeNode * node) {
+   for (int ii = 0; ii < node->childCount(); ++ii) {
+      this->unindexSubtree(node->child(ii));
+   }
+
+   if (node->type() == TreeNode::Type::Folder) {
+      Folder * folder = node->getData<Folder>();
+      // Only remove the entry if it's for this node -- in case there are two folders with the same path
+      if (folder && this->m_folderNodesByPath.value(folder->fullPath(), nullptr) == node) {
+         this->m_folderNodesByPath.remove(folder->fullPath());
+      }
+      return;
+   }
+
+   NamedEntity * thing = node->thing();
+   if (thing) {
+      this->m_nodesByThing.remove(thing, node);
+   }
+   return;
+}
+
+void TreeModel::clearIndexes() {
+   this->m_nodesByThing.clear();
+   this->m_folderNodesByPath.clear();
+   return;
+}
+
 // One find method for all things. This .. is nice
 QModelIndex TreeModel::findElement(NamedEntity * thing, TreeNode * parent) {
    TreeNode * pItem = parent ? parent : this->rootItem->child(0);
 
-
    if (! thing) {
       return createIndex(0, 0, pItem);
    }
 
-   if (pItem) {
-      qDebug() << Q_FUNC_INFO << "Find" << *thing << "in" << pItem->name();
-   }
-
-   QList<TreeNode *> folders;
-   folders.append(pItem);
-
-   // Recursion. Wonderful.
-   while (! folders.isEmpty()) {
-      TreeNode * target = folders.takeFirst();
-      for (int i = 0; i < target->childCount(); ++i) {
-         // If we've found what we are looking for, return
-         if (target->child(i)->thing() == thing) {
-            qDebug() << Q_FUNC_INFO << "Found at" << i;
-            return createIndex(i, 0, target->child(i));
+   //
+   // We used to do a breadth-first search down from pItem, looking inside folders (and, if looking for a brewnote,
+   // inside recipes).  Now we look up the nodes holding thing directly, and then check which of them that search would
+   // have found, by walking up from each of them to pItem.  Normally there is only one such node, and the walk up is
+   // only a few levels, so this is much quicker for big trees.
+   //
+   BrewNote * brewNote = qobject_cast<BrewNote *>(thing);
+   bool const isBrewNote = brewNote != nullptr;
+   if (isBrewNote) {
+      // A BrewNote won't be in the tree if its Recipe hasn't been expanded yet, so make sure that's done.  (We don't
+      // try to do the same for the Recipe's descendants, which would mean searching for them.)
+      Recipe * recipe = ObjectStoreWrapper::getByIdRaw<Recipe>(brewNote->recipeId());
+      for (TreeNode * recipeNode : this->m_nodesByThing.values(recipe)) {
+         if (!recipeNode->childrenFetched()) {
+            this->fetchMore(createIndex(recipeNode->childNumber(), 0, recipeNode));
          }
-
-         // If we have a folder, or we are looking for a brewnote and have a
-         // recipe in hand, push the child onto the stack
-         if (target->child(i)->type() == TreeNode::Type::Folder ||
-             (qobject_cast<BrewNote *>(thing) && target->child(i)->type() == TreeNode::Type::Recipe)) {
-            folders.append(target->child(i));
+      }
+   }
+   //
+   // If there is more than one candidate, the search would have found the shallowest one and, amongst those at the same
+   // depth, the one that comes first in the tree.  The latter is the one with the lexicographically smallest list of
+   // rows on the way down from pItem.  (We can't rely on the order of m_nodesByThing, as it's a hash.)
+   //
+   TreeNode * found = nullptr;
+   std::vector<int> foundRows;
+   std::vector<int> rows;
+   for (auto [node, end] = this->m_nodesByThing.equal_range(thing); node != end; ++node) {
+      rows.clear();
+      rows.push_back((*node)->childNumber());
+      TreeNode * ancestor = (*node)->parent();
+      while (ancestor && ancestor != pItem) {
+         if (ancestor->type() != TreeNode::Type::Folder &&
+             !(isBrewNote && ancestor->type() == TreeNode::Type::Recipe)) {
+            // The search wouldn't have looked inside this node
+            break;
          }
+         rows.push_back(ancestor->childNumber());
+         ancestor = ancestor->parent();
+      }
+      if (ancestor != pItem) {
+         continue;
+      }
+      std::reverse(rows.begin(), rows.end());
+      if (!found ||
+          rows.size() < foundRows.size() ||
+          (rows.size() == foundRows.size() && rows < foundRows)) {
+         found = *node;
+         std::swap(foundRows, rows);
       }
    }
-   return QModelIndex();
+
+   if (!found) {
+      return QModelIndex();
+   }
+
+   int const row = found->childNumber();
+   qDebug() << Q_FUNC_INFO << "Found" << *thing << "at" << row;
+   return createIndex(row, 0, found);
 }
 
 QList<NamedEntity *> TreeModel::elements() {
@@ -472,7 +560,183 @@ QList<NamedEntity *> TreeModel::elements() {
    return elements;
 }
 
+void TreeModel::reloadTreeModel(TreeModel::LoadMethod const method) {
+   if (method == TreeModel::LoadMethod::Bulk) {
+      // The bulk loader clears out the old tree itself, as part of its model reset
+      this->loadTreeModel();
+      return;
+   }
+
+   this->beginResetModel();
+   TreeNode * top = this->rootItem->child(0);
+   top->removeChildren(0, top->childCount());
+   this->clearIndexes();
+   this->endResetModel();
+   this->loadTreeModelIncrementally();
+   return;
+}
+
+TreeNode * TreeModel::bulkFolderNode(QString const & folder, TreeNode * top) {
+   // This needs to give the same results as findFolder(folder, top, true) -- including the full paths it gives to the
+   // new Folder objects -- but without walking the tree each time.
+   QStringList const dirs = folder.simplified().split("/", Qt::SkipEmptyParts);
+   TreeNode * parentNode = top;
+   QString fullPath;
+   for (QString const & dir : dirs) {
+      fullPath = fullPath % "/" % dir;
+      TreeNode * folderNode = this->m_folderNodesByPath.value(fullPath, nullptr);
+      if (!folderNode) {
+         Folder * newFolder = new Folder();
+         newFolder->setfullPath(fullPath);
+         int const row = parentNode->childCount();
+         parentNode->insertChildren(row, 1, TreeNode::Type::Folder);
+         folderNode = parentNode->child(row);
+         folderNode->setData(TreeNode::Type::Folder, newFolder);
+         this->indexNode(folderNode);
+      }
+      parentNode = folderNode;
+   }
+   return parentNode;
+}
+
+void TreeModel::appendBrewNoteNodes(TreeNode * recipeNode, QList<BrewNote *> const & brewNotes) {
+   for (BrewNote * note : brewNotes) {
+      int const row = recipeNode->childCount();
+      recipeNode->insertChildren(row, 1, TreeNode::Type::BrewNote);
+      recipeNode->child(row)->setData(TreeNode::Type::BrewNote, note);
+      this->indexNode(recipeNode->child(row));
+      this->observeElement(note);
+   }
+   return;
+}
+
 void TreeModel::loadTreeModel() {
+   QList<NamedEntity *> elems = this->elements();
+   qDebug() << Q_FUNC_INFO << "Got " << elems.length() << "elements matching type mask" << this->m_treeMask;
+
+   bool const isRecipeTree = this->m_treeMask.testFlag(TreeModel::TypeMask::Recipe);
+
+   // Read this once up-front, rather than once per element
+   bool const showSnapshots =
+      isRecipeTree && PersistentSettings::value(PersistentSettings::Names::showsnapshots, false).toBool();
+
+   //
+   // Now build the tree.  We're going to tell the views to throw away everything they know about the model, so there
+   // is no need to tell them about individual rows as we add them.
+   //
+   this->beginResetModel();
+
+   TreeNode * top = this->rootItem->child(0);
+   top->removeChildren(0, top->childCount());
+   this->clearIndexes();
+
+   for (NamedEntity * elem : elems) {
+      TreeNode * parentNode = top;
+      auto folder = FolderUtils::getFolder(elem);
+      if (folder && !folder->isEmpty()) {
+         parentNode = this->bulkFolderNode(*folder, top);
+      }
+
+      int const row = parentNode->childCount();
+      parentNode->insertChildren(row, 1, this->nodeType);
+      TreeNode * node = parentNode->child(row);
+      node->setData(this->nodeType, elem);
+      this->indexNode(node);
+
+      // A Recipe's brewnotes and ancestors are not added until the node is expanded -- see fetchMore()
+      if (isRecipeTree) {
+         node->setChildrenFetched(false);
+         if (showSnapshots && hasAncestors(*qobject_cast<Recipe *>(elem))) {
+            // .:TBD:. This matches the setShowChild() call in loadTreeModelIncrementally(), which, because of the way
+            //         the index it uses is constructed, sets the flag on the parent node rather than on the Recipe.
+            parentNode->setShowMe(true);
+         }
+      }
+      this->observeElement(elem);
+   }
+
+   this->endResetModel();
+   return;
+}
+
+bool TreeModel::hasChildren(QModelIndex const & parent) const {
+   TreeNode * node = this->item(parent);
+   if (node->childrenFetched()) {
+      return node->childCount() > 0;
+   }
+
+   // We don't want to load everything just to say whether there is anything to load.  Strictly, a recipe with ancestors
+   // might not have any brewnotes to show, but it's good enough to say it has children.
+   Recipe const * recipe = node->getData<Recipe>();
+   return recipe && (
+      hasAncestors(*recipe) ||
+      ObjectStoreWrapper::findFirstByIndex<BrewNote>(PropertyNames::OwnedByRecipe::recipeId, recipe->key())
+   );
+}
+
+bool TreeModel::canFetchMore(QModelIndex const & parent) const {
+   return parent.isValid() && !this->item(parent)->childrenFetched();
+}
+
+void TreeModel::fetchMore(QModelIndex const & parent) {
+   if (!this->canFetchMore(parent)) {
+      return;
+   }
+
+   TreeNode * node = this->item(parent);
+   // Mark the node as fetched up-front, in case anything below causes us to be called again for the same node
+   node->setChildrenFetched(true);
+
+   Recipe * recipe = node->getData<Recipe>();
+   if (!recipe) {
+      // Only Recipe nodes are loaded lazily, so this would be a coding error
+      qCritical() << Q_FUNC_INFO << "Unexpected node type" << node->type();
+      return;
+   }
+
+   //
+   // This gives the same children, in the same order, as addBrewNoteSubTree() and addAncestoralTree() do when called
+   // from loadTreeModelIncrementally().  Ancestor nodes have only their own brewnotes, and are themselves fetched
+   // lazily.
+   //
+   QList<BrewNote *> brewNotes;
+   QList<Recipe *> ancestorsToShow;
+   bool const isAncestorNode = node->parent() && node->parent()->type() == TreeNode::Type::Recipe;
+   if (isAncestorNode) {
+      brewNotes = recipe->brewNotes();
+   } else if (PersistentSettings::value(PersistentSettings::Names::showsnapshots, false).toBool() &&
+              recipe->hasAncestors()) {
+      brewNotes = recipe->brewNotes();
+      ancestorsToShow = recipe->ancestors();
+   } else {
+      brewNotes = RecipeHelper::brewNotesForRecipeAndAncestors(*recipe);
+   }
+
+   int const numChildren = brewNotes.size() + ancestorsToShow.size();
+   qDebug() <<
+      Q_FUNC_INFO << "Adding" << brewNotes.size() << "brewnotes and" << ancestorsToShow.size() << "ancestors to" <<
+      *recipe;
+   if (numChildren == 0) {
+      return;
+   }
+
+   this->beginInsertRows(parent, node->childCount(), node->childCount() + numChildren - 1);
+   this->appendBrewNoteNodes(node, brewNotes);
+   for (Recipe * ancestor : ancestorsToShow) {
+      int const ancestorRow = node->childCount();
+      node->insertChildren(ancestorRow, 1, TreeNode::Type::Recipe);
+      TreeNode * ancestorNode = node->child(ancestorRow);
+      ancestorNode->setData(TreeNode::Type::Recipe, ancestor);
+      ancestorNode->setShowMe(true);
+      ancestorNode->setChildrenFetched(false);
+      this->indexNode(ancestorNode);
+      this->observeElement(ancestor);
+   }
+   this->endInsertRows();
+   return;
+}
+
+void TreeModel::loadTreeModelIncrementally() {
    int i;
 
    QModelIndex ndxLocal;
@@ -489,7 +753,7 @@ void TreeModel::loadTreeModel() {
          ndxLocal = findFolder(*folder, rootItem->child(0), true);
          // I cannot imagine this failing, but what the hell
          if (! ndxLocal.isValid()) {
-            qWarning() << Q_FUNC_INFO << "Invalid return from findFolder in loadTreeModel()";
+            qWarning() << Q_FUNC_INFO << "Invalid return from findFolder in loadTreeModelIncrementally()";
             continue;
          }
          local = item(ndxLocal);
@@ -501,7 +765,7 @@ void TreeModel::loadTreeModel() {
       }
 
       if (!this->insertRow(i, ndxLocal, elem, this->nodeType)) {
-         qWarning() << Q_FUNC_INFO << "Insert failed in loadTreeModel()";
+         qWarning() << Q_FUNC_INFO << "Insert failed in loadTreeModelIncrementally()";
          continue;
       }
 
@@ -998,6 +1262,7 @@ QModelIndex TreeModel::createFolderTree(QStringList dirs, TreeNode * parent, QSt
 
       pItem->insertChildren(i, 1, TreeNode::Type::Folder);
       pItem->child(i)->setData(TreeNode::Type::Folder, temp);
+      this->indexNode(pItem->child(i));
 
       // Set the parent item to point to the newly created tree
       pItem = pItem->child(i);
@@ -1040,6 +1305,37 @@ QModelIndex TreeModel::findFolder(QString name, TreeNode * parent, bool create)
       return QModelIndex();
    }
 
+   //
+   // All folders are indexed by full path (eg "/foo/bar"), so, when we're looking from the top of the tree (which is
+   // nearly always), we don't need to walk the tree.
+   //
+   if (pItem == this->rootItem->child(0)) {
+      QStringList pathsOnTheWay;
+      for (QString const & dir : dirs) {
+         pathsOnTheWay.append(QString{(pathsOnTheWay.isEmpty() ? QString{} : pathsOnTheWay.last()) % "/" % dir});
+      }
+      TreeNode * folderNode = this->m_folderNodesByPath.value(pathsOnTheWay.last(), nullptr);
+      if (folderNode) {
+         return createIndex(folderNode->childNumber(), 0, folderNode);
+      }
+      if (!create) {
+         return QModelIndex();
+      }
+      // Find the deepest folder on the path that already exists, and create the rest of the path below it
+      int numExisting = pathsOnTheWay.size() - 1;
+      TreeNode * deepestExisting = pItem;
+      for (; numExisting > 0; --numExisting) {
+         deepestExisting = this->m_folderNodesByPath.value(pathsOnTheWay.at(numExisting - 1), nullptr);
+         if (deepestExisting) {
+            break;
+         }
+      }
+      if (numExisting == 0) {
+         return createFolderTree(dirs, pItem, "/");
+      }
+      return createFolderTree(dirs.mid(numExisting), deepestExisting, pathsOnTheWay.at(numExisting - 1));
+   }
+
    current = dirs.takeFirst();
    fullPath = "/";
    targetPath = fullPath % current;
@@ -1166,6 +1462,12 @@ void TreeModel::elementAdded(NamedEntity * victim) {
       return;
    }
 
+   if (!this->item(pIdx)->childrenFetched()) {
+      // New brewnote on a Recipe that hasn't been expanded yet.  It will get added, along with the Recipe's other
+      // brewnotes, if and when the Recipe is expanded.
+      return;
+   }
+
    int breadth = rowCount(pIdx);
    if (!insertRow(breadth, pIdx, victim, lType)) {
       return;
@@ -1280,11 +1582,13 @@ void TreeModel::observeElement(NamedEntity * d) {
       return;
    }
 
+   // We use Qt::UniqueConnection so that it's harmless to observe the same element twice -- eg if the tree is
+   // reloaded.
    if (qobject_cast<BrewNote *>(d)) {
-      connect(qobject_cast<BrewNote *>(d), &BrewNote::brewDateChanged, this, &TreeModel::elementChanged);
+      connect(qobject_cast<BrewNote *>(d), &BrewNote::brewDateChanged, this, &TreeModel::elementChanged, Qt::UniqueConnection);
    } else {
-      connect(d, &NamedEntity::changedName,   this, &TreeModel::elementChanged);
-      connect(d, &NamedEntity::changedFolder, this, static_cast<void (TreeModel::*)(QString)>(&TreeModel::folderChanged));
+      connect(d, &NamedEntity::changedName,   this, &TreeModel::elementChanged, Qt::UniqueConnection);
+      connect(d, &NamedEntity::changedFolder, this, static_cast<void (TreeModel::*)(QString)>(&TreeModel::folderChanged), Qt::UniqueConnection);
    }
 }
 
@@ -1561,6 +1865,8 @@ void TreeModel::showAncestors(QModelIndex ndx) {
    QList<Recipe *> ancestors = descendant->ancestors();
 
    removeRows(0, node->childCount(), ndx);
+   // We're about to add all the children, so there's nothing left for fetchMore() to do
+   node->setChildrenFetched(true);
 
    // add the brewnotes for this version back
    addBrewNoteSubTree(descendant, ndx.row(), node->parent(), false);
@@ -1596,6 +1902,7 @@ void TreeModel::hideAncestors(QModelIndex ndx) {
 
    // remove all the currently shown children
    removeRows(0, node->childCount(), ndx);
+   node->setChildrenFetched(true);
    auto descendant = this->getItem<Recipe>(ndx);
 
    // put the brewnotes back, including those from the ancestors.
@@ -25,7 +25,9 @@
 
 #include <QAbstractItemModel>
 #include <QFlags> // For Q_DECLARE_FLAGS
+#include <QHash>
 #include <QList>
+#include <QMultiHash>
 #include <QMetaProperty>
 #include <QModelIndex>
 #include <QObject>
@@ -35,6 +37,7 @@
 #include "trees/TreeNode.h"
 
 // Forward declarations
+class BrewNote;
 class BtStringConst;
 class NamedEntity;
 class Recipe;
@@ -88,6 +91,19 @@ public:
    //! \brief Reimplemented from QAbstractItemModel
    virtual QModelIndex parent(const QModelIndex & index) const;
 
+   /**
+    * \brief Reimplemented from QAbstractItemModel.
+    *
+    *        In a recipe tree, the brewnotes and ancestors (ie previous versions) of each recipe are not added to the
+    *        tree until the recipe is expanded.  This saves a lot of time (and memory) building the tree for people with
+    *        lots of recipes and long version histories.  These three functions are what make that work.
+    */
+   virtual bool hasChildren(QModelIndex const & parent = QModelIndex()) const;
+   //! \brief Reimplemented from QAbstractItemModel.  See \c hasChildren.
+   virtual bool canFetchMore(QModelIndex const & parent) const;
+   //! \brief Reimplemented from QAbstractItemModel.  See \c hasChildren.
+   virtual void fetchMore(QModelIndex const & parent);
+
    //! \brief Reimplemented from QAbstractItemModel
    bool insertRow(int row,
                   QModelIndex const & parent = QModelIndex(),
@@ -134,7 +150,12 @@ public:
    //! \brief Get NamedEntity at \c index.
    NamedEntity * thing(const QModelIndex & index) const;
 
-   //! \brief one find method to find them all, and in darkness bind them
+   /**
+    * \brief one find method to find them all, and in darkness bind them
+    *
+    *        NB: Because \c Recipe nodes are populated lazily, looking for a \c BrewNote will, if necessary, fetch the
+    *            children of its \c Recipe's node(s) -- ie rows can get inserted under them as a side effect.
+    */
    QModelIndex findElement(NamedEntity * thing, TreeNode * parent = nullptr);
 
    //! \brief Get index of \c Folder
@@ -167,6 +188,23 @@ public:
    //! \b spawns a recipe
    void spawnRecipe(QModelIndex ndx);
 
+   /**
+    * \brief Ways of loading the tree from the object store
+    */
+   enum class LoadMethod {
+      //! Build the whole tree off-model and publish it with a single model reset.  This is what we normally use.
+      Bulk,
+      //! Add each element with its own \c insertRow call, finding its folder by walking the tree.  This is a lot slower
+      //  for big trees, and is kept mainly so we can compare the two.
+      Incremental,
+   };
+
+   /**
+    * \brief Throw away the current tree and load it again from the object store.  (NB: The constructor does the
+    *        initial load, so this is not normally needed.)
+    */
+   void reloadTreeModel(LoadMethod const method = LoadMethod::Bulk);
+
 public slots:
    void versionedRecipe(Recipe * ancestor, Recipe * descendant);
    void catchAncestors(bool showem);
@@ -208,9 +246,30 @@ signals:
    void recipeSpawn(Recipe * descendant);
 
 private:
-   //! \brief Loads the tree.
+   /**
+    * \brief Loads the tree in bulk (see \c LoadMethod::Bulk)
+    *
+    *        The \c TreeNode hierarchy is built, grouping elements by folder path, without emitting any per-row signals.
+    *        Once the children of all recipe nodes have been fetched (see \c fetchMore), the resulting tree is the same
+    *        as that built by \c loadTreeModelIncrementally.
+    */
    void loadTreeModel();
 
+   //! \brief Loads the tree one element at a time (see \c LoadMethod::Incremental)
+   void loadTreeModelIncrementally();
+
+   /**
+    * \brief Used by \c loadTreeModel to find or create the node for \c folder, without walking the tree or emitting
+    *        any signals
+    *
+    * \param folder
+    * \param top the node under which the folder tree hangs
+    */
+   TreeNode * bulkFolderNode(QString const & folder, TreeNode * top);
+
+   //! \brief Used by \c loadTreeModel to add BrewNotes as the last children of \c recipeNode
+   void appendBrewNoteNodes(TreeNode * recipeNode, QList<BrewNote *> const & brewNotes);
+
    //! \brief add and remove an element from the, respectively. All of the
    //slots actually call these two methods
    void elementAdded(NamedEntity * victim);
@@ -239,7 +298,26 @@ private:
    void setShowChild(QModelIndex child, bool val);
    void addAncestoralTree(Recipe * rec, int i, TreeNode * parent);
 
+   /**
+    * \brief Add \c node to \c m_nodesByThing or \c m_folderNodesByPath as appropriate.  Needs to be called whenever we
+    *        add a node to the tree (after its data is set).
+    */
+   void indexNode(TreeNode * node);
+
+   /**
+    * \brief Remove \c node and everything below it from \c m_nodesByThing and \c m_folderNodesByPath.  Needs to be
+    *        called whenever we remove a node from the tree (before it is deleted).
+    */
+   void unindexSubtree(TreeNode * node);
+
+   void clearIndexes();
+
    TreeNode * rootItem;
+   //! Nodes by the element they hold, so that \c findElement doesn't have to search the tree.  NB: The same element
+   //  can be in the tree more than once (eg a Recipe that is both shown in its own right and as an ancestor of another).
+   QMultiHash<NamedEntity const *, TreeNode *> m_nodesByThing;
+   //! Folder nodes by full path (eg "/foo/bar"), so that \c findFolder doesn't have to search the tree
+   QHash<QString, TreeNode *> m_folderNodesByPath;
    TreeView * parentTree;
    TypeMasks m_treeMask;
    TreeNode::Type nodeType;
@@ -297,7 +297,8 @@ TreeNode::TreeNode(TreeNode::Type nodeType, TreeNode * parent) :
    parentItem{parent},
    nodeType{nodeType},
    m_thing{nullptr},
-   m_showMe{false} {
+   m_showMe{false},
+   m_childrenFetched{true} {
    return;
 }
 
@@ -708,6 +709,14 @@ void TreeNode::setShowMe(bool val) {
    m_showMe = val;
 }
 
+void TreeNode::setChildrenFetched(bool val) {
+   m_childrenFetched = val;
+}
+
+bool TreeNode::childrenFetched() const {
+   return m_childrenFetched;
+}
+
 template<class S>
 S & operator<<(S & stream, TreeNode::Type const treeItemType) {
    std::optional<QString> itemTypeAsString = itemTypeToName.enumToString(treeItemType);
@@ -500,6 +500,14 @@ public:
    //! \brief does the node want to be shown regardless of display()
    bool showMe() const;
 
+   /**
+    * \brief Set to \c false for a node whose children have not yet been added to the tree.  (See
+    *        \c TreeModel::canFetchMore and \c TreeModel::fetchMore.)
+    */
+   void setChildrenFetched(bool val);
+   //! \brief \c false if the children of this node are still to be added to the tree
+   bool childrenFetched() const;
+
 private:
    /*!  Keep a pointer to the parent tree item. */
    TreeNode * parentItem;
@@ -513,6 +521,7 @@ private:
    QObject * m_thing;
    //! \b overrides the display()
    bool m_showMe;
+   bool m_childrenFetched;
 
    /*! helper functions to get the information from the item */
    QVariant dataRecipe(int column);
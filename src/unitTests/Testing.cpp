@@ -21,37 +21,50 @@
  =====================================================================================================================*/
 #include "unitTests/Testing.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <exception>
 #include <filesystem>
+#include <functional>
 #include <iostream>
 #include <iostream> // For std::cout
 #include <math.h>
 #include <sstream>
 #include <thread>
+#include <utility>
 
 #include <boost/json/src.hpp> // Needs to be included exactly once in the code to use header-only version of Boost.JSON
 
 #include <xercesc/util/PlatformUtils.hpp>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QString>
+#include <QThread>
 #include <QtTest/QtTest>
 #include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSignalBlocker>
+#include <QSqlQuery>
+#include <QTableView>
 #include <QVector>
 
 #include "Application.h"
 #include "Logging.h"
 #include "Algorithms.h"
 #include "config.h"
+#include "database/Database.h"
+#include "database/ObjectStoreTyped.h"
 #include "database/ObjectStoreWrapper.h"
 #include "Localization.h"
 #include "Logging.h"
+#include "measurement/IbuMethods.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
 #include "measurement/UnitSystem.h"
 #include "model/Boil.h"
+#include "model/BrewNote.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
 #include "model/Hop.h"
@@ -61,7 +74,15 @@
 #include "model/Recipe.h"
 #include "model/RecipeAdditionFermentable.h"
 #include "model/RecipeAdditionHop.h"
+#include "model/RecipeAdditionYeast.h"
+#include "model/RecipeCalc.h"
+#include "model/Yeast.h"
 #include "PersistentSettings.h"
+#include "serialization/ImportExport.h"
+#include "serialization/xml/BeerXml.h"
+#include "sortFilterProxyModels/FilterQuery.h"
+#include "tableModels/HopTableModel.h"
+#include "trees/TreeModel.h"
 #include "utils/ErrorCodeToStream.h"
 #include "utils/FileSystemHelpers.h"
 
@@ -285,6 +306,183 @@ namespace {
       return hop;
    }
 
+   /**
+    * \brief Some tests can also report how long things take, but they need a lot more data for the timings to mean
+    *        anything, which makes them too slow for a normal test run.  So we only do this if the environment variable
+    *        BREWKEN_UNIT_TEST_BENCHMARKS (or its equivalent for the application name) is set.
+    */
+   bool runBenchmarks() {
+      static bool const benchmarking = qEnvironmentVariableIsSet(
+         QString{"%1_UNIT_TEST_BENCHMARKS"}.arg(CONFIG_APPLICATION_NAME_UC).toUpper().toLocal8Bit().constData()
+      );
+      return benchmarking;
+   }
+
+   /**
+    * \brief Test fixture of Recipes, and optionally BrewNotes for them, stored in the ObjectStore.  They are all
+    *        hard-deleted again when the fixture goes out of scope, including when a test bails out on a failed check.
+    */
+   class StoredRecipes {
+   public:
+      /**
+       * \param namePrefix Recipe \c ii is called "namePrefix ii"
+       * \param numRecipes
+       * \param numBrewNotesPerRecipe
+       * \param setUp If supplied, called for each Recipe, with its index, before it is stored
+       */
+      StoredRecipes(QString const & namePrefix,
+                    int const numRecipes,
+                    int const numBrewNotesPerRecipe = 0,
+                    std::function<void(Recipe & recipe, int const index)> const & setUp = nullptr) {
+         for (int ii = 0; ii < numRecipes; ++ii) {
+            auto recipe = std::make_shared<Recipe>(QString("%1 %2").arg(namePrefix).arg(ii));
+            if (setUp) {
+               setUp(*recipe, ii);
+            }
+            ObjectStoreWrapper::insert(recipe);
+            this->m_recipes.append(recipe);
+            for (int jj = 0; jj < numBrewNotesPerRecipe; ++jj) {
+               auto brewNote = std::make_shared<BrewNote>(*recipe);
+               ObjectStoreWrapper::insert(brewNote);
+               this->m_brewNotes.append(brewNote);
+            }
+         }
+         return;
+      }
+
+      ~StoredRecipes() {
+         for (auto brewNote : this->m_brewNotes) {
+            ObjectStoreWrapper::hardDelete(brewNote);
+         }
+         for (auto recipe : this->m_recipes) {
+            ObjectStoreWrapper::hardDelete(recipe);
+         }
+         return;
+      }
+
+      StoredRecipes(StoredRecipes const &) = delete;
+      StoredRecipes & operator=(StoredRecipes const &) = delete;
+
+      QList<std::shared_ptr<Recipe>> const & recipes() const { return this->m_recipes; }
+
+   private:
+      QList<std::shared_ptr<Recipe>>   m_recipes;
+      QList<std::shared_ptr<BrewNote>> m_brewNotes;
+   };
+
+   /**
+    * \brief Test fixture for any other objects a test needs to put in the ObjectStore.  As with \c StoredRecipes,
+    *        everything is hard-deleted again when the fixture goes out of scope, including when a test bails out on a
+    *        failed check.  (Objects are deleted in the reverse order to which they were stored, and anything the test
+    *        has already hard-deleted itself is skipped.)
+    */
+   class StoredObjects {
+   public:
+      StoredObjects() = default;
+
+      ~StoredObjects() {
+         for (auto hardDelete = this->m_hardDeletes.crbegin(); hardDelete != this->m_hardDeletes.crend();
+              ++hardDelete) {
+            (*hardDelete)();
+         }
+         return;
+      }
+
+      StoredObjects(StoredObjects const &) = delete;
+      StoredObjects & operator=(StoredObjects const &) = delete;
+
+      /**
+       * \brief Store \c ne in the ObjectStore
+       *
+       * \return \c ne, for convenience
+       */
+      template<class NE> std::shared_ptr<NE> insert(std::shared_ptr<NE> ne) {
+         ObjectStoreWrapper::insert(ne);
+         this->m_hardDeletes.append([ne]() {
+            if (ne->key() > 0) {
+               ObjectStoreWrapper::hardDelete(ne);
+            }
+            return;
+         });
+         return ne;
+      }
+
+   private:
+      QList<std::function<void()>> m_hardDeletes;
+   };
+
+   /**
+    * \brief Calls the supplied function when it goes out of scope.  Tests use this to put back any global setting they
+    *        change, so it gets put back even when the test bails out on a failed check.
+    */
+   class OnScopeExit {
+   public:
+      OnScopeExit(std::function<void()> cleanUp) : m_cleanUp{std::move(cleanUp)} {
+         return;
+      }
+
+      ~OnScopeExit() {
+         this->m_cleanUp();
+         return;
+      }
+
+      OnScopeExit(OnScopeExit const &) = delete;
+      OnScopeExit & operator=(OnScopeExit const &) = delete;
+
+   private:
+      std::function<void()> m_cleanUp;
+   };
+
+   /**
+    * \brief Load one copy of the \c NE object store the way \c InitialiseAllObjectStores() does (fetching the data on a
+    *        worker thread and constructing the objects on this one) and another copy entirely on this thread, and check
+    *        they come out the same.
+    *
+    * \return Empty string if all is well, otherwise a description of the first difference found
+    */
+   template<class NE> QString compareParallelAndSerialLoads() {
+      auto parallelStore = ObjectStoreTyped<NE>::makeUnloadedInstance();
+      auto serialStore   = ObjectStoreTyped<NE>::makeUnloadedInstance();
+      char const * const className = NE::staticMetaObject.className();
+
+      bool fetched = false;
+      std::thread worker{[&parallelStore, &fetched]() {
+         fetched = parallelStore->fetchAll();
+         Database::instance().closeConnectionForThisThread();
+         return;
+      }};
+      worker.join();
+      if (!fetched) {
+         return QString{"Unable to fetch %1 data on worker thread"}.arg(className);
+      }
+      parallelStore->loadAll();
+      serialStore->loadAll();
+      if (parallelStore->state() != ObjectStore::State::InitialisedOk ||
+          serialStore  ->state() != ObjectStore::State::InitialisedOk) {
+         return QString{"Unable to load %1 object store"}.arg(className);
+      }
+
+      if (parallelStore->size() != serialStore->size()) {
+         return QString{"Loaded %1 %2 objects in parallel but %3 serially"}
+            .arg(parallelStore->size()).arg(className).arg(serialStore->size());
+      }
+      QThread * const mainThread = QCoreApplication::instance()->thread();
+      for (auto const & serialObject : serialStore->getAll()) {
+         int const key = serialObject->key();
+         if (!parallelStore->contains(key)) {
+            return QString{"%1 #%2 missing from parallel load"}.arg(className).arg(key);
+         }
+         auto const parallelObject = parallelStore->getById(key);
+         if (!(*parallelObject == *serialObject)) {
+            return QString{"%1 #%2 differs between parallel and serial loads"}.arg(className).arg(key);
+         }
+         if (parallelObject->thread() != mainThread) {
+            return QString{"%1 #%2 from parallel load does not belong to main thread"}.arg(className).arg(key);
+         }
+      }
+      return QString{};
+   }
+
 }
 
 class Testing::impl {
@@ -414,6 +612,9 @@ Testing::~Testing() {
 //   - Run unit tests with  meson test
 //   - Debug log output is in mbuild/meson-logs/testlog.txt (assuming "mbuild" is your Meson build directory)
 //
+// Either way, set BREWKEN_UNIT_TEST_BENCHMARKS in the environment to have the tests that support it also report timings
+// (using enough data for them to be meaningful) -- see runBenchmarks().
+//
 // QTEST_MAIN generates (via horrible macros) a main() function for the unit test runner
 //
 QTEST_MAIN(Testing)
@@ -847,6 +1048,311 @@ void Testing::testAlgorithms() {
    return;
 }
 
+void Testing::testPostBoilUtilization() {
+   // Each call to the numerical integration takes the best part of a millisecond, so we don't want too fine a grid here
+   double maxDifference = 0.0;
+   for (double const boilTime_minutes : {0.0, 2.0, 5.0, 10.0, 30.0, 60.0, 90.0}) {
+      for (double const wortGravity_sg : {1.030, 1.060, 1.100}) {
+         for (double const coolTime_minutes : {0.0, 1.0, 3.0, 10.0, 20.0, 45.0, 60.0}) {
+            for (double const postBoilVolume_liters : {5.0, 20.0, 100.0}) {
+               for (double const kettleDiameter_cm : {10.0, 25.0, 45.0, 60.0}) {
+                  double const integrated = IbuMethods::postBoilUtilization(
+                     boilTime_minutes, wortGravity_sg, postBoilVolume_liters, coolTime_minutes,
+                     kettleDiameter_cm, kettleDiameter_cm, IbuMethods::PostBoilUtilizationMethod::Integration
+                  );
+                  double const lookedUp = IbuMethods::postBoilUtilization(
+                     boilTime_minutes, wortGravity_sg, postBoilVolume_liters, coolTime_minutes,
+                     kettleDiameter_cm, kettleDiameter_cm, IbuMethods::PostBoilUtilizationMethod::LookupTable
+                  );
+                  maxDifference = std::max(maxDifference, std::abs(integrated - lookedUp));
+                  QVERIFY2(
+                     std::abs(integrated - lookedUp) <= IbuMethods::postBoilUtilizationLookupTableMaxError,
+                     qPrintable(QString("Post-boil utilization lookup %1 too far from integrated value %2 (boil %3 "
+                                        "min, SG %4, cool %5 min, volume %6 l, diameter %7 cm)").arg(
+                                   lookedUp).arg(integrated).arg(boilTime_minutes).arg(wortGravity_sg).arg(
+                                   coolTime_minutes).arg(postBoilVolume_liters).arg(kettleDiameter_cm))
+                  );
+               }
+            }
+         }
+      }
+   }
+   qDebug() << Q_FUNC_INFO << "Max difference in post-boil utilization:" << maxDifference;
+   return;
+}
+
+void Testing::testIbuBatch() {
+   std::vector<double> const AAratings     {0.04, 0.12, 0.065, 0.15, 0.03};
+   std::vector<double> const grams         {28.0, 10.0,  50.0,  5.0, 100.0};
+   std::vector<double> const gravities     {1.040, 1.055, 1.070, 1.090, 1.110};
+   std::vector<double> const boilTimes_mins{60.0, 30.0,  15.0,  5.0, 0.0};
+   std::vector<double> batchIbus(AAratings.size());
+
+   // Put the formula back however the test exits
+   IbuMethods::IbuFormula const savedIbuFormula = IbuMethods::ibuFormula;
+   OnScopeExit const restoreIbuFormula{[savedIbuFormula]() {
+      IbuMethods::ibuFormula = savedIbuFormula;
+      return;
+   }};
+
+   for (auto const formula : {IbuMethods::IbuFormula::Tinseth,
+                              IbuMethods::IbuFormula::Rager  ,
+                              IbuMethods::IbuFormula::Noonan ,
+                              IbuMethods::IbuFormula::mIbu   ,
+                              IbuMethods::IbuFormula::Smph   }) {
+      IbuMethods::ibuFormula = formula;
+      for (double const postBoilVolume_liters : {5.0, 20.0, 100.0}) {
+         for (std::optional<double> const coolTime_minutes : {std::optional<double>{}, std::optional<double>{10.0}}) {
+            IbuMethods::getIbusBatch(
+               IbuMethods::IbuBatchParms{
+                  .AArating                  = AAratings,
+                  .hops_grams                = grams,
+                  .wortGravity_sg            = gravities,
+                  .boilTime_minutes          = boilTimes_mins,
+                  .postBoilVolume_liters     = postBoilVolume_liters,
+                  .coolTime_minutes          = coolTime_minutes,
+                  .kettleInternalDiameter_cm = 35.0,
+                  .kettleOpeningDiameter_cm  = 35.0,
+               },
+               batchIbus
+            );
+            for (std::size_t ii = 0; ii < AAratings.size(); ++ii) {
+               double const ibus = IbuMethods::getIbus(
+                  IbuMethods::IbuCalculationParms{
+                     .AArating                  = AAratings[ii],
+                     .hops_grams                = grams[ii],
+                     .postBoilVolume_liters     = postBoilVolume_liters,
+                     .wortGravity_sg            = gravities[ii],
+                     .boilTime_minutes          = boilTimes_mins[ii],
+                     .coolTime_minutes          = coolTime_minutes,
+                     .kettleInternalDiameter_cm = 35.0,
+                     .kettleOpeningDiameter_cm  = 35.0,
+                  }
+               );
+               QVERIFY2(
+                  fuzzyComp(batchIbus[ii], ibus, 1e-9),
+                  qPrintable(QString("Batch IBUs %1 differ from single IBUs %2 for %3 formula, hop addition %4, "
+                                     "volume %5 l").arg(batchIbus[ii]).arg(ibus).arg(
+                                IbuMethods::formulaStringMapping[formula]).arg(ii).arg(postBoilVolume_liters))
+               );
+            }
+         }
+      }
+   }
+   return;
+}
+
+void Testing::testDryHopOnlyIbu() {
+   // No equipment and no batch size, so the post-boil volume that IBU calculations divide by is 0
+   StoredRecipes const storedRecipes{
+      "Dry Hop Only Recipe",
+      1,
+      0,
+      [](Recipe & recipe, [[maybe_unused]] int const index) {
+         recipe.setBatchSize_l(0.0);
+         return;
+      }
+   };
+   auto const & recipe = storedRecipes.recipes().at(0);
+
+   auto dryHopAddition = std::make_shared<RecipeAdditionHop>("Cascade 4% Dry Hop Addition");
+   dryHopAddition->setHop(this->pimpl->m_cascade_4pct.get());
+   dryHopAddition->setStage(RecipeAddition::Stage::Fermentation);
+   dryHopAddition->setQuantity(0.050);
+   dryHopAddition->setMeasure(Measurement::PhysicalQuantity::Mass);
+   recipe->addAddition(dryHopAddition);
+
+   QCOMPARE(recipe->IBU(), 0.0);
+
+   RecipeCalc::Results const results = RecipeCalc::evaluate(RecipeCalc::snapshot(QList<Recipe *>{recipe.get()}));
+   QCOMPARE(results.ibu.at(0), 0.0);
+   return;
+}
+
+void Testing::testRecipeCalcMatchesRecipe() {
+   // Recipe additions refer to their ingredients by ID, so the ingredients need to be in the ObjectStore.  (The
+   // recipes, declared below, are cleaned up before the things they use.)
+   StoredObjects storedObjects;
+   auto twoRow = std::make_shared<Fermentable>("Two Row (RecipeCalc test)");
+   twoRow->setType(Fermentable::Type::Grain);
+   twoRow->setFineGrindYield_pct(70.0);
+   twoRow->setColor_srm(2.0);
+   twoRow->setMoisture_pct(0);
+   storedObjects.insert(twoRow);
+
+   // Non-fermentable sugar -- see RecipeCalc::isFermentableSugar()
+   auto lactose = std::make_shared<Fermentable>("Milk Sugar (Lactose)");
+   lactose->setType(Fermentable::Type::Sugar);
+   lactose->setFineGrindYield_pct(100.0);
+   lactose->setColor_srm(0.0);
+   storedObjects.insert(lactose);
+
+   // Hopped extract, so there is bitterness from a fermentable as well as from hops
+   auto hoppedExtract = std::make_shared<Fermentable>("Hopped Extract (RecipeCalc test)");
+   hoppedExtract->setType(Fermentable::Type::Dry_Extract);
+   hoppedExtract->setFineGrindYield_pct(95.0);
+   hoppedExtract->setColor_srm(8.0);
+   hoppedExtract->setIbuGalPerLb(20.0);
+   storedObjects.insert(hoppedExtract);
+
+   auto yeast = std::make_shared<Yeast>("Ale Yeast (RecipeCalc test)");
+   yeast->setAttenuationMin_pct(70.0);
+   yeast->setAttenuationMax_pct(80.0);
+   storedObjects.insert(yeast);
+
+   // Copy of the shared equipment, with some losses so that sugar retention and final volume come into play
+   auto equipment = std::make_shared<Equipment>(*this->pimpl->m_equipFiveGalNoLoss);
+   equipment->setName("5 gal With Loss (RecipeCalc test)");
+   equipment->setKettleTrubChillerLoss_l(2.0);
+   storedObjects.insert(equipment);
+
+   // Recipe 0 is all grain, recipe 1 is extract, and recipe 2 is all grain with equipment
+   int const numRecipes = 3;
+   StoredRecipes const storedRecipes{
+      "RecipeCalc Test Recipe",
+      numRecipes,
+      0,
+      [](Recipe & recipe, [[maybe_unused]] int const index) {
+         recipe.setBatchSize_l(20.0);
+         recipe.setEfficiency_pct(72.0);
+         return;
+      }
+   };
+   auto addFermentable = [](Recipe & recipe,
+                            Fermentable * fermentable,
+                            RecipeAddition::Stage const stage,
+                            double const quantity_kg) {
+      auto addition = std::make_shared<RecipeAdditionFermentable>();
+      addition->setFermentable(fermentable);
+      addition->setStage(stage);
+      addition->setQuantity(quantity_kg);
+      addition->setMeasure(Measurement::PhysicalQuantity::Mass);
+      recipe.addAddition(addition);
+      return;
+   };
+   auto addHop = [this](Recipe & recipe,
+                        RecipeAddition::Stage const stage,
+                        std::optional<double> const addAtTime_mins,
+                        double const quantity_kg) {
+      auto addition = std::make_shared<RecipeAdditionHop>();
+      addition->setHop(this->pimpl->m_cascade_4pct.get());
+      addition->setStage(stage);
+      addition->setAddAtTime_mins(addAtTime_mins);
+      addition->setQuantity(quantity_kg);
+      addition->setMeasure(Measurement::PhysicalQuantity::Mass);
+      recipe.addAddition(addition);
+      return;
+   };
+   QList<Recipe *> recipes;
+   for (int ii = 0; ii < numRecipes; ++ii) {
+      Recipe & recipe = *storedRecipes.recipes().at(ii);
+      if (ii == 1) {
+         addFermentable(recipe, hoppedExtract.get(), RecipeAddition::Stage::Boil, 3.0);
+      } else {
+         addFermentable(recipe, twoRow.get(), RecipeAddition::Stage::Mash, 5.0);
+      }
+      addFermentable(recipe, lactose.get(), RecipeAddition::Stage::Boil, 0.5);
+      addHop(recipe, RecipeAddition::Stage::Boil, 60.0, 0.030);
+      addHop(recipe, RecipeAddition::Stage::Boil, 15.0, 0.020);
+      addHop(recipe, RecipeAddition::Stage::Fermentation, std::nullopt, 0.050);
+
+      auto yeastAddition = std::make_shared<RecipeAdditionYeast>();
+      yeastAddition->setYeast(yeast.get());
+      yeastAddition->setStage(RecipeAddition::Stage::Fermentation);
+      yeastAddition->setAttenuation_pct(75.0);
+      yeastAddition->setQuantity(0.011);
+      yeastAddition->setMeasure(Measurement::PhysicalQuantity::Mass);
+      recipe.addAddition(yeastAddition);
+
+      if (ii == 2) {
+         recipe.setEquipment(equipment);
+      }
+      recipes.append(&recipe);
+   }
+
+   RecipeCalc::Results const results = RecipeCalc::evaluate(RecipeCalc::snapshot(recipes));
+   for (int ii = 0; ii < numRecipes; ++ii) {
+      Recipe & recipe = *recipes.at(ii);
+      qDebug() <<
+         Q_FUNC_INFO << recipe.name() << ": OG" << recipe.og() << ", FG" << recipe.fg() << ", ABV" <<
+         recipe.ABV_pct() << ", color" << recipe.color_srm() << ", IBU" << recipe.IBU();
+      QCOMPARE(results.og       .at(ii), recipe.og       ());
+      QCOMPARE(results.fg       .at(ii), recipe.fg       ());
+      QCOMPARE(results.abv_pct  .at(ii), recipe.ABV_pct  ());
+      QCOMPARE(results.color_srm.at(ii), recipe.color_srm());
+      QCOMPARE(results.ibu      .at(ii), recipe.IBU      ());
+   }
+   return;
+}
+
+void Testing::testRecipeCalcDependencies() {
+   StoredRecipes const storedRecipes{
+      "Calc Dependency Test Recipe",
+      1,
+      0,
+      [](Recipe & recipe, [[maybe_unused]] int const index) {
+         recipe.setBatchSize_l(20.0);
+         recipe.setEfficiency_pct(72.0);
+         return;
+      }
+   };
+   Recipe & recipe = *storedRecipes.recipes().at(0);
+
+   auto grainAddition = std::make_shared<RecipeAdditionFermentable>("Two Row Calc Dependency Test Addition");
+   grainAddition->setFermentable(this->pimpl->m_twoRow.get());
+   grainAddition->setStage(RecipeAddition::Stage::Mash);
+   grainAddition->setQuantity(5.0);
+   grainAddition->setMeasure(Measurement::PhysicalQuantity::Mass);
+   recipe.addAddition(grainAddition);
+
+   auto hopAddition = std::make_shared<RecipeAdditionHop>("Cascade 4% Calc Dependency Test Addition");
+   hopAddition->setHop(this->pimpl->m_cascade_4pct.get());
+   hopAddition->setStage(RecipeAddition::Stage::Boil);
+   hopAddition->setAddAtTime_mins(60.0);
+   hopAddition->setQuantity(0.030);
+   hopAddition->setMeasure(Measurement::PhysicalQuantity::Mass);
+   recipe.addAddition(hopAddition);
+
+   double const og  = recipe.og ();
+   double const fg  = recipe.fg ();
+   double const ibu = recipe.IBU();
+   QVERIFY(og > 1.0);
+   QVERIFY(ibu > 0.0);
+
+   //
+   // Nothing in this test runs the event loop, so calculations only get redone when a calculated value is read.  To
+   // see which ones get redone, we change the grain without telling the Recipe (by blocking the signal it would
+   // otherwise get).  Any calculation that is redone from here on will pick up the extra grain; any that isn't will
+   // still give the value it had before.
+   //
+   {
+      QSignalBlocker const blocker{grainAddition.get()};
+      grainAddition->setQuantity(6.0);
+   }
+   QCOMPARE(recipe.og(), og);
+
+   //
+   // A hop change only makes IBU dirty, so OG and FG are still the cached values.  Reading IBU recalculates it (with
+   // the cached OG, so the bitterness is exactly proportional to the amount of hops).
+   //
+   hopAddition->setQuantity(0.060);
+   QCOMPARE(recipe.og(), og);
+   QCOMPARE(recipe.fg(), fg);
+   QVERIFY(fuzzyComp(recipe.IBU(), 2.0 * ibu, 0.001));
+   QCOMPARE(recipe.og(), og);
+   QVERIFY(recipe.ensureCalculationsDone());
+
+   //
+   // Once the Recipe is told about a change to the grain, OG and everything that depends on it gets recalculated when
+   // read, including the change it wasn't told about.
+   //
+   grainAddition->setQuantity(7.0);
+   QVERIFY(recipe.og() > og);
+   QVERIFY(recipe.fg() > fg);
+   QVERIFY(recipe.ensureCalculationsDone());
+   return;
+}
+
 void Testing::testTypeLookups() {
    QVERIFY2(Hop::typeLookup.getType(PropertyNames::Hop::alpha_pct).typeIndex == typeid(double),
             "PropertyNames::Hop::alpha_pct not a double");
@@ -857,6 +1363,245 @@ void Testing::testTypeLookups() {
             "PropertyNames::Fermentable::grainGroup not optional enum");
    return;
 }
+
+void Testing::testObjectStoreSecondaryIndexes() {
+   // Hard-deleting the Recipes at the end also hard-deletes any additions still owned by them
+   StoredRecipes const storedRecipes{"Index Test Recipe", 2};
+   int const recipeIdA = storedRecipes.recipes().at(0)->key();
+   int const recipeIdB = storedRecipes.recipes().at(1)->key();
+
+   auto & additionStore = ObjectStoreTyped<RecipeAdditionHop>::getInstance();
+   QVERIFY(additionStore.hasIndex(PropertyNames::OwnedByRecipe::recipeId));
+
+   //
+   // Whatever has happened to the objects, looking them up via the index should give the same answer as the linear
+   // search that findAllByIndex() etc fall back to when there is no index.
+   //
+   auto checkIndexFor = [&additionStore](int const recipeId, QVector<int> expectedIds) {
+      std::sort(expectedIds.begin(), expectedIds.end());
+
+      QVector<int> linearIds = ObjectStoreWrapper::idsOfAllMatching<RecipeAdditionHop>(
+         [recipeId](RecipeAdditionHop const * addition) { return addition->recipeId() == recipeId; }
+      );
+      std::sort(linearIds.begin(), linearIds.end());
+
+      QVector<int> indexIds = additionStore.idsOfAllByIndex(PropertyNames::OwnedByRecipe::recipeId, recipeId);
+      std::sort(indexIds.begin(), indexIds.end());
+
+      QVector<int> foundIds;
+      for (auto const & addition : additionStore.findAllByIndex(PropertyNames::OwnedByRecipe::recipeId, recipeId)) {
+         foundIds.append(addition->key());
+      }
+      std::sort(foundIds.begin(), foundIds.end());
+
+      auto const firstFound = additionStore.findFirstByIndex(PropertyNames::OwnedByRecipe::recipeId, recipeId);
+
+      return linearIds == expectedIds &&
+             indexIds  == expectedIds &&
+             foundIds  == expectedIds &&
+             (firstFound ? expectedIds.contains(firstFound->key()) : expectedIds.isEmpty());
+   };
+
+   // Insert
+   auto additionA = std::make_shared<RecipeAdditionHop>("Index Test Addition A",
+                                                        recipeIdA,
+                                                        this->pimpl->m_cascade_4pct->key());
+   auto additionB = std::make_shared<RecipeAdditionHop>("Index Test Addition B",
+                                                        recipeIdA,
+                                                        this->pimpl->m_cascade_4pct->key());
+   ObjectStoreWrapper::insert(additionA);
+   ObjectStoreWrapper::insert(additionB);
+   QVERIFY(checkIndexFor(recipeIdA, {additionA->key(), additionB->key()}));
+   QVERIFY(checkIndexFor(recipeIdB, {}));
+
+   // Update of the indexed property (via ObjectStore::updateProperty())
+   additionB->setRecipeId(recipeIdB);
+   QVERIFY(checkIndexFor(recipeIdA, {additionA->key()}));
+   QVERIFY(checkIndexFor(recipeIdB, {additionB->key()}));
+
+   // Soft delete leaves the object in the store (marked deleted), so it should still be found
+   ObjectStoreWrapper::softDelete(*additionA);
+   QVERIFY(checkIndexFor(recipeIdA, {additionA->key()}));
+
+   // Hard delete removes it altogether
+   ObjectStoreWrapper::hardDelete(additionA);
+   QVERIFY(checkIndexFor(recipeIdA, {}));
+   QVERIFY(checkIndexFor(recipeIdB, {additionB->key()}));
+
+   ObjectStoreWrapper::hardDelete(additionB);
+   QVERIFY(checkIndexFor(recipeIdB, {}));
+   return;
+}
+
+void Testing::testObjectStoreNameIndex() {
+   StoredObjects storedObjects;
+   auto & hopStore = ObjectStoreTyped<Hop>::getInstance();
+
+   auto idsOf = [](QList<std::shared_ptr<Hop>> const & hops) {
+      QVector<int> ids;
+      for (auto const & hop : hops) {
+         ids.append(hop->key());
+      }
+      std::sort(ids.begin(), ids.end());
+      return ids;
+   };
+
+   //
+   // As with the secondary indexes, the name index should always give the same answers as a linear search.
+   // expectedIds are the Hops called name; expectedPossibleDuplicateIds are the ones whose names are the same as name
+   // once any duplicate number is stripped off.
+   //
+   auto checkNameIndexFor = [&hopStore, &idsOf](QString const & name,
+                                                QVector<int> expectedIds,
+                                                QVector<int> expectedPossibleDuplicateIds) {
+      std::sort(expectedIds.begin(), expectedIds.end());
+      std::sort(expectedPossibleDuplicateIds.begin(), expectedPossibleDuplicateIds.end());
+
+      QString const baseName = NamedEntity::nameWithoutDuplicateNumber(name);
+      QVector<int> const linearIds = idsOf(ObjectStoreWrapper::findAllMatching<Hop>(
+         [&name](std::shared_ptr<Hop> hop) { return hop->name() == name; }
+      ));
+      QVector<int> const linearPossibleDuplicateIds = idsOf(ObjectStoreWrapper::findAllMatching<Hop>(
+         [&baseName](std::shared_ptr<Hop> hop) {
+            return NamedEntity::nameWithoutDuplicateNumber(hop->name()) == baseName;
+         }
+      ));
+
+      return linearIds                                       == expectedIds                  &&
+             idsOf(hopStore.findAllByName(name))             == expectedIds                  &&
+             hopStore.containsName(name)                     == !expectedIds.isEmpty()       &&
+             linearPossibleDuplicateIds                      == expectedPossibleDuplicateIds &&
+             idsOf(hopStore.findAllPossibleDuplicates(name)) == expectedPossibleDuplicateIds;
+   };
+
+   QString const nameA{"Name Index Test Hop"};
+   QString const nameB{"Name Index Test Hop (1)"};
+   QString const renamedA{"Renamed Name Index Test Hop"};
+   QVERIFY(checkNameIndexFor(nameA, {}, {}));
+
+   // Insert
+   auto hopA = storedObjects.insert(std::make_shared<Hop>(nameA));
+   QVERIFY(checkNameIndexFor(nameA, {hopA->key()}, {hopA->key()}));
+
+   // Name set before the object is stored gets picked up when it is inserted
+   auto hopB = std::make_shared<Hop>();
+   hopB->setName(nameB);
+   storedObjects.insert(hopB);
+   QVERIFY(checkNameIndexFor(nameA, {hopA->key()}, {hopA->key(), hopB->key()}));
+   QVERIFY(checkNameIndexFor(nameB, {hopB->key()}, {hopA->key(), hopB->key()}));
+
+   // Rename via NamedEntity::setName (which reaches the store via ObjectStore::updateProperty())
+   hopA->setName(renamedA);
+   QVERIFY(checkNameIndexFor(nameA   , {}           , {hopB->key()}));
+   QVERIFY(checkNameIndexFor(nameB   , {hopB->key()}, {hopB->key()}));
+   QVERIFY(checkNameIndexFor(renamedA, {hopA->key()}, {hopA->key()}));
+
+   // Soft-deleted objects stay in the store, so are still found
+   ObjectStoreWrapper::softDelete(*hopB);
+   QVERIFY(checkNameIndexFor(nameB, {hopB->key()}, {hopB->key()}));
+
+   // Hard-deleted ones are not
+   ObjectStoreWrapper::hardDelete(hopB);
+   QVERIFY(checkNameIndexFor(nameA, {}, {}));
+   QVERIFY(checkNameIndexFor(nameB, {}, {}));
+   QVERIFY(checkNameIndexFor(renamedA, {hopA->key()}, {hopA->key()}));
+   return;
+}
+
+void Testing::testParallelObjectStoreLoading() {
+   QString errorMessage;
+   QVERIFY2(InitialiseAllObjectStores(errorMessage), qPrintable(errorMessage));
+
+   // However they were loaded, the singleton stores, and everything in them, should belong to the main thread
+   QThread * const mainThread = QCoreApplication::instance()->thread();
+   QCOMPARE(ObjectStoreTyped<Recipe>::getInstance().thread(), mainThread);
+   for (auto const & recipe : ObjectStoreTyped<Recipe>::getInstance().getAll()) {
+      QCOMPARE(recipe->thread(), mainThread);
+   }
+
+   // Stores with and without junction tables and secondary indexes
+   QCOMPARE(compareParallelAndSerialLoads<BrewNote   >(), QString{});
+   QCOMPARE(compareParallelAndSerialLoads<Equipment  >(), QString{});
+   QCOMPARE(compareParallelAndSerialLoads<Fermentable>(), QString{});
+   QCOMPARE(compareParallelAndSerialLoads<Hop        >(), QString{});
+   QCOMPARE(compareParallelAndSerialLoads<MashStep   >(), QString{});
+   QCOMPARE(compareParallelAndSerialLoads<Recipe     >(), QString{});
+   QCOMPARE(compareParallelAndSerialLoads<Style      >(), QString{});
+   return;
+}
+
+void Testing::testWriteBehind() {
+   StoredObjects storedObjects;
+   auto hop = storedObjects.insert(std::make_shared<Hop>("Write-Behind Test Hop"));
+   hop->setAlpha_pct(5.0);
+
+   // Read straight from the DB, rather than via the object store, to see what has actually been written
+   auto valueInDb = [&hop](QString const & columnName) {
+      QSqlQuery query{Database::instance().sqlDatabase()};
+      query.prepare(QString{"SELECT %1 FROM hop WHERE id = :id"}.arg(columnName));
+      query.bindValue(":id", hop->key());
+      return (query.exec() && query.next()) ? query.value(0) : QVariant{};
+   };
+
+   //
+   // Nothing runs the event loop during the test, so the flush timer never fires and we can see what is queued.  (We
+   // give it a long delay anyway.)  Write-behind is turned off again (which flushes the queue) before storedObjects
+   // cleans up, however the test exits.
+   //
+   ObjectStore::setWriteBehind(true, 60 * 60 * 1000);
+   OnScopeExit const writeBehindOff{[]() {
+      QSqlQuery{Database::instance().sqlDatabase()}.exec("DROP TRIGGER IF EXISTS write_behind_test_failure");
+      ObjectStore::setWriteBehind(false);
+      return;
+   }};
+
+   // Repeated changes to the same property of the same object are coalesced, and nothing is written until the flush
+   hop->setAlpha_pct(6.0);
+   hop->setAlpha_pct(7.0);
+   hop->setName("Renamed Write-Behind Test Hop");
+   QCOMPARE(ObjectStore::numQueuedWrites(), qsizetype{2});
+   QVERIFY(fuzzyComp(valueInDb("alpha").toDouble(), 5.0, 0.001));
+   QCOMPARE(valueInDb("name").toString(), QString{"Write-Behind Test Hop"});
+
+   //
+   // A change on another thread is written straight through, but not before the changes already queued on the main
+   // thread, otherwise it could overtake them.
+   //
+   std::thread worker{[&hop]() {
+      hop->setBeta_pct(4.0);
+      Database::instance().closeConnectionForThisThread();
+      return;
+   }};
+   worker.join();
+   QCOMPARE(ObjectStore::numQueuedWrites(), qsizetype{0});
+   QVERIFY(fuzzyComp(valueInDb("alpha").toDouble(), 7.0, 0.001));
+   QCOMPARE(valueInDb("name").toString(), QString{"Renamed Write-Behind Test Hop"});
+   QVERIFY(fuzzyComp(valueInDb("beta").toDouble(), 4.0, 0.001));
+
+   //
+   // If a flush fails, the changes stay queued to be retried, rather than being lost.  We make the flush fail with a
+   // trigger that rejects any update to the hop table (on this connection only).
+   //
+   hop->setAlpha_pct(8.0);
+   QVERIFY(QSqlQuery{Database::instance().sqlDatabase()}.exec(
+      "CREATE TEMP TRIGGER write_behind_test_failure BEFORE UPDATE ON hop "
+      "BEGIN SELECT RAISE(ABORT, 'Simulated write-behind failure'); END"
+   ));
+   QVERIFY(!ObjectStore::flush());
+   QCOMPARE(ObjectStore::numQueuedWrites(), qsizetype{1});
+   QVERIFY(fuzzyComp(valueInDb("alpha").toDouble(), 7.0, 0.001));
+
+   // Changes made after the failure are still coalesced with the ones put back on the queue
+   hop->setAlpha_pct(9.0);
+   QCOMPARE(ObjectStore::numQueuedWrites(), qsizetype{1});
+
+   QVERIFY(QSqlQuery{Database::instance().sqlDatabase()}.exec("DROP TRIGGER write_behind_test_failure"));
+   QVERIFY(ObjectStore::flush());
+   QCOMPARE(ObjectStore::numQueuedWrites(), qsizetype{0});
+   QVERIFY(fuzzyComp(valueInDb("alpha").toDouble(), 9.0, 0.001));
+   return;
+}
+
 void Testing::testLogRotation() {
    qDebug() << Q_FUNC_INFO << "Logging to" << Logging::getDirectory();
 
@@ -872,6 +1617,9 @@ void Testing::testLogRotation() {
       qInfo() << QString("iteration %1-4; (%2)").arg(i).arg(randomStringGenerator());
    }
 
+   // Logging is asynchronous, so make sure everything has been written (and rotated) before we look at the files
+   Logging::flush();
+
    // Put logging back to normal
    Logging::setLoggingToStderr(true);
 
@@ -892,6 +1640,383 @@ void Testing::testLogRotation() {
    return;
 }
 
+void Testing::testTreeModelLoading() {
+   //
+   // Normally, we just check that the bulk and incremental ways of loading the recipe tree give the same, correct,
+   // tree.  When benchmarking, we add enough Recipes, in enough folders, and with enough BrewNotes, for the difference
+   // in load times to show up.
+   //
+   int const numRecipes = runBenchmarks() ? 1000 : 60;
+   int const numBrewNotesPerRecipe = 2;
+   StoredRecipes const storedRecipes{
+      "Tree Test Recipe",
+      numRecipes,
+      numBrewNotesPerRecipe,
+      [](Recipe & recipe, int const index) {
+         recipe.setFolder(QString("Tree Test/Folder %1/Subfolder %2").arg(index % 20).arg(index % 3));
+         return;
+      }
+   };
+
+   // Depth-first list of the names of everything in the tree, indented by depth.  Recipe nodes are populated lazily, so
+   // we do what the view would do on expanding each node.
+   std::function<void(TreeModel &, QModelIndex const &, QString const &, QStringList &)> listTree =
+      [&listTree](TreeModel & model, QModelIndex const & parent, QString const & indent, QStringList & names) {
+         for (int row = 0; row < model.rowCount(parent); ++row) {
+            QModelIndex const child = model.index(row, 0, parent);
+            names.append(indent + model.data(child, Qt::DisplayRole).toString());
+            if (model.canFetchMore(child)) {
+               model.fetchMore(child);
+            }
+            listTree(model, child, indent + "  ", names);
+         }
+         return;
+      };
+   auto depthOf = [](QString const & name) {
+      qsizetype depth = 0;
+      while (depth < name.size() && name.at(depth) == ' ') {
+         ++depth;
+      }
+      return depth;
+   };
+
+   QElapsedTimer timer;
+   timer.start();
+   TreeModel treeModel{nullptr, TreeModel::TypeMask::Recipe};
+   qint64 const initialLoad_ms = timer.restart();
+   QStringList bulkNames;
+   listTree(treeModel, QModelIndex(), "", bulkNames);
+
+   timer.restart();
+   treeModel.reloadTreeModel(TreeModel::LoadMethod::Incremental);
+   qint64 const incrementalLoad_ms = timer.restart();
+   QStringList incrementalNames;
+   listTree(treeModel, QModelIndex(), "", incrementalNames);
+
+   timer.restart();
+   treeModel.reloadTreeModel(TreeModel::LoadMethod::Bulk);
+   qint64 const bulkReload_ms = timer.elapsed();
+   QStringList bulkReloadNames;
+   listTree(treeModel, QModelIndex(), "", bulkReloadNames);
+
+   if (runBenchmarks()) {
+      qInfo() <<
+         Q_FUNC_INFO << "Recipe tree with" << bulkNames.size() << "nodes: initial (bulk) load" << initialLoad_ms <<
+         "ms; incremental load" << incrementalLoad_ms << "ms; bulk reload" << bulkReload_ms << "ms";
+   }
+
+   QVERIFY2(bulkNames == incrementalNames, "Bulk and incremental loads give different trees");
+   QVERIFY2(bulkNames == bulkReloadNames , "Bulk reload gives a different tree from initial load");
+
+   //
+   // Each Recipe should be in the tree exactly once, in the right subfolder, and with its BrewNotes under it
+   //
+   for (int ii = 0; ii < numRecipes; ++ii) {
+      QString const recipeName = storedRecipes.recipes().at(ii)->name();
+      auto const isRecipe = [&recipeName](QString const & name) { return name.trimmed() == recipeName; };
+      QCOMPARE(static_cast<int>(std::count_if(bulkNames.cbegin(), bulkNames.cend(), isRecipe)), 1);
+
+      qsizetype const recipeRow = std::find_if(bulkNames.cbegin(), bulkNames.cend(), isRecipe) - bulkNames.cbegin();
+      qsizetype const recipeDepth = depthOf(bulkNames.at(recipeRow));
+      qsizetype parentRow = recipeRow - 1;
+      while (parentRow >= 0 && depthOf(bulkNames.at(parentRow)) >= recipeDepth) {
+         --parentRow;
+      }
+      QVERIFY2(parentRow >= 0, qPrintable(QString("%1 is not in a folder").arg(recipeName)));
+      QCOMPARE(bulkNames.at(parentRow).trimmed(), QString("Subfolder %1").arg(ii % 3));
+
+      int numChildren = 0;
+      for (qsizetype row = recipeRow + 1;
+           row < bulkNames.size() && depthOf(bulkNames.at(row)) > recipeDepth;
+           ++row) {
+         ++numChildren;
+      }
+      QCOMPARE(numChildren, numBrewNotesPerRecipe);
+   }
+
+   //
+   // Looking for a BrewNote whose Recipe node has not been expanded should still find it (by populating that node)
+   //
+   treeModel.reloadTreeModel(TreeModel::LoadMethod::Bulk);
+   Recipe * const lastRecipe = storedRecipes.recipes().last().get();
+   auto const brewNote =
+      ObjectStoreWrapper::findFirstByIndex<BrewNote>(PropertyNames::OwnedByRecipe::recipeId, lastRecipe->key());
+   QVERIFY(brewNote);
+   QModelIndex const brewNoteIndex = treeModel.findElement(brewNote.get());
+   QVERIFY(brewNoteIndex.isValid());
+   QCOMPARE(treeModel.thing(treeModel.parent(brewNoteIndex)), static_cast<NamedEntity *>(lastRecipe));
+   return;
+}
+
+void Testing::testRecipeHasDescendants() {
+   //
+   // Make a chain of versions, newest first: Recipe 2, whose immediate ancestor (aka previous version) is Recipe 0,
+   // whose immediate ancestor is Recipe 1.
+   //
+   StoredRecipes const storedRecipes{"Descendants Test Recipe", 3};
+   Recipe & recipe0 = *storedRecipes.recipes().at(0);
+   Recipe & recipe1 = *storedRecipes.recipes().at(1);
+   Recipe & recipe2 = *storedRecipes.recipes().at(2);
+   recipe2.setAncestor(recipe1);
+   recipe2.setAncestor(recipe0);
+   QCOMPARE(recipe0.getAncestorId(), recipe1.key());
+   QCOMPARE(recipe2.getAncestorId(), recipe0.key());
+
+   //
+   // Straight after start-up, no Recipe knows it has descendants until something asks.  Loading the recipe tree (the
+   // way MainWindow does, without expanding anything) shouldn't be what makes the answer right.
+   //
+   for (auto const & recipe : storedRecipes.recipes()) {
+      recipe->setHasDescendants(false);
+   }
+   TreeModel const treeModel{nullptr, TreeModel::TypeMask::Recipe};
+   QVERIFY( recipe1.hasDescendants());
+   QVERIFY( recipe0.hasDescendants());
+   QVERIFY(!recipe2.hasDescendants());
+
+   // Reverting the newest version means the one before it no longer has descendants, but the oldest still does
+   QCOMPARE(recipe2.revertToPreviousVersion(), &recipe0);
+   QVERIFY(!recipe0.hasDescendants());
+   QVERIFY( recipe1.hasDescendants());
+   QVERIFY(!recipe2.hasDescendants());
+   return;
+}
+
+void Testing::testFilterQuery() {
+   QTableView tableView;
+   HopTableModel const hopTableModel{&tableView, false};
+   int const nameColumn = static_cast<int>(HopTableModel::ColumnIndex::Name);
+
+   //
+   // Rather than set up Hops, we supply the sortKey values for each column directly.  Amounts are in canonical units
+   // (here kilograms), and an unset inventory is an invalid QVariant.
+   //
+   struct Row {
+      QString  name;
+      double   alpha_pct;
+      QVariant inventory_kg;
+   };
+   Row const eastKent {"East Kent Goldings",  5.0, 0.250};
+   Row const kentEast {"Kent East"         , 12.0, 1.000};
+   Row const saaz     {"Saaz"              ,  3.5, QVariant{}};
+   auto matches = [&hopTableModel, nameColumn](QString const & text, Row const & row) {
+      FilterQuery const query{text, hopTableModel, nameColumn};
+      return query.matches([&row](int const column) -> QVariant {
+         switch (static_cast<HopTableModel::ColumnIndex>(column)) {
+            case HopTableModel::ColumnIndex::Name          : return row.name;
+            case HopTableModel::ColumnIndex::Alpha         : return row.alpha_pct;
+            case HopTableModel::ColumnIndex::TotalInventory: return row.inventory_kg;
+            default                                        : return QVariant{};
+         }
+      });
+   };
+
+   // Empty query matches everything
+   QVERIFY(FilterQuery{}.isEmpty());
+   QVERIFY(FilterQuery("  ", hopTableModel, nameColumn).isEmpty());
+   QVERIFY(matches("", saaz));
+
+   // Plain text matches the name, ignoring case, and several words are one phrase
+   QVERIFY( matches("KENT"     , eastKent));
+   QVERIFY( matches("east kent", eastKent));
+   QVERIFY(!matches("east kent", kentEast));
+   QVERIFY( matches("kent east", kentEast));
+
+   // Column terms, by internal name or by label, ignoring case and with optional spaces around the operator
+   QVERIFY( matches("alpha>10"    , kentEast));
+   QVERIFY(!matches("alpha>10"    , eastKent));
+   QVERIFY( matches("ALPHA <= 5"  , eastKent));
+   QVERIFY(!matches("alpha<5"     , eastKent));
+   QVERIFY( matches("alpha!=5"    , kentEast));
+   QVERIFY( matches("name=saaz"   , saaz));
+   QVERIFY(!matches("name=saa"    , saaz));
+   QVERIFY( matches("name:saa"    , saaz));
+
+   // Amounts can have units, and are compared in canonical units
+   QVERIFY( matches("inventory<500g"     , eastKent));
+   QVERIFY(!matches("inventory<500g"     , kentEast));
+   QVERIFY( matches("TotalInventory>=1kg", kentEast));
+   // An unset amount only matches "not equal to"
+   QVERIFY(!matches("inventory<500g", saaz));
+   QVERIFY( matches("inventory!=0"  , saaz));
+
+   // Quoted values can contain spaces
+   QVERIFY( matches(R"(name:"east kent")", eastKent));
+   QVERIFY(!matches(R"(name:"east kent")", kentEast));
+
+   // Plain text and column terms together must all match
+   QVERIFY( matches("kent alpha>10", kentEast));
+   QVERIFY(!matches("kent alpha>10", eastKent));
+   QVERIFY( matches("alpha<10 east kent", eastKent));
+
+   // Something that looks like a column term, but for a column we don't have, is plain text
+   QVERIFY(!matches("bitterness>10", kentEast));
+   QVERIFY( matches("bitterness>10", Row{"Bitterness>10 Blend", 1.0, QVariant{}}));
+
+   //
+   // Narrowing, which is what lets the proxy model skip rows that did not match the previous query
+   //
+   auto isNarrowing = [&hopTableModel, nameColumn](QString const & newText, QString const & previousText) {
+      return FilterQuery{newText     , hopTableModel, nameColumn}.isNarrowingOf(
+             FilterQuery{previousText, hopTableModel, nameColumn});
+   };
+   QVERIFY( isNarrowing("saaz"          , "saa"           ));
+   QVERIFY(!isNarrowing("saa"           , "saaz"          ));
+   QVERIFY( isNarrowing("saa"           , ""              ));
+   QVERIFY(!isNarrowing(""              , "saa"           ));
+   QVERIFY( isNarrowing("east k"        , "east"          ));
+   QVERIFY(!isNarrowing("east"          , "east k"        ));
+   QVERIFY( isNarrowing("saaz alpha>5"  , "saaz"          ));
+   QVERIFY( isNarrowing("alpha>10"      , "alpha>5"       ));
+   QVERIFY(!isNarrowing("alpha>5"       , "alpha>10"      ));
+   QVERIFY( isNarrowing("alpha>10"      , "alpha>=10"     ));
+   QVERIFY(!isNarrowing("alpha>=10"     , "alpha>10"      ));
+   QVERIFY( isNarrowing("alpha<5"       , "alpha<10"      ));
+   QVERIFY(!isNarrowing("alpha<10"      , "alpha>5"       ));
+   QVERIFY( isNarrowing("name:saaz"     , "name:saa"      ));
+   QVERIFY(!isNarrowing("name=saaz"     , "name=saa"      ));
+   QVERIFY(!isNarrowing("inventory<1kg" , "alpha<1"       ));
+   QVERIFY( isNarrowing("inventory<500g", "inventory<1kg" ));
+
+   return;
+}
+
+void Testing::testBeerXmlExport() {
+   //
+   // When benchmarking, we want to see how long it takes to export a big recipe library.  What matters then is the
+   // number of records written rather than whether they are all different, so, to keep the test setup quick, we export
+   // a smaller set of recipes many times over.
+   //
+   int const numDistinctRecipes = 100;
+   int const numRecipesToExport = runBenchmarks() ? 10000 : numDistinctRecipes;
+   StoredRecipes const storedRecipes{"Export Test Recipe", numDistinctRecipes};
+   for (auto const & recipe : storedRecipes.recipes()) {
+      // Needed before export, as records are serialised on worker threads -- see ImportExport::exportToFile
+      QVERIFY(recipe->ensureCalculationsDone());
+   }
+   QList<Recipe const *> recipesToExport;
+   recipesToExport.reserve(numRecipesToExport);
+   for (int ii = 0; ii < numRecipesToExport; ++ii) {
+      recipesToExport.append(storedRecipes.recipes().at(ii % numDistinctRecipes).get());
+   }
+
+   BeerXML & beerXml = BeerXML::getInstance();
+   QElapsedTimer timer;
+
+   //
+   // Exporting one recipe per call to BeerXML::toXml gives a rough idea of the cost of setting up for each record, as
+   // we used to do, compared with the cost of writing the records themselves.
+   //
+   qint64 oneByOne_ms = 0;
+   if (runBenchmarks()) {
+      QFile oneByOneFile{this->pimpl->m_tempDir.filePath("exportOneByOne.xml")};
+      QVERIFY2(oneByOneFile.open(QIODevice::WriteOnly | QIODevice::Truncate),
+               "Unable to open file for one-by-one export");
+      timer.start();
+      beerXml.createXmlFile(oneByOneFile);
+      for (Recipe const * recipe : recipesToExport) {
+         beerXml.toXml(QList<Recipe const *>{recipe}, oneByOneFile);
+      }
+      oneByOneFile.close();
+      oneByOne_ms = timer.elapsed();
+      oneByOneFile.remove();
+   }
+
+   QFile batchFile{this->pimpl->m_tempDir.filePath("exportBatch.xml")};
+   QVERIFY2(batchFile.open(QIODevice::WriteOnly | QIODevice::Truncate), "Unable to open file for batch export");
+   timer.start();
+   beerXml.createXmlFile(batchFile);
+   beerXml.toXml(recipesToExport, batchFile);
+   batchFile.close();
+   qint64 const batch_ms = timer.elapsed();
+
+   if (runBenchmarks()) {
+      qInfo() <<
+         Q_FUNC_INFO << "Exporting" << numRecipesToExport << "recipes to BeerXML: one per call" << oneByOne_ms <<
+         "ms; all in one call" << batch_ms << "ms (" << batchFile.size() << "bytes)";
+   }
+
+   QVERIFY2(batchFile.open(QIODevice::ReadOnly), "Unable to read back batch export");
+   QByteArray const batchOutput = batchFile.readAll();
+   batchFile.close();
+   batchFile.remove();
+   QVERIFY2(batchOutput.count("<RECIPE>\n") == numRecipesToExport, "Wrong number of recipes in batch export");
+   QVERIFY2(batchOutput.count("<RECIPES>\n") == 1, "Recipes not all in one list in batch export");
+   QVERIFY2(batchOutput.trimmed().endsWith("</RECIPES>"), "Batch export not terminated correctly");
+   return;
+}
+
+void Testing::testExportOrderAndCancellation() {
+   //
+   // Enough Recipes for them to be split across several worker threads (see ImportExport::exportInParallel), exported
+   // in a different order from the one in which they were created, so we can see that the output order is the order we
+   // asked for rather than the order in which the workers happened to finish.
+   //
+   int const numRecipes = 50;
+   StoredRecipes const storedRecipes{"Order Test Recipe", numRecipes};
+   QList<Recipe const *> recipesToExport;
+   QStringList expectedNames;
+   for (int ii = 0; ii < numRecipes; ++ii) {
+      // Odd numbered Recipes first, in reverse order, then even numbered ones in forward order
+      int const index = ii < numRecipes / 2 ? numRecipes - 1 - 2 * ii : 2 * (ii - numRecipes / 2);
+      recipesToExport.append(storedRecipes.recipes().at(index).get());
+      expectedNames.append(storedRecipes.recipes().at(index)->name());
+   }
+
+   // In BeerJSON, each Recipe is an object with a "name" field, and in BeerXML it is a <NAME> element
+   for (auto const & [fileName, namePattern] : {
+      std::pair<QString, QString>{"exportOrder.json", R"("name"\s*:\s*"(Order Test Recipe \d+)")"},
+      std::pair<QString, QString>{"exportOrder.xml" , R"(<NAME>(Order Test Recipe \d+)</NAME>)"   }
+   }) {
+      QString const filePath = this->pimpl->m_tempDir.filePath(fileName);
+
+      qsizetype numRecordsToWrite = 0;
+      qsizetype numRecordsWritten = 0;
+      QVERIFY2(
+         ImportExport::exportToNamedFile(
+            filePath,
+            [&numRecordsWritten](qsizetype const numJustWritten) {
+               numRecordsWritten += numJustWritten;
+               return true;
+            },
+            [&numRecordsToWrite](qsizetype const numRecords) {
+               numRecordsToWrite = numRecords;
+               return;
+            },
+            &recipesToExport
+         ),
+         qPrintable(QString("Export to %1 failed").arg(fileName))
+      );
+      QCOMPARE(numRecordsToWrite, static_cast<qsizetype>(numRecipes));
+      QCOMPARE(numRecordsWritten, static_cast<qsizetype>(numRecipes));
+
+      QFile exportedFile{filePath};
+      QVERIFY2(exportedFile.open(QIODevice::ReadOnly), qPrintable(QString("Unable to read back %1").arg(fileName)));
+      QString const output = QString::fromUtf8(exportedFile.readAll());
+      exportedFile.close();
+      exportedFile.remove();
+      QStringList exportedNames;
+      QRegularExpression const nameRegexp{namePattern};
+      for (auto const & match : nameRegexp.globalMatch(output)) {
+         exportedNames.append(match.captured(1));
+      }
+      QCOMPARE(exportedNames, expectedNames);
+
+      //
+      // If the progress callback says stop, the export should stop, and not leave a partly-written file behind
+      //
+      QVERIFY2(
+         !ImportExport::exportToNamedFile(filePath,
+                                          [](qsizetype const) { return false; },
+                                          nullptr,
+                                          &recipesToExport),
+         qPrintable(QString("Cancelled export to %1 reported as completed").arg(fileName))
+      );
+      QVERIFY2(!QFile::exists(filePath), qPrintable(QString("Cancelled export left %1 behind").arg(fileName)));
+   }
+   return;
+}
+
 void Testing::cleanupTestCase() {
    Application::cleanup();
    Logging::terminateLogging();
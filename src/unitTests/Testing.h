@@ -77,15 +77,99 @@ private slots:
     */
    void testAlgorithms();
 
+   /**
+    * \brief Verify that the lookup table we use for mIBU post-boil utilization agrees with the numerical integration
+    *        it replaces, to within the documented error bound.
+    */
+   void testPostBoilUtilization();
+
+   /**
+    * \brief Verify that, for each IBU formula, \c IbuMethods::getIbusBatch gives the same results as calling
+    *        \c IbuMethods::getIbus for each hop addition in turn.
+    */
+   void testIbuBatch();
+
+   /**
+    * \brief Verify that a recipe whose only hops are dry hops has no bitterness, even when it has no volume.
+    */
+   void testDryHopOnlyIbu();
+
+   /**
+    * \brief Verify that the batch calculations in \c RecipeCalc give the same OG, FG, ABV, color and IBU as \c Recipe
+    *        itself, for recipes with and without equipment.
+    */
+   void testRecipeCalcMatchesRecipe();
+
+   /**
+    * \brief Verify that, when one of a \c Recipe's inputs changes, only the calculations that depend on it are redone,
+    *        and that a calculated value that is out of date is recalculated when it is read.
+    */
+   void testRecipeCalcDependencies();
+
    /**
     * \brief Verify the mechanism we use for looking up type info about a parameter in the "model" classes (ie
     *        \c NamedEntity and subclasses thereof).
     */
    void testTypeLookups();
 
+   /**
+    * \brief Verify that \c ObjectStore secondary indexes give the same answers as a linear search after an object is
+    *        inserted, has its indexed property updated, and is soft- and hard-deleted.
+    */
+   void testObjectStoreSecondaryIndexes();
+
+   /**
+    * \brief Verify that \c ObjectStore name lookups (\c findAllByName, \c containsName and
+    *        \c findAllPossibleDuplicates) give the same answers as a linear search after objects are inserted, renamed,
+    *        and soft- and hard-deleted.
+    */
+   void testObjectStoreNameIndex();
+
+   /**
+    * \brief Verify that loading object stores in parallel gives the same objects as loading them serially, and that
+    *        the objects always belong to the main thread.
+    */
+   void testParallelObjectStoreLoading();
+
+   /**
+    * \brief Verify that \c ObjectStore write-behind coalesces repeated changes, writes queued changes before any
+    *        change made on another thread, and keeps changes queued when a flush fails.
+    */
+   void testWriteBehind();
+
    //! \brief Verify Log rotation is working
    void testLogRotation();
 
+   /**
+    * \brief Verify that the bulk and incremental ways of loading a \c TreeModel give the same, correct, tree (and, when
+    *        benchmarking, report how long each takes).
+    */
+   void testTreeModelLoading();
+
+   /**
+    * \brief Verify that an old version of a \c Recipe knows it has descendants (ie later versions) without anything,
+    *        eg the recipe tree, first having loaded the ancestry of those later versions.
+    */
+   void testRecipeHasDescendants();
+
+   /**
+    * \brief Verify how \c FilterQuery parses catalog search text (plain text, column terms, units and quoting), and
+    *        when it says one query is narrower than another.
+    */
+   void testFilterQuery();
+
+   /**
+    * \brief Verify that exporting lots of recipes to BeerXML gives the right number of records (and, when
+    *        benchmarking, report how long it takes).
+    */
+   void testBeerXmlExport();
+
+   /**
+    * \brief Verify that, for both BeerXML and BeerJSON, exported records come out in the order we asked for, and that
+    *        cancelling an export stops it and removes the partly-written file.
+    */
+   void testExportOrderAndCancellation();
+
 };
 
 #endif
@@ -0,0 +1,73 @@
+/*======================================================================================================================
+ * utils/MappedFile.cpp is part of Brewken, and is copyright the following authors 2024:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#include "utils/MappedFile.h"
+
+#include <QDebug>
+
+MappedFile::MappedFile(QString const & fileName) :
+   m_file{fileName},
+   m_mapping{nullptr},
+   m_fileData{},
+   m_contents{} {
+   return;
+}
+
+MappedFile::~MappedFile() {
+   if (this->m_mapping) {
+      this->m_file.unmap(this->m_mapping);
+   }
+   return;
+}
+
+bool MappedFile::open() {
+   if (!this->m_file.open(QIODevice::ReadOnly)) {
+      qWarning() <<
+         Q_FUNC_INFO << "Could not open" << this->m_file.fileName() << "for reading (error #" << this->m_file.error() <<
+         ":" << this->m_file.errorString() << ")";
+      return false;
+   }
+
+   qint64 const fileSize = this->m_file.size();
+   if (fileSize == 0) {
+      // Nothing to map, and QFile::map would fail anyway
+      return true;
+   }
+
+   this->m_mapping = this->m_file.map(0, fileSize);
+   if (this->m_mapping) {
+      this->m_contents = QByteArrayView{this->m_mapping, static_cast<qsizetype>(fileSize)};
+      return true;
+   }
+
+   qDebug() <<
+      Q_FUNC_INFO << "Could not map" << this->m_file.fileName() << "(" << this->m_file.errorString() << "), so "
+      "reading it into memory instead";
+   this->m_fileData = this->m_file.readAll();
+   this->m_contents = this->m_fileData;
+   return true;
+}
+
+QByteArrayView MappedFile::contents() const {
+   return this->m_contents;
+}
+
+bool MappedFile::isMapped() const {
+   return this->m_mapping != nullptr;
+}
+
+QFile const & MappedFile::file() const {
+   return this->m_file;
+}
@@ -0,0 +1,76 @@
+/*======================================================================================================================
+ * utils/MappedFile.h is part of Brewken, and is copyright the following authors 2024:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewken is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Brewken is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ =====================================================================================================================*/
+#ifndef UTILS_MAPPEDFILE_H
+#define UTILS_MAPPEDFILE_H
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+
+/**
+ * \brief Read-only access to the whole contents of a file, without making a copy of it in memory.
+ *
+ *        We use \c QFile::map to map the file into memory, so the OS pages it in from disk as it is read (and can drop
+ *        pages again if memory is short).  This means that parsing a large import file doesn't need the file's size
+ *        in memory on top of whatever the parser builds from it.
+ *
+ *        Not every file can be mapped (eg compressed Qt resources can't), so, if mapping fails, we fall back to
+ *        reading the file into memory.  Callers don't need to care which happened.
+ */
+class MappedFile {
+public:
+   MappedFile(QString const & fileName);
+   ~MappedFile();
+
+   /**
+    * \brief Open and map (or, failing that, read) the file
+    *
+    * \return \c true if succeeded, \c false otherwise, in which case \c file() can be used to get the error
+    */
+   [[nodiscard]] bool open();
+
+   /**
+    * \brief The contents of the file.  Only valid after a successful call to \c open(), and for as long as this object
+    *        exists.
+    */
+   QByteArrayView contents() const;
+
+   //! \return \c true if \c contents() is a mapping of the file rather than a copy of it
+   bool isMapped() const;
+
+   //! For getting the file name, error etc
+   QFile const & file() const;
+
+private:
+   QFile m_file;
+   uchar * m_mapping;
+   //! Only used if we can't map the file
+   QByteArray m_fileData;
+   QByteArrayView m_contents;
+
+   //! No copy constructor, as the mapping belongs to us
+   MappedFile(MappedFile const &) = delete;
+   //! No assignment operator
+   MappedFile & operator=(MappedFile const &) = delete;
+   //! No move constructor
+   MappedFile(MappedFile &&) = delete;
+   //! No move assignment
+   MappedFile & operator=(MappedFile &&) = delete;
+};
+
+#endif